@@ -399,11 +399,12 @@ void simple_update() {
  */
 #ifdef DUMP_EKF
 
-extern float **P, *X;	// covariance matrix and state vector
+extern float X[];	// state vector
 
 void print_ekf_binary() 
 {
 	uint16_t states = ins_get_num_states();
+	float PDiag[16];
 	uint8_t framing[16] = { 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 };
 	// Dump raw buffer
 	PIOS_COM_SendBuffer(PIOS_COM_AUX, &framing[0], 16);                                                         // framing header (1:16)
@@ -417,12 +418,14 @@ void print_ekf_binary()
 	
 	PIOS_COM_SendBuffer(PIOS_COM_AUX, (uint8_t *) & gps_data, sizeof(gps_data));                                // gps data (58:85)
 	
-	PIOS_COM_SendBuffer(PIOS_COM_AUX, (uint8_t *) & X, 4 * states);                                             // X (86:149)
-	for(uint8_t i = 0; i < states; i++) 
-		PIOS_COM_SendBuffer(PIOS_COM_AUX, (uint8_t *) &((*P)[i + i * states]), 4);                         // diag(P) (150:213)
+	PIOS_COM_SendBuffer(PIOS_COM_AUX, (uint8_t *) X, 4 * states);                                               // X (86:149)
+	INSGetPDiag(PDiag);
+	PIOS_COM_SendBuffer(PIOS_COM_AUX, (uint8_t *) PDiag, 4 * states);                                           // diag(P) (150:213)
 	
 	PIOS_COM_SendBuffer(PIOS_COM_AUX, (uint8_t *) & altitude_data.altitude, 4);                                 // BaroAlt (214:217)
 	PIOS_COM_SendBuffer(PIOS_COM_AUX, (uint8_t *) & baro_offset, 4);                                            // baro_offset (218:221)
+	PIOS_COM_SendBuffer(PIOS_COM_AUX, (uint8_t *) & altitude_data.updated, 1);                                  // baro update (222)
+	PIOS_COM_SendBuffer(PIOS_COM_AUX, (uint8_t *) & ahrs_algorithm, 1);                                         // algorithm (223)
 }
 #else
 void print_ekf_binary() {}
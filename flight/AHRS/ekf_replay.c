@@ -0,0 +1,543 @@
+/**
+ ******************************************************************************
+ * @addtogroup AHRS
+ * @{
+ * @addtogroup INSGPS
+ * @{
+ * @brief INSGPS is a joint attitude and position estimation EKF
+ *
+ * @file       ekf_replay.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+ * @brief      Host replay of recorded AHRS EKF logs through the INSGPS filters
+ *             with per step timing.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * Built by Makefile.posix against insgps13state.c (ekf_replay13) and
+ * insgps16state.c (ekf_replay16).
+ *
+ * The input is the stream written by print_ekf_binary() when the AHRS is
+ * built with DUMP_EKF, as captured by the SerialLogger.  Every frame is
+ * fed through the same sequence as ins_outdoor_update() / ins_indoor_update()
+ * in ahrs.c, so keep replay_update() in step with those.
+ *
+ * Usage: ekf_replay [options] log
+ *   -s states   number of states in the log frames (13 or 16, default 13)
+ *   -o n        AHRSSettings.Downsampling used when recording (default 20)
+ *   -a n        AHRSSettings.Algorithm to replay with (2 indoor, 3 outdoor),
+ *               default taken from the log or outdoor for old logs
+ *   -b x,y,z    HomeLocation.Be, magnetic field in NED (default 1,0,0)
+ *   -x factor   pace the replay at factor times real time (default 0,
+ *               run as fast as possible)
+ *   -t file     write a CSV trace of the replayed and on-board states
+ *       ekf_replay -g log [seconds]
+ *               write a synthetic outdoor flight log instead
+ */
+
+#include "inc/insgps.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <math.h>
+#include <time.h>
+#include <errno.h>
+
+#define DEG_TO_RAD         (M_PI / 180.0)
+
+// From ahrs.c
+#define INSGPS_GPS_TIMEOUT 2   /* 2 seconds triggers reinit of position */
+
+// From STM32103CB_AHRS.h, blocks of ADC conversions per second before downsampling
+#define PIOS_ADC_NUM_PINS  8
+#define PIOS_ADC_RATE      (72.0e6 / 16 / 2 / 252 / (PIOS_ADC_NUM_PINS / 2))
+
+// AHRSSettings.Algorithm
+#define ALGORITHM_INSGPS_INDOOR_NOMAG 1
+#define ALGORITHM_INSGPS_INDOOR       2
+#define ALGORITHM_INSGPS_OUTDOOR      3
+
+#define MAX_STATES         16
+#define HIST_BUCKETS       24   /* power of two buckets from 1 ns */
+
+// Frame layout of print_ekf_binary(), offsets from the framing header
+#define FRAME_COUNTS       16
+#define FRAME_ACCEL        20
+#define FRAME_GYRO         32
+#define FRAME_MAG_UPDATED  44
+#define FRAME_MAG          45
+#define FRAME_GPS          57   /* NED[3], heading, groundspeed, quality, updated */
+#define FRAME_X            85
+#define FRAME_PDIAG(n)     (FRAME_X + 4 * (n))
+#define FRAME_BARO(n)      (FRAME_X + 8 * (n))
+#define FRAME_BARO_OFFSET(n) (FRAME_BARO(n) + 4)
+#define FRAME_BARO_UPDATED(n) (FRAME_BARO(n) + 8)   /* not in logs before the flags were added */
+#define FRAME_ALGORITHM(n) (FRAME_BARO(n) + 9)
+#define FRAME_MIN_LEN(n)   (FRAME_BARO(n) + 8)
+#define FRAME_LEN(n)       (FRAME_BARO(n) + 10)
+
+static const uint8_t framing[16] = { 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0 };
+
+struct ekf_frame {
+	int32_t counts;
+	float accel[3];
+	float gyro[3];
+	bool mag_updated;
+	float mag[3];
+	float NED[3];
+	float heading;
+	float groundspeed;
+	bool gps_updated;
+	float X[MAX_STATES];
+	float PDiag[MAX_STATES];
+	float baro;
+	float baro_offset;
+	int baro_updated;	/* -1 when not in the log */
+	int algorithm;		/* -1 when not in the log */
+};
+
+struct step_timing {
+	uint64_t prediction;
+	uint64_t correction;
+};
+
+extern float X[];	// filter state vector
+
+static float baro_offset;
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static float get_float(const uint8_t * buf, int offset)
+{
+	float f;
+	memcpy(&f, buf + offset, sizeof(f));
+	return f;
+}
+
+static void put_float(uint8_t * buf, int offset, float f)
+{
+	memcpy(buf + offset, &f, sizeof(f));
+}
+
+/**
+ * Split a raw log into frames.  Frames are delimited by the framing header, anything
+ * too short to hold a frame with the given number of states is dropped.
+ */
+static int parse_log(const uint8_t * dat, size_t len, int states, struct ekf_frame ** frames)
+{
+	size_t start, next;
+	int n = 0, max = 0;
+
+	*frames = 0;
+	for (start = 0; start + sizeof(framing) <= len; start = next) {
+		if (memcmp(dat + start, framing, sizeof(framing))) {
+			next = start + 1;
+			continue;
+		}
+		for (next = start + FRAME_MIN_LEN(states); next + sizeof(framing) <= len; next++)
+			if (!memcmp(dat + next, framing, sizeof(framing)))
+				break;
+		if (next + sizeof(framing) > len)
+			next = len;
+		if (next - start < FRAME_MIN_LEN(states) || start + FRAME_MIN_LEN(states) > len)
+			continue;
+
+		if (n == max) {
+			max = max ? 2 * max : 1024;
+			*frames = realloc(*frames, max * sizeof(**frames));
+		}
+		struct ekf_frame *f = &(*frames)[n++];
+		const uint8_t *p = dat + start;
+		memset(f, 0, sizeof(*f));
+		memcpy(&f->counts, p + FRAME_COUNTS, sizeof(f->counts));
+		for (int i = 0; i < 3; i++) {
+			f->accel[i] = get_float(p, FRAME_ACCEL + 4 * i);
+			f->gyro[i] = get_float(p, FRAME_GYRO + 4 * i);
+			f->mag[i] = get_float(p, FRAME_MAG + 4 * i);
+			f->NED[i] = get_float(p, FRAME_GPS + 4 * i);
+		}
+		f->mag_updated = p[FRAME_MAG_UPDATED];
+		f->heading = get_float(p, FRAME_GPS + 12);
+		f->groundspeed = get_float(p, FRAME_GPS + 16);
+		f->gps_updated = p[FRAME_GPS + 24];
+		for (int i = 0; i < states; i++) {
+			f->X[i] = get_float(p, FRAME_X + 4 * i);
+			f->PDiag[i] = get_float(p, FRAME_PDIAG(states) + 4 * i);
+		}
+		f->baro = get_float(p, FRAME_BARO(states));
+		f->baro_offset = get_float(p, FRAME_BARO_OFFSET(states));
+		if (next - start >= FRAME_LEN(states)) {
+			f->baro_updated = p[FRAME_BARO_UPDATED(states)];
+			f->algorithm = (int8_t) p[FRAME_ALGORITHM(states)];
+		} else {
+			f->baro_updated = -1;
+			f->algorithm = -1;
+		}
+	}
+	return n;
+}
+
+/**
+ * Start from the on-board state of the first frame, or level and north
+ * from the accels when that is not valid, like ins_init_algorithm().
+ */
+static void replay_init(const struct ekf_frame * f, int states, const float Be[3])
+{
+	float Pdiag[16] = { 25, 25, 25, 5, 5, 5, 1e-5, 1e-5, 1e-5, 1e-5, 1e-5, 1e-5, 1e-5, 1e-4, 1e-4, 1e-4 };
+	float zeros[3] = { 0, 0, 0 }, q[4], accel_bias[3] = { 0, 0, 0 };
+	float qmag = sqrt(f->X[6] * f->X[6] + f->X[7] * f->X[7] + f->X[8] * f->X[8] + f->X[9] * f->X[9]);
+
+	INSGPSInit();
+	INSSetMagNorth((float *) Be);
+
+	if (fabs(qmag - 1) < 1e-3) {
+		if (states == 16)
+			memcpy(accel_bias, &f->X[13], sizeof(accel_bias));
+		INSSetState((float *) &f->X[0], (float *) &f->X[3], (float *) &f->X[6], (float *) &f->X[10], accel_bias);
+	} else {
+		float mag = sqrt(f->accel[0] * f->accel[0] + f->accel[1] * f->accel[1] + f->accel[2] * f->accel[2]);
+		float pitch = asinf(-f->accel[0] / mag) / 2, roll = atan2(f->accel[1] / mag, f->accel[2] / mag) / 2;
+		q[0] = cos(roll) * cos(pitch);
+		q[1] = sin(roll) * cos(pitch);
+		q[2] = cos(roll) * sin(pitch);
+		q[3] = -sin(roll) * sin(pitch);
+		INSSetState(zeros, zeros, q, zeros, zeros);
+	}
+	INSResetP(Pdiag);
+}
+
+/**
+ * One EKF step, following ins_outdoor_update() and ins_indoor_update()
+ */
+static void replay_update(const struct ekf_frame * f, int algorithm, bool baro_updated,
+			  float dT, float delay, struct step_timing * timing)
+{
+	float gyro[3], accel[3], mag[3], NED[3], vel[3];
+	uint16_t sensors = 0;
+	uint64_t t0 = now_ns(), t1;
+
+	memcpy(gyro, f->gyro, sizeof(gyro));
+	memcpy(accel, f->accel, sizeof(accel));
+	memcpy(mag, f->mag, sizeof(mag));
+	memcpy(NED, f->NED, sizeof(NED));
+
+	INSStatePrediction(gyro, accel, dT);
+	INSCovariancePrediction(dT);
+	t1 = now_ns();
+	timing->prediction = t1 - t0;
+
+	if (algorithm == ALGORITHM_INSGPS_OUTDOOR) {
+		if (f->gps_updated) {
+			vel[0] = f->groundspeed * cos(f->heading * DEG_TO_RAD);
+			vel[1] = f->groundspeed * sin(f->heading * DEG_TO_RAD);
+			vel[2] = 0;
+
+			if (delay > INSGPS_GPS_TIMEOUT)
+				INSPosVelReset(NED, vel);	// position stale, reset
+			else
+				sensors |= HORIZ_SENSORS | POS_SENSORS;
+
+			if (fabs(f->NED[2] + (f->baro - baro_offset)) > 10)
+				baro_offset = f->NED[2] + f->baro;
+			else
+				baro_offset = baro_offset * 0.999 + (f->NED[2] + f->baro) * 0.001;
+		} else if (delay > INSGPS_GPS_TIMEOUT) {
+			vel[0] = vel[1] = vel[2] = 0;
+			sensors |= VERT_SENSORS | HORIZ_SENSORS;
+		} else {
+			vel[0] = vel[1] = vel[2] = 0;
+		}
+		if (f->mag_updated)
+			sensors |= MAG_SENSORS;
+		if (baro_updated)
+			sensors |= BARO_SENSOR;
+		INSCorrection(mag, NED, vel, f->baro - baro_offset, sensors);
+	} else {
+		vel[0] = vel[1] = vel[2] = 0;
+		if (delay > INSGPS_GPS_TIMEOUT)
+			INSPosVelReset(vel, vel);
+		else
+			sensors = HORIZ_SENSORS | VERT_SENSORS;
+		if (f->mag_updated && algorithm == ALGORITHM_INSGPS_INDOOR)
+			sensors |= MAG_SENSORS;
+		if (baro_updated)
+			sensors |= BARO_SENSOR;
+		INSCorrection(mag, NED, vel, f->baro, sensors | HORIZ_SENSORS | VERT_SENSORS);
+	}
+	timing->correction = now_ns() - t1;
+}
+
+static int compare_u64(const void *a, const void *b)
+{
+	uint64_t x = *(const uint64_t *) a, y = *(const uint64_t *) b;
+	return x < y ? -1 : x > y;
+}
+
+static void print_histogram(const char *name, uint64_t * ns, int n)
+{
+	int hist[HIST_BUCKETS] = { 0 }, first = HIST_BUCKETS, last = 0;
+
+	for (int i = 0; i < n; i++) {
+		int b = 0;
+		while (b < HIST_BUCKETS - 1 && ns[i] >= (2ULL << b))
+			b++;
+		hist[b]++;
+		if (b < first)
+			first = b;
+		if (b > last)
+			last = b;
+	}
+	qsort(ns, n, sizeof(*ns), compare_u64);
+
+	printf("%s latency (ns): p50 %llu  p90 %llu  p99 %llu  max %llu\n", name,
+	       (unsigned long long) ns[n / 2], (unsigned long long) ns[(int) (n * 0.9)],
+	       (unsigned long long) ns[(int) (n * 0.99)], (unsigned long long) ns[n - 1]);
+	for (int b = first; b <= last; b++) {
+		int width = (int) (50.0 * hist[b] / n + 0.5);
+		printf("  < %9llu %8d %6.2f%% ", 2ULL << b, hist[b], 100.0 * hist[b] / n);
+		while (width--)
+			putchar('#');
+		putchar('\n');
+	}
+}
+
+/**
+ * Level flight on a 50 m circle at 10 m/s, gps at 5 Hz, mag at 50 Hz, baro at 25 Hz,
+ * framed like print_ekf_binary() for a 13 state filter.
+ */
+static int write_synthetic_log(const char *fn, float seconds, int downsampling)
+{
+	const float speed = 10, radius = 50, g = 9.81, Be[3] = { 0.6, 0.1, 0.8 };
+	const float block_rate = PIOS_ADC_RATE / downsampling;
+	const int states = 13;
+	uint8_t frame[FRAME_LEN(13)];
+	uint32_t seed = 12345;
+	FILE *out = fopen(fn, "wb");
+
+	if (!out) {
+		perror(fn);
+		return 2;
+	}
+
+#define NOISE(a) ((seed = seed * 1103515245 + 12345), (a) * (((seed >> 8) & 0xffff) / 32768.0f - 1))
+	for (int32_t counts = 0; counts < seconds * block_rate; counts += 2) {
+		float t = counts / block_rate, w = speed / radius, yaw = w * t;
+		float cy = cos(yaw), sy = sin(yaw);
+		int step = counts / 2;
+
+		memset(frame, 0, sizeof(frame));
+		memcpy(frame, framing, sizeof(framing));
+		memcpy(frame + FRAME_COUNTS, &counts, sizeof(counts));
+		put_float(frame, FRAME_ACCEL, NOISE(0.1));
+		put_float(frame, FRAME_ACCEL + 4, speed * w + NOISE(0.1));
+		put_float(frame, FRAME_ACCEL + 8, -g + NOISE(0.1));
+		put_float(frame, FRAME_GYRO, NOISE(0.01));
+		put_float(frame, FRAME_GYRO + 4, NOISE(0.01));
+		put_float(frame, FRAME_GYRO + 8, w + NOISE(0.01));
+		frame[FRAME_MAG_UPDATED] = (step % 2) == 0;
+		put_float(frame, FRAME_MAG, 500 * (cy * Be[0] + sy * Be[1]) + NOISE(5));
+		put_float(frame, FRAME_MAG + 4, 500 * (-sy * Be[0] + cy * Be[1]) + NOISE(5));
+		put_float(frame, FRAME_MAG + 8, 500 * Be[2] + NOISE(5));
+		put_float(frame, FRAME_GPS, radius * sy + NOISE(1));
+		put_float(frame, FRAME_GPS + 4, radius * (1 - cy) + NOISE(1));
+		put_float(frame, FRAME_GPS + 8, -100 + NOISE(2));
+		put_float(frame, FRAME_GPS + 12, fmod(yaw / DEG_TO_RAD, 360));
+		put_float(frame, FRAME_GPS + 16, speed + NOISE(0.2));
+		put_float(frame, FRAME_GPS + 20, 1);
+		frame[FRAME_GPS + 24] = (step % 15) == 0;
+		if (step == 0)
+			put_float(frame, FRAME_X + 6 * 4, 1);
+		put_float(frame, FRAME_BARO(states), 350 + NOISE(0.5));
+		frame[FRAME_BARO_UPDATED(states)] = (step % 3) == 0;
+		frame[FRAME_ALGORITHM(states)] = ALGORITHM_INSGPS_OUTDOOR;
+		fwrite(frame, sizeof(frame), 1, out);
+	}
+#undef NOISE
+	fclose(out);
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	int states = 13, downsampling = 20, algorithm = -1, opt_end = argc;
+	float Be[3] = { 1, 0, 0 }, speedup = 0;
+	const char *trace_fn = 0, *log_fn = 0;
+	FILE *trace = 0;
+
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "-g") && i + 1 < argc) {
+			return write_synthetic_log(argv[i + 1], i + 2 < argc ? atof(argv[i + 2]) : 60, downsampling);
+		} else if (!strcmp(argv[i], "-s") && i + 1 < argc) {
+			states = atoi(argv[++i]);
+		} else if (!strcmp(argv[i], "-o") && i + 1 < argc) {
+			downsampling = atoi(argv[++i]);
+		} else if (!strcmp(argv[i], "-a") && i + 1 < argc) {
+			algorithm = atoi(argv[++i]);
+		} else if (!strcmp(argv[i], "-b") && i + 1 < argc) {
+			if (sscanf(argv[++i], "%f,%f,%f", &Be[0], &Be[1], &Be[2]) != 3)
+				opt_end = i;
+		} else if (!strcmp(argv[i], "-x") && i + 1 < argc) {
+			speedup = atof(argv[++i]);
+		} else if (!strcmp(argv[i], "-t") && i + 1 < argc) {
+			trace_fn = argv[++i];
+		} else if (argv[i][0] != '-' && !log_fn) {
+			log_fn = argv[i];
+		} else {
+			opt_end = i;
+			break;
+		}
+	}
+	if (!log_fn || opt_end != argc || (states != 13 && states != 16) || downsampling <= 0) {
+		fprintf(stderr, "usage: %s [-s states] [-o downsampling] [-a algorithm] [-b Bx,By,Bz] "
+			"[-x factor] [-t trace.csv] log\n       %s -g log [seconds]\n", argv[0], argv[0]);
+		return 2;
+	}
+
+	// Read and split the log
+	FILE *in = fopen(log_fn, "rb");
+	if (!in) {
+		perror(log_fn);
+		return 2;
+	}
+	fseek(in, 0, SEEK_END);
+	size_t len = ftell(in);
+	fseek(in, 0, SEEK_SET);
+	uint8_t *dat = malloc(len ? len : 1);
+	if (fread(dat, 1, len, in) != len) {
+		perror(log_fn);
+		return 2;
+	}
+	fclose(in);
+
+	struct ekf_frame *frames;
+	int n = parse_log(dat, len, states, &frames);
+	free(dat);
+	if (n < 2) {
+		fprintf(stderr, "%s: no EKF frames with %d states\n", log_fn, states);
+		return 2;
+	}
+
+	if (trace_fn && !(trace = fopen(trace_fn, "w"))) {
+		perror(trace_fn);
+		return 2;
+	}
+
+	// Norm of the home location field, like homelocation_callback()
+	float Bmag = sqrt(Be[0] * Be[0] + Be[1] * Be[1] + Be[2] * Be[2]);
+	for (int i = 0; i < 3; i++)
+		Be[i] /= Bmag;
+
+	int filter_states = ins_get_num_states();
+	float block_rate = PIOS_ADC_RATE / downsampling;
+	float dT = 1 / (block_rate / 2);	// 1 / EKF_RATE
+	uint64_t *total_ns = malloc(n * sizeof(uint64_t));
+	uint64_t *pred_ns = malloc(n * sizeof(uint64_t));
+	uint64_t *corr_ns = malloc(n * sizeof(uint64_t));
+	int late = 0;
+
+	if (trace) {
+		fprintf(trace, "t,algorithm,baro_offset");
+		for (int i = 0; i < filter_states; i++)
+			fprintf(trace, ",X%d", i);
+		for (int i = 0; i < filter_states; i++)
+			fprintf(trace, ",P%d", i);
+		for (int i = 0; i < states; i++)
+			fprintf(trace, ",logX%d", i);
+		fprintf(trace, "\n");
+	}
+
+	replay_init(&frames[0], states, Be);
+	baro_offset = frames[0].baro_offset;
+
+	uint64_t start = now_ns();
+	for (int k = 0; k < n; k++) {
+		const struct ekf_frame *f = &frames[k];
+		float t = (f->counts - frames[0].counts) / block_rate;
+		float delay = k ? (f->counts - frames[k - 1].counts) / block_rate : 0;
+		int alg = algorithm >= 0 ? algorithm : f->algorithm >= 0 ? f->algorithm : ALGORITHM_INSGPS_OUTDOOR;
+		bool baro_updated = f->baro_updated >= 0 ? f->baro_updated : k && f->baro != frames[k - 1].baro;
+		struct step_timing timing;
+
+		if (speedup > 0) {
+			uint64_t due = start + (uint64_t) (t / speedup * 1e9), now = now_ns();
+			if (now < due) {
+				struct timespec ts = { (due - now) / 1000000000ULL, (due - now) % 1000000000ULL };
+				while (nanosleep(&ts, &ts) && errno == EINTR) ;
+			} else if (now - due > dT / speedup * 1e9) {
+				late++;
+			}
+		}
+
+		replay_update(f, alg, baro_updated, dT, delay, &timing);
+		pred_ns[k] = timing.prediction;
+		corr_ns[k] = timing.correction;
+		total_ns[k] = timing.prediction + timing.correction;
+
+		if (trace) {
+			float PDiag[MAX_STATES];
+			INSGetPDiag(PDiag);
+			fprintf(trace, "%.4f,%d,%g", t, alg, baro_offset);
+			for (int i = 0; i < filter_states; i++)
+				fprintf(trace, ",%g", X[i]);
+			for (int i = 0; i < filter_states; i++)
+				fprintf(trace, ",%g", PDiag[i]);
+			// The on-board state after this step is dumped at the start of the next one
+			for (int i = 0; i < states; i++)
+				if (k + 1 < n)
+					fprintf(trace, ",%g", frames[k + 1].X[i]);
+				else
+					fprintf(trace, ",");
+			fprintf(trace, "\n");
+		}
+	}
+	double elapsed = (now_ns() - start) / 1e9;
+	double duration = (frames[n - 1].counts - frames[0].counts) / block_rate + dT;
+
+	printf("%d frames, %d state log, %d state filter, EKF rate %.1f Hz\n", n, states, filter_states, 1 / dT);
+	printf("replayed %.1f s of flight in %.3f s (%.1fx real time", duration, elapsed, duration / elapsed);
+	if (speedup > 0)
+		printf(", paced at %gx, %d late steps", speedup, late);
+	printf(")\n");
+	printf("final position %.2f %.2f %.2f  velocity %.2f %.2f %.2f  q %.4f %.4f %.4f %.4f\n",
+	       Nav.Pos[0], Nav.Pos[1], Nav.Pos[2], Nav.Vel[0], Nav.Vel[1], Nav.Vel[2],
+	       Nav.q[0], Nav.q[1], Nav.q[2], Nav.q[3]);
+	print_histogram("step", total_ns, n);
+	print_histogram("prediction", pred_ns, n);
+	print_histogram("correction", corr_ns, n);
+
+	if (trace)
+		fclose(trace);
+	free(frames);
+	free(total_ns);
+	free(pred_ns);
+	free(corr_ns);
+	return isnan(Nav.q[0]) ? 1 : 0;
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -39,17 +39,35 @@
 #define NUMV 10			// number of measurements, v is the measurement noise vector
 #define NUMU 6			// number of deterministic inputs, U is the input vector
 
+// Covariance kernels, selected at compile time:
+//   default      - P stored as its packed upper triangle, kernels skip the zero blocks of F, G and H
+//   SYMBOLIC_COV - full P, prediction from the scalar expansion of a symbolic manipulator
+//   GENERAL_COV  - full P, general matrix products (slow, kept as the reference)
 #if defined(GENERAL_COV)
 // This might trick people so I have a note here.  There is a slower but bigger version of the 
 // code here but won't fit when debugging disabled (requires -Os)
 #define COVARIANCE_PREDICTION_GENERAL
+#elif defined(SYMBOLIC_COV)
+#define COVARIANCE_PREDICTION_SYMBOLIC
+#else
+#define COVARIANCE_PACKED
+#endif
+
+#if defined(COVARIANCE_PACKED)
+#define NUMP (NUMX*(NUMX+1)/2)	// number of stored covariance elements
+#define PUIDX(i,j) ((i)*(2*NUMX-(i)-1)/2+(j))	// index of P[i][j], i<=j, in the row major upper triangle
+#define PEL(i,j) P[(i) <= (j) ? PUIDX(i,j) : PUIDX(j,i)]
+typedef float CovMatrix[NUMP];
+#else
+#define PEL(i,j) P[i][j]
+typedef float CovMatrix[NUMX][NUMX];
 #endif
 
 // Private functions
 void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
-			  float Q[NUMW], float dT, float P[NUMX][NUMX]);
+			  float Q[NUMW], float dT, CovMatrix P);
 void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
-		  float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
+		  float Y[NUMV], CovMatrix P, float X[NUMX],
 		  uint16_t SensorsUsed);
 void RungeKutta(float X[NUMX], float U[NUMU], float dT);
 void StateEq(float X[NUMX], float U[NUMU], float Xdot[NUMX]);
@@ -62,7 +80,8 @@ void LinearizeH(float X[NUMX], float Be[3], float H[NUMV][NUMX]);
 float F[NUMX][NUMX], G[NUMX][NUMW], H[NUMV][NUMX];	// linearized system matrices
 													// global to init to zero and maintain zero elements
 float Be[3];			// local magnetic unit vector in NED frame
-float P[NUMX][NUMX], X[NUMX];	// covariance matrix and state vector
+CovMatrix P;			// covariance matrix
+float X[NUMX];			// state vector
 float Q[NUMW], R[NUMV];		// input noise and measurement noise variances
 float K[NUMX][NUMV];		// feedback gain matrix
 
@@ -82,14 +101,14 @@ void INSGPSInit()		//pretty much just a place holder for now
 
 	for (int i = 0; i < NUMX; i++) {
 		for (int j = 0; j < NUMX; j++) {
-			P[i][j] = 0; // zero all terms
+			PEL(i, j) = 0; // zero all terms
 		}
 	}
 	
-	P[0][0] = P[1][1] = P[2][2] = 25;	// initial position variance (m^2)
-	P[3][3] = P[4][4] = P[5][5] = 5;	// initial velocity variance (m/s)^2
-	P[6][6] = P[7][7] = P[8][8] = P[9][9] = 1e-5;	// initial quaternion variance
-	P[10][10] = P[11][11] = P[12][12] = 1e-5;	// initial gyro bias variance (rad/s)^2
+	PEL(0, 0) = PEL(1, 1) = PEL(2, 2) = 25;	// initial position variance (m^2)
+	PEL(3, 3) = PEL(4, 4) = PEL(5, 5) = 5;	// initial velocity variance (m/s)^2
+	PEL(6, 6) = PEL(7, 7) = PEL(8, 8) = PEL(9, 9) = 1e-5;	// initial quaternion variance
+	PEL(10, 10) = PEL(11, 11) = PEL(12, 12) = 1e-5;	// initial gyro bias variance (rad/s)^2
 
 	X[0] = X[1] = X[2] = X[3] = X[4] = X[5] = 0;	// initial pos and vel (m)
 	X[6] = 1;
@@ -108,7 +127,7 @@ void INSGPSInit()		//pretty much just a place holder for now
 	R[9] = .05;		// High freq altimeter noise variance (m^2)
 }
 
-void INSResetP(float PDiag[NUMX])
+void INSResetP(float * PDiag)
 {
 	uint8_t i,j;
 
@@ -116,12 +135,18 @@ void INSResetP(float PDiag[NUMX])
 	for (i=0;i<NUMX;i++){
 		if (PDiag != 0){
 			for (j=0;j<NUMX;j++)
-				P[i][j]=P[j][i]=0;
-			P[i][i]=PDiag[i];
+				PEL(i,j)=PEL(j,i)=0;
+			PEL(i,i)=PDiag[i];
 		}
 	}
 }
 
+void INSGetPDiag(float * PDiag)
+{
+	for (int i = 0; i < NUMX; i++)
+		PDiag[i] = PEL(i, i);
+}
+
 void INSSetState(float pos[3], float vel[3], float q[4], float gyro_bias[3], float accel_bias[3])
 {
 	/* Note: accel_bias not used in 13 state INS */
@@ -144,13 +169,13 @@ void INSPosVelReset(float pos[3], float vel[3])
 {
 	for (int i = 0; i < 6; i++) {
 		for(int j = i; j < NUMX; j++) {
-			P[i][j] = 0;  // zero the first 6 rows and columns
-			P[j][i] = 0; 
+			PEL(i, j) = 0;  // zero the first 6 rows and columns
+			PEL(j, i) = 0; 
 		}
 	}
 	
-	P[0][0] = P[1][1] = P[2][2] = 25;	// initial position variance (m^2)
-	P[3][3] = P[4][4] = P[5][5] = 5;	// initial velocity variance (m/s)^2
+	PEL(0, 0) = PEL(1, 1) = PEL(2, 2) = 25;	// initial position variance (m^2)
+	PEL(3, 3) = PEL(4, 4) = PEL(5, 5) = 5;	// initial velocity variance (m/s)^2
 	
 	X[0] = pos[0];
 	X[1] = pos[1];
@@ -347,13 +372,15 @@ void INSCorrection(float mag_data[3], float Pos[3], float Vel[3],
 //  Q is vector of the diagonal for a square matrix with
 //    dimensions equal to the number of disturbance noise variables
 //  The General Method is very inefficient,not taking advantage of the sparse F and G
-//  The first Method is very specific to this implementation
+//  The symbolic Method is very specific to this implementation
+//  The packed Method stores only the upper triangle of P and restricts the products
+//    to the structurally nonzero column ranges of F and G listed in FRange and GRange
 //  ************************************************
 
 #ifdef COVARIANCE_PREDICTION_GENERAL
 
 void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
-			  float Q[NUMW], float dT, float P[NUMX][NUMX])
+			  float Q[NUMW], float dT, CovMatrix P)
 {
 	float Dummy[NUMX][NUMX], dTsq;
 	uint8_t i, j, k;
@@ -379,10 +406,10 @@ void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
 		}
 }
 
-#else
+#elif defined(COVARIANCE_PREDICTION_SYMBOLIC)
 
 void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
-			  float Q[NUMW], float dT, float P[NUMX][NUMX])
+			  float Q[NUMW], float dT, CovMatrix P)
 {
 	float D[NUMX][NUMX], T, Tsq;
 	uint8_t i, j;
@@ -1315,6 +1342,70 @@ void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
 	P[11][12] = P[12][11] = D[11][12];
 	P[12][12] = Q[8] * Tsq + D[12][12];
 }
+#else
+
+// Column range [first, last) of the structurally nonzero elements in each row of F and G
+static const uint8_t FRange[NUMX][2] = {
+	{3, 4}, {4, 5}, {5, 6},			// dP/dV
+	{6, 10}, {6, 10}, {6, 10},		// dV/dq
+	{6, 13}, {6, 13}, {6, 13}, {6, 13},	// dq/dq, dq/dwbias
+	{0, 0}, {0, 0}, {0, 0}			// gyro bias random walk
+};
+static const uint8_t GRange[NUMX][2] = {
+	{0, 0}, {0, 0}, {0, 0},
+	{3, 6}, {3, 6}, {3, 6},			// dV/dna
+	{0, 3}, {0, 3}, {0, 3}, {0, 3},		// dq/dnw
+	{6, 7}, {7, 8}, {8, 9}			// gyro bias random walk
+};
+
+// row[first..NUMX-1] += f * P[k][first..NUMX-1]; the packed upper triangle is
+// walked down column k to the diagonal and then along row k
+static void AddCovRow(float row[NUMX], CovMatrix P, uint8_t k, uint8_t first, float f)
+{
+	uint16_t idx;
+	uint8_t j = first;
+
+	for (idx = PUIDX(j, k); j < k; idx += NUMX - j - 1, j++)
+		row[j] += f * P[idx];
+	for (idx = PUIDX(k, j); j < NUMX; j++, idx++)
+		row[j] += f * P[idx];
+}
+
+void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
+			  float Q[NUMW], float dT, CovMatrix P)
+{
+	float A[NUMX][NUMX], Tsq, sum;
+	uint8_t i, j, k, first, last, lo;
+	uint16_t idx;
+
+	//  Pnew = (I+F*T)*P*(I+F*T)' + T^2*G*Q*G' = A*(I+F*T)' + T^2*G*Q*G'
+
+	Tsq = dT * dT;
+
+	// Calculate A = (I+F*T)*P; row i of Pnew only reads A[i][j] for j >= i and
+	// for the columns of F in rows j >= i, so the columns left of both are skipped
+	for (i = NUMX, lo = NUMX; i-- > 0;) {
+		if (FRange[i][0] < FRange[i][1] && FRange[i][0] < lo)
+			lo = FRange[i][0];
+		first = lo < i ? lo : i;
+		for (j = first; j < NUMX; j++)
+			A[i][j] = 0;
+		AddCovRow(A[i], P, i, first, 1);
+		for (k = FRange[i][0]; k < FRange[i][1]; k++)
+			AddCovRow(A[i], P, k, first, F[i][k] * dT);
+	}
+	for (i = 0, idx = 0; i < NUMX; i++)	// Calculate Pnew = A + A*F'*T + T^2*G*Q*G'
+		for (j = i; j < NUMX; j++, idx++) {	// only the upper triangular is stored
+			sum = 0;
+			for (k = FRange[j][0]; k < FRange[j][1]; k++)
+				sum += A[i][k] * F[j][k];
+			P[idx] = A[i][j] + sum * dT;
+			first = GRange[i][0] > GRange[j][0] ? GRange[i][0] : GRange[j][0];
+			last = GRange[i][1] < GRange[j][1] ? GRange[i][1] : GRange[j][1];
+			for (k = first; k < last; k++)
+				P[idx] += Q[k] * G[i][k] * G[j][k] * Tsq;
+		}
+}
 #endif
 
 //  *************  SerialUpdate *******************
@@ -1331,10 +1422,59 @@ void CovariancePrediction(float F[NUMX][NUMX], float G[NUMX][NUMW],
 //            - or see Simon, "Optimal State Estimation," 1st Ed, p.150
 //  The SensorsUsed variable is a bitwise mask indicating which sensors
 //     should be used in the update.
+//  The packed version only visits the nonzero columns of each row of H
+//     listed in HRange.
 //  ************************************************
 
+#if defined(COVARIANCE_PACKED)
+
+// Column range [first, last) of the structurally nonzero elements in each row of H
+static const uint8_t HRange[NUMV][2] = {
+	{0, 1}, {1, 2}, {2, 3},			// dP/dP
+	{3, 4}, {4, 5}, {5, 6},			// dV/dV
+	{6, 10}, {6, 10}, {6, 10},		// dBb/dq
+	{2, 3}				// dAlt/dPz
+};
+
 void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
-		  float Y[NUMV], float P[NUMX][NUMX], float X[NUMX],
+		  float Y[NUMV], CovMatrix P, float X[NUMX],
+		  uint16_t SensorsUsed)
+{
+	float HP[NUMX], HPHR, Error;
+	uint8_t i, j, k, m;
+	uint16_t idx;
+
+	for (m = 0; m < NUMV; m++) {
+
+		if (SensorsUsed & (0x01 << m)) {	// use this sensor for update
+
+			for (j = 0; j < NUMX; j++)	// Find Hp = H*P
+				HP[j] = 0;
+			for (k = HRange[m][0]; k < HRange[m][1]; k++)
+				AddCovRow(HP, P, k, 0, H[m][k]);
+			HPHR = R[m];	// Find  HPHR = H*P*H' + R
+			for (k = HRange[m][0]; k < HRange[m][1]; k++)
+				HPHR += HP[k] * H[m][k];
+
+			for (k = 0; k < NUMX; k++)
+				K[k][m] = HP[k] / HPHR;	// find K = HP/HPHR
+
+			for (i = 0, idx = 0; i < NUMX; i++)	// Find P(m)= P(m-1) + K*HP
+				for (j = i; j < NUMX; j++, idx++)
+					P[idx] -= K[i][m] * HP[j];
+
+			Error = Z[m] - Y[m];
+			for (i = 0; i < NUMX; i++)	// Find X(m)= X(m-1) + K*Error
+				X[i] = X[i] + K[i][m] * Error;
+
+		}
+	}
+}
+
+#else
+
+void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
+		  float Y[NUMV], CovMatrix P, float X[NUMX],
 		  uint16_t SensorsUsed)
 {
 	float HP[NUMX], HPHR, Error;
@@ -1370,6 +1510,8 @@ void SerialUpdate(float H[NUMV][NUMX], float R[NUMV], float Z[NUMV],
 	}
 }
 
+#endif
+
 //  *************  RungeKutta **********************
 //  Does a 4th order Runge Kutta numerical integration step
 //  Output, Xnew, is written over X
@@ -0,0 +1,351 @@
+/**
+ ******************************************************************************
+ * @addtogroup AHRS
+ * @{
+ * @addtogroup INSGPS
+ * @{
+ * @brief INSGPS is a joint attitude and position estimation EKF
+ *
+ * @file       test_insgps_cov.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
+ * @brief      Host harness checking the INSGPS covariance kernels against the
+ *             general dense formulation and timing them.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/*
+ * Built by Makefile.posix once per filter (TEST_NUMX=13 or 16) and covariance
+ * kernel (PACKED_COV, SYMBOLIC_COV or GENERAL_COV; the 13 state filter defaults
+ * to packed, the 16 state one to symbolic).  Every step of a sensor
+ * stream is run through the filter and, from the same starting P and X, through
+ * the dense reference below; the largest deviation over the full NUMX x NUMX
+ * covariance, where it occurred and the time spent per prediction and correction
+ * are reported.  P starts from the same diagonal as ahrs.c, so the accel bias
+ * states of the 16 state filter are coupled from the first step.
+ *
+ * Usage: test_insgps_cov [log]
+ *
+ * The log is a text file with one step per line:
+ *   dT gx gy gz ax ay az mx my mz px py pz vx vy vz baro sensors
+ * with sensors the INSCorrection mask in hex (0 for a prediction only step).
+ * Without a log a deterministic synthetic flight is generated.
+ */
+
+#include "inc/insgps.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#if defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#endif
+
+#if TEST_NUMX == 13
+#define NUMX 13
+#define NUMW 9
+#define PTOL 1e-5		// largest P error relative to sqrt(Pii*Pjj)
+#elif TEST_NUMX == 16
+#define NUMX 16
+#define NUMW 12
+#define PTOL 2e-5
+#else
+#error "TEST_NUMX must be 13 or 16"
+#endif
+#define NUMV 10
+
+#define SYNTH_STEPS 20000
+#define XTOL 1e-5		// largest X error relative to 1+|X|
+
+// Filter internals, must match the storage selected in insgps*state.c
+#if TEST_NUMX == 13 && !defined(GENERAL_COV) && !defined(SYMBOLIC_COV) && !defined(PACKED_COV)
+#define PACKED_COV
+#endif
+extern float F[NUMX][NUMX], G[NUMX][NUMW], H[NUMV][NUMX];
+extern float Be[3], X[NUMX], Q[NUMW], R[NUMV];
+#if !defined(PACKED_COV)
+extern float P[NUMX][NUMX];
+#define PEL(i,j) P[i][j]
+#else
+extern float P[NUMX * (NUMX + 1) / 2];
+#define PUIDX(i,j) ((i)*(2*NUMX-(i)-1)/2+(j))
+#define PEL(i,j) P[(i) <= (j) ? PUIDX(i,j) : PUIDX(j,i)]
+#endif
+void MeasurementEq(float X[NUMX], float Be[3], float Y[NUMV]);
+void LinearizeH(float X[NUMX], float Be[3], float H[NUMV][NUMX]);
+
+struct SensorStep {
+	float dT;
+	float gyro[3], accel[3], mag[3];
+	float pos[3], vel[3], baro;
+	unsigned int sensors;
+};
+
+static float Pref[NUMX][NUMX], Xref[NUMX], Href[NUMV][NUMX];
+static int pErrRow, pErrCol;
+
+static uint64_t ticks(void)
+{
+#if defined(__i386__) || defined(__x86_64__)
+	return __rdtsc();
+#else
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t) ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+static void GetP(float Pd[NUMX][NUMX])
+{
+	for (int i = 0; i < NUMX; i++)
+		for (int j = 0; j < NUMX; j++)
+			Pd[i][j] = PEL(i, j);
+}
+
+// Same formulation as COVARIANCE_PREDICTION_GENERAL
+static void RefCovariancePrediction(float dT)
+{
+	float Dummy[NUMX][NUMX], dTsq = dT * dT;
+
+	for (int i = 0; i < NUMX; i++)
+		for (int j = 0; j < NUMX; j++) {
+			Dummy[i][j] = Pref[i][j] / dT;
+			for (int k = 0; k < NUMX; k++)
+				Dummy[i][j] += F[i][k] * Pref[k][j];
+		}
+	for (int i = 0; i < NUMX; i++)
+		for (int j = i; j < NUMX; j++) {
+			float p = Dummy[i][j] / dT;
+			for (int k = 0; k < NUMX; k++)
+				p += Dummy[i][k] * F[j][k];
+			for (int k = 0; k < NUMW; k++)
+				p += Q[k] * G[i][k] * G[j][k];
+			Pref[i][j] = Pref[j][i] = p * dTsq;
+		}
+}
+
+// Same as the dense SerialUpdate followed by the INSCorrection quaternion normalization
+static void RefCorrection(const struct SensorStep *s)
+{
+	float Z[NUMV], Y[NUMV], HP[NUMX], Kc[NUMX], HPHR, Bmag, qmag;
+
+	for (int i = 0; i < 3; i++) {
+		Z[i] = s->pos[i];
+		Z[3 + i] = s->vel[i];
+	}
+	Bmag = sqrt(s->mag[0] * s->mag[0] + s->mag[1] * s->mag[1] + s->mag[2] * s->mag[2]);
+	for (int i = 0; i < 3; i++)
+		Z[6 + i] = s->mag[i] / Bmag;
+	Z[9] = s->baro;
+
+	LinearizeH(Xref, Be, Href);
+	MeasurementEq(Xref, Be, Y);
+
+	for (int m = 0; m < NUMV; m++) {
+		if (!(s->sensors & (0x01 << m)))
+			continue;
+		for (int j = 0; j < NUMX; j++) {
+			HP[j] = 0;
+			for (int k = 0; k < NUMX; k++)
+				HP[j] += Href[m][k] * Pref[k][j];
+		}
+		HPHR = R[m];
+		for (int k = 0; k < NUMX; k++)
+			HPHR += HP[k] * Href[m][k];
+		for (int k = 0; k < NUMX; k++)
+			Kc[k] = HP[k] / HPHR;
+		for (int i = 0; i < NUMX; i++)
+			for (int j = i; j < NUMX; j++)
+				Pref[i][j] = Pref[j][i] = Pref[i][j] - Kc[i] * HP[j];
+		for (int i = 0; i < NUMX; i++)
+			Xref[i] += Kc[i] * (Z[m] - Y[m]);
+	}
+
+	qmag = sqrt(Xref[6] * Xref[6] + Xref[7] * Xref[7] + Xref[8] * Xref[8] + Xref[9] * Xref[9]);
+	for (int i = 6; i < 10; i++)
+		Xref[i] /= qmag;
+}
+
+// Largest error over the full matrix, its element is left in pErrRow, pErrCol
+static double PError(void)
+{
+	double err = 0;
+
+	for (int i = 0; i < NUMX; i++)
+		for (int j = 0; j < NUMX; j++) {
+			double scale = sqrt(fabs((double) Pref[i][i] * Pref[j][j])) + 1e-12;
+			double e = fabs((double) PEL(i, j) - Pref[i][j]) / scale;
+			if (e > err) {
+				err = e;
+				pErrRow = i;
+				pErrCol = j;
+			}
+		}
+	return err;
+}
+
+static double XError(void)
+{
+	double err = 0;
+
+	for (int i = 0; i < NUMX; i++) {
+		double e = fabs((double) X[i] - Xref[i]) / (1 + fabs(Xref[i]));
+		if (e > err)
+			err = e;
+	}
+	return err;
+}
+
+// Level flight on a 50 m circle at 10 m/s, 50 Hz IMU, 5 Hz GPS, magnetometer and baro every step
+static void SynthStep(int n, struct SensorStep *s)
+{
+	static uint32_t seed = 12345;
+	const float dT = 0.02, speed = 10, radius = 50, g = 9.81;
+	const float Bn[3] = { 0.6, 0.1, 0.8 };
+	float w = speed / radius, t = n * dT, yaw = w * t;
+	float cy = cos(yaw), sy = sin(yaw);
+
+#define NOISE(a) ((seed = seed * 1103515245 + 12345), (a) * (((seed >> 8) & 0xffff) / 32768.0f - 1))
+	memset(s, 0, sizeof(*s));
+	s->dT = dT;
+	s->gyro[0] = NOISE(0.01);
+	s->gyro[1] = NOISE(0.01);
+	s->gyro[2] = w + NOISE(0.01);
+	s->accel[0] = NOISE(0.1);
+	s->accel[1] = speed * w + NOISE(0.1);
+	s->accel[2] = -g + NOISE(0.1);
+	s->mag[0] = cy * Bn[0] + sy * Bn[1] + NOISE(0.01);
+	s->mag[1] = -sy * Bn[0] + cy * Bn[1] + NOISE(0.01);
+	s->mag[2] = Bn[2] + NOISE(0.01);
+	s->pos[0] = radius * sin(yaw) + NOISE(1);
+	s->pos[1] = radius * (1 - cos(yaw)) + NOISE(1);
+	s->pos[2] = NOISE(2);
+	s->vel[0] = speed * cy + NOISE(0.2);
+	s->vel[1] = speed * sy + NOISE(0.2);
+	s->vel[2] = NOISE(0.2);
+	s->baro = NOISE(0.5);
+	s->sensors = (n % 10 == 0) ? FULL_SENSORS : MAG_SENSORS | BARO_SENSOR;
+#undef NOISE
+}
+
+static int ReadStep(FILE * log, struct SensorStep *s)
+{
+	return fscanf(log, "%f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %f %x",
+		      &s->dT, &s->gyro[0], &s->gyro[1], &s->gyro[2],
+		      &s->accel[0], &s->accel[1], &s->accel[2],
+		      &s->mag[0], &s->mag[1], &s->mag[2],
+		      &s->pos[0], &s->pos[1], &s->pos[2],
+		      &s->vel[0], &s->vel[1], &s->vel[2], &s->baro, &s->sensors) == 18;
+}
+
+int main(int argc, char **argv)
+{
+	struct SensorStep s;
+	FILE *log = 0;
+	uint64_t t0, predTicks = 0, corrTicks = 0, refPredTicks = 0, refCorrTicks = 0;
+	unsigned int steps = 0, corrections = 0, pErrStep = 0;
+	int pErrI = 0, pErrJ = 0;
+	double pErr = 0, xErr = 0, e;
+	float Bn[3] = { 0.6, 0.1, 0.8 };
+	float Pdiag[16] = { 25, 25, 25, 5, 5, 5, 1e-5, 1e-5, 1e-5, 1e-5, 1e-5, 1e-5, 1e-5, 1e-4, 1e-4, 1e-4 };
+
+	if (argc > 1 && !(log = fopen(argv[1], "r"))) {
+		perror(argv[1]);
+		return 2;
+	}
+
+	INSGPSInit();
+	INSSetMagNorth(Bn);
+	INSResetP(Pdiag);
+
+	while (log ? ReadStep(log, &s) : steps < SYNTH_STEPS) {
+		if (!log)
+			SynthStep(steps, &s);
+
+		INSStatePrediction(s.gyro, s.accel, s.dT);
+
+		GetP(Pref);
+		t0 = ticks();
+		RefCovariancePrediction(s.dT);
+		refPredTicks += ticks() - t0;
+		t0 = ticks();
+		INSCovariancePrediction(s.dT);
+		predTicks += ticks() - t0;
+		if ((e = PError()) > pErr) {
+			pErr = e;
+			pErrStep = steps;
+			pErrI = pErrRow;
+			pErrJ = pErrCol;
+		}
+
+		if (s.sensors) {
+			GetP(Pref);
+			memcpy(Xref, X, sizeof(Xref));
+			t0 = ticks();
+			RefCorrection(&s);
+			refCorrTicks += ticks() - t0;
+			t0 = ticks();
+			INSCorrection(s.mag, s.pos, s.vel, s.baro, s.sensors);
+			corrTicks += ticks() - t0;
+			if ((e = PError()) > pErr) {
+				pErr = e;
+				pErrStep = steps;
+				pErrI = pErrRow;
+				pErrJ = pErrCol;
+			}
+			if ((e = XError()) > xErr)
+				xErr = e;
+			corrections++;
+		}
+		steps++;
+	}
+
+	if (!steps || !corrections) {
+		fprintf(stderr, "no steps replayed\n");
+		return 2;
+	}
+
+#if defined(GENERAL_COV)
+	printf("%d states, general kernels\n", NUMX);
+#elif defined(PACKED_COV)
+	printf("%d states, packed kernels\n", NUMX);
+#else
+	printf("%d states, symbolic kernels\n", NUMX);
+#endif
+	printf("steps %u, corrections %u\n", steps, corrections);
+	printf("prediction: %8.0f ticks/update (dense reference %8.0f)\n",
+	       (double) predTicks / steps, (double) refPredTicks / steps);
+	printf("correction: %8.0f ticks/update (dense reference %8.0f)\n",
+	       (double) corrTicks / corrections, (double) refCorrTicks / corrections);
+	printf("max P error %g at P[%d][%d] step %u (tolerance %g), max X error %g\n",
+	       pErr, pErrI, pErrJ, pErrStep, PTOL, xErr);
+
+	if (pErr > PTOL || xErr > XTOL || isnan(pErr) || isnan(xErr)) {
+		printf("FAILED\n");
+		return 1;
+	}
+	printf("PASSED\n");
+	return 0;
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -74,6 +74,8 @@
 
 /* A really shitty setting saving implementation */
 #define PIOS_INCLUDE_FLASH_SECTOR_SETTINGS
+#define PIOS_FLASHFS_MAX_OBJECTS	32	/* 384 bytes of RAM, settings and some metaobjects */
+#define PIOS_FLASHFS_MAX_SECTORS	16	/* 256 bytes of RAM, 64KB of the W25X */
 
 /* Defaults for Logging */
 #define LOG_FILENAME 			"PIOS.LOG"
@@ -106,6 +108,9 @@
 // This can't be too high to stop eventdispatcher thread overflowing
 #define PIOS_EVENTDISAPTCHER_QUEUE      10
 
+// Object index slots (power of two), needs room for each object and its metaobject
+#define PIOS_UAVOBJECTMANAGER_INDEX_SIZE 128
+
 #endif /* PIOS_CONFIG_H */
 /**
  * @}
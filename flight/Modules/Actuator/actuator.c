@@ -41,6 +41,7 @@
 #include "flightstatus.h"
 #include "mixersettings.h"
 #include "mixerstatus.h"
+#include "mixer.h"
 #include "cameradesired.h"
 
 
@@ -55,7 +56,6 @@
 
 #define TASK_PRIORITY (tskIDLE_PRIORITY+4)
 #define FAILSAFE_TIMEOUT_MS 100
-#define MAX_MIX_ACTUATORS ACTUATORCOMMAND_CHANNEL_NUMELEM
 
 // Private types
 
@@ -68,23 +68,23 @@ static float lastResult[MAX_MIX_ACTUATORS]={0,0,0,0,0,0,0,0};
 static float lastFilteredResult[MAX_MIX_ACTUATORS]={0,0,0,0,0,0,0,0};
 static float filterAccumulator[MAX_MIX_ACTUATORS]={0,0,0,0,0,0,0,0};
 
+// Copies of the settings, only refreshed when the settings objects change
+static MixerSettingsData mixerSettings;
+static UAVObjSnapshot mixerSettingsSnapshot;
+static ActuatorSettingsData actuatorSettings;
+static UAVObjSnapshot actuatorSettingsSnapshot;
+static CompiledMixer_t compiledMixer;
+
 
 // Private functions
 static void actuatorTask(void* parameters);
 static void actuator_update_rate(UAVObjEvent *);
 static int16_t scaleChannel(float value, int16_t max, int16_t min, int16_t neutral);
 static void setFailsafe();
-static float MixerCurve(const float throttle, const float* curve);
+static void updateMixerSettings();
 static bool set_channel(uint8_t mixer_channel, uint16_t value);
-float ProcessMixer(const int index, const float curve1, const float curve2,
-		   MixerSettingsData* mixerSettings, ActuatorDesiredData* desired,
-		   const float period);
-
-//this structure is equivalent to the UAVObjects for one mixer.
-typedef struct {
-	uint8_t type;
-	int8_t matrix[5];
-} __attribute__((packed)) Mixer_t;
+static float ProcessMotor(const int index, float result,
+			  const MixerSettingsData* mixerSettings, const float period);
 
 /**
  * @brief Module initialization
@@ -121,7 +121,7 @@ int32_t ActuatorInitialize()
 	ActuatorDesiredConnectQueue(queue);
 
 	// If settings change, update the output rate
-	ActuatorSettingsConnectCallback(actuator_update_rate);
+	ActuatorSettingsConnectCallbackPriority(actuator_update_rate, EVENT_PRIORITY_BACKGROUND);
 
 	return 0;
 }
@@ -148,20 +148,16 @@ static void actuatorTask(void* parameters)
 	float dT = 0.0f;
 
 	ActuatorCommandData command;
-	MixerSettingsData mixerSettings;
 	ActuatorDesiredData desired;
 	MixerStatusData mixerStatus;
 	FlightStatusData flightStatus;
 
-	uint8_t MotorsSpinWhileArmed;
-	int16_t ChannelMax[ACTUATORCOMMAND_CHANNEL_NUMELEM];
-	int16_t ChannelMin[ACTUATORCOMMAND_CHANNEL_NUMELEM];
-	int16_t ChannelNeutral[ACTUATORCOMMAND_CHANNEL_NUMELEM];
-	uint16_t ChannelUpdateFreq[ACTUATORSETTINGS_CHANNELUPDATEFREQ_NUMELEM];
-	ActuatorSettingsChannelUpdateFreqGet(ChannelUpdateFreq);
+	MixerSettingsSnapshotInit(&mixerSettingsSnapshot, &mixerSettings);
+	compileMixer(&mixerSettings, &compiledMixer);
+	ActuatorSettingsSnapshotInit(&actuatorSettingsSnapshot, &actuatorSettings);
 	// TODO XXX Replace this with a real OP-wide define switch for enabling / disabling servo out
 #ifndef STM32F2XX
-	PIOS_Servo_SetHz(&ChannelUpdateFreq[0], ACTUATORSETTINGS_CHANNELUPDATEFREQ_NUMELEM);
+	PIOS_Servo_SetHz(&actuatorSettings.ChannelUpdateFreq[0], ACTUATORSETTINGS_CHANNELUPDATEFREQ_NUMELEM);
 #endif
 
 	float * status = (float *)&mixerStatus; //access status objects as an array of floats
@@ -189,28 +185,17 @@ static void actuatorTask(void* parameters)
 		lastSysTime = thisSysTime;
 
 		FlightStatusGet(&flightStatus);
-		MixerSettingsGet (&mixerSettings);
+		updateMixerSettings();
 		ActuatorDesiredGet(&desired);
 		ActuatorCommandGet(&command);
 
 #if defined(DIAGNOSTICS)
 		MixerStatusGet(&mixerStatus);
 #endif
-		ActuatorSettingsMotorsSpinWhileArmedGet(&MotorsSpinWhileArmed);
-		ActuatorSettingsChannelMaxGet(ChannelMax);
-		ActuatorSettingsChannelMinGet(ChannelMin);
-		ActuatorSettingsChannelNeutralGet(ChannelNeutral);
+		UAVObjSnapshotUpdate(&actuatorSettingsSnapshot);
 
-		int nMixers = 0;
 		Mixer_t * mixers = (Mixer_t *)&mixerSettings.Mixer1Type;
-		for(int ct=0; ct < MAX_MIX_ACTUATORS; ct++)
-		{
-			if(mixers[ct].type != MIXERSETTINGS_MIXER1TYPE_DISABLED)
-			{
-				nMixers ++;
-			}
-		}
-		if((nMixers < 2) && !ActuatorCommandReadOnly(dummy)) //Nothing can fly with less than two mixers.
+		if((compiledMixer.nMixers < 2) && !ActuatorCommandReadOnly(dummy)) //Nothing can fly with less than two mixers.
 		{
 			setFailsafe(); // So that channels like PWM buzzer keep working
 			continue;
@@ -218,24 +203,24 @@ static void actuatorTask(void* parameters)
 
 		bool armed = flightStatus.Armed == FLIGHTSTATUS_ARMED_ARMED;
 		bool positiveThrottle = desired.Throttle >= 0.00;
-		bool spinWhileArmed = MotorsSpinWhileArmed == ACTUATORSETTINGS_MOTORSSPINWHILEARMED_TRUE;
+		bool spinWhileArmed = actuatorSettings.MotorsSpinWhileArmed == ACTUATORSETTINGS_MOTORSSPINWHILEARMED_TRUE;
 
-		float curve1 = MixerCurve(desired.Throttle,mixerSettings.ThrottleCurve1);
+		float curve1 = MixerCurve(desired.Throttle,&compiledMixer.curve1);
 		//The source for the secondary curve is selectable
 		float curve2 = 0;
 		AccessoryDesiredData accessory;
 		switch(mixerSettings.Curve2Source) {
 			case MIXERSETTINGS_CURVE2SOURCE_THROTTLE:
-				curve2 = MixerCurve(desired.Throttle,mixerSettings.ThrottleCurve2);
+				curve2 = MixerCurve(desired.Throttle,&compiledMixer.curve2);
 				break;
 			case MIXERSETTINGS_CURVE2SOURCE_ROLL:
-				curve2 = MixerCurve(desired.Roll,mixerSettings.ThrottleCurve2);
+				curve2 = MixerCurve(desired.Roll,&compiledMixer.curve2);
 				break;
 			case MIXERSETTINGS_CURVE2SOURCE_PITCH:
-				curve2 = MixerCurve(desired.Pitch,mixerSettings.ThrottleCurve2);
+				curve2 = MixerCurve(desired.Pitch,&compiledMixer.curve2);
 				break;
 			case MIXERSETTINGS_CURVE2SOURCE_YAW:
-				curve2 = MixerCurve(desired.Yaw,mixerSettings.ThrottleCurve2);
+				curve2 = MixerCurve(desired.Yaw,&compiledMixer.curve2);
 				break;
 			case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY0:
 			case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY1:
@@ -244,12 +229,22 @@ static void actuatorTask(void* parameters)
 			case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY4:
 			case MIXERSETTINGS_CURVE2SOURCE_ACCESSORY5:
 				if(AccessoryDesiredInstGet(mixerSettings.Curve2Source - MIXERSETTINGS_CURVE2SOURCE_ACCESSORY0,&accessory) == 0)
-					curve2 = MixerCurve(accessory.AccessoryVal,mixerSettings.ThrottleCurve2);
+					curve2 = MixerCurve(accessory.AccessoryVal,&compiledMixer.curve2);
 				else
 					curve2 = 0;
 				break;
 		}
 
+		// Mix all channels at once, in the order of the MixerVector elements
+		float input[MIXER_NUM_INPUTS];
+		float mixed[MAX_MIX_ACTUATORS];
+		input[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE1] = curve1;
+		input[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE2] = curve2;
+		input[MIXERSETTINGS_MIXER1VECTOR_ROLL] = desired.Roll;
+		input[MIXERSETTINGS_MIXER1VECTOR_PITCH] = desired.Pitch;
+		input[MIXERSETTINGS_MIXER1VECTOR_YAW] = desired.Yaw;
+		MixerMatrixMultiply(compiledMixer.matrix, input, mixed);
+
 		for(int ct=0; ct < MAX_MIX_ACTUATORS; ct++)
 		{
 			if(mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_DISABLED) {
@@ -259,8 +254,10 @@ static void actuatorTask(void* parameters)
 				continue;
 			}
 
-			if((mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_MOTOR) || (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_SERVO))
-				status[ct] = ProcessMixer(ct, curve1, curve2, &mixerSettings, &desired, dT);
+			if(mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_MOTOR)
+				status[ct] = ProcessMotor(ct, mixed[ct], &mixerSettings, dT);
+			else if(mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_SERVO)
+				status[ct] = mixed[ct];
 			else
 				status[ct] = -1;
 
@@ -321,9 +318,9 @@ static void actuatorTask(void* parameters)
 			}
 
 			command.Channel[ct] = scaleChannel(status[ct],
-							   ChannelMax[ct],
-							   ChannelMin[ct],
-							   ChannelNeutral[ct]);
+							   actuatorSettings.ChannelMax[ct],
+							   actuatorSettings.ChannelMin[ct],
+							   actuatorSettings.ChannelNeutral[ct]);
 		}
 #if defined(DIAGNOSTICS)
 		MixerStatusSet(&mixerStatus);
@@ -363,101 +360,65 @@ static void actuatorTask(void* parameters)
 
 
 /**
- *Process mixing for one actuator
+ * Apply the idle throttle, feed forward and acceleration limit to the mixed value of a motor
  */
-
-float ProcessMixer(const int index, const float curve1, const float curve2,
-		   MixerSettingsData* mixerSettings, ActuatorDesiredData* desired, const float period)
+static float ProcessMotor(const int index, float result,
+			  const MixerSettingsData* mixerSettings, const float period)
 {
-	Mixer_t * mixers = (Mixer_t *)&mixerSettings->Mixer1Type; //pointer to array of mixers in UAVObjects
-	Mixer_t * mixer = &mixers[index];
-	float result = ((mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE1] / 128.0f) * curve1) +
-	((mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE2] / 128.0f) * curve2) +
-	((mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_ROLL] / 128.0f) * desired->Roll) +
-	((mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_PITCH] / 128.0f) * desired->Pitch) +
-	((mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_YAW] / 128.0f) * desired->Yaw);
-	if(mixer->type == MIXERSETTINGS_MIXER1TYPE_MOTOR)
+	if(result < 0) //idle throttle
 	{
-		if(result < 0) //idle throttle
-		{
-			result = 0;
-		}
+		result = 0;
+	}
 
-		//feed forward
-		float accumulator = filterAccumulator[index];
-		accumulator += (result - lastResult[index]) * mixerSettings->FeedForward;
-		lastResult[index] = result;
-		result += accumulator;
-		if(period !=0)
+	//feed forward
+	float accumulator = filterAccumulator[index];
+	accumulator += (result - lastResult[index]) * mixerSettings->FeedForward;
+	lastResult[index] = result;
+	result += accumulator;
+	if(period !=0)
+	{
+		if(accumulator > 0)
 		{
-			if(accumulator > 0)
+			float filter = mixerSettings->AccelTime / period;
+			if(filter <1)
 			{
-				float filter = mixerSettings->AccelTime / period;
-				if(filter <1)
-				{
-					filter = 1;
-				}
-				accumulator -= accumulator / filter;
-			}else
+				filter = 1;
+			}
+			accumulator -= accumulator / filter;
+		}else
+		{
+			float filter = mixerSettings->DecelTime / period;
+			if(filter <1)
 			{
-				float filter = mixerSettings->DecelTime / period;
-				if(filter <1)
-				{
-					filter = 1;
-				}
-				accumulator -= accumulator / filter;
+				filter = 1;
 			}
+			accumulator -= accumulator / filter;
 		}
-		filterAccumulator[index] = accumulator;
-		result += accumulator;
+	}
+	filterAccumulator[index] = accumulator;
+	result += accumulator;
 
-		//acceleration limit
-		float dt = result - lastFilteredResult[index];
-		float maxDt = mixerSettings->MaxAccel * period;
-		if(dt > maxDt) //we are accelerating too hard
-		{
-			result = lastFilteredResult[index] + maxDt;
-		}
-		lastFilteredResult[index] = result;
+	//acceleration limit
+	float dt = result - lastFilteredResult[index];
+	float maxDt = mixerSettings->MaxAccel * period;
+	if(dt > maxDt) //we are accelerating too hard
+	{
+		result = lastFilteredResult[index] + maxDt;
 	}
+	lastFilteredResult[index] = result;
 	return(result);
 }
 
 
 /**
- *Interpolate a throttle curve. Throttle input should be in the range 0 to 1.
- *Output is in the range 0 to 1.
+ * Copy the mixer settings again if they changed, and recompile the mixer
  */
-
-#define MIXER_CURVE_ENTRIES 5
-
-static float MixerCurve(const float throttle, const float* curve)
+static void updateMixerSettings()
 {
-	float scale = throttle * MIXER_CURVE_ENTRIES;
-	int idx1 = scale;
-	scale -= (float)idx1; //remainder
-	if(curve[0] < -1)
-	{
-		return(throttle);
-	}
-	if (idx1 < 0)
-	{
-		idx1 = 0; //clamp to lowest entry in table
-		scale = 0;
-	}
-	int idx2 = idx1 + 1;
-	if(idx2 >= MIXER_CURVE_ENTRIES)
-	{
-		idx2 = MIXER_CURVE_ENTRIES -1; //clamp to highest entry in table
-		if(idx1 >= MIXER_CURVE_ENTRIES)
-		{
-			idx1 = MIXER_CURVE_ENTRIES -1;
-		}
-	}
-	return((curve[idx1] * (1 - scale)) + (curve[idx2] * scale));
+	if (UAVObjSnapshotUpdate(&mixerSettingsSnapshot))
+		compileMixer(&mixerSettings, &compiledMixer);
 }
 
-
 /**
  * Convert channel from -1/+1 to servo pulse duration in microseconds
  */
@@ -493,16 +454,11 @@ static int16_t scaleChannel(float value, int16_t max, int16_t min, int16_t neutr
  */
 static void setFailsafe()
 {
-	/* grab only the modules parts that we are going to use */
-	int16_t ChannelMin[ACTUATORCOMMAND_CHANNEL_NUMELEM];
-	ActuatorSettingsChannelMinGet(ChannelMin);
-	int16_t ChannelNeutral[ACTUATORCOMMAND_CHANNEL_NUMELEM];
-	ActuatorSettingsChannelNeutralGet(ChannelNeutral);
+	UAVObjSnapshotUpdate(&actuatorSettingsSnapshot);
+	updateMixerSettings();
 	int16_t Channel[ACTUATORCOMMAND_CHANNEL_NUMELEM];
 	ActuatorCommandChannelGet(Channel);
 
-	MixerSettingsData mixerSettings;
-	MixerSettingsGet (&mixerSettings);
 	Mixer_t * mixers = (Mixer_t *)&mixerSettings.Mixer1Type; //pointer to array of mixers in UAVObjects
 
 	// Reset ActuatorCommand to safe values
@@ -511,11 +467,11 @@ static void setFailsafe()
 
 		if(mixers[n].type == MIXERSETTINGS_MIXER1TYPE_MOTOR)
 		{
-			Channel[n] = ChannelMin[n];
+			Channel[n] = actuatorSettings.ChannelMin[n];
 		}
 		else if(mixers[n].type == MIXERSETTINGS_MIXER1TYPE_SERVO)
 		{
-			Channel[n] = ChannelNeutral[n];
+			Channel[n] = actuatorSettings.ChannelNeutral[n];
 		}
 		else
 		{
@@ -559,10 +515,9 @@ static bool set_channel(uint8_t mixer_channel, uint16_t value) {
 #else
 static bool set_channel(uint8_t mixer_channel, uint16_t value) {
 
-	ActuatorSettingsData settings;
-	ActuatorSettingsGet(&settings);
+	const ActuatorSettingsData *settings = &actuatorSettings;
 
-	switch(settings.ChannelType[mixer_channel]) {
+	switch(settings->ChannelType[mixer_channel]) {
 #if defined(PIOS_INCLUDE_SERVO)
 		case ACTUATORSETTINGS_CHANNELTYPE_PWMALARMBUZZER: {
 			// This is for buzzers that take a PWM input
@@ -607,22 +562,22 @@ static bool set_channel(uint8_t mixer_channel, uint16_t value) {
 				}
 			}
 			// TODO XXX Replace this with a real OP-wide define switch for enabling / disabling servo out
-			PIOS_Servo_Set(	settings.ChannelAddr[mixer_channel],
-							buzzOn?settings.ChannelMax[mixer_channel]:settings.ChannelMin[mixer_channel]);
+			PIOS_Servo_Set(	settings->ChannelAddr[mixer_channel],
+							buzzOn?settings->ChannelMax[mixer_channel]:settings->ChannelMin[mixer_channel]);
 			return true;
 		}
 #endif
 		// TODO XXX Replace this with a real OP-wide define switch for enabling / disabling servo out
 #if defined(PIOS_INCLUDE_SERVO)
 		case ACTUATORSETTINGS_CHANNELTYPE_PWM:
-			PIOS_Servo_Set(settings.ChannelAddr[mixer_channel], value);
+			PIOS_Servo_Set(settings->ChannelAddr[mixer_channel], value);
 			return true;
 #endif
 #if defined(PIOS_INCLUDE_I2C_ESC)
 		case ACTUATORSETTINGS_CHANNELTYPE_MK:
-			return PIOS_SetMKSpeed(settings.ChannelAddr[mixer_channel],value);
+			return PIOS_SetMKSpeed(settings->ChannelAddr[mixer_channel],value);
 		case ACTUATORSETTINGS_CHANNELTYPE_ASTEC4:
-			return PIOS_SetAstec4Speed(settings.ChannelAddr[mixer_channel],value);
+			return PIOS_SetAstec4Speed(settings->ChannelAddr[mixer_channel],value);
 #endif
 		case ACTUATORSETTINGS_CHANNELTYPE_DISABLED:
 			return true;
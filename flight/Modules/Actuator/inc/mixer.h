@@ -0,0 +1,75 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilotModules OpenPilot Modules
+ * @{
+ * @addtogroup ActuatorModule Actuator Module
+ * @{
+ *
+ * @file       mixer.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2011.
+ * @brief      Mixer matrix and throttle curves compiled from the MixerSettings.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef MIXER_H
+#define MIXER_H
+
+#include <stdbool.h>
+#include "actuatorcommand.h"
+#include "mixersettings.h"
+
+#define MAX_MIX_ACTUATORS ACTUATORCOMMAND_CHANNEL_NUMELEM
+#define MIXER_NUM_INPUTS MIXERSETTINGS_MIXER1VECTOR_NUMELEM
+#define MIXER_CURVE_ENTRIES 5
+
+//this structure is equivalent to the UAVObjects for one mixer.
+typedef struct {
+	uint8_t type;
+	int8_t matrix[5];
+} __attribute__((packed)) Mixer_t;
+
+// Throttle curve split in segments, the value in a segment is interpolated
+// between its low and high point
+typedef struct {
+	float low[MIXER_CURVE_ENTRIES];
+	float high[MIXER_CURVE_ENTRIES];
+	bool passThrough;
+} MixerCurve_t;
+
+// MixerSettings compiled for the main loop, rebuilt only when the settings change.
+// The inputs are in the order of the MixerVector elements, the rows of channels
+// that are neither motors nor servos are zero.
+typedef struct {
+	float matrix[MAX_MIX_ACTUATORS][MIXER_NUM_INPUTS];
+	MixerCurve_t curve1;
+	MixerCurve_t curve2;
+	uint8_t nMixers;
+} CompiledMixer_t;
+
+void compileMixer(const MixerSettingsData* mixerSettings, CompiledMixer_t* mixer);
+void MixerMatrixMultiply(const float matrix[MAX_MIX_ACTUATORS][MIXER_NUM_INPUTS],
+			 const float input[MIXER_NUM_INPUTS], float output[MAX_MIX_ACTUATORS]);
+float MixerCurve(const float throttle, const MixerCurve_t* curve);
+
+#endif // MIXER_H
+
+/**
+  * @}
+  * @}
+  */
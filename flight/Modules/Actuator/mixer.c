@@ -0,0 +1,120 @@
+/**
+ ******************************************************************************
+ * @addtogroup OpenPilotModules OpenPilot Modules
+ * @{
+ * @addtogroup ActuatorModule Actuator Module
+ * @{
+ *
+ * @file       mixer.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2011.
+ * @brief      Mixer matrix and throttle curves compiled from the MixerSettings.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "openpilot.h"
+#include "mixer.h"
+
+// Private functions
+static void compileMixerCurve(const float* curve, MixerCurve_t* compiled);
+
+/**
+ * Build the mixer matrix and the throttle curve segments from the settings
+ */
+void compileMixer(const MixerSettingsData* mixerSettings, CompiledMixer_t* mixer)
+{
+	const Mixer_t * mixers = (const Mixer_t *)&mixerSettings->Mixer1Type;
+	float curve[MIXERSETTINGS_THROTTLECURVE1_NUMELEM];
+
+	mixer->nMixers = 0;
+	for(int ct=0; ct < MAX_MIX_ACTUATORS; ct++)
+	{
+		bool mixed = (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_MOTOR) || (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_SERVO);
+		for(int in=0; in < MIXER_NUM_INPUTS; in++)
+			mixer->matrix[ct][in] = mixed ? mixers[ct].matrix[in] / 128.0f : 0;
+		if(mixers[ct].type != MIXERSETTINGS_MIXER1TYPE_DISABLED)
+			mixer->nMixers++;
+	}
+	// The settings are packed, the curves are copied out before they are passed on
+	memcpy(curve, mixerSettings->ThrottleCurve1, sizeof(curve));
+	compileMixerCurve(curve, &mixer->curve1);
+	memcpy(curve, mixerSettings->ThrottleCurve2, sizeof(curve));
+	compileMixerCurve(curve, &mixer->curve2);
+}
+
+/**
+ * Split a throttle curve in segments. The last segment is flat: the curve is sampled
+ * every 1/MIXER_CURVE_ENTRIES, so full throttle falls in the segment of the last entry.
+ */
+static void compileMixerCurve(const float* curve, MixerCurve_t* compiled)
+{
+	compiled->passThrough = curve[0] < -1;
+	for(int n=0; n < MIXER_CURVE_ENTRIES; n++)
+	{
+		compiled->low[n] = curve[n];
+		compiled->high[n] = (n < MIXER_CURVE_ENTRIES - 1) ? curve[n + 1] : curve[n];
+	}
+}
+
+/**
+ * Product of the mixer matrix and the input vector. The inner loop has a fixed
+ * length so the compiler unrolls it, and the sums are done in the same order as
+ * the per channel code it replaces.
+ */
+void MixerMatrixMultiply(const float matrix[MAX_MIX_ACTUATORS][MIXER_NUM_INPUTS],
+			 const float input[MIXER_NUM_INPUTS], float output[MAX_MIX_ACTUATORS])
+{
+	for(int ct=0; ct < MAX_MIX_ACTUATORS; ct++)
+	{
+		float sum = 0;
+		for(int in=0; in < MIXER_NUM_INPUTS; in++)
+			sum += matrix[ct][in] * input[in];
+		output[ct] = sum;
+	}
+}
+
+/**
+ *Interpolate a throttle curve. Throttle input should be in the range 0 to 1.
+ *Output is in the range 0 to 1.
+ */
+float MixerCurve(const float throttle, const MixerCurve_t* curve)
+{
+	if(curve->passThrough)
+	{
+		return(throttle);
+	}
+	float scale = throttle * MIXER_CURVE_ENTRIES;
+	int idx = scale;
+	scale -= (float)idx; //remainder
+	if (idx < 0)
+	{
+		idx = 0; //clamp to lowest entry in table
+		scale = 0;
+	}
+	else if (idx >= MIXER_CURVE_ENTRIES)
+	{
+		idx = MIXER_CURVE_ENTRIES - 1; //clamp to highest entry in table
+	}
+	return((curve->low[idx] * (1 - scale)) + (curve->high[idx] * scale));
+}
+
+/**
+  * @}
+  * @}
+  */
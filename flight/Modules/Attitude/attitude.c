@@ -146,7 +146,7 @@ int32_t AttitudeInitialize(void)
 
 	PIOS_ADC_SetQueue(gyro_queue);
 
-	AttitudeSettingsConnectCallback(&settingsUpdatedCb);
+	AttitudeSettingsConnectCallbackPriority(&settingsUpdatedCb, EVENT_PRIORITY_BACKGROUND);
 
 	return 0;
 }
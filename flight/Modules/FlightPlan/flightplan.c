@@ -80,7 +80,7 @@ int32_t FlightPlanInitialize()
 	FlightPlanSettingsInitialize();
 	
 	// Listen for object updates
-	FlightPlanControlConnectCallback(&objectUpdatedCb);
+	FlightPlanControlConnectCallbackPriority(&objectUpdatedCb, EVENT_PRIORITY_BACKGROUND);
 
 	// Create object queue
 	queue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(UAVObjEvent));
@@ -546,12 +546,12 @@ static void onTimer(UAVObjEvent * ev)
  */
 int32_t OsdEtStdInitialize(void)
 {
-	GPSPositionConnectCallback(GPSPositionUpdatedCb);
-	FlightBatteryStateConnectCallback(FlightBatteryStateUpdatedCb);
-	BaroAltitudeConnectCallback(BaroAltitudeUpdatedCb);
+	GPSPositionConnectCallbackPriority(GPSPositionUpdatedCb, EVENT_PRIORITY_BACKGROUND);
+	FlightBatteryStateConnectCallbackPriority(FlightBatteryStateUpdatedCb, EVENT_PRIORITY_BACKGROUND);
+	BaroAltitudeConnectCallbackPriority(BaroAltitudeUpdatedCb, EVENT_PRIORITY_BACKGROUND);
 
 	memset(&ev,0,sizeof(UAVObjEvent));
-	EventPeriodicCallbackCreate(&ev, onTimer, 100 / portTICK_RATE_MS);
+	EventPeriodicCallbackCreatePriority(&ev, onTimer, 100 / portTICK_RATE_MS, EVENT_PRIORITY_BACKGROUND);
 
 	return 0;
 }
@@ -80,6 +80,7 @@ typedef struct {
 // Private variables
 static xTaskHandle taskHandle;
 static StabilizationSettingsData settings;
+static UAVObjSnapshot settingsSnapshot;
 static xQueueHandle queue;
 float dT = 1;
 float gyro_alpha = 0;
@@ -98,7 +99,7 @@ static void stabilizationTask(void* parameters);
 static float ApplyPid(pid_type * pid, const float err);
 static float bound(float val);
 static void ZeroPids(void);
-static void SettingsUpdatedCb(UAVObjEvent * ev);
+static void SettingsUpdated(void);
 
 /**
  * Module initialization
@@ -139,8 +140,6 @@ int32_t StabilizationInitialize()
 	AttitudeRawConnectQueue(queue);
 #endif
 
-	StabilizationSettingsConnectCallback(SettingsUpdatedCb);
-	SettingsUpdatedCb(StabilizationSettingsHandle());
 	// Start main task
 
 	return 0;
@@ -170,7 +169,10 @@ static void stabilizationTask(void* parameters)
 #endif
 	FlightStatusData flightStatus;
 
-	SettingsUpdatedCb((UAVObjEvent *) NULL);
+	// The settings are copied again by the task itself when they change, so the PID
+	// constants are never replaced in the middle of a cycle
+	StabilizationSettingsSnapshotInit(&settingsSnapshot, &settings);
+	SettingsUpdated();
 
 	// Main task loop
 	lastSysTime = xTaskGetTickCount();
@@ -191,6 +193,9 @@ static void stabilizationTask(void* parameters)
 			dT = (thisSysTime - lastSysTime) / portTICK_RATE_MS / 1000.0f;
 		lastSysTime = thisSysTime;
 
+		if (UAVObjSnapshotUpdate(&settingsSnapshot))
+			SettingsUpdated();
+
 		FlightStatusGet(&flightStatus);
 		StabilizationDesiredGet(&stabDesired);
 		AttitudeActualGet(&attitudeActual);
@@ -426,10 +431,9 @@ static float bound(float val)
 }
 
 
-static void SettingsUpdatedCb(UAVObjEvent * ev)
+static void SettingsUpdated(void)
 {
 	memset(pids,0,sizeof (pid_type) * PID_MAX);
-	StabilizationSettingsGet(&settings);
 
 	// Set the roll rate PID constants
 	pids[0].p = settings.RollRatePID[STABILIZATIONSETTINGS_ROLLRATEPID_KP];
@@ -147,7 +147,7 @@ static void systemTask(void *parameters)
 	lastSysTime = xTaskGetTickCount();
 
 	// Listen for SettingPersistance object updates, connect a callback function
-	ObjectPersistenceConnectCallback(&objectUpdatedCb);
+	ObjectPersistenceConnectCallbackPriority(&objectUpdatedCb, EVENT_PRIORITY_BACKGROUND);
 
 	// Main system loop
 	while (1) {
@@ -454,6 +454,15 @@ static void updateSystemAlarms()
 	}
 #endif
 
+#if defined(PIOS_INCLUDE_FLASH_SECTOR_SETTINGS)
+	// Check that settings can be saved, an older flash layout waits for a full erase
+	if (PIOS_FLASHFS_IsMounted() == 0) {
+		AlarmsSet(SYSTEMALARMS_ALARM_SETTINGS, SYSTEMALARMS_ALARM_ERROR);
+	} else {
+		AlarmsClear(SYSTEMALARMS_ALARM_SETTINGS);
+	}
+#endif
+
 	// Check for event errors
 	UAVObjGetStats(&objStats);
 	EventGetStats(&evStats);
@@ -35,6 +35,7 @@
 #include "flighttelemetrystats.h"
 #include "gcstelemetrystats.h"
 #include "telemetrysettings.h"
+#include "flighttelemetryrates.h"
 
 // Private constants
 #define MAX_QUEUE_SIZE   TELEM_QUEUE_SIZE
@@ -46,8 +47,20 @@
 #define MAX_RETRIES 2
 #define STATS_UPDATE_PERIOD_MS 4000
 #define CONNECTION_TIMEOUT_MS 8000
+#define RX_BUFFER_SIZE 16
+#define MAX_PERIODIC_OBJECTS 32
+#define PACKET_OVERHEAD_BYTES 11	// sync, type, length, object id, instance id and checksum
+#define BUCKET_DEPTH_MS 500		// burst the token bucket absorbs, in ms of the budgeted rate
+#define MIN_PERIODIC_SHARE 4		// periodic updates always get at least 1/4 of the budget
+#define SCALE_HYSTERESIS 10		// period scale changes below this many % are ignored
+#define MAX_PERIOD_SCALE 6400	// periods are stretched at most 64 times
 
 // Private types
+typedef struct {
+	UAVObjHandle obj;
+	uint16_t period;	// configured update period (ms)
+	uint16_t sent;		// updates sent since the last stats update
+} PeriodicObjectInfo;
 
 // Private variables
 static uint32_t telemetryPort;
@@ -68,6 +81,17 @@ static uint32_t txRetries;
 static TelemetrySettingsData settings;
 static uint32_t timeOfLastObjectUpdate;
 static UAVTalkConnection uavTalkCon;
+static uint32_t linkBaud;
+static PeriodicObjectInfo periodicObjects[MAX_PERIODIC_OBJECTS];
+static uint8_t numPeriodicObjects;
+static xSemaphoreHandle schedulerMutex;	// guards the periodic object table, both tx tasks update it
+static uint32_t budget;		// bytes/s available to telemetry, 0 if unlimited
+static uint32_t periodScale;	// scale applied to the periods of all periodic objects (%)
+static uint32_t demand;		// bytes/s needed by the periodic objects at their configured periods
+static int32_t tokens;
+static uint32_t timeOfLastRefill;
+static uint32_t periodicBytes;
+static uint32_t throttled;
 
 // Private functions
 static void telemetryTxTask(void *parameters);
@@ -81,6 +105,15 @@ static void processObjEvent(UAVObjEvent * ev);
 static void updateTelemetryStats();
 static void gcsTelemetryStatsUpdated();
 static void updateSettings();
+static int32_t schedulerAddObject(UAVObjHandle obj, uint16_t period);
+static void schedulerRemoveObject(UAVObjHandle obj);
+static int32_t schedulerFindObject(UAVObjHandle obj);
+static uint8_t schedulerIsPeriodic(UAVObjHandle obj);
+static void schedulerCountSent(UAVObjHandle obj, uint32_t bytes);
+static uint32_t schedulerScalePeriod(uint16_t period);
+static void schedulerUpdate(uint32_t otherBytes);
+static uint8_t schedulerConsume(uint32_t bytes, uint8_t periodic);
+static uint32_t packetSize(UAVObjHandle obj, uint16_t instId);
 
 /**
  * Initialise the telemetry module
@@ -91,6 +124,7 @@ int32_t TelemetryStart(void)
 {
 	// Process all registered objects and connect queue for updates
 	UAVObjIterate(&registerObject);
+	schedulerUpdate(0);
     
 	// Listen to objects of interest
 	GCSTelemetryStatsConnectQueue(priorityQueue);
@@ -122,9 +156,19 @@ int32_t TelemetryInitialize(void)
 	FlightTelemetryStatsInitialize();
 	GCSTelemetryStatsInitialize();
 	TelemetrySettingsInitialize();
+	FlightTelemetryRatesInitialize();
 
 	// Initialize vars
 	timeOfLastObjectUpdate = 0;
+	numPeriodicObjects = 0;
+	budget = 0;
+	periodScale = 100;
+	demand = 0;
+	tokens = 0;
+	timeOfLastRefill = 0;
+	periodicBytes = 0;
+	throttled = 0;
+	schedulerMutex = xSemaphoreCreateMutex();
 
 	// Create object queues
 	queue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(UAVObjEvent));
@@ -178,34 +222,41 @@ static void updateObject(UAVObjHandle obj)
 
 	// Setup object depending on update mode
 	if (metadata.telemetryUpdateMode == UPDATEMODE_PERIODIC) {
-		// Set update period
-		setUpdatePeriod(obj, metadata.telemetryUpdatePeriod);
+		// Set update period, scaled to fit the bandwidth budget
+		if (schedulerAddObject(obj, metadata.telemetryUpdatePeriod) == 0) {
+			setUpdatePeriod(obj, schedulerScalePeriod(metadata.telemetryUpdatePeriod));
+		} else {
+			setUpdatePeriod(obj, metadata.telemetryUpdatePeriod);
+		}
 		// Connect queue
 		eventMask = EV_UPDATED_MANUAL | EV_UPDATE_REQ;
 		if (UAVObjIsMetaobject(obj)) {
 			eventMask |= EV_UNPACKED;	// we also need to act on remote updates (unpack events)
 		}
-		UAVObjConnectQueue(obj, priorityQueue, eventMask);
+		UAVObjConnectQueueCoalesced(obj, priorityQueue, eventMask);
 	} else if (metadata.telemetryUpdateMode == UPDATEMODE_ONCHANGE) {
 		// Set update period
+		schedulerRemoveObject(obj);
 		setUpdatePeriod(obj, 0);
 		// Connect queue
 		eventMask = EV_UPDATED | EV_UPDATED_MANUAL | EV_UPDATE_REQ;
 		if (UAVObjIsMetaobject(obj)) {
 			eventMask |= EV_UNPACKED;	// we also need to act on remote updates (unpack events)
 		}
-		UAVObjConnectQueue(obj, priorityQueue, eventMask);
+		UAVObjConnectQueueCoalesced(obj, priorityQueue, eventMask);
 	} else if (metadata.telemetryUpdateMode == UPDATEMODE_MANUAL) {
 		// Set update period
+		schedulerRemoveObject(obj);
 		setUpdatePeriod(obj, 0);
 		// Connect queue
 		eventMask = EV_UPDATED_MANUAL | EV_UPDATE_REQ;
 		if (UAVObjIsMetaobject(obj)) {
 			eventMask |= EV_UNPACKED;	// we also need to act on remote updates (unpack events)
 		}
-		UAVObjConnectQueue(obj, priorityQueue, eventMask);
+		UAVObjConnectQueueCoalesced(obj, priorityQueue, eventMask);
 	} else if (metadata.telemetryUpdateMode == UPDATEMODE_NEVER) {
 		// Set update period
+		schedulerRemoveObject(obj);
 		setUpdatePeriod(obj, 0);
 		// Disconnect queue
 		UAVObjDisconnectQueue(obj, priorityQueue);
@@ -221,6 +272,7 @@ static void processObjEvent(UAVObjEvent * ev)
 	FlightTelemetryStatsData flightStats;
 	int32_t retries;
 	int32_t success;
+	uint8_t periodic;
 
 	if (ev->obj == 0) {
 		updateTelemetryStats();
@@ -238,15 +290,24 @@ static void processObjEvent(UAVObjEvent * ev)
 			retries = 0;
 			success = -1;
 			if (ev->event == EV_UPDATED || ev->event == EV_UPDATED_MANUAL) {
-				// Send update to GCS (with retries)
-				while (retries < MAX_RETRIES && success == -1) {
-					success = UAVTalkSendObject(uavTalkCon, ev->obj, ev->instId, metadata.telemetryAcked, REQ_TIMEOUT_MS);	// call blocks until ack is received or timeout
-					++retries;
-				}
-				// Update stats
-				txRetries += (retries - 1);
-				if (success == -1) {
-					++txErrors;
+				// Periodic objects are skipped while the link is over budget, their next update carries newer data.
+				// The stats object is exempt as it also drives the connection handshake.
+				periodic = (ev->event == EV_UPDATED_MANUAL && schedulerIsPeriodic(ev->obj));
+				if (!schedulerConsume(packetSize(ev->obj, ev->instId), periodic && ev->obj != FlightTelemetryStatsHandle())) {
+					++throttled;
+				} else {
+					// Send update to GCS (with retries)
+					while (retries < MAX_RETRIES && success == -1) {
+						success = UAVTalkSendObject(uavTalkCon, ev->obj, ev->instId, metadata.telemetryAcked, REQ_TIMEOUT_MS);	// call blocks until ack is received or timeout
+						++retries;
+					}
+					// Update stats
+					txRetries += (retries - 1);
+					if (success == -1) {
+						++txErrors;
+					} else if (periodic) {
+						schedulerCountSent(ev->obj, packetSize(ev->obj, ev->instId));
+					}
 				}
 			} else if (ev->event == EV_UPDATE_REQ) {
 				// Request object update from GCS (with retries)
@@ -279,6 +340,8 @@ static void telemetryTxTask(void *parameters)
 	while (1) {
 		// Wait for queue message
 		if (xQueueReceive(queue, &ev, portMAX_DELAY) == pdTRUE) {
+			// Further updates of the object get queued again from now on
+			UAVObjClearPendingEvent(queue, &ev);
 			// Process event
 			processObjEvent(&ev);
 		}
@@ -297,6 +360,8 @@ static void telemetryTxPriTask(void *parameters)
 	while (1) {
 		// Wait for queue message
 		if (xQueueReceive(priorityQueue, &ev, portMAX_DELAY) == pdTRUE) {
+			// Further updates of the object get queued again from now on
+			UAVObjClearPendingEvent(priorityQueue, &ev);
 			// Process event
 			processObjEvent(&ev);
 		}
@@ -324,15 +389,13 @@ static void telemetryRxTask(void *parameters)
 		}
 
 		if (inputPort) {
-			// Block until data are available
-			uint8_t serial_data[1];
+			// Block until data are available, then process everything received so far
+			uint8_t serial_data[RX_BUFFER_SIZE];
 			uint16_t bytes_to_process;
 
 			bytes_to_process = PIOS_COM_ReceiveBuffer(inputPort, serial_data, sizeof(serial_data), 500);
 			if (bytes_to_process > 0) {
-				for (uint8_t i = 0; i < bytes_to_process; i++) {
-					UAVTalkProcessInputStream(uavTalkCon,serial_data[i]);
-				}
+				UAVTalkProcessInputBuffer(uavTalkCon, serial_data, bytes_to_process);
 			}
 		} else {
 			vTaskDelay(5);
@@ -434,6 +497,9 @@ static void updateTelemetryStats()
 	UAVTalkGetStats(uavTalkCon, &utalkStats);
 	UAVTalkResetStats(uavTalkCon);
 
+	// Fit the periodic updates into what the other traffic left of the budget
+	schedulerUpdate(utalkStats.txBytes > periodicBytes ? utalkStats.txBytes - periodicBytes : 0);
+
 	// Get object data
 	FlightTelemetryStatsGet(&flightStats);
 	GCSTelemetryStatsGet(&gcsStats);
@@ -517,21 +583,276 @@ static void updateSettings()
     // Set port
     telemetryPort = PIOS_COM_TELEM_RF;
 
-    // Retrieve settings
+    // Retrieve settings, a zero BandwidthBudget disables the bandwidth scheduler
     TelemetrySettingsGet(&settings);
 
+    // Get port speed
+    if (settings.Speed == TELEMETRYSETTINGS_SPEED_2400) linkBaud = 2400;
+    else if (settings.Speed == TELEMETRYSETTINGS_SPEED_4800) linkBaud = 4800;
+    else if (settings.Speed == TELEMETRYSETTINGS_SPEED_9600) linkBaud = 9600;
+    else if (settings.Speed == TELEMETRYSETTINGS_SPEED_19200) linkBaud = 19200;
+    else if (settings.Speed == TELEMETRYSETTINGS_SPEED_38400) linkBaud = 38400;
+    else if (settings.Speed == TELEMETRYSETTINGS_SPEED_57600) linkBaud = 57600;
+    else linkBaud = 115200;
+
     if (telemetryPort) {
 	// Set port speed
-	if (settings.Speed == TELEMETRYSETTINGS_SPEED_2400) PIOS_COM_ChangeBaud(telemetryPort, 2400);
-	else if (settings.Speed == TELEMETRYSETTINGS_SPEED_4800) PIOS_COM_ChangeBaud(telemetryPort, 4800);
-	else if (settings.Speed == TELEMETRYSETTINGS_SPEED_9600) PIOS_COM_ChangeBaud(telemetryPort, 9600);
-	else if (settings.Speed == TELEMETRYSETTINGS_SPEED_19200) PIOS_COM_ChangeBaud(telemetryPort, 19200);
-	else if (settings.Speed == TELEMETRYSETTINGS_SPEED_38400) PIOS_COM_ChangeBaud(telemetryPort, 38400);
-	else if (settings.Speed == TELEMETRYSETTINGS_SPEED_57600) PIOS_COM_ChangeBaud(telemetryPort, 57600);
-	else if (settings.Speed == TELEMETRYSETTINGS_SPEED_115200) PIOS_COM_ChangeBaud(telemetryPort, 115200);
+	PIOS_COM_ChangeBaud(telemetryPort, linkBaud);
     }
 }
 
+/**
+ * Add a periodic object to the bandwidth scheduler, or update its configured period
+ * \param[in] obj The object
+ * \param[in] period The configured update period in ms
+ * \return 0 Success
+ * \return -1 Failure, the object table is full and the object is sent unscheduled
+ */
+static int32_t schedulerAddObject(UAVObjHandle obj, uint16_t period)
+{
+	int32_t idx;
+
+	xSemaphoreTake(schedulerMutex, portMAX_DELAY);
+	idx = schedulerFindObject(obj);
+	if (idx < 0) {
+		if (numPeriodicObjects >= MAX_PERIODIC_OBJECTS) {
+			xSemaphoreGive(schedulerMutex);
+			return -1;
+		}
+		idx = numPeriodicObjects++;
+		periodicObjects[idx].obj = obj;
+		periodicObjects[idx].sent = 0;
+	}
+	periodicObjects[idx].period = period;
+	xSemaphoreGive(schedulerMutex);
+	return 0;
+}
+
+/**
+ * Remove an object from the bandwidth scheduler, if it was periodic
+ * \param[in] obj The object
+ */
+static void schedulerRemoveObject(UAVObjHandle obj)
+{
+	int32_t idx;
+
+	xSemaphoreTake(schedulerMutex, portMAX_DELAY);
+	idx = schedulerFindObject(obj);
+	if (idx >= 0) {
+		periodicObjects[idx] = periodicObjects[--numPeriodicObjects];
+	}
+	xSemaphoreGive(schedulerMutex);
+}
+
+/**
+ * Find a periodic object in the bandwidth scheduler, the caller holds schedulerMutex
+ * \param[in] obj The object
+ * \return Index of the object or -1 if not periodic
+ */
+static int32_t schedulerFindObject(UAVObjHandle obj)
+{
+	int32_t n;
+
+	for (n = 0; n < numPeriodicObjects; ++n) {
+		if (periodicObjects[n].obj == obj) {
+			return n;
+		}
+	}
+	return -1;
+}
+
+/**
+ * Check whether an object is scheduled as periodic
+ * \param[in] obj The object
+ * \return 1 if periodic, 0 if not
+ */
+static uint8_t schedulerIsPeriodic(UAVObjHandle obj)
+{
+	uint8_t periodic;
+
+	xSemaphoreTake(schedulerMutex, portMAX_DELAY);
+	periodic = (schedulerFindObject(obj) >= 0);
+	xSemaphoreGive(schedulerMutex);
+	return periodic;
+}
+
+/**
+ * Count a sent update of a periodic object for the rate statistics. The object is
+ * looked up again, the table may have changed while the update was being sent.
+ * \param[in] obj The object
+ * \param[in] bytes Size of the update on the link
+ */
+static void schedulerCountSent(UAVObjHandle obj, uint32_t bytes)
+{
+	int32_t idx;
+
+	xSemaphoreTake(schedulerMutex, portMAX_DELAY);
+	idx = schedulerFindObject(obj);
+	if (idx >= 0) {
+		++periodicObjects[idx].sent;
+		periodicBytes += bytes;
+	}
+	xSemaphoreGive(schedulerMutex);
+}
+
+/**
+ * Scale a configured update period by the current period scale
+ */
+static uint32_t schedulerScalePeriod(uint16_t period)
+{
+	return ((uint32_t)period * periodScale) / 100;
+}
+
+/**
+ * Recompute the budget and the period scale, called on startup and with each stats update.
+ * The periodic objects get what is left of the budget after the other (on change, manual
+ * and acked) traffic of the last stats period, the periods of all of them are stretched
+ * by the same factor until their demand fits. Also exports the achieved rates of the objects
+ * that take the most bandwidth, the object is kept small enough for the GCS.
+ * \param[in] otherBytes Bytes sent by non periodic traffic during the last stats period
+ */
+static void schedulerUpdate(uint32_t otherBytes)
+{
+	FlightTelemetryRatesData rates;
+	uint32_t otherRate;
+	uint32_t available;
+	uint32_t newScale;
+	uint32_t bytes;
+	uint32_t maxBytes;
+	uint8_t exported[MAX_PERIODIC_OBJECTS];
+	int32_t maxIdx;
+	int32_t n;
+	int32_t k;
+
+	xSemaphoreTake(schedulerMutex, portMAX_DELAY);
+
+	// Budget, the USB link is not limited
+	budget = (linkBaud / 10) * settings.BandwidthBudget / 100;
+#if defined(PIOS_INCLUDE_USB_HID)
+	if (PIOS_USB_HID_CheckAvailable(0)) {
+		budget = 0;
+	}
+#endif /* PIOS_INCLUDE_USB_HID */
+
+	// Demand of the periodic objects at their configured periods
+	demand = 0;
+	for (n = 0; n < numPeriodicObjects; ++n) {
+		if (periodicObjects[n].period > 0) {
+			demand += (packetSize(periodicObjects[n].obj, UAVOBJ_ALL_INSTANCES) * 1000) / periodicObjects[n].period;
+		}
+	}
+
+	// Period scale needed to fit the demand into the available bandwidth
+	newScale = 100;
+	if (budget > 0) {
+		otherRate = (otherBytes * 1000) / STATS_UPDATE_PERIOD_MS;
+		available = budget / MIN_PERIODIC_SHARE;
+		if (otherRate < budget - available) {
+			available = budget - otherRate;
+		}
+		if (demand > available) {
+			newScale = (demand * 100 + available - 1) / available;
+			if (newScale > MAX_PERIOD_SCALE) {
+				newScale = MAX_PERIOD_SCALE;
+			}
+		}
+	}
+
+	// Apply the new periods, small changes are ignored so the periods do not jitter
+	if (newScale > periodScale + SCALE_HYSTERESIS || newScale + SCALE_HYSTERESIS < periodScale ||
+			(newScale == 100 && periodScale != 100)) {
+		periodScale = newScale;
+		for (n = 0; n < numPeriodicObjects; ++n) {
+			setUpdatePeriod(periodicObjects[n].obj, schedulerScalePeriod(periodicObjects[n].period));
+		}
+	}
+
+	// Export the achieved rates
+	memset(&rates, 0, sizeof(rates));
+	rates.Budget = (budget > 0xFFFF ? 0xFFFF : budget);
+	rates.Demand = (demand > 0xFFFF ? 0xFFFF : demand);
+	rates.PeriodScale = periodScale;
+	rates.Throttled = throttled;
+	memset(exported, 0, sizeof(exported));
+	for (k = 0; k < FLIGHTTELEMETRYRATES_OBJECTID_NUMELEM; ++k) {
+		maxIdx = -1;
+		maxBytes = 0;
+		for (n = 0; n < numPeriodicObjects; ++n) {
+			bytes = periodicObjects[n].sent * packetSize(periodicObjects[n].obj, UAVOBJ_ALL_INSTANCES);
+			if (!exported[n] && (maxIdx < 0 || bytes > maxBytes)) {
+				maxIdx = n;
+				maxBytes = bytes;
+			}
+		}
+		if (maxIdx < 0) {
+			break;
+		}
+		exported[maxIdx] = 1;
+		rates.ObjectID[k] = UAVObjGetID(periodicObjects[maxIdx].obj);
+		rates.Rate[k] = (float)periodicObjects[maxIdx].sent / ((float)STATS_UPDATE_PERIOD_MS / 1000.0);
+	}
+	for (n = 0; n < numPeriodicObjects; ++n) {
+		periodicObjects[n].sent = 0;
+	}
+	periodicBytes = 0;
+	xSemaphoreGive(schedulerMutex);
+
+	FlightTelemetryRatesSet(&rates);
+}
+
+/**
+ * Take the bytes of an update from the token bucket. The bucket refills at the budgeted
+ * rate. Periodic updates are only sent if the bucket holds enough tokens, all other
+ * updates are always sent and may overdraw the bucket, which then delays the periodic ones.
+ * \param[in] bytes Size of the update on the link
+ * \param[in] periodic Non zero if this is an update of a periodic object
+ * \return 1 if the update can be sent, 0 if it has to be skipped
+ */
+static uint8_t schedulerConsume(uint32_t bytes, uint8_t periodic)
+{
+	uint32_t timeNow;
+	int32_t depth;
+	uint8_t allowed;
+
+	if (budget == 0) {
+		return 1;
+	}
+
+	taskENTER_CRITICAL();
+	// Refill
+	timeNow = xTaskGetTickCount() * portTICK_RATE_MS;
+	depth = (budget * BUCKET_DEPTH_MS) / 1000;
+	tokens += ((timeNow - timeOfLastRefill) * budget) / 1000;
+	timeOfLastRefill = timeNow;
+	if (tokens > depth) {
+		tokens = depth;
+	}
+	// Consume
+	allowed = (!periodic || tokens >= (int32_t)bytes);
+	if (allowed) {
+		tokens -= bytes;
+		if (tokens < -depth) {
+			tokens = -depth;
+		}
+	}
+	taskEXIT_CRITICAL();
+	return allowed;
+}
+
+/**
+ * Number of bytes an update of the object takes on the link
+ * \param[in] obj The object
+ * \param[in] instId The instance, or UAVOBJ_ALL_INSTANCES
+ */
+static uint32_t packetSize(UAVObjHandle obj, uint16_t instId)
+{
+	uint32_t size = UAVObjGetNumBytes(obj) + PACKET_OVERHEAD_BYTES;
+	if (instId == UAVOBJ_ALL_INSTANCES) {
+		size *= UAVObjGetNumInstances(obj);
+	}
+	return size;
+}
+
 // Dummy function for now, should be filled with life
 void debug_vect(const char* string, const float x, const float y, const float z)
 {
@@ -92,6 +92,14 @@ do {\
 #define CHECK_IRQ_STACK
 #endif
 
+/* Ticks advanced by an external simulator in the posix SITL build, see
+   TICK_LOCKSTEP in PiOS.posix/inc/FreeRTOSConfig.h */
+#if defined(ARCH_POSIX) && defined(TICK_LOCKSTEP)
+#define INCLUDE_xTaskGetIdleTaskHandle	1
+#define configLOCKSTEP_PORT		9100
+#define configLOCKSTEP_TIMEOUT_MS	1000
+#endif
+
 /**
   * @}
   */
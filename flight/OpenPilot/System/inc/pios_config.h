@@ -80,6 +80,9 @@
 /* Enable a priority queue in telemetry */
 #define PIOS_TELEM_PRIORITY_QUEUE
 
+/* Run background callbacks (settings, logging) on their own event task and queue */
+#define PIOS_EVENTDISPATCHER_BACKGROUND_LANE
+
 /* COM Module */
 #define GPS_BAUDRATE			19200
 #define TELEM_BAUDRATE			19200
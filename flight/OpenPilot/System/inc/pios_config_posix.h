@@ -46,17 +46,24 @@
 #define PIOS_RCVR_MAX_CHANNELS			12
 #define PIOS_RCVR_MAX_DEVS              3
 
+/* Settings on the RAM flash chip, 128KB of it */
+#define PIOS_FLASHFS_MAX_OBJECTS	48
+#define PIOS_FLASHFS_MAX_SECTORS	32
+
 /* Defaults for Logging */
 #define LOG_FILENAME 			"PIOS.LOG"
 #define STARTUP_LOG_ENABLED		1
 
+/* Run background callbacks (settings, logging) on their own event task and queue */
+#define PIOS_EVENTDISPATCHER_BACKGROUND_LANE
+
 /* COM Module */
 #define GPS_BAUDRATE			19200
 #define TELEM_BAUDRATE			19200
 #define AUXUART_ENABLED			0
 #define AUXUART_BAUDRATE		19200
 
-#define TELEM_QUEUE_SIZE                20
+#define TELEM_QUEUE_SIZE                10
 #define PIOS_TELEM_STACK_SIZE           2048
 
 /* Stabilization options */
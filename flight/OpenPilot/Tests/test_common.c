@@ -34,4 +34,12 @@ void vApplicationStackOverflowHook( xTaskHandle *pxTask, signed portCHAR *pcTask
 	PIOS_DEBUG_Panic("STACK OVERFLOW");
 }
 
+/**
+ * Called by the RTOS when a memory allocation fails.
+ */
+void vApplicationMallocFailedHook(void)
+{
+	PIOS_DEBUG_Panic("MALLOC FAILED");
+}
+
 
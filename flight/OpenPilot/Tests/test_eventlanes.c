@@ -0,0 +1,150 @@
+/**
+ ******************************************************************************
+ *
+ * @file       test_eventlanes.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2011.
+ * @brief      SITL test for the lanes of the event dispatcher
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/**
+ * Runs a fast periodic callback while a slow callback (like a settings update that
+ * waits for a flash write) is triggered by object updates. The slow callback first runs on
+ * the high priority lane, next to the periodic one, and then on the background lane.
+ * Reports the worst delay of the periodic callback and the lane statistics.
+ * Build and run with:
+ *   make -f Makefile.posix TESTAPP=test_eventlanes
+ */
+
+#include "openpilot.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Local constants
+#define PERIOD_MS 10
+#define SLOW_CALLBACK_MS 30
+#define NUM_UPDATES 20
+#define UPDATE_INTERVAL_MS 100
+
+// Local functions
+static void testTask(void *pvParameters);
+static uint32_t runLane(int32_t priority);
+static void periodicCallback(UAVObjEvent* ev);
+static void slowCallback(UAVObjEvent* ev);
+
+// Variables
+static UAVObjHandle settingsObj;
+static uint32_t lastCall;
+static uint32_t maxIntervalUs;
+static uint32_t slowCalls;
+
+int main()
+{
+	PIOS_SYS_Init();
+	UAVObjInitialize();
+	EventDispatcherInitialize();
+
+	// Create test task
+	xTaskCreate(testTask, (signed portCHAR *)"Test", 1000 , NULL, 1, NULL);
+
+	// Start the FreeRTOS scheduler
+	vTaskStartScheduler();
+	return 0;
+}
+
+void vApplicationIdleHook(void)
+{
+	/* Called when the scheduler has no tasks to run */
+}
+
+static void testTask(void *pvParameters)
+{
+	UAVObjEvent ev;
+	uint32_t highMax;
+	uint32_t backgroundMax;
+
+	settingsObj = UAVObjRegister(0x5000, "LaneSettings", "LaneSettingsMeta", 0, 1, 1, sizeof(uint32_t), NULL);
+
+	memset(&ev, 0, sizeof(ev));
+	EventPeriodicCallbackCreate(&ev, periodicCallback, PERIOD_MS);
+	vTaskDelay(100 / portTICK_RATE_MS);
+
+	printf("slow callback lane  periodic max interval[us]  high depth/latency[ms]  background depth/latency[ms]\n");
+	highMax = runLane(EVENT_PRIORITY_HIGH);
+	backgroundMax = runLane(EVENT_PRIORITY_BACKGROUND);
+
+	// The periodic callback must not wait for the slow callback on the background lane
+	exit(backgroundMax < (PERIOD_MS + SLOW_CALLBACK_MS / 2) * 1000 && highMax > backgroundMax ? 0 : 1);
+}
+
+/**
+ * Trigger the slow callback from object updates, with the callback on the given lane
+ * \return Largest interval between two calls of the periodic callback in us
+ */
+static uint32_t runLane(int32_t priority)
+{
+	EventStats stats;
+	uint32_t value;
+	uint32_t n;
+
+	UAVObjConnectCallbackPriority(settingsObj, slowCallback, EV_MASK_ALL_UPDATES, priority);
+	vTaskDelay(100 / portTICK_RATE_MS);
+	EventClearStats();
+	maxIntervalUs = 0;
+	slowCalls = 0;
+
+	for (n = 0; n < NUM_UPDATES; ++n)
+	{
+		value = n;
+		UAVObjSetData(settingsObj, &value);
+		vTaskDelay(UPDATE_INTERVAL_MS / portTICK_RATE_MS);
+	}
+	EventGetStats(&stats);
+	UAVObjDisconnectCallback(settingsObj, slowCallback);
+
+	printf("%18s  %25u  %13u/%8u  %19u/%8u\n", (priority == EVENT_PRIORITY_HIGH ? "high" : "background"),
+			(unsigned int)maxIntervalUs,
+			(unsigned int)stats.lanes[EVENT_PRIORITY_HIGH].maxQueueDepth, (unsigned int)stats.lanes[EVENT_PRIORITY_HIGH].maxLatencyMs,
+			(unsigned int)stats.lanes[EVENT_PRIORITY_BACKGROUND].maxQueueDepth, (unsigned int)stats.lanes[EVENT_PRIORITY_BACKGROUND].maxLatencyMs);
+	if (slowCalls != NUM_UPDATES || stats.eventErrors > 0)
+		printf("slow callback ran %u of %u times, %u event errors\n", (unsigned int)slowCalls, NUM_UPDATES, (unsigned int)stats.eventErrors);
+
+	return maxIntervalUs;
+}
+
+/**
+ * Periodic callback, measures the largest interval between two calls
+ */
+static void periodicCallback(UAVObjEvent* ev)
+{
+	uint32_t now = PIOS_DELAY_GetuS();
+
+	if (lastCall != 0 && now - lastCall > maxIntervalUs)
+		maxIntervalUs = now - lastCall;
+	lastCall = now;
+}
+
+/**
+ * Slow callback, waits like a flash write does
+ */
+static void slowCallback(UAVObjEvent* ev)
+{
+	vTaskDelay(SLOW_CALLBACK_MS / portTICK_RATE_MS);
+	++slowCalls;
+}
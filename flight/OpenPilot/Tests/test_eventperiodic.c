@@ -0,0 +1,178 @@
+/**
+ ******************************************************************************
+ *
+ * @file       test_eventperiodic.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2011.
+ * @brief      SITL benchmark for the periodic events of the event dispatcher
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/**
+ * Creates an increasing number of periodic callbacks with periods from 10ms to
+ * 1s and reports the CPU time used by the event task and the deadline jitter,
+ * the difference between the measured and the configured callback interval.
+ * Build and run with:
+ *   make -f Makefile.posix TESTAPP=test_eventperiodic
+ */
+
+#include "openpilot.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+// Local constants
+#define MAX_EVENTS 800
+#define RUN_TIME_MS 3000
+#define PROBE_PERIOD_MS 50
+
+// Local types
+typedef struct {
+	int32_t periodMs;
+	uint32_t lastCall;
+} EventInfo;
+
+// Local functions
+static void testTask(void *pvParameters);
+static void createEvents(uint32_t numEvents);
+static void periodicCallback(UAVObjEvent* ev);
+static void probeCallback(UAVObjEvent* ev);
+static uint64_t threadCpuTimeUs();
+
+// Variables
+static const int32_t periods[] = { 10, 20, 50, 100, 200, 500, 1000 };
+static EventInfo events[MAX_EVENTS];
+static uint32_t numEvents = 0;
+static volatile uint64_t eventTaskCpuUs = 0;
+static uint32_t calls;
+static uint64_t jitterSumUs;
+static uint32_t jitterMaxUs;
+static uint8_t measuring = 0;
+
+int main()
+{
+	PIOS_SYS_Init();
+	UAVObjInitialize();
+	EventDispatcherInitialize();
+
+	// Create test task
+	xTaskCreate(testTask, (signed portCHAR *)"Test", 1000 , NULL, 1, NULL);
+
+	// Start the FreeRTOS scheduler
+	vTaskStartScheduler();
+	return 0;
+}
+
+void vApplicationIdleHook(void)
+{
+	/* Called when the scheduler has no tasks to run */
+}
+
+static void testTask(void *pvParameters)
+{
+	static const uint32_t steps[] = { 25, 50, 100, 200, 400, 800 };
+	UAVObjEvent ev;
+	uint64_t cpuStart;
+	uint32_t n;
+
+	// The probe samples the CPU time of the event task, it runs in that task
+	memset(&ev, 0, sizeof(ev));
+	EventPeriodicCallbackCreate(&ev, probeCallback, PROBE_PERIOD_MS);
+
+	printf("events  cpu[%%]  calls/s  jitter avg[us]  jitter max[us]\n");
+	for (n = 0; n < sizeof(steps) / sizeof(steps[0]); ++n)
+	{
+		createEvents(steps[n]);
+		// Let the new events settle
+		vTaskDelay(1000 / portTICK_RATE_MS);
+		// Measure
+		calls = 0;
+		jitterSumUs = 0;
+		jitterMaxUs = 0;
+		cpuStart = eventTaskCpuUs;
+		measuring = 1;
+		vTaskDelay(RUN_TIME_MS / portTICK_RATE_MS);
+		measuring = 0;
+		printf("%6u  %6.2f  %7u  %14.1f  %14u\n", (unsigned int)steps[n],
+				(float)(eventTaskCpuUs - cpuStart) / (RUN_TIME_MS * 10.0f),
+				(unsigned int)(calls * 1000 / RUN_TIME_MS),
+				(calls > 0 ? (float)jitterSumUs / (float)calls : 0.0f), (unsigned int)jitterMaxUs);
+	}
+
+	exit(0);
+}
+
+/**
+ * Create periodic callbacks until numEvents are active, the event object is a dummy
+ * handle that identifies the entry
+ */
+static void createEvents(uint32_t numTotal)
+{
+	UAVObjEvent ev;
+
+	while (numEvents < numTotal)
+	{
+		events[numEvents].periodMs = periods[numEvents % (sizeof(periods) / sizeof(periods[0]))];
+		events[numEvents].lastCall = 0;
+		memset(&ev, 0, sizeof(ev));
+		ev.obj = (UAVObjHandle)&events[numEvents];
+		EventPeriodicCallbackCreate(&ev, periodicCallback, events[numEvents].periodMs);
+		++numEvents;
+	}
+}
+
+/**
+ * Periodic callback, measures the deviation from the configured period
+ */
+static void periodicCallback(UAVObjEvent* ev)
+{
+	EventInfo* info = (EventInfo*)ev->obj;
+	uint32_t now = PIOS_DELAY_GetuS();
+	int32_t jitter;
+
+	if (measuring && info->lastCall != 0)
+	{
+		jitter = (int32_t)(now - info->lastCall) - info->periodMs * 1000;
+		if (jitter < 0)
+			jitter = -jitter;
+		jitterSumUs += jitter;
+		if ((uint32_t)jitter > jitterMaxUs)
+			jitterMaxUs = jitter;
+		++calls;
+	}
+	info->lastCall = now;
+}
+
+/**
+ * Probe callback, samples the CPU time of the event task
+ */
+static void probeCallback(UAVObjEvent* ev)
+{
+	eventTaskCpuUs = threadCpuTimeUs();
+}
+
+/**
+ * CPU time used by the calling thread in us
+ */
+static uint64_t threadCpuTimeUs()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
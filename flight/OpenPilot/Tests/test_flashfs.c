@@ -0,0 +1,329 @@
+/**
+ ******************************************************************************
+ *
+ * @file       test_flashfs.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2011.
+ * @brief      SITL benchmark for the flash object store
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/**
+ * Saves and loads a settings sized set of objects on the RAM flash chip, then
+ * saves a single object over and over like a user tuning one setting. Reports the
+ * time per operation and the flash traffic and wear, checks that every load returns
+ * the latest data, also after the file system is mounted again, and that deleted
+ * objects stay deleted. Finally the power is cut at every byte of a save, the
+ * previous data must load after the mount and later saves must still work. A chip
+ * with the old object table layout must only be formatted on request.
+ * Build and run with:
+ *   make -f Makefile.posix TESTAPP=test_flashfs
+ */
+
+#include "openpilot.h"
+#include "pios_flash_ram.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/time.h>
+
+// Local constants
+#define NUM_OBJECTS 40
+#define MIN_OBJECT_SIZE 20
+#define MAX_OBJECT_SIZE 200
+#define ROUNDS 25
+#define HOT_SAVES 200000
+
+// Typical W25X timings to estimate the time on the real chip
+#define W25X_ERASE_US 150000
+#define W25X_PROGRAM_US 1500
+#define W25X_READ_CMD_US 5
+#define W25X_READ_BYTE_US 1
+
+// Local functions
+static void testTask(void *pvParameters);
+static void fillData(uint16_t obj, uint32_t round);
+static int32_t saveAll(uint32_t round);
+static int32_t loadAll(uint32_t round);
+static int32_t cutSaves(void);
+static int32_t oldLayout(void);
+static uint32_t timeUs(void);
+static void printStats(const char *name, uint32_t ops, uint32_t us);
+
+// Variables
+static UAVObjHandle objs[NUM_OBJECTS];
+static uint16_t sizes[NUM_OBJECTS];
+static char names[NUM_OBJECTS][2][24];
+static uint8_t data[MAX_OBJECT_SIZE];
+static uint8_t loaded[MAX_OBJECT_SIZE];
+
+int main()
+{
+	PIOS_SYS_Init();
+	UAVObjInitialize();
+	EventDispatcherInitialize();
+
+	// Create test task
+	xTaskCreate(testTask, (signed portCHAR *)"Test", 1000 , NULL, 1, NULL);
+
+	// Start the FreeRTOS scheduler
+	vTaskStartScheduler();
+	return 0;
+}
+
+void vApplicationIdleHook(void)
+{
+	/* Called when the scheduler has no tasks to run */
+}
+
+static void testTask(void *pvParameters)
+{
+	int32_t failed = 0;
+	uint32_t start;
+	uint32_t round;
+	uint32_t n;
+
+	for (n = 0; n < NUM_OBJECTS; ++n) {
+		sizes[n] = MIN_OBJECT_SIZE + (n * 37) % (MAX_OBJECT_SIZE - MIN_OBJECT_SIZE + 1);
+		snprintf(names[n][0], sizeof(names[n][0]), "FlashObj%u", (unsigned int)n);
+		snprintf(names[n][1], sizeof(names[n][1]), "FlashObj%uMeta", (unsigned int)n);
+		objs[n] = UAVObjRegister(0x5000 + n * 2, names[n][0], names[n][1], 0, 1, 1, sizes[n], NULL);
+	}
+
+	start = timeUs();
+	if (PIOS_FLASHFS_Init(&PIOS_Flash_RAM_Driver) != 0 || PIOS_FLASHFS_Format() != 0) {
+		printf("init failed\n");
+		exit(1);
+	}
+	printf("format: %u us\n", (unsigned int)(timeUs() - start));
+
+	// Save and load the whole set
+	PIOS_Flash_RAM_ClearStats();
+	start = timeUs();
+	for (round = 1; round <= ROUNDS; ++round)
+		failed |= saveAll(round);
+	printStats("save all", ROUNDS * NUM_OBJECTS, timeUs() - start);
+
+	PIOS_Flash_RAM_ClearStats();
+	start = timeUs();
+	for (n = 0; n < ROUNDS; ++n)
+		failed |= loadAll(ROUNDS);
+	printStats("load all", ROUNDS * NUM_OBJECTS, timeUs() - start);
+
+	// Save a single object repeatedly
+	PIOS_Flash_RAM_ClearStats();
+	start = timeUs();
+	for (round = ROUNDS + 1; round <= ROUNDS + HOT_SAVES; ++round) {
+		fillData(0, round);
+		if (PIOS_FLASHFS_ObjSave(objs[0], 0, data) != 0)
+			failed |= 1;
+	}
+	printStats("save one", HOT_SAVES, timeUs() - start);
+
+	// Mount again, everything must still be there
+	start = timeUs();
+	if (PIOS_FLASHFS_Init(&PIOS_Flash_RAM_Driver) != 0)
+		failed |= 1;
+	printf("mount: %u us\n", (unsigned int)(timeUs() - start));
+	fillData(0, ROUNDS + HOT_SAVES);
+	if (PIOS_FLASHFS_ObjLoad(objs[0], 0, loaded) != 0 || memcmp(data, loaded, sizes[0]) != 0) {
+		printf("hot object lost after mount\n");
+		failed |= 1;
+	}
+	for (n = 1; n < NUM_OBJECTS; ++n) {
+		fillData(n, ROUNDS);
+		if (PIOS_FLASHFS_ObjLoad(objs[n], 0, loaded) != 0 || memcmp(data, loaded, sizes[n]) != 0) {
+			printf("object %u lost after mount\n", (unsigned int)n);
+			failed |= 1;
+		}
+	}
+
+	// Deleted objects stay deleted
+	PIOS_FLASHFS_ObjDelete(objs[1], 0);
+	if (PIOS_FLASHFS_ObjLoad(objs[1], 0, loaded) == 0)
+		failed |= 1;
+	PIOS_FLASHFS_Init(&PIOS_Flash_RAM_Driver);
+	if (PIOS_FLASHFS_ObjLoad(objs[1], 0, loaded) == 0) {
+		printf("deleted object back after mount\n");
+		failed |= 1;
+	}
+
+	// Reset safety
+	failed |= cutSaves();
+
+	// Settings of the old layout
+	failed |= oldLayout();
+
+	printf("%s\n", failed ? "FAILED" : "passed");
+	exit(failed);
+}
+
+/**
+ * Data pattern of an object for a save round
+ */
+static void fillData(uint16_t obj, uint32_t round)
+{
+	uint16_t n;
+
+	for (n = 0; n < sizes[obj]; ++n)
+		data[n] = (uint8_t)(round * 31 + obj * 7 + n);
+}
+
+/**
+ * Save every object
+ * \return 0 if all saves succeeded
+ */
+static int32_t saveAll(uint32_t round)
+{
+	int32_t failed = 0;
+	uint16_t n;
+
+	for (n = 0; n < NUM_OBJECTS; ++n) {
+		fillData(n, round);
+		if (PIOS_FLASHFS_ObjSave(objs[n], 0, data) != 0) {
+			printf("save of object %u failed\n", n);
+			failed = 1;
+		}
+	}
+	return failed;
+}
+
+/**
+ * Load every object and compare it with the data of a save round
+ * \return 0 if all objects loaded with the expected data
+ */
+static int32_t loadAll(uint32_t round)
+{
+	int32_t failed = 0;
+	uint16_t n;
+
+	for (n = 0; n < NUM_OBJECTS; ++n) {
+		fillData(n, round);
+		if (PIOS_FLASHFS_ObjLoad(objs[n], 0, loaded) != 0 || memcmp(data, loaded, sizes[n]) != 0) {
+			printf("load of object %u failed\n", n);
+			failed = 1;
+		}
+	}
+	return failed;
+}
+
+/**
+ * Cut the power at every byte of a save of object 2 until one goes through. After
+ * each cut the file system is mounted again, object 2 must load its previous data
+ * and a save of object 3 must not be corrupted by the remains of the cut record.
+ * \return 0 if every cut was survived
+ */
+static int32_t cutSaves(void)
+{
+	int32_t failed = 0;
+	int32_t retval;
+	uint32_t cut;
+
+	for (cut = 1; ; ++cut) {
+		fillData(2, ROUNDS + 1);
+		PIOS_Flash_RAM_CutAfter(cut);
+		retval = PIOS_FLASHFS_ObjSave(objs[2], 0, data);
+		PIOS_Flash_RAM_CutAfter(0);
+		if (retval == 0)
+			break;
+
+		if (PIOS_FLASHFS_Init(&PIOS_Flash_RAM_Driver) != 0) {
+			printf("cut at byte %u: mount failed\n", (unsigned int)cut);
+			return 1;
+		}
+		fillData(2, ROUNDS);
+		if (PIOS_FLASHFS_ObjLoad(objs[2], 0, loaded) != 0 || memcmp(data, loaded, sizes[2]) != 0) {
+			printf("cut at byte %u: previous data lost\n", (unsigned int)cut);
+			failed = 1;
+		}
+
+		fillData(3, ROUNDS + cut);
+		if (PIOS_FLASHFS_ObjSave(objs[3], 0, data) != 0)
+			failed = 1;
+		PIOS_FLASHFS_Init(&PIOS_Flash_RAM_Driver);
+		if (PIOS_FLASHFS_ObjLoad(objs[3], 0, loaded) != 0 || memcmp(data, loaded, sizes[3]) != 0) {
+			printf("cut at byte %u: later save lost\n", (unsigned int)cut);
+			failed = 1;
+		}
+	}
+
+	// The save that went through must be there after the mount
+	PIOS_FLASHFS_Init(&PIOS_Flash_RAM_Driver);
+	fillData(2, ROUNDS + 1);
+	if (PIOS_FLASHFS_ObjLoad(objs[2], 0, loaded) != 0 || memcmp(data, loaded, sizes[2]) != 0) {
+		printf("save after the cuts lost\n");
+		failed = 1;
+	}
+	printf("power cut at %u points of a save of %u bytes: %s\n", (unsigned int)(cut - 1),
+			(unsigned int)sizes[2], failed ? "FAILED" : "passed");
+
+	return failed;
+}
+
+/**
+ * Mount a chip that holds the object table of the old layout, it must stay
+ * untouched and unmounted until it is formatted
+ * \return 0 if the layout was kept until the format
+ */
+static int32_t oldLayout(void)
+{
+	const uint32_t tableMagic = 0x85FB3C35;
+	uint32_t magic = 0;
+	int32_t failed = 0;
+
+	PIOS_Flash_RAM_Driver.EraseChip();
+	PIOS_Flash_RAM_Driver.WriteData(0, (uint8_t *) &tableMagic, sizeof(tableMagic));
+
+	fillData(4, 1);
+	if (PIOS_FLASHFS_Init(&PIOS_Flash_RAM_Driver) != -2 || PIOS_FLASHFS_IsMounted() ||
+			PIOS_FLASHFS_ObjSave(objs[4], 0, data) == 0)
+		failed = 1;
+	PIOS_Flash_RAM_Driver.ReadData(0, (uint8_t *) &magic, sizeof(magic));
+	if (magic != tableMagic)
+		failed = 1;
+
+	if (PIOS_FLASHFS_Format() != 0 || !PIOS_FLASHFS_IsMounted() ||
+			PIOS_FLASHFS_ObjSave(objs[4], 0, data) != 0 ||
+			PIOS_FLASHFS_Init(&PIOS_Flash_RAM_Driver) != 0 ||
+			PIOS_FLASHFS_ObjLoad(objs[4], 0, loaded) != 0 || memcmp(data, loaded, sizes[4]) != 0)
+		failed = 1;
+
+	printf("old object table layout kept until the format: %s\n", failed ? "FAILED" : "passed");
+	return failed;
+}
+
+static uint32_t timeUs(void)
+{
+	struct timeval tv;
+
+	gettimeofday(&tv, NULL);
+	return tv.tv_sec * 1000000 + tv.tv_usec;
+}
+
+static void printStats(const char *name, uint32_t ops, uint32_t us)
+{
+	struct pios_flash_ram_stats stats;
+
+	PIOS_Flash_RAM_GetStats(&stats);
+	float chipUs = (float)stats.sectorErases * W25X_ERASE_US + (float)stats.writes * W25X_PROGRAM_US +
+			(float)stats.reads * W25X_READ_CMD_US + (float)stats.bytesRead * W25X_READ_BYTE_US;
+	printf("%s: %u ops, %.2f us/op, W25X estimate %.2f ms/op, %u erases, %u writes (%u bytes), %u reads (%u bytes), worst sector %u erases\n",
+			name, (unsigned int)ops, (float)us / ops, chipUs / 1000 / ops, (unsigned int)stats.sectorErases,
+			(unsigned int)stats.writes, (unsigned int)stats.bytesWritten,
+			(unsigned int)stats.reads, (unsigned int)stats.bytesRead,
+			(unsigned int)stats.maxSectorErases);
+}
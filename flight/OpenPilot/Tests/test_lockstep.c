@@ -0,0 +1,249 @@
+/**
+ ******************************************************************************
+ *
+ * @file       test_lockstep.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2011.
+ * @brief      SITL test of the lockstep tick mode of the posix port
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/**
+ * Runs a control loop against a simulated plant, a busy task that preempts the
+ * logger and a logger that hashes every sample. A simulator thread steps the
+ * ticks over UDP one at a time, like an external simulator with a 1ms step,
+ * then checks the task counts and the virtual time and reports the speed
+ * relative to real time. The hash must be the same on every run.
+ * Build and run with:
+ *   make -f Makefile.posix TESTAPP=test_lockstep LOCKSTEP=YES
+ */
+
+#include "openpilot.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+#if !defined(TICK_LOCKSTEP)
+#error "test_lockstep needs the lockstep tick, build with LOCKSTEP=YES"
+#endif
+
+// Local constants
+#define SIM_TICKS 5000
+#define CONTROL_PERIOD_MS 2
+#define BUSY_PERIOD_MS 5
+#define BUSY_LOOPS 20000
+#define SETPOINT_PERIOD_MS 500
+
+// Local types
+typedef struct {
+	uint32_t timeUs;
+	float position;
+	float command;
+} Sample;
+
+// Local functions
+static void controlTask(void *pvParameters);
+static void busyTask(void *pvParameters);
+static void logTask(void *pvParameters);
+static void *simulatorThread(void *arg);
+static uint32_t step(int sock, uint32_t ticks);
+static uint64_t wallTimeUs();
+
+// Variables
+static xQueueHandle sampleQueue;
+static volatile uint32_t controlRuns = 0;
+static volatile uint32_t busyRuns = 0;
+static volatile uint32_t samplesLogged = 0;
+static volatile uint32_t timeErrors = 0;
+static volatile uint32_t sampleHash = 2166136261u;
+
+int main()
+{
+	pthread_t simulator;
+
+	PIOS_SYS_Init();
+
+	sampleQueue = xQueueCreate(16, sizeof(Sample));
+	xTaskCreate(controlTask, (signed portCHAR *)"Control", 1000, NULL, 3, NULL);
+	xTaskCreate(busyTask, (signed portCHAR *)"Busy", 1000, NULL, 2, NULL);
+	xTaskCreate(logTask, (signed portCHAR *)"Log", 1000, NULL, 1, NULL);
+
+	// The simulator is not a task, it only talks to the port over UDP
+	pthread_create(&simulator, NULL, simulatorThread, NULL);
+
+	// Start the FreeRTOS scheduler
+	vTaskStartScheduler();
+	return 0;
+}
+
+void vApplicationIdleHook(void)
+{
+	/* Called when the scheduler has no tasks to run */
+}
+
+/**
+ * PD control of a unit mass towards a setpoint that toggles every 500ms
+ */
+static void controlTask(void *pvParameters)
+{
+	const float dT = CONTROL_PERIOD_MS / 1000.0f;
+	portTickType lastWake = xTaskGetTickCount();
+	float position = 0;
+	float velocity = 0;
+	float setpoint;
+	Sample sample;
+
+	while (1)
+	{
+		vTaskDelayUntil(&lastWake, CONTROL_PERIOD_MS / portTICK_RATE_MS);
+		if (PIOS_DELAY_GetuS() != lastWake * portTICK_RATE_MICROSECONDS)
+			++timeErrors;
+
+		setpoint = ((lastWake / SETPOINT_PERIOD_MS) & 1) ? 1.0f : -1.0f;
+		sample.command = 40.0f * (setpoint - position) - 8.0f * velocity;
+		velocity += sample.command * dT;
+		position += velocity * dT;
+
+		sample.timeUs = PIOS_DELAY_GetuS();
+		sample.position = position;
+		xQueueSend(sampleQueue, &sample, 0);
+		++controlRuns;
+	}
+}
+
+/**
+ * Burns CPU time so the logger is preempted at points that depend on the
+ * tick, not on the host load
+ */
+static void busyTask(void *pvParameters)
+{
+	portTickType lastWake = xTaskGetTickCount();
+	volatile uint32_t work;
+	uint32_t n;
+
+	while (1)
+	{
+		vTaskDelayUntil(&lastWake, BUSY_PERIOD_MS / portTICK_RATE_MS);
+		for (n = 0, work = 0; n < BUSY_LOOPS; ++n)
+			work += n;
+		++busyRuns;
+	}
+}
+
+/**
+ * FNV-1a hash over the samples and the time they are logged at
+ */
+static void logTask(void *pvParameters)
+{
+	Sample sample;
+	uint32_t words[4];
+	uint8_t *bytes = (uint8_t *)words;
+	uint32_t hash = sampleHash;
+	uint32_t n;
+
+	while (1)
+	{
+		xQueueReceive(sampleQueue, &sample, portMAX_DELAY);
+		words[0] = sample.timeUs;
+		words[1] = xTaskGetTickCount();
+		memcpy(&words[2], &sample.position, sizeof(float));
+		memcpy(&words[3], &sample.command, sizeof(float));
+		for (n = 0; n < sizeof(words); ++n)
+			hash = (hash ^ bytes[n]) * 16777619u;
+		sampleHash = hash;
+		++samplesLogged;
+	}
+}
+
+/**
+ * Steps the ticks one at a time and checks the result
+ */
+static void *simulatorThread(void *arg)
+{
+	struct timeval timeout = { 0, 100000 };
+	uint64_t wallStart;
+	uint64_t wallUs;
+	uint32_t startTick;
+	uint32_t tick;
+	uint32_t n;
+	int failed;
+	int sock;
+
+	sock = socket(AF_INET, SOCK_DGRAM, 0);
+	setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+	// Poll until the port serves requests
+	while ((startTick = step(sock, 0)) == 0xFFFFFFFF)
+		;
+
+	wallStart = wallTimeUs();
+	for (n = 0, tick = startTick; n < SIM_TICKS; ++n)
+		tick = step(sock, 1);
+	wallUs = wallTimeUs() - wallStart;
+
+	failed = (tick != startTick + SIM_TICKS)
+			|| (controlRuns != tick / CONTROL_PERIOD_MS)
+			|| (busyRuns != tick / BUSY_PERIOD_MS)
+			|| (samplesLogged != controlRuns)
+			|| (timeErrors != 0)
+			|| (PIOS_DELAY_GetuS() != tick * portTICK_RATE_MICROSECONDS);
+
+	printf("ticks %u, control %u, busy %u, logged %u, time errors %u\n", (unsigned int)tick,
+			(unsigned int)controlRuns, (unsigned int)busyRuns, (unsigned int)samplesLogged, (unsigned int)timeErrors);
+	printf("%u ms simulated in %.1f ms, %.1fx real time, %.1f us per tick\n", (unsigned int)SIM_TICKS,
+			wallUs / 1000.0f, SIM_TICKS * 1000.0f / wallUs, (float)wallUs / SIM_TICKS);
+	printf("sample hash %08x (must be the same on every run)\n", (unsigned int)sampleHash);
+	printf("lockstep: %s\n", failed ? "FAILED" : "passed");
+
+	exit(failed ? 1 : 0);
+	return NULL;
+}
+
+/**
+ * Advance the given number of ticks, returns the tick count reached or
+ * 0xFFFFFFFF if the port did not answer
+ */
+static uint32_t step(int sock, uint32_t ticks)
+{
+	struct sockaddr_in addr;
+	uint32_t reply;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sin_family = AF_INET;
+	addr.sin_port = htons(configLOCKSTEP_PORT);
+	addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+	sendto(sock, &ticks, sizeof(ticks), 0, (struct sockaddr *)&addr, sizeof(addr));
+	if (recv(sock, &reply, sizeof(reply), 0) != sizeof(reply))
+		return 0xFFFFFFFF;
+	return reply;
+}
+
+/**
+ * Host wall clock in us
+ */
+static uint64_t wallTimeUs()
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
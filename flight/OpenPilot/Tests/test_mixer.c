@@ -0,0 +1,266 @@
+/**
+ ******************************************************************************
+ *
+ * @file       test_mixer.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2011.
+ * @brief      SITL test of the compiled mixer of the actuator module
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/**
+ * Mixes random MixerSettings and inputs once with the per channel code the
+ * actuator module used before (copied below) and once with the compiled
+ * mixer matrix and curves, and checks that the outputs are identical. The
+ * settings cover every mixer type, pass through and clamped curves and
+ * configurations with too few mixers, where the module goes to failsafe.
+ * Build and run with:
+ *   make -f Makefile.posix TESTAPP=test_mixer
+ */
+
+#include "openpilot.h"
+#include "mixersettings.h"
+#include "mixer.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Local constants
+#define NUM_SETTINGS 20000
+#define NUM_INPUTS_PER_SETTINGS 20
+#define NUM_MIXER_TYPES (MIXERSETTINGS_MIXER1TYPE_ACCESSORY5 + 1)
+
+// Local types
+typedef struct {
+	float throttle;
+	float curve2Input;
+	float roll;
+	float pitch;
+	float yaw;
+} Inputs;
+
+// Local functions
+static void testTask(void *pvParameters);
+static int32_t checkMixer();
+static void randomSettings(MixerSettingsData *settings);
+static void randomInputs(Inputs *in);
+static float randomFloat(float min, float max);
+static float perChannelMix(const Mixer_t *mixer, float curve1, float curve2, const Inputs *in);
+static float perChannelCurve(const float throttle, const float *curve);
+
+// Variables
+static const float edgeThrottles[] = { -0.5f, -0.01f, 0.0f, 0.2f, 0.4f, 0.6f, 0.8f, 0.99f, 1.0f, 1.2f };
+
+int main()
+{
+	PIOS_SYS_Init();
+
+	// Create test task
+	xTaskCreate(testTask, (signed portCHAR *)"Test", 1000 , NULL, 1, NULL);
+
+	// Start the FreeRTOS scheduler
+	vTaskStartScheduler();
+	return 0;
+}
+
+void vApplicationIdleHook(void)
+{
+	/* Called when the scheduler has no tasks to run */
+}
+
+static void testTask(void *pvParameters)
+{
+	int32_t failed;
+
+	srand(1);
+	failed = checkMixer();
+	printf("compiled mixer: %s\n", failed ? "FAILED" : "passed");
+
+	exit(failed ? 1 : 0);
+}
+
+/**
+ * Compare the per channel mixer with the compiled one
+ * \return 0 if success or -1 if failure
+ */
+static int32_t checkMixer()
+{
+	static MixerSettingsData settings;
+	CompiledMixer_t compiled;
+	const Mixer_t *mixers = (const Mixer_t *)&settings.Mixer1Type;
+	float input[MIXER_NUM_INPUTS];
+	float mixed[MAX_MIX_ACTUATORS];
+	float curve1Points[MIXERSETTINGS_THROTTLECURVE1_NUMELEM];
+	float curve2Points[MIXERSETTINGS_THROTTLECURVE2_NUMELEM];
+	float curve1;
+	float curve2;
+	uint32_t mismatches = 0;
+	uint32_t failsafes = 0;
+	uint32_t passThroughs = 0;
+	Inputs in;
+
+	for (int n = 0; n < NUM_SETTINGS; ++n)
+	{
+		randomSettings(&settings);
+		if (settings.ThrottleCurve1[0] < -1)
+			++passThroughs;
+		compileMixer(&settings, &compiled);
+		memcpy(curve1Points, settings.ThrottleCurve1, sizeof(curve1Points));
+		memcpy(curve2Points, settings.ThrottleCurve2, sizeof(curve2Points));
+
+		// The module goes to failsafe below two mixers, whatever their type
+		int nMixers = 0;
+		for (int ct = 0; ct < MAX_MIX_ACTUATORS; ++ct)
+			if (mixers[ct].type != MIXERSETTINGS_MIXER1TYPE_DISABLED)
+				++nMixers;
+		if (compiled.nMixers != nMixers)
+			++mismatches;
+		if (nMixers < 2)
+		{
+			++failsafes;
+			continue;
+		}
+
+		for (int k = 0; k < NUM_INPUTS_PER_SETTINGS; ++k)
+		{
+			randomInputs(&in);
+			if (k < sizeof(edgeThrottles) / sizeof(edgeThrottles[0]))
+				in.throttle = in.curve2Input = edgeThrottles[k];
+
+			curve1 = perChannelCurve(in.throttle, curve1Points);
+			curve2 = perChannelCurve(in.curve2Input, curve2Points);
+			if (MixerCurve(in.throttle, &compiled.curve1) != curve1 ||
+			    MixerCurve(in.curve2Input, &compiled.curve2) != curve2)
+				++mismatches;
+
+			input[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE1] = curve1;
+			input[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE2] = curve2;
+			input[MIXERSETTINGS_MIXER1VECTOR_ROLL] = in.roll;
+			input[MIXERSETTINGS_MIXER1VECTOR_PITCH] = in.pitch;
+			input[MIXERSETTINGS_MIXER1VECTOR_YAW] = in.yaw;
+			MixerMatrixMultiply(compiled.matrix, input, mixed);
+
+			// Only motors and servos are mixed, the other rows must be zero
+			for (int ct = 0; ct < MAX_MIX_ACTUATORS; ++ct)
+			{
+				if ((mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_MOTOR) || (mixers[ct].type == MIXERSETTINGS_MIXER1TYPE_SERVO))
+				{
+					if (mixed[ct] != perChannelMix(&mixers[ct], curve1, curve2, &in))
+						++mismatches;
+				}
+				else if (mixed[ct] != 0)
+					++mismatches;
+			}
+		}
+	}
+
+	printf("%u settings, %u pass through curves, %u in failsafe, %u mismatches\n", (unsigned int)NUM_SETTINGS,
+	       (unsigned int)passThroughs, (unsigned int)failsafes, (unsigned int)mismatches);
+
+	if (failsafes == 0 || failsafes == NUM_SETTINGS || passThroughs == 0)
+		return -1;
+	return mismatches == 0 ? 0 : -1;
+}
+
+/**
+ * Random mixer types and vectors, a random share of them disabled, and
+ * random curves, sometimes pass through
+ */
+static void randomSettings(MixerSettingsData *settings)
+{
+	Mixer_t *mixers = (Mixer_t *)&settings->Mixer1Type;
+	int disabledPercent = rand() % 101;
+
+	memset(settings, 0, sizeof(MixerSettingsData));
+	for (int ct = 0; ct < MAX_MIX_ACTUATORS; ++ct)
+	{
+		if (rand() % 100 < disabledPercent)
+			mixers[ct].type = MIXERSETTINGS_MIXER1TYPE_DISABLED;
+		else
+			mixers[ct].type = 1 + rand() % (NUM_MIXER_TYPES - 1);
+		for (int in = 0; in < MIXER_NUM_INPUTS; ++in)
+			mixers[ct].matrix[in] = (int8_t)(rand() % 256 - 128);
+	}
+	for (int n = 0; n < MIXER_CURVE_ENTRIES; ++n)
+	{
+		settings->ThrottleCurve1[n] = randomFloat(-0.2f, 1.2f);
+		settings->ThrottleCurve2[n] = randomFloat(-1.0f, 1.0f);
+	}
+	if (rand() % 8 == 0)
+		settings->ThrottleCurve1[0] = -2;
+	if (rand() % 8 == 0)
+		settings->ThrottleCurve2[0] = -1.5f;
+}
+
+/**
+ * Random inputs, the throttle also out of its 0 to 1 range
+ */
+static void randomInputs(Inputs *in)
+{
+	in->throttle = randomFloat(-0.2f, 1.2f);
+	in->curve2Input = randomFloat(-1.2f, 1.2f);
+	in->roll = randomFloat(-1.0f, 1.0f);
+	in->pitch = randomFloat(-1.0f, 1.0f);
+	in->yaw = randomFloat(-1.0f, 1.0f);
+}
+
+static float randomFloat(float min, float max)
+{
+	return min + (max - min) * (float)rand() / (float)RAND_MAX;
+}
+
+/**
+ * The mix of one channel as ProcessMixer() of the actuator module did it
+ * before the mixer was compiled, without the motor filters
+ */
+static float perChannelMix(const Mixer_t *mixer, float curve1, float curve2, const Inputs *in)
+{
+	return ((mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE1] / 128.0f) * curve1) +
+	((mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_THROTTLECURVE2] / 128.0f) * curve2) +
+	((mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_ROLL] / 128.0f) * in->roll) +
+	((mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_PITCH] / 128.0f) * in->pitch) +
+	((mixer->matrix[MIXERSETTINGS_MIXER1VECTOR_YAW] / 128.0f) * in->yaw);
+}
+
+/**
+ * MixerCurve() of the actuator module before the curves were compiled
+ */
+static float perChannelCurve(const float throttle, const float *curve)
+{
+	float scale = throttle * MIXER_CURVE_ENTRIES;
+	int idx1 = scale;
+	scale -= (float)idx1; //remainder
+	if(curve[0] < -1)
+	{
+		return(throttle);
+	}
+	if (idx1 < 0)
+	{
+		idx1 = 0; //clamp to lowest entry in table
+		scale = 0;
+	}
+	int idx2 = idx1 + 1;
+	if(idx2 >= MIXER_CURVE_ENTRIES)
+	{
+		idx2 = MIXER_CURVE_ENTRIES -1; //clamp to highest entry in table
+		if(idx1 >= MIXER_CURVE_ENTRIES)
+		{
+			idx1 = MIXER_CURVE_ENTRIES -1;
+		}
+	}
+	return((curve[idx1] * (1 - scale)) + (curve[idx2] * scale));
+}
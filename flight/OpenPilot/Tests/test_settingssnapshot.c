@@ -0,0 +1,186 @@
+/**
+ ******************************************************************************
+ *
+ * @file       test_settingssnapshot.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2011.
+ * @brief      SITL benchmark of the settings snapshots used by the control loops
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/**
+ * Reads the settings the actuator task needs on every cycle, once with the
+ * getters it used before (a copy of MixerSettings and four ActuatorSettings
+ * fields) and once through snapshots, and reports the time saved per cycle.
+ * Also checks that a snapshot is refreshed after a set, and only then.
+ * Build and run with:
+ *   make -f Makefile.posix TESTAPP=test_settingssnapshot
+ */
+
+#include "openpilot.h"
+#include "mixersettings.h"
+#include "actuatorsettings.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+// Local constants
+#define NUM_CYCLES 200000
+#define NUM_CHANNELS ACTUATORSETTINGS_CHANNELMAX_NUMELEM
+
+// Local functions
+static void testTask(void *pvParameters);
+static float benchmarkGetters();
+static float benchmarkSnapshots();
+static int32_t checkRefresh();
+
+// Variables
+static UAVObjHandle mixerObj;
+static UAVObjHandle actuatorObj;
+static volatile int32_t sink;
+
+int main()
+{
+	PIOS_SYS_Init();
+	UAVObjInitialize();
+	EventDispatcherInitialize();
+
+	// Create test task
+	xTaskCreate(testTask, (signed portCHAR *)"Test", 1000 , NULL, 1, NULL);
+
+	// Start the FreeRTOS scheduler
+	vTaskStartScheduler();
+	return 0;
+}
+
+void vApplicationIdleHook(void)
+{
+	/* Called when the scheduler has no tasks to run */
+}
+
+static void testTask(void *pvParameters)
+{
+	float getters;
+	float snapshots;
+	int32_t failed;
+
+	// Same sizes as the real settings, the IDs do not matter here
+	mixerObj = UAVObjRegister(0x5000, "BenchMixerSettings", "BenchMixerSettingsMeta", 0, 1, 1, sizeof(MixerSettingsData), NULL);
+	actuatorObj = UAVObjRegister(0x5100, "BenchActuatorSettings", "BenchActuatorSettingsMeta", 0, 1, 1, sizeof(ActuatorSettingsData), NULL);
+
+	getters = benchmarkGetters();
+	snapshots = benchmarkSnapshots();
+	printf("settings read per cycle: getters %.1f ns, snapshots %.1f ns, saved %.1f ns\n",
+	       getters, snapshots, getters - snapshots);
+
+	failed = checkRefresh();
+	printf("snapshot refresh: %s\n", failed ? "FAILED" : "passed");
+
+	exit(failed ? 1 : 0);
+}
+
+/**
+ * Average time in ns to read the settings with the getters
+ */
+static float benchmarkGetters()
+{
+	MixerSettingsData mixerSettings;
+	uint8_t motorsSpinWhileArmed;
+	int16_t channelMax[NUM_CHANNELS];
+	int16_t channelMin[NUM_CHANNELS];
+	int16_t channelNeutral[NUM_CHANNELS];
+	uint32_t n;
+	uint32_t start;
+	uint32_t elapsed;
+
+	start = PIOS_DELAY_GetuS();
+	for (n = 0; n < NUM_CYCLES; ++n)
+	{
+		UAVObjGetData(mixerObj, &mixerSettings);
+		UAVObjGetDataField(actuatorObj, &motorsSpinWhileArmed, offsetof(ActuatorSettingsData, MotorsSpinWhileArmed), sizeof(motorsSpinWhileArmed));
+		UAVObjGetDataField(actuatorObj, channelMax, offsetof(ActuatorSettingsData, ChannelMax), sizeof(channelMax));
+		UAVObjGetDataField(actuatorObj, channelMin, offsetof(ActuatorSettingsData, ChannelMin), sizeof(channelMin));
+		UAVObjGetDataField(actuatorObj, channelNeutral, offsetof(ActuatorSettingsData, ChannelNeutral), sizeof(channelNeutral));
+		sink += mixerSettings.Mixer1Type + motorsSpinWhileArmed + channelMax[n % NUM_CHANNELS] +
+			channelMin[n % NUM_CHANNELS] + channelNeutral[n % NUM_CHANNELS];
+	}
+	elapsed = PIOS_DELAY_GetuSSince(start);
+
+	return (float)elapsed * 1000.0f / (float)NUM_CYCLES;
+}
+
+/**
+ * Average time in ns to read the same settings through snapshots
+ */
+static float benchmarkSnapshots()
+{
+	static MixerSettingsData mixerSettings;
+	static ActuatorSettingsData actuatorSettings;
+	UAVObjSnapshot mixerSnapshot;
+	UAVObjSnapshot actuatorSnapshot;
+	uint32_t n;
+	uint32_t start;
+	uint32_t elapsed;
+
+	UAVObjSnapshotInit(mixerObj, &mixerSnapshot, &mixerSettings);
+	UAVObjSnapshotInit(actuatorObj, &actuatorSnapshot, &actuatorSettings);
+
+	start = PIOS_DELAY_GetuS();
+	for (n = 0; n < NUM_CYCLES; ++n)
+	{
+		UAVObjSnapshotUpdate(&mixerSnapshot);
+		UAVObjSnapshotUpdate(&actuatorSnapshot);
+		sink += mixerSettings.Mixer1Type + actuatorSettings.MotorsSpinWhileArmed + actuatorSettings.ChannelMax[n % NUM_CHANNELS] +
+			actuatorSettings.ChannelMin[n % NUM_CHANNELS] + actuatorSettings.ChannelNeutral[n % NUM_CHANNELS];
+	}
+	elapsed = PIOS_DELAY_GetuSSince(start);
+
+	return (float)elapsed * 1000.0f / (float)NUM_CYCLES;
+}
+
+/**
+ * Check that a snapshot is copied again after a set, and not before
+ * \return 0 if success or -1 if failure
+ */
+static int32_t checkRefresh()
+{
+	static ActuatorSettingsData settings;
+	static ActuatorSettingsData snapshotData;
+	UAVObjSnapshot snapshot;
+	uint32_t version;
+
+	memset(&settings, 0, sizeof(settings));
+	UAVObjSetData(actuatorObj, &settings);
+	UAVObjSnapshotInit(actuatorObj, &snapshot, &snapshotData);
+	version = snapshot.version;
+	if (version == 0 || UAVObjSnapshotUpdate(&snapshot) != 0 || snapshot.version != version)
+		return -1;
+
+	settings.ChannelMax[3] = 2000;
+	UAVObjSetData(actuatorObj, &settings);
+	if (snapshotData.ChannelMax[3] != 0)
+		return -1;
+	if (UAVObjSnapshotUpdate(&snapshot) != 1 || snapshot.version != version + 1)
+		return -1;
+	if (memcmp(&snapshotData, &settings, sizeof(settings)) != 0)
+		return -1;
+	if (UAVObjSnapshotUpdate(&snapshot) != 0)
+		return -1;
+
+	return 0;
+}
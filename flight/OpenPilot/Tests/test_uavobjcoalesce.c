@@ -0,0 +1,178 @@
+/**
+ ******************************************************************************
+ *
+ * @file       test_uavobjcoalesce.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2011.
+ * @brief      SITL test for the coalescing UAVObject event queues
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/**
+ * Floods a small queue with updates of a fast object (like AttitudeActual) and of the
+ * interleaved instances of a multi instance object while a slow object is updated once.
+ * With a plain queue the later updates are lost, with a coalescing queue every object
+ * and instance must be received, with its latest data, and each burst must take a
+ * single slot.
+ * Build and run with:
+ *   make -f Makefile.posix TESTAPP=test_uavobjcoalesce
+ */
+
+#include "openpilot.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Local constants
+#define QUEUE_SIZE 5
+#define BURST_LENGTH 50
+#define NUM_INSTANCES 3
+
+// Local functions
+static void testTask(void *pvParameters);
+static int32_t runBurst(uint8_t coalesce);
+
+// Variables
+static UAVObjHandle fastObj;
+static UAVObjHandle slowObj;
+static UAVObjHandle multiObj;
+
+int main()
+{
+	PIOS_SYS_Init();
+	UAVObjInitialize();
+	EventDispatcherInitialize();
+
+	// Create test task
+	xTaskCreate(testTask, (signed portCHAR *)"Test", 1000 , NULL, 1, NULL);
+
+	// Start the FreeRTOS scheduler
+	vTaskStartScheduler();
+	return 0;
+}
+
+void vApplicationIdleHook(void)
+{
+	/* Called when the scheduler has no tasks to run */
+}
+
+static void testTask(void *pvParameters)
+{
+	xQueueHandle queue;
+	xQueueHandle other;
+	int32_t failed;
+
+	fastObj = UAVObjRegister(0x4000, "CoalesceFast", "CoalesceFastMeta", 0, 1, 0, sizeof(uint32_t), NULL);
+	slowObj = UAVObjRegister(0x4100, "CoalesceSlow", "CoalesceSlowMeta", 0, 1, 0, sizeof(uint32_t), NULL);
+	multiObj = UAVObjRegister(0x4200, "CoalesceMulti", "CoalesceMultiMeta", 0, 0, 0, sizeof(uint32_t), NULL);
+	UAVObjCreateInstance(multiObj, NULL);
+	UAVObjCreateInstance(multiObj, NULL);
+
+	printf("plain queue:\n");
+	runBurst(0);
+	printf("coalescing queue:\n");
+	failed = runBurst(1);
+
+	// The pending events are kept with the object, a second coalescing queue is refused
+	queue = xQueueCreate(QUEUE_SIZE, sizeof(UAVObjEvent));
+	other = xQueueCreate(QUEUE_SIZE, sizeof(UAVObjEvent));
+	if (UAVObjConnectQueueCoalesced(multiObj, queue, EV_MASK_ALL_UPDATES) != 0 ||
+			UAVObjConnectQueueCoalesced(multiObj, other, EV_MASK_ALL_UPDATES) == 0) {
+		printf("second coalescing queue not refused\n");
+		failed = 1;
+	}
+	UAVObjDisconnectQueue(multiObj, queue);
+
+	exit(failed);
+}
+
+/**
+ * Send the burst then drain the queue like the telemetry task does
+ * \return 0 if all objects were received with their latest data and no event was lost
+ */
+static int32_t runBurst(uint8_t coalesce)
+{
+	xQueueHandle queue = xQueueCreate(QUEUE_SIZE, sizeof(UAVObjEvent));
+	UAVObjStats stats;
+	UAVObjEvent ev;
+	uint32_t value;
+	uint32_t received[3] = { 0, 0, 0 };
+	uint32_t latest[3] = { 0, 0, 0 };
+	uint32_t multiReceived[NUM_INSTANCES];
+	uint32_t multiLatest[NUM_INSTANCES];
+	uint32_t k;
+	uint16_t n;
+	int32_t failed;
+
+	memset(multiReceived, 0, sizeof(multiReceived));
+	memset(multiLatest, 0, sizeof(multiLatest));
+
+	if (coalesce) {
+		UAVObjConnectQueueCoalesced(fastObj, queue, EV_MASK_ALL_UPDATES);
+		UAVObjConnectQueueCoalesced(slowObj, queue, EV_MASK_ALL_UPDATES);
+		UAVObjConnectQueueCoalesced(multiObj, queue, EV_MASK_ALL_UPDATES);
+	} else {
+		UAVObjConnectQueue(fastObj, queue, EV_MASK_ALL_UPDATES);
+		UAVObjConnectQueue(slowObj, queue, EV_MASK_ALL_UPDATES);
+		UAVObjConnectQueue(multiObj, queue, EV_MASK_ALL_UPDATES);
+	}
+	UAVObjClearStats();
+
+	for (value = 1; value <= BURST_LENGTH; ++value)
+		UAVObjSetData(fastObj, &value);
+	value = 1000;
+	UAVObjSetData(slowObj, &value);
+	for (k = 1; k <= BURST_LENGTH; ++k) {
+		for (n = 0; n < NUM_INSTANCES; ++n) {
+			value = 1000 * (n + 2) + k;
+			UAVObjSetInstanceData(multiObj, n, &value);
+		}
+	}
+
+	while (xQueueReceive(queue, &ev, 0) == pdTRUE) {
+		if (coalesce)
+			UAVObjClearPendingEvent(queue, &ev);
+		UAVObjGetInstanceData(ev.obj, ev.instId, &value);
+		n = (ev.obj == fastObj ? 0 : (ev.obj == slowObj ? 1 : 2));
+		++received[n];
+		latest[n] = value;
+		if (n == 2) {
+			++multiReceived[ev.instId];
+			multiLatest[ev.instId] = value;
+		}
+	}
+	UAVObjGetStats(&stats);
+
+	printf("  fast %u events (last %u), slow %u, multi %u, %u lost, %u coalesced\n",
+			(unsigned int)received[0], (unsigned int)latest[0], (unsigned int)received[1],
+			(unsigned int)received[2], (unsigned int)stats.eventErrors, (unsigned int)stats.eventsCoalesced);
+
+	UAVObjDisconnectQueue(fastObj, queue);
+	UAVObjDisconnectQueue(slowObj, queue);
+	UAVObjDisconnectQueue(multiObj, queue);
+	vQueueDelete(queue);
+
+	failed = (latest[0] == BURST_LENGTH && received[1] == 1 && stats.eventErrors == 0) ? 0 : 1;
+	for (n = 0; n < NUM_INSTANCES; ++n) {
+		printf("  multi instance %u: %u events (last %u)\n", (unsigned int)n,
+				(unsigned int)multiReceived[n], (unsigned int)multiLatest[n]);
+		if (multiReceived[n] != 1 || multiLatest[n] != 1000 * (n + 2) + BURST_LENGTH)
+			failed = 1;
+	}
+	return failed;
+}
@@ -0,0 +1,151 @@
+/**
+ ******************************************************************************
+ *
+ * @file       test_uavobjlookup.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2011.
+ * @brief      SITL benchmark for the UAVObject lookup by ID and by name
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/**
+ * Registers an increasing number of dummy objects and measures the average
+ * cost of UAVObjGetByID() and UAVObjGetByName(), as done by UAVTalk for
+ * every received packet. Build and run with:
+ *   make -f Makefile.posix TESTAPP=test_uavobjlookup
+ */
+
+#include "openpilot.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Local constants
+#define MAX_OBJECTS 96
+#define NUM_LOOKUPS 200000
+#define OBJECT_SIZE 32
+#define NAME_LENGTH 20
+
+// Local functions
+static void testTask(void *pvParameters);
+static void registerObjects(uint32_t numObjects);
+static float benchmarkByID(uint32_t numObjects);
+static float benchmarkByName(uint32_t numObjects);
+
+// Variables
+static uint32_t objIds[MAX_OBJECTS];
+static char objNames[MAX_OBJECTS][NAME_LENGTH];
+static char metaNames[MAX_OBJECTS][NAME_LENGTH];
+static uint32_t numRegistered = 0;
+
+int main()
+{
+	PIOS_SYS_Init();
+	UAVObjInitialize();
+	EventDispatcherInitialize();
+
+	// Create test task
+	xTaskCreate(testTask, (signed portCHAR *)"Test", 1000 , NULL, 1, NULL);
+
+	// Start the FreeRTOS scheduler
+	vTaskStartScheduler();
+	return 0;
+}
+
+static void testTask(void *pvParameters)
+{
+	static const uint32_t steps[] = { 4, 8, 16, 32, 48, 64, 96 };
+	uint32_t n;
+
+	printf("objects  byID[ns]  byName[ns]\n");
+	for (n = 0; n < sizeof(steps) / sizeof(steps[0]); ++n)
+	{
+		registerObjects(steps[n]);
+		printf("%7u  %8.1f  %10.1f\n", (unsigned int)steps[n], benchmarkByID(steps[n]), benchmarkByName(steps[n]));
+	}
+
+	exit(0);
+}
+
+void vApplicationIdleHook(void)
+{
+	/* Called when the scheduler has no tasks to run */
+}
+
+/**
+ * Register objects until numObjects are available, each one also registers its metaobject
+ */
+static void registerObjects(uint32_t numObjects)
+{
+	while (numRegistered < numObjects)
+	{
+		snprintf(objNames[numRegistered], NAME_LENGTH, "BenchObject%u", (unsigned int)numRegistered);
+		snprintf(metaNames[numRegistered], NAME_LENGTH, "BenchObject%uMeta", (unsigned int)numRegistered);
+		// Spread the IDs like the generator hashes do, LSB is reserved for the metaobject
+		objIds[numRegistered] = (0x9E3779B1 * (numRegistered + 1)) & 0xFFFFFFFE;
+		UAVObjRegister(objIds[numRegistered], objNames[numRegistered], metaNames[numRegistered], 0, 1, 0, OBJECT_SIZE, NULL);
+		++numRegistered;
+	}
+}
+
+/**
+ * Average time in ns of a lookup by ID, cycling through all registered objects
+ */
+static float benchmarkByID(uint32_t numObjects)
+{
+	uint32_t n;
+	uint32_t found = 0;
+	uint32_t start;
+	uint32_t elapsed;
+
+	start = PIOS_DELAY_GetuS();
+	for (n = 0; n < NUM_LOOKUPS; ++n)
+	{
+		if (UAVObjGetByID(objIds[n % numObjects]) != NULL)
+			++found;
+	}
+	elapsed = PIOS_DELAY_GetuSSince(start);
+
+	if (found != NUM_LOOKUPS)
+		printf("Lookup by ID failed (%u of %u found)\n", (unsigned int)found, NUM_LOOKUPS);
+
+	return (float)elapsed * 1000.0f / (float)NUM_LOOKUPS;
+}
+
+/**
+ * Average time in ns of a lookup by name, cycling through all registered objects
+ */
+static float benchmarkByName(uint32_t numObjects)
+{
+	uint32_t n;
+	uint32_t found = 0;
+	uint32_t start;
+	uint32_t elapsed;
+
+	start = PIOS_DELAY_GetuS();
+	for (n = 0; n < NUM_LOOKUPS; ++n)
+	{
+		if (UAVObjGetByName(objNames[n % numObjects]) != NULL)
+			++found;
+	}
+	elapsed = PIOS_DELAY_GetuSSince(start);
+
+	if (found != NUM_LOOKUPS)
+		printf("Lookup by name failed (%u of %u found)\n", (unsigned int)found, NUM_LOOKUPS);
+
+	return (float)elapsed * 1000.0f / (float)NUM_LOOKUPS;
+}
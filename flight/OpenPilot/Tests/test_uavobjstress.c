@@ -0,0 +1,264 @@
+/**
+ ******************************************************************************
+ *
+ * @file       test_uavobjstress.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2011.
+ * @brief      SITL stress test for concurrent UAVObject access
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/**
+ * Several writer tasks update a few objects at a high priority (like the
+ * Stabilization -> Actuator chain) while many low priority reader tasks read
+ * them continuously (like Telemetry). Writers always fill an object with one
+ * repeated value, so a reader seeing two different values got a torn copy.
+ * An event queue is connected to every object to load the event dispatch.
+ * The first writer also keeps adding instances to a multi-instance object
+ * while the readers copy its existing instances.
+ * Reports throughput, worst case call latency and torn reads. Build and run with:
+ *   make -f Makefile.posix TESTAPP=test_uavobjstress
+ */
+
+#include "openpilot.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Local constants
+#define NUM_OBJECTS 4
+#define NUM_WORDS 32
+#define NUM_WRITERS 4
+#define NUM_READERS 8
+#define NUM_LIST_INSTANCES 600
+#define WRITES_PER_PERIOD 16
+#define TEST_DURATION_MS 3000
+#define EVENT_QUEUE_SIZE 32
+#define STACK_SIZE 1000
+#define READER_PRIORITY 1
+#define WRITER_PRIORITY 2
+#define EVENT_PRIORITY 3
+#define MONITOR_PRIORITY 4
+
+// Local types
+typedef struct {
+	uint32_t ops;
+	uint64_t totalLatency;
+	uint32_t maxLatency;
+	uint32_t torn;
+} TaskStats;
+
+// Local functions
+static void monitorTask(void *pvParameters);
+static void writerTask(void *pvParameters);
+static void readerTask(void *pvParameters);
+static void eventTask(void *pvParameters);
+
+// Variables
+static UAVObjHandle objects[NUM_OBJECTS];
+static UAVObjHandle listObject;
+static char objNames[NUM_OBJECTS][20];
+static char metaNames[NUM_OBJECTS][20];
+static TaskStats writerStats[NUM_WRITERS];
+static TaskStats readerStats[NUM_READERS];
+static xQueueHandle eventQueue;
+static uint32_t numEvents;
+static volatile uint8_t running = 1;
+
+int main()
+{
+	PIOS_SYS_Init();
+	UAVObjInitialize();
+	EventDispatcherInitialize();
+
+	// Create monitor task, it creates the rest once the scheduler runs
+	xTaskCreate(monitorTask, (signed portCHAR *)"Monitor", STACK_SIZE, NULL, MONITOR_PRIORITY, NULL);
+
+	// Start the FreeRTOS scheduler
+	vTaskStartScheduler();
+	return 0;
+}
+
+void vApplicationIdleHook(void)
+{
+	/* Called when the scheduler has no tasks to run */
+}
+
+static void monitorTask(void *pvParameters)
+{
+	UAVObjStats objStats;
+	uint32_t writes = 0;
+	uint32_t reads = 0;
+	uint64_t writeTime = 0;
+	uint64_t readTime = 0;
+	uint32_t torn = 0;
+	uint32_t maxWrite = 0;
+	uint32_t maxRead = 0;
+	uint32_t n;
+
+	// Register objects and connect the event queue
+	eventQueue = xQueueCreate(EVENT_QUEUE_SIZE, sizeof(UAVObjEvent));
+	for (n = 0; n < NUM_OBJECTS; ++n)
+	{
+		snprintf(objNames[n], sizeof(objNames[n]), "StressObject%u", (unsigned int)n);
+		snprintf(metaNames[n], sizeof(metaNames[n]), "StressObject%uMeta", (unsigned int)n);
+		objects[n] = UAVObjRegister(0x5A5A0000 + 2 * n, objNames[n], metaNames[n], 0, 1, 0, NUM_WORDS * sizeof(uint32_t), NULL);
+		UAVObjConnectQueue(objects[n], eventQueue, EV_MASK_ALL_UPDATES);
+	}
+	listObject = UAVObjRegister(0x5A5A1000, "StressList", "StressListMeta", 0, 0, 0, NUM_WORDS * sizeof(uint32_t), NULL);
+	UAVObjClearStats();
+
+	// Start the load
+	xTaskCreate(eventTask, (signed portCHAR *)"Events", STACK_SIZE, NULL, EVENT_PRIORITY, NULL);
+	for (n = 0; n < NUM_WRITERS; ++n)
+		xTaskCreate(writerTask, (signed portCHAR *)"Writer", STACK_SIZE, &writerStats[n], WRITER_PRIORITY, NULL);
+	for (n = 0; n < NUM_READERS; ++n)
+		xTaskCreate(readerTask, (signed portCHAR *)"Reader", STACK_SIZE, &readerStats[n], READER_PRIORITY, NULL);
+
+	vTaskDelay(TEST_DURATION_MS / portTICK_RATE_MS);
+	running = 0;
+
+	// Collect results
+	for (n = 0; n < NUM_WRITERS; ++n)
+	{
+		writes += writerStats[n].ops;
+		writeTime += writerStats[n].totalLatency;
+		if (writerStats[n].maxLatency > maxWrite)
+			maxWrite = writerStats[n].maxLatency;
+	}
+	for (n = 0; n < NUM_READERS; ++n)
+	{
+		reads += readerStats[n].ops;
+		readTime += readerStats[n].totalLatency;
+		torn += readerStats[n].torn;
+		if (readerStats[n].maxLatency > maxRead)
+			maxRead = readerStats[n].maxLatency;
+	}
+	UAVObjGetStats(&objStats);
+
+	printf("writers %u, readers %u, objects %u of %u bytes, %u ms\n", NUM_WRITERS, NUM_READERS, NUM_OBJECTS,
+			(unsigned int)(NUM_WORDS * sizeof(uint32_t)), TEST_DURATION_MS);
+	printf("writes/s %10.0f  avg write latency %8.3f us  max %6u us\n", (float)writes * 1000.0f / TEST_DURATION_MS,
+			(float)writeTime / (float)writes, (unsigned int)maxWrite);
+	printf("reads/s  %10.0f  avg read latency  %8.3f us  max %6u us\n", (float)reads * 1000.0f / TEST_DURATION_MS,
+			(float)readTime / (float)reads, (unsigned int)maxRead);
+	printf("events received %u, event errors %u\n", (unsigned int)numEvents, (unsigned int)objStats.eventErrors);
+	printf("list instances %u\n", (unsigned int)UAVObjGetNumInstances(listObject));
+	printf("torn reads %u\n", (unsigned int)torn);
+
+	exit(torn == 0 ? 0 : 1);
+}
+
+/**
+ * Fill the objects with a value unique to this writer and iteration, sleep one tick every
+ * WRITES_PER_PERIOD writes so the lower priority readers get to run in between
+ */
+static void writerTask(void *pvParameters)
+{
+	TaskStats *stats = (TaskStats *)pvParameters;
+	uint32_t id = stats - writerStats;
+	uint32_t data[NUM_WORDS];
+	uint32_t start;
+	uint32_t elapsed;
+	uint32_t n;
+
+	while (running)
+	{
+		for (n = 0; n < NUM_WORDS; ++n)
+			data[n] = (id << 24) | (stats->ops & 0x00FFFFFF);
+
+		start = PIOS_DELAY_GetuS();
+		// Alternate between the whole object and the field accessors
+		if (stats->ops & 1)
+			UAVObjSetData(objects[stats->ops % NUM_OBJECTS], data);
+		else
+			UAVObjSetDataField(objects[stats->ops % NUM_OBJECTS], data, 0, sizeof(data));
+		elapsed = PIOS_DELAY_GetuSSince(start);
+
+		// Grow the list, the new instance is filled with a single value too
+		if (id == 0 && (stats->ops % WRITES_PER_PERIOD) == 0 && UAVObjGetNumInstances(listObject) < NUM_LIST_INSTANCES)
+			UAVObjSetInstanceData(listObject, UAVObjCreateInstance(listObject, NULL), data);
+
+		stats->totalLatency += elapsed;
+		if (elapsed > stats->maxLatency)
+			stats->maxLatency = elapsed;
+		if ((++stats->ops % WRITES_PER_PERIOD) == 0)
+			vTaskDelay(1);
+	}
+	vTaskSuspend(NULL);
+}
+
+/**
+ * Read the objects as fast as possible and check that all words of a copy match
+ */
+static void readerTask(void *pvParameters)
+{
+	TaskStats *stats = (TaskStats *)pvParameters;
+	uint32_t data[NUM_WORDS];
+	uint32_t start;
+	uint32_t elapsed;
+	uint32_t n;
+
+	while (running)
+	{
+		start = PIOS_DELAY_GetuS();
+		if (stats->ops & 1)
+			UAVObjGetData(objects[stats->ops % NUM_OBJECTS], data);
+		else
+			UAVObjGetDataField(objects[stats->ops % NUM_OBJECTS], data, 0, sizeof(data));
+		elapsed = PIOS_DELAY_GetuSSince(start);
+
+		stats->totalLatency += elapsed;
+		if (elapsed > stats->maxLatency)
+			stats->maxLatency = elapsed;
+		for (n = 1; n < NUM_WORDS; ++n)
+		{
+			if (data[n] != data[0])
+			{
+				++stats->torn;
+				break;
+			}
+		}
+
+		// Read the instances of the list, which may grow during the copy
+		UAVObjGetInstanceData(listObject, stats->ops % UAVObjGetNumInstances(listObject), data);
+		for (n = 1; n < NUM_WORDS; ++n)
+		{
+			if (data[n] != data[0])
+			{
+				++stats->torn;
+				break;
+			}
+		}
+		++stats->ops;
+	}
+	vTaskSuspend(NULL);
+}
+
+/**
+ * Drain the event queue
+ */
+static void eventTask(void *pvParameters)
+{
+	UAVObjEvent ev;
+
+	while (1)
+	{
+		if (xQueueReceive(eventQueue, &ev, portMAX_DELAY) == pdTRUE)
+			++numEvents;
+	}
+}
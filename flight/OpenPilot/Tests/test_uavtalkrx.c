@@ -0,0 +1,201 @@
+/**
+ ******************************************************************************
+ *
+ * @file       test_uavtalkrx.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2011.
+ * @brief      SITL test and benchmark for the UAVTalk receive path
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/**
+ * Records a telemetry stream (packets of a few objects mixed with garbage and
+ * corrupted bytes), then feeds it to UAVTalkProcessInputStream() one byte at a
+ * time and to UAVTalkProcessInputBuffer() in chunks of several sizes. All the
+ * runs must end with the same statistics, the time taken by each and the number
+ * of payload bytes copied per received packet are reported.
+ * Build and run with:
+ *   make -f Makefile.posix TESTAPP=test_uavtalkrx
+ */
+
+#include "openpilot.h"
+#include "uavtalk.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+// Local constants
+#define NUM_PACKETS 4000
+#define STREAM_SIZE (NUM_PACKETS * 120)
+#define NUM_REPEATS 20
+
+// Local functions
+static void testTask(void *pvParameters);
+static int32_t recordStream(uint8_t *data, int32_t length);
+static void buildStream(void);
+static uint32_t runStream(uint32_t chunkSize, UAVTalkStats *stats);
+
+// Variables
+static UAVObjHandle objects[3];
+static uint8_t stream[STREAM_SIZE];
+static uint32_t streamLength = 0;
+
+int main()
+{
+	PIOS_SYS_Init();
+	UAVObjInitialize();
+	EventDispatcherInitialize();
+
+	// Create test task
+	xTaskCreate(testTask, (signed portCHAR *)"Test", 1000 , NULL, 1, NULL);
+
+	// Start the FreeRTOS scheduler
+	vTaskStartScheduler();
+	return 0;
+}
+
+void vApplicationIdleHook(void)
+{
+	/* Called when the scheduler has no tasks to run */
+}
+
+static void testTask(void *pvParameters)
+{
+	static const uint32_t chunks[] = { 1, 7, 16, 64, 256 };
+	UAVTalkStats ref;
+	UAVTalkStats stats;
+	uint32_t elapsed;
+	uint32_t n;
+	int32_t failed = 0;
+
+	// Single instance, multi instance and a tiny object
+	objects[0] = UAVObjRegister(0x1000, "RxTestSingle", "RxTestSingleMeta", 0, 1, 0, 40, NULL);
+	objects[1] = UAVObjRegister(0x2000, "RxTestMulti", "RxTestMultiMeta", 0, 0, 0, 100, NULL);
+	objects[2] = UAVObjRegister(0x3000, "RxTestTiny", "RxTestTinyMeta", 0, 1, 0, 4, NULL);
+	buildStream();
+
+	elapsed = runStream(0, &ref);
+	printf("stream %u bytes, %u objects, %u errors\n", (unsigned int)streamLength,
+			(unsigned int)ref.rxObjects, (unsigned int)ref.rxErrors);
+	printf("per byte          %8.2f ns/byte %8.2f copied bytes/packet\n",
+			(float)elapsed * 1000.0f / (float)(streamLength * NUM_REPEATS),
+			(float)ref.rxCopiedBytes / (float)ref.rxObjects);
+	ref.rxCopiedBytes = 0;
+
+	for (n = 0; n < sizeof(chunks) / sizeof(chunks[0]); ++n)
+	{
+		elapsed = runStream(chunks[n], &stats);
+		printf("buffer, chunk %3u %8.2f ns/byte %8.2f copied bytes/packet\n", (unsigned int)chunks[n],
+				(float)elapsed * 1000.0f / (float)(streamLength * NUM_REPEATS),
+				(float)stats.rxCopiedBytes / (float)stats.rxObjects);
+		// Only the copies depend on how the stream is split
+		stats.rxCopiedBytes = 0;
+		if (memcmp(&ref, &stats, sizeof(UAVTalkStats)) != 0)
+		{
+			printf("  statistics mismatch: %u bytes %u objects %u object bytes %u errors\n",
+					(unsigned int)stats.rxBytes, (unsigned int)stats.rxObjects,
+					(unsigned int)stats.rxObjectBytes, (unsigned int)stats.rxErrors);
+			failed = 1;
+		}
+	}
+
+	exit(failed);
+}
+
+/**
+ * Output stream of the sending connection, appends to the recorded stream
+ */
+static int32_t recordStream(uint8_t *data, int32_t length)
+{
+	if (streamLength + length <= STREAM_SIZE)
+	{
+		memcpy(&stream[streamLength], data, length);
+		streamLength += length;
+	}
+	return length;
+}
+
+/**
+ * Record packets of random objects, with garbage (including stray sync bytes)
+ * between some of them and some corrupted bytes
+ */
+static void buildStream(void)
+{
+	UAVTalkConnection tx = UAVTalkInitialize(&recordStream, 256);
+	uint8_t data[100];
+	uint32_t n;
+	uint32_t k;
+	uint32_t obj;
+
+	srand(1);
+	for (n = 0; n < NUM_PACKETS; ++n)
+	{
+		obj = rand() % 3;
+		for (k = 0; k < sizeof(data); ++k)
+			data[k] = rand();
+		UAVObjSetInstanceData(objects[obj], 0, data);
+		UAVTalkSendObject(tx, objects[obj], 0, 0, 0);
+
+		if (rand() % 8 == 0)
+		{
+			// Garbage, sometimes starting with a sync byte
+			k = rand() % 20;
+			while (k-- > 0 && streamLength < STREAM_SIZE)
+				stream[streamLength++] = (rand() % 4 == 0 ? 0x3C : rand());
+		}
+		if (rand() % 16 == 0 && streamLength > 0)
+		{
+			// Corrupt a byte of the last packet
+			stream[streamLength - 1 - rand() % 8] ^= 0x55;
+		}
+	}
+}
+
+/**
+ * Feed the stream to a new connection NUM_REPEATS times, byte by byte when chunkSize
+ * is zero, return the time taken in us and the statistics of the connection
+ */
+static uint32_t runStream(uint32_t chunkSize, UAVTalkStats *stats)
+{
+	UAVTalkConnection rx = UAVTalkInitialize(NULL, 256);
+	uint32_t start;
+	uint32_t repeat;
+	uint32_t pos;
+	uint32_t length;
+
+	start = PIOS_DELAY_GetuS();
+	for (repeat = 0; repeat < NUM_REPEATS; ++repeat)
+	{
+		for (pos = 0; pos < streamLength; pos += length)
+		{
+			if (chunkSize == 0)
+			{
+				length = 1;
+				UAVTalkProcessInputStream(rx, stream[pos]);
+			}
+			else
+			{
+				length = (streamLength - pos < chunkSize ? streamLength - pos : chunkSize);
+				UAVTalkProcessInputBuffer(rx, &stream[pos], length);
+			}
+		}
+	}
+	start = PIOS_DELAY_GetuSSince(start);
+
+	UAVTalkGetStats(rx, stats);
+	return start;
+}
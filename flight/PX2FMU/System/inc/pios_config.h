@@ -64,6 +64,10 @@
 //#define PIOS_INCLUDE_HCSR04		// XXX needs PiOS support work
 //#define PIOS_INCLUDE_WDG			// XXX needs PiOS support work
 
+/* Settings in the EEPROM, the whole 16KB */
+#define PIOS_FLASHFS_MAX_OBJECTS	48
+#define PIOS_FLASHFS_MAX_SECTORS	64
+
 /* Defaults for Logging */
 #define LOG_FILENAME 			"PIOS.LOG"
 #define STARTUP_LOG_ENABLED		1
@@ -71,6 +75,9 @@
 /* Enable a priority queue in telemetry */
 #define PIOS_TELEM_PRIORITY_QUEUE
 
+/* Run background callbacks (settings, logging) on their own event task and queue */
+#define PIOS_EVENTDISPATCHER_BACKGROUND_LANE
+
 /* COM Module */
 #define GPS_BAUDRATE			38400
 
@@ -51,6 +51,15 @@
 	#define configIDLE_SHOULD_YIELD		0
 #endif
 
+/* TICK_LOCKSTEP replaces the wall clock tick with ticks requested by an
+   external simulator over UDP, see xPortStartScheduler() in the port. Each
+   request is a uint32 number of ticks, the reply is the uint32 tick count
+   reached once all tasks are blocked again. Enabled by LOCKSTEP=YES */
+#ifdef TICK_LOCKSTEP
+	#define configLOCKSTEP_PORT		9100
+	#define configLOCKSTEP_TIMEOUT_MS	1000
+#endif
+
 
 #define configUSE_IDLE_HOOK		1
 #define configUSE_TICK_HOOK		0
@@ -86,6 +95,7 @@ to exclude the API function. */
 #define INCLUDE_vTaskDelay			1
 #define INCLUDE_xTaskGetSchedulerState		1
 #define INCLUDE_xTaskGetCurrentTaskHandle	1
+#define INCLUDE_xTaskGetIdleTaskHandle		1
 #define INCLUDE_uxTaskGetStackHighWaterMark	0
 
 
@@ -32,6 +32,8 @@
 extern int32_t PIOS_DELAY_Init(void);
 extern int32_t PIOS_DELAY_WaituS(uint16_t uS);
 extern int32_t PIOS_DELAY_WaitmS(uint16_t mS);
+extern uint32_t PIOS_DELAY_GetuS(void);
+extern uint32_t PIOS_DELAY_GetuSSince(uint32_t t);
 
 
 #endif /* PIOS_DELAY_H */
@@ -0,0 +1,55 @@
+/**
+ ******************************************************************************
+ *
+ * @file       pios_flash_ram.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2011.
+ * @brief      RAM backed flash chip for the flash file system
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PIOS_FLASH_RAM_H
+#define PIOS_FLASH_RAM_H
+
+#include <pios_flashfs_objlist.h>
+
+/* Emulated chip, sector and page sizes match the W25X flash */
+#ifndef PIOS_FLASH_RAM_SIZE
+#define PIOS_FLASH_RAM_SIZE		0x80000
+#endif
+#define PIOS_FLASH_RAM_SECTOR_SIZE	0x1000
+#define PIOS_FLASH_RAM_PAGE_SIZE	0x100
+
+/* Access counters */
+struct pios_flash_ram_stats {
+	uint32_t sectorErases;
+	uint32_t chipErases;
+	uint32_t writes;
+	uint32_t bytesWritten;
+	uint32_t reads;
+	uint32_t bytesRead;
+	uint32_t maxSectorErases;	/* erase count of the most worn sector */
+};
+
+extern PIOS_FLASHFS_Driver PIOS_Flash_RAM_Driver;
+
+extern void PIOS_Flash_RAM_GetStats(struct pios_flash_ram_stats *stats);
+extern void PIOS_Flash_RAM_ClearStats(void);
+extern void PIOS_Flash_RAM_CutAfter(uint32_t bytes);
+
+#endif /* PIOS_FLASH_RAM_H */
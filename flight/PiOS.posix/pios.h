@@ -67,6 +67,7 @@
 #include <pios_debug.h>
 #include <pios_crc.h>
 #include <pios_rcvr.h>
+#include <pios_flash_ram.h>
 
 #define NELEMENTS(x) (sizeof(x) / sizeof(*(x)))
 
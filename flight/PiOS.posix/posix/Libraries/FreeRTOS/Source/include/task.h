@@ -1213,6 +1213,12 @@ void vTaskSwitchContext( void ) PRIVILEGED_FUNCTION;
  */
 xTaskHandle xTaskGetCurrentTaskHandle( void ) PRIVILEGED_FUNCTION;
 
+/*
+ * Return the handle of the idle task.  Only valid once the scheduler has been
+ * started.
+ */
+xTaskHandle xTaskGetIdleTaskHandle( void ) PRIVILEGED_FUNCTION;
+
 /*
  * Capture the current time status for future reference.
  */
@@ -65,10 +65,20 @@
 #include <stdio.h>
 #include <unistd.h>
 #include <limits.h>
+#ifdef TICK_LOCKSTEP
+#include <stdint.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#endif
 
 /* Scheduler includes. */
 #include "FreeRTOS.h"
 #include "task.h"
+
+#if defined(TICK_LOCKSTEP) && ( INCLUDE_xTaskGetIdleTaskHandle != 1 )
+#error "TICK_LOCKSTEP needs INCLUDE_xTaskGetIdleTaskHandle"
+#endif
 /*-----------------------------------------------------------*/
 
 #define MAX_NUMBER_OF_TASKS 		( _POSIX_THREAD_THREADS_MAX )
@@ -105,6 +115,10 @@ static volatile portBASE_TYPE xServicingTick = pdFALSE;
 static volatile portBASE_TYPE xPendYield = pdFALSE;
 static volatile portLONG lIndexOfLastAddedTask = 0;
 static volatile unsigned portBASE_TYPE uxCriticalNesting;
+#ifdef TICK_LOCKSTEP
+static volatile portBASE_TYPE xLockstepTickPending = pdFALSE;
+static volatile portTickType xLockstepTicks = 0;
+#endif
 /*-----------------------------------------------------------*/
 
 /*
@@ -122,6 +136,11 @@ static portLONG prvGetFreeThreadState( void );
 static void prvSetTaskCriticalNesting( pthread_t xThreadId, unsigned portBASE_TYPE uxNesting );
 static unsigned portBASE_TYPE prvGetTaskCriticalNesting( pthread_t xThreadId );
 static void prvDeleteThread( void *xThreadId );
+#ifdef TICK_LOCKSTEP
+static void prvLockstepServe( void );
+static void prvLockstepTick( void );
+static void prvLockstepWaitIdle( void );
+#endif
 /*-----------------------------------------------------------*/
 
 /*
@@ -226,6 +245,12 @@ portLONG lIndex;
 	/* Start the first task. Will not return unless all threads are killed. */
 	vPortStartFirstTask();
 
+#ifdef TICK_LOCKSTEP
+	/* The main thread generates the ticks requested by the simulator. */
+	prvLockstepServe();
+	(void)xSignals;
+	(void)iSignal;
+#else
 	/* This is the end signal we are looking for. */
 	sigemptyset( &xSignals );
 	sigaddset( &xSignals, SIG_RESUME );
@@ -237,6 +262,7 @@ portLONG lIndex;
 			printf( "Main thread spurious signal: %d\n", iSignal );
 		}
 	}
+#endif
 
 	printf( "Cleaning Up, Exiting.\n" );
 	/* Cleanup the mutexes */
@@ -369,6 +395,7 @@ void vPortClearInterruptMask( portBASE_TYPE xMask )
  */
 void prvSetupTimerInterrupt( void )
 {
+#ifndef TICK_LOCKSTEP
 struct itimerval itimer, oitimer;
 portTickType xMicroSeconds = portTICK_RATE_MICROSECONDS;
 
@@ -393,6 +420,7 @@ portTickType xMicroSeconds = portTICK_RATE_MICROSECONDS;
 	{
 		printf( "Get Timer problem.\n" );
 	}
+#endif
 }
 /*-----------------------------------------------------------*/
 
@@ -401,12 +429,32 @@ void vPortSystemTickHandler( int sig )
 pthread_t xTaskToSuspend;
 pthread_t xTaskToResume;
 
+#ifdef TICK_LOCKSTEP
+	/* Retried tick signals can arrive after the tick has been taken. */
+	if ( pdTRUE != xLockstepTickPending )
+	{
+		return;
+	}
+#endif
+
 	if ( ( pdTRUE == xInterruptsEnabled ) && ( pdTRUE != xServicingTick ) )
 	{
 		if ( 0 == pthread_mutex_trylock( &xSingleThreadMutex ) )
 		{
 			xServicingTick = pdTRUE;
 
+#ifdef TICK_LOCKSTEP
+			/* Check again now that no other thread can take the tick. */
+			if ( pdTRUE != xLockstepTickPending )
+			{
+				xServicingTick = pdFALSE;
+				(void)pthread_mutex_unlock( &xSingleThreadMutex );
+				return;
+			}
+			xLockstepTicks++;
+			xLockstepTickPending = pdFALSE;
+#endif
+
 			xTaskToSuspend = prvGetThreadHandle( xTaskGetCurrentTaskHandle() );
 			/* Tick Increment. */
 			vTaskIncrementTick();
@@ -772,3 +820,122 @@ struct tms xTimes;
 	(void)ulTotalTime;
 }
 /*-----------------------------------------------------------*/
+
+#ifdef TICK_LOCKSTEP
+
+portTickType xPortGetLockstepTicks( void )
+{
+	return xLockstepTicks;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Serve tick requests from the simulator on the main thread. A request is a
+ * uint32 number of ticks in host byte order, each tick is only followed by
+ * the next one when all tasks are blocked again, so a run depends on the
+ * number of ticks and not on the wall clock. The reply is the uint32 tick
+ * count reached, a request for zero ticks just reads it.
+ */
+void prvLockstepServe( void )
+{
+int iSocket;
+struct sockaddr_in xAddress;
+struct sockaddr_in xPeer;
+socklen_t xPeerLength;
+struct timeval xTimeout;
+uint32_t ulRequest;
+uint32_t ulReply;
+
+	memset( &xAddress, 0, sizeof( xAddress ) );
+	xAddress.sin_family = AF_INET;
+	xAddress.sin_port = htons( configLOCKSTEP_PORT );
+	xAddress.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+
+	iSocket = socket( AF_INET, SOCK_DGRAM, 0 );
+	if ( ( iSocket < 0 ) || ( 0 != bind( iSocket, ( struct sockaddr * )&xAddress, sizeof( xAddress ) ) ) )
+	{
+		printf( "Lockstep: cannot bind UDP port %d.\n", configLOCKSTEP_PORT );
+		vPortEndScheduler();
+		return;
+	}
+
+	/* Wake up regularly to notice the end of the scheduler. */
+	xTimeout.tv_sec = 0;
+	xTimeout.tv_usec = 100000;
+	(void)setsockopt( iSocket, SOL_SOCKET, SO_RCVTIMEO, &xTimeout, sizeof( xTimeout ) );
+
+	/* Let the tasks finish their initialisation at tick 0. */
+	prvLockstepWaitIdle();
+	printf( "Lockstep: waiting for ticks on UDP port %d.\n", configLOCKSTEP_PORT );
+
+	while ( pdTRUE != xSchedulerEnd )
+	{
+		xPeerLength = sizeof( xPeer );
+		if ( sizeof( ulRequest ) != recvfrom( iSocket, &ulRequest, sizeof( ulRequest ), 0, ( struct sockaddr * )&xPeer, &xPeerLength ) )
+		{
+			continue;
+		}
+
+		for ( ; ( ulRequest > 0 ) && ( pdTRUE != xSchedulerEnd ); ulRequest-- )
+		{
+			prvLockstepTick();
+			prvLockstepWaitIdle();
+		}
+
+		ulReply = xLockstepTicks;
+		(void)sendto( iSocket, &ulReply, sizeof( ulReply ), 0, ( struct sockaddr * )&xPeer, xPeerLength );
+	}
+
+	close( iSocket );
+}
+/*-----------------------------------------------------------*/
+
+void prvLockstepTick( void )
+{
+pthread_t hThread;
+portLONG lSpin;
+
+	xLockstepTickPending = pdTRUE;
+	while ( ( pdTRUE == xLockstepTickPending ) && ( pdTRUE != xSchedulerEnd ) )
+	{
+		/* Only the running thread can process the tick. The signal is sent
+		again when it was dropped inside a critical section or a switch. */
+		hThread = prvGetThreadHandle( xTaskGetCurrentTaskHandle() );
+		if ( ( pthread_t )NULL != hThread )
+		{
+			(void)pthread_kill( hThread, SIG_TICK );
+		}
+		for ( lSpin = 0; ( lSpin < 100 ) && ( pdTRUE == xLockstepTickPending ); lSpin++ )
+		{
+			sched_yield();
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+void prvLockstepWaitIdle( void )
+{
+struct timespec xStart;
+struct timespec xNow;
+
+	/* The idle task only runs once every other task is blocked. */
+	clock_gettime( CLOCK_MONOTONIC, &xStart );
+	while ( pdTRUE != xSchedulerEnd )
+	{
+		if ( ( pdTRUE != xServicingTick ) && ( xTaskGetCurrentTaskHandle() == xTaskGetIdleTaskHandle() ) )
+		{
+			break;
+		}
+		sched_yield();
+
+		clock_gettime( CLOCK_MONOTONIC, &xNow );
+		if ( ( xNow.tv_sec - xStart.tv_sec ) * 1000 + ( xNow.tv_nsec - xStart.tv_nsec ) / 1000000 > configLOCKSTEP_TIMEOUT_MS )
+		{
+			printf( "Lockstep: tasks still running at tick %lu, continuing.\n", ( unsigned long )xLockstepTicks );
+			break;
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+#endif
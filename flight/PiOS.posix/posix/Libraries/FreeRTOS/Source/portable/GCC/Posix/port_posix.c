@@ -66,11 +66,21 @@
 #include <unistd.h>
 #include <limits.h>
 #include <assert.h>
+#ifdef TICK_LOCKSTEP
+#include <stdint.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#endif
 
 
 /* Scheduler includes. */
 #include "FreeRTOS.h"
 #include "task.h"
+
+#if defined(TICK_LOCKSTEP) && ( INCLUDE_xTaskGetIdleTaskHandle != 1 )
+#error "TICK_LOCKSTEP needs INCLUDE_xTaskGetIdleTaskHandle"
+#endif
 /*-----------------------------------------------------------*/
 
 #define MAX_NUMBER_OF_TASKS 		( _POSIX_THREAD_THREADS_MAX )
@@ -114,6 +124,9 @@ static volatile portBASE_TYPE xServicingTick = pdFALSE;
 static volatile portBASE_TYPE xPendYield = pdFALSE;
 static volatile portLONG lIndexOfLastAddedTask = 0;
 static volatile unsigned portBASE_TYPE uxCriticalNesting;
+#ifdef TICK_LOCKSTEP
+static volatile portTickType xLockstepTicks = 0;
+#endif
 /*-----------------------------------------------------------*/
 
 /*
@@ -137,6 +150,10 @@ static portLONG prvGetFreeThreadState( void );
 static void prvSetTaskCriticalNesting( pthread_t xThreadId, unsigned portBASE_TYPE uxNesting );
 static unsigned portBASE_TYPE prvGetTaskCriticalNesting( pthread_t xThreadId );
 static void prvDeleteThread( void *xThreadId );
+#ifdef TICK_LOCKSTEP
+static void prvLockstepServe( void );
+static void prvLockstepWaitIdle( void );
+#endif
 /*-----------------------------------------------------------*/
 
 /*
@@ -361,6 +378,11 @@ portLONG lIndex;
 	/* checked careful in startup on hardware */
 	usleep(1000000);
 
+#ifdef TICK_LOCKSTEP
+	/* The main thread generates the ticks requested by the simulator. */
+	prvLockstepServe();
+#endif
+
 #if defined(TICK_SIGNAL) || defined(TICK_SIGWAIT)
 		
 	struct itimerval itimer;
@@ -418,7 +440,7 @@ portLONG lIndex;
 	}
 #endif	
 
-#if !defined(TICK_SIGNAL) && !defined(TICK_SIGWAIT)
+#if !defined(TICK_SIGNAL) && !defined(TICK_SIGWAIT) && !defined(TICK_LOCKSTEP)
 	
 	struct timespec x;
 	while( pdTRUE != xSchedulerEnd ) {
@@ -676,6 +698,9 @@ tskTCB * oldTask, * newTask;
 						
 			/* Tick Increment. */
 			vTaskIncrementTick();
+#ifdef TICK_LOCKSTEP
+			xLockstepTicks++;
+#endif
 
 			/* Select Next Task. */
 #if ( configUSE_PREEMPTION == 1 )
@@ -1256,3 +1281,109 @@ struct tms xTimes;
 	(void)ulTotalTime;
 }
 /*-----------------------------------------------------------*/
+
+#ifdef TICK_LOCKSTEP
+
+portTickType xPortGetLockstepTicks( void )
+{
+	return xLockstepTicks;
+}
+/*-----------------------------------------------------------*/
+
+/*
+ * Serve tick requests from the simulator on the main thread. A request is a
+ * uint32 number of ticks in host byte order, each tick is only followed by
+ * the next one when all tasks are blocked again, so a run depends on the
+ * number of ticks and not on the wall clock. The reply is the uint32 tick
+ * count reached, a request for zero ticks just reads it.
+ */
+void prvLockstepServe( void )
+{
+int iSocket;
+struct sockaddr_in xAddress;
+struct sockaddr_in xPeer;
+socklen_t xPeerLength;
+struct timeval xTimeout;
+uint32_t ulRequest;
+uint32_t ulReply;
+portTickType xTicks;
+
+	memset( &xAddress, 0, sizeof( xAddress ) );
+	xAddress.sin_family = AF_INET;
+	xAddress.sin_port = htons( configLOCKSTEP_PORT );
+	xAddress.sin_addr.s_addr = htonl( INADDR_LOOPBACK );
+
+	iSocket = socket( AF_INET, SOCK_DGRAM, 0 );
+	if ( ( iSocket < 0 ) || ( 0 != bind( iSocket, ( struct sockaddr * )&xAddress, sizeof( xAddress ) ) ) )
+	{
+		printf( "Lockstep: cannot bind UDP port %d.\n", configLOCKSTEP_PORT );
+		vPortEndScheduler();
+		return;
+	}
+
+	/* Wake up regularly to notice the end of the scheduler. */
+	xTimeout.tv_sec = 0;
+	xTimeout.tv_usec = 100000;
+	(void)setsockopt( iSocket, SOL_SOCKET, SO_RCVTIMEO, &xTimeout, sizeof( xTimeout ) );
+
+	/* Let the tasks finish their initialisation at tick 0. */
+	prvLockstepWaitIdle();
+	printf( "Lockstep: waiting for ticks on UDP port %d.\n", configLOCKSTEP_PORT );
+
+	while ( pdTRUE != xSchedulerEnd )
+	{
+		xPeerLength = sizeof( xPeer );
+		if ( sizeof( ulRequest ) != recvfrom( iSocket, &ulRequest, sizeof( ulRequest ), 0, ( struct sockaddr * )&xPeer, &xPeerLength ) )
+		{
+			continue;
+		}
+
+		for ( ; ( ulRequest > 0 ) && ( pdTRUE != xSchedulerEnd ); ulRequest-- )
+		{
+			/* The tick is dropped inside a critical section or a swap, retry. */
+			xTicks = xLockstepTicks;
+			while ( ( xTicks == xLockstepTicks ) && ( pdTRUE != xSchedulerEnd ) )
+			{
+				vPortSystemTickHandler( SIG_TICK );
+				if ( xTicks == xLockstepTicks )
+				{
+					sched_yield();
+				}
+			}
+			prvLockstepWaitIdle();
+		}
+
+		ulReply = xLockstepTicks;
+		(void)sendto( iSocket, &ulReply, sizeof( ulReply ), 0, ( struct sockaddr * )&xPeer, xPeerLength );
+	}
+
+	close( iSocket );
+}
+/*-----------------------------------------------------------*/
+
+void prvLockstepWaitIdle( void )
+{
+struct timespec xStart;
+struct timespec xNow;
+
+	/* The idle task only runs once every other task is blocked. */
+	clock_gettime( CLOCK_MONOTONIC, &xStart );
+	while ( pdTRUE != xSchedulerEnd )
+	{
+		if ( ( pdTRUE != xServicingTick ) && ( xTaskGetCurrentTaskHandle() == xTaskGetIdleTaskHandle() ) )
+		{
+			break;
+		}
+		sched_yield();
+
+		clock_gettime( CLOCK_MONOTONIC, &xNow );
+		if ( ( xNow.tv_sec - xStart.tv_sec ) * 1000 + ( xNow.tv_nsec - xStart.tv_nsec ) / 1000000 > configLOCKSTEP_TIMEOUT_MS )
+		{
+			printf( "Lockstep: tasks still running at tick %lu, continuing.\n", ( unsigned long )xLockstepTicks );
+			break;
+		}
+	}
+}
+/*-----------------------------------------------------------*/
+
+#endif
@@ -162,6 +162,11 @@ extern unsigned long ulPortGetTimerValue( void );
 #undef portGET_RUN_TIME_COUNTER_VALUE
 #define portGET_RUN_TIME_COUNTER_VALUE()			ulPortGetTimerValue()			/* Query the System time stats for this process. */
 
+#ifdef TICK_LOCKSTEP
+/* Ticks advanced by the lockstep simulator so far, safe to call from any thread. */
+extern portTickType xPortGetLockstepTicks( void );
+#endif
+
 #ifdef __cplusplus
 }
 #endif
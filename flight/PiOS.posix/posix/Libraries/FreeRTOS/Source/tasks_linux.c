@@ -163,6 +163,10 @@ PRIVILEGED_DATA static volatile portBASE_TYPE xMissedYield 						= ( portBASE_TY
 PRIVILEGED_DATA static volatile portBASE_TYPE xNumOfOverflows 					= ( portBASE_TYPE ) 0;
 PRIVILEGED_DATA static unsigned portBASE_TYPE uxTaskNumber 						= ( unsigned portBASE_TYPE ) 0;
 
+#if ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
+	PRIVILEGED_DATA static xTaskHandle xIdleTaskHandle = NULL;				/*< Holds the handle of the idle task. */
+#endif
+
 #if ( configGENERATE_RUN_TIME_STATS == 1 )
 
 	PRIVILEGED_DATA static char pcStatsString[ 50 ] ;
@@ -1023,7 +1027,15 @@ void vTaskStartScheduler( void )
 portBASE_TYPE xReturn;
 
 	/* Add the idle task at the lowest priority. */
-	xReturn = xTaskCreate( prvIdleTask, ( signed char * ) "IDLE", tskIDLE_STACK_SIZE, ( void * ) NULL, ( tskIDLE_PRIORITY | portPRIVILEGE_BIT ), ( xTaskHandle * ) NULL );
+	#if ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
+	{
+		xReturn = xTaskCreate( prvIdleTask, ( signed char * ) "IDLE", tskIDLE_STACK_SIZE, ( void * ) NULL, ( tskIDLE_PRIORITY | portPRIVILEGE_BIT ), &xIdleTaskHandle );
+	}
+	#else
+	{
+		xReturn = xTaskCreate( prvIdleTask, ( signed char * ) "IDLE", tskIDLE_STACK_SIZE, ( void * ) NULL, ( tskIDLE_PRIORITY | portPRIVILEGE_BIT ), ( xTaskHandle * ) NULL );
+	}
+	#endif
 
 	if( xReturn == pdPASS )
 	{
@@ -2196,6 +2208,19 @@ tskTCB *pxNewTCB;
 
 /*-----------------------------------------------------------*/
 
+#if ( INCLUDE_xTaskGetIdleTaskHandle == 1 )
+
+	xTaskHandle xTaskGetIdleTaskHandle( void )
+	{
+		/* Only valid once the scheduler has been started, the idle task is
+		never deleted so no critical section is required. */
+		return xIdleTaskHandle;
+	}
+
+#endif
+
+/*-----------------------------------------------------------*/
+
 #if ( INCLUDE_xTaskGetSchedulerState == 1 )
 
 	portBASE_TYPE xTaskGetSchedulerState( void )
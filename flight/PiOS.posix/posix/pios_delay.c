@@ -61,12 +61,17 @@ int32_t PIOS_DELAY_Init(void)
 */
 int32_t PIOS_DELAY_WaituS(uint16_t uS)
 {
+#if defined(TICK_LOCKSTEP)
+	// Virtual time only advances between ticks, a short wait takes no time
+	(void)uS;
+#else
 	static struct timespec wait,rest;
 	wait.tv_sec=0;
 	wait.tv_nsec=1000*uS;
 	while (!nanosleep(&wait,&rest)) {
 		wait=rest;
 	}
+#endif
 
 	/* No error */
 	return 0;
@@ -85,6 +90,12 @@ int32_t PIOS_DELAY_WaituS(uint16_t uS)
 */
 int32_t PIOS_DELAY_WaitmS(uint16_t mS)
 {
+#if defined(TICK_LOCKSTEP)
+	// Wait in virtual time, before the scheduler runs time stands still
+	if (xTaskGetSchedulerState() == taskSCHEDULER_RUNNING) {
+		vTaskDelay(mS / portTICK_RATE_MS);
+	}
+#else
 	//for(int i = 0; i < mS; i++) {
 	//	PIOS_DELAY_WaituS(1000);
 	static struct timespec wait,rest;
@@ -94,9 +105,36 @@ int32_t PIOS_DELAY_WaitmS(uint16_t mS)
 		wait=rest;
 	}
 	//}
+#endif
 
 	/* No error */
 	return 0;
 }
 
+/**
+* Query the host monotonic clock for the current uS, in lockstep mode the
+* virtual time of the ticks advanced by the simulator
+* \return A microsecond value (wraps around like the STM32 version)
+*/
+uint32_t PIOS_DELAY_GetuS(void)
+{
+#if defined(TICK_LOCKSTEP)
+	return (uint32_t)(xPortGetLockstepTicks() * portTICK_RATE_MICROSECONDS);
+#else
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (uint32_t)(now.tv_sec * 1000000ULL + now.tv_nsec / 1000);
+#endif
+}
+
+/**
+* Calculate time in microseconds since a previous time
+* \param[in] t previous time
+* \return time in us since previous time t.
+*/
+uint32_t PIOS_DELAY_GetuSSince(uint32_t t)
+{
+	return (PIOS_DELAY_GetuS() - t);
+}
+
 #endif
@@ -0,0 +1,194 @@
+/**
+ ******************************************************************************
+ *
+ * @file       pios_flash_ram.c
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2011.
+ * @brief      RAM backed flash chip for the flash file system. Behaves like a
+ *             NOR flash: erased bytes read 0xFF, writes can only clear bits and
+ *             must not cross a page. Counts all accesses so the file system can
+ *             be benchmarked in SITL.
+ * @see        The GNU Public License (GPL) Version 3
+ * @defgroup   PIOS_FLASH_RAM RAM flash Functions
+ * @{
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+/* Project Includes */
+#include "pios.h"
+#include "pios_flash_ram.h"
+
+/* Private Function Prototypes */
+static int8_t PIOS_Flash_RAM_EraseSector(uint32_t addr);
+static int8_t PIOS_Flash_RAM_EraseChip(void);
+static int8_t PIOS_Flash_RAM_WriteData(uint32_t addr, uint8_t * data, uint16_t len);
+static int8_t PIOS_Flash_RAM_ReadData(uint32_t addr, uint8_t * data, uint16_t len);
+
+/* Local Variables */
+static uint8_t flash[PIOS_FLASH_RAM_SIZE];
+static uint32_t sectorErases[PIOS_FLASH_RAM_SIZE / PIOS_FLASH_RAM_SECTOR_SIZE];
+static struct pios_flash_ram_stats stats;
+static uint8_t initialized = 0;
+static uint32_t cutBytes = 0;
+static uint8_t powerLost = 0;
+
+PIOS_FLASHFS_Driver PIOS_Flash_RAM_Driver = {
+		PIOS_FLASH_RAM_SECTOR_SIZE,			/* flash sector size */
+		PIOS_FLASH_RAM_SIZE,				/* flash chip size */
+		PIOS_Flash_RAM_EraseSector,
+		PIOS_Flash_RAM_EraseChip,
+		PIOS_Flash_RAM_WriteData,
+		PIOS_Flash_RAM_ReadData
+};
+
+/**
+ * A new chip is erased
+ */
+static void PIOS_Flash_RAM_Init(void)
+{
+	if (!initialized) {
+		memset(flash, 0xFF, sizeof(flash));
+		memset(sectorErases, 0, sizeof(sectorErases));
+		initialized = 1;
+	}
+}
+
+/**
+ * Get the access counters
+ * \param[out] statsOut The counters are copied there
+ */
+void PIOS_Flash_RAM_GetStats(struct pios_flash_ram_stats *statsOut)
+{
+	uint32_t n;
+
+	stats.maxSectorErases = 0;
+	for (n = 0; n < NELEMENTS(sectorErases); ++n) {
+		if (sectorErases[n] > stats.maxSectorErases)
+			stats.maxSectorErases = sectorErases[n];
+	}
+	memcpy(statsOut, &stats, sizeof(stats));
+}
+
+/**
+ * Clear the access counters, the erase counts of the sectors are kept
+ */
+void PIOS_Flash_RAM_ClearStats(void)
+{
+	memset(&stats, 0, sizeof(stats));
+}
+
+/**
+ * Simulate a reset in the middle of programming. The given byte, counted from
+ * the next write, only gets some of its bits, the write stops there and every
+ * access fails until this is called again.
+ * \param[in] bytes Byte the power is cut at, 0 to power the chip up again
+ */
+void PIOS_Flash_RAM_CutAfter(uint32_t bytes)
+{
+	cutBytes = bytes;
+	powerLost = 0;
+}
+
+/**
+ * Erase the sector containing an address
+ * \param[in] addr Address in the sector
+ * \return 0 if success, -1 if the address is out of range
+ */
+static int8_t PIOS_Flash_RAM_EraseSector(uint32_t addr)
+{
+	PIOS_Flash_RAM_Init();
+	if (powerLost || addr >= PIOS_FLASH_RAM_SIZE)
+		return -1;
+
+	addr &= ~(PIOS_FLASH_RAM_SECTOR_SIZE - 1);
+	memset(&flash[addr], 0xFF, PIOS_FLASH_RAM_SECTOR_SIZE);
+	++sectorErases[addr / PIOS_FLASH_RAM_SECTOR_SIZE];
+	++stats.sectorErases;
+	return 0;
+}
+
+/**
+ * Erase the whole chip
+ * \return 0 if success
+ */
+static int8_t PIOS_Flash_RAM_EraseChip(void)
+{
+	uint32_t n;
+
+	PIOS_Flash_RAM_Init();
+	if (powerLost)
+		return -1;
+	memset(flash, 0xFF, sizeof(flash));
+	for (n = 0; n < NELEMENTS(sectorErases); ++n)
+		++sectorErases[n];
+	++stats.chipErases;
+	return 0;
+}
+
+/**
+ * Program data, like the W25X page program the data must be within one page
+ * \param[in] addr Address to write to
+ * \param[in] data Data to write
+ * \param[in] len Length in bytes
+ * \return 0 if success, -1 if the write is out of range or crosses a page
+ */
+static int8_t PIOS_Flash_RAM_WriteData(uint32_t addr, uint8_t * data, uint16_t len)
+{
+	uint16_t n;
+
+	PIOS_Flash_RAM_Init();
+	if (powerLost || addr + len > PIOS_FLASH_RAM_SIZE)
+		return -1;
+	if (((addr & (PIOS_FLASH_RAM_PAGE_SIZE - 1)) + len) > PIOS_FLASH_RAM_PAGE_SIZE)
+		return -1;
+
+	// Programming can only clear bits
+	for (n = 0; n < len; ++n) {
+		if (cutBytes > 0 && --cutBytes == 0) {
+			flash[addr + n] &= data[n] | 0x0F;
+			powerLost = 1;
+			return -1;
+		}
+		flash[addr + n] &= data[n];
+	}
+	++stats.writes;
+	stats.bytesWritten += len;
+	return 0;
+}
+
+/**
+ * Read data
+ * \param[in] addr Address to read from
+ * \param[out] data Buffer for the data
+ * \param[in] len Length in bytes
+ * \return 0 if success, -1 if the read is out of range
+ */
+static int8_t PIOS_Flash_RAM_ReadData(uint32_t addr, uint8_t * data, uint16_t len)
+{
+	PIOS_Flash_RAM_Init();
+	if (powerLost || addr + len > PIOS_FLASH_RAM_SIZE)
+		return -1;
+
+	memcpy(data, &flash[addr], len);
+	++stats.reads;
+	stats.bytesRead += len;
+	return 0;
+}
+
+/**
+  * @}
+  */
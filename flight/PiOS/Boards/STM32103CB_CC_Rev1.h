@@ -78,7 +78,7 @@ TIM4  |  RC In 1  |  Servo 3  |  Servo 2  |  Servo 1
 //------------------------
 // TELEMETRY
 //------------------------
-#define TELEM_QUEUE_SIZE         20
+#define TELEM_QUEUE_SIZE         10
 
 //------------------------
 // PIOS_LED
@@ -64,7 +64,7 @@
 //------------------------
 // TELEMETRY
 //------------------------
-#define TELEM_QUEUE_SIZE		20
+#define TELEM_QUEUE_SIZE		10
 #define PIOS_TELEM_STACK_SIZE	1200
 
 //------------------------
@@ -39,6 +39,7 @@ static int8_t PIOS_EEPROM_Read(uint32_t address, uint8_t *data, uint16_t count);
 
 PIOS_FLASHFS_Driver PIOS_EEPROM_Driver = {
 		EEPROM_SECTOR_SIZE,
+		PIOS_I2C_EEPROM_SIZE,
 		PIOS_EEPROM_Erase,
 		PIOS_EEPROM_EraseChip,
 		PIOS_EEPROM_Write,
@@ -33,6 +33,7 @@
 
 PIOS_FLASHFS_Driver PIOS_Flash_W25X_Driver = {
 		0x1000,							/* flash sector size */
+		0x80000,						/* flash chip size, smallest part fitted */
 		PIOS_Flash_W25X_EraseSector,
 		PIOS_Flash_W25X_EraseChip,
 		PIOS_Flash_W25X_WriteData,
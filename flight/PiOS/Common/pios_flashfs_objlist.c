@@ -3,12 +3,17 @@
  *
  * @addtogroup PIOS PIOS Core hardware abstraction layer
  * @{
- * @addtogroup PIOS_FLASHFS_OBJLIST Object list based flash filesystem (low ram)
+ * @addtogroup PIOS_FLASHFS_OBJLIST Log structured flash filesystem for objects
  * @{
  *
  * @file       pios_flashfs_objlist.c
  * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2010.
- * @brief      A file system for storing UAVObject in flash chip
+ * @brief      A file system for storing UAVObject in flash chip.
+ *             Object records are appended to a log that spans the sectors of the
+ *             chip, a RAM index built at init maps each object to its latest
+ *             record. Sectors are reclaimed in batches by copying their live
+ *             records forward, new sectors are taken by lowest erase count and
+ *             cold sectors are moved when the wear spread gets too large.
  * @see        The GNU Public License (GPL) Version 3
  *
  *****************************************************************************/
@@ -31,329 +36,751 @@
 #include "openpilot.h"
 #include "uavobjectmanager.h"
 
-// Private functions
-static int32_t PIOS_FLASHFS_ClearObjectTableHeader();
-static int32_t PIOS_FLASHFS_GetObjAddress(uint32_t objId, uint16_t instId);
-static int32_t PIOS_FLASHFS_GetNewAddress(uint32_t objId, uint16_t instId);
-
-// Private variables
-static int32_t numObjects = -1;
-static PIOS_FLASHFS_Driver *driver;
+// Private constants
+#define SECTOR_MAGIC       0x4C53FB3C
+#define RECORD_MAGIC       0xAE71
+#define RECORD_COMMIT      0xA5
+#define SEQ_ERASED_NOR     0xFFFFFFFF
+#define SEQ_ERASED_EEPROM  0x00000000
+#define PAGE_SIZE          0x100	// writes must not cross a page of the W25X
+#define COPY_CHUNK         32
+#define RESERVE_SECTORS    1	// kept free for compaction
+#define COMPACT_BATCH      2	// sectors reclaimed by one compaction
+#define WEAR_THRESHOLD     32	// erase count spread that triggers a static move
+#define MAX_BADMAGIC       4
+#define OBJECT_TABLE_MAGIC 0x85FB3C35	// object table of the layout before the log
+
+// Private types
+enum sectorState {
+	SECTOR_ERASE_NEEDED = 0,	// no valid header, must be erased before use
+	SECTOR_FREE,			// erased with header, not in the log yet
+	SECTOR_ACTIVE,			// records are appended here
+	SECTOR_USED			// closed log sector
+};
+
+// Header at the start of every sector
+struct sectorHeader {
+	uint32_t magic;
+	uint32_t eraseCount;
+	uint32_t seq;		// position in the log, erased while the sector is free
+} __attribute__((packed));
 
-// Private structures
-// Header for objects in the file system table
-struct objectHeader {
-	uint32_t objMagic;
+// Header of a record, followed by the data, a CRC and the commit byte
+struct recordHeader {
+	uint16_t magic;
+	uint16_t size;		// 0 for the record of a deleted object
 	uint32_t objId;
-	uint32_t instId;
-	uint32_t address;
-} __attribute__((packed));;
-
-struct fileHeader {
-	uint32_t id;
 	uint16_t instId;
-	uint16_t size;
 } __attribute__((packed));
 
+// RAM index entry pointing at the latest record of an object instance
+struct objectEntry {
+	uint32_t objId;
+	uint32_t addr;
+	uint16_t instId;
+	uint16_t size;		// 0 if deleted, the record is kept to hide older ones
+};
 
-#define OBJECT_TABLE_MAGIC 0x85FB3C35
-#define OBJ_MAGIC          0x3015AE71
-#define OBJECT_TABLE_START 0x00000010
-#define OBJECT_TABLE_END   0x00001000
-#define MAX_BADMAGIC       4
+struct sectorInfo {
+	uint32_t eraseCount;
+	uint32_t seq;
+	uint16_t used;		// bytes from the sector start to the end of the log
+	uint16_t live;		// bytes of records still in the index
+	uint8_t state;
+};
+
+// Private functions
+static int32_t mountLog();
+static int32_t scanSector(uint16_t sector);
+static int32_t eraseSector(uint16_t sector);
+static int32_t allocSector(uint8_t useReserve);
+static int32_t reserveSpace(uint16_t len, uint8_t useReserve);
+static int32_t compact();
+static int32_t relocateSector(uint16_t sector);
+static int32_t appendRecord(struct objectEntry *entry, uint32_t objId, uint16_t instId, uint16_t size, uint8_t *data);
+static int32_t copyRecord(struct objectEntry *entry);
+static int32_t flashWrite(uint32_t addr, uint8_t *data, uint32_t len);
+static struct objectEntry *findEntry(uint32_t objId, uint16_t instId);
+static struct objectEntry *newEntry(uint32_t objId, uint16_t instId);
+static void updateEntry(struct objectEntry *entry, uint32_t addr, uint16_t size);
+static uint16_t recordLength(uint16_t size);
+static uint8_t isErased(uint8_t *data, uint16_t len);
+static uint16_t numReclaimable();
+
+// Private variables
+static PIOS_FLASHFS_Driver *driver;
+static xSemaphoreHandle mutex;
+static struct objectEntry objects[PIOS_FLASHFS_MAX_OBJECTS];
+static struct sectorInfo sectors[PIOS_FLASHFS_MAX_SECTORS];
+static uint16_t numObjects;
+static uint16_t numSectors;
+static int32_t activeSector = -1;
+static uint32_t lastSeq;
+static uint8_t mounted = 0;
 
 /**
- * @brief Initialize the flash object setting FS
- * @return 0 if success, -1 if failure
+ * @brief Initialize the flash object setting FS and build the index of the saved objects
+ * @return 0 if success, -1 if failure, -2 if the chip holds the settings of the old object
+ * table layout, they are kept until PIOS_FLASHFS_Format is called
  */
 int32_t PIOS_FLASHFS_Init(PIOS_FLASHFS_Driver *withDriver)
 {
+	int32_t retval;
+
 	driver = withDriver;
+	if (mutex == NULL) {
+		mutex = xSemaphoreCreateMutex();
+		if (mutex == NULL)
+			return -1;
+	}
 
-	// Check for valid object table or create one
-	uint32_t object_table_magic;
-	uint8_t magic_fail_count = 0;
-	bool magic_good = false;
+	numSectors = driver->chip_size / driver->sector_size;
+	if (numSectors > PIOS_FLASHFS_MAX_SECTORS)
+		numSectors = PIOS_FLASHFS_MAX_SECTORS;
+	if (numSectors < RESERVE_SECTORS + 2)
+		return -1;
 
-	while(!magic_good) {
-		if (driver->ReadData(0, (uint8_t *)&object_table_magic, sizeof(object_table_magic)) != 0)
-			return -1;
-		if(object_table_magic != OBJECT_TABLE_MAGIC) {
-			if(magic_fail_count++ > MAX_BADMAGIC) {
-				PIOS_FLASHFS_ClearObjectTableHeader();
-				PIOS_LED_Toggle(LED1);
-				magic_fail_count = 0;
-				magic_good = true;
-			} else {
-				PIOS_DELAY_WaituS(100);
+	xSemaphoreTake(mutex, portMAX_DELAY);
+	retval = mountLog();
+	mounted = (retval == 0);
+	xSemaphoreGive(mutex);
+
+	// No file system on the chip
+	if (retval == 1) {
+		PIOS_LED_Toggle(LED1);
+		retval = PIOS_FLASHFS_Format();
+	}
+
+	// The settings of the old object table layout are only erased on request,
+	// until then the file system stays unmounted
+	if (retval == 2)
+		retval = -2;
+
+	return retval;
+}
+
+/**
+ * @brief Check whether objects can be saved and loaded
+ * @return 1 if the file system is mounted, 0 if it failed or holds the old object table layout
+ * @note PIOS_FLASHFS_Format mounts an empty file system
+ */
+int32_t PIOS_FLASHFS_IsMounted()
+{
+	return mounted;
+}
+
+/**
+ * @brief Erase the whole flash chip and create the file system
+ * @return 0 if successful, -1 if not
+ */
+int32_t PIOS_FLASHFS_Format()
+{
+	int32_t retval = 0;
+	struct sectorHeader header;
+	uint16_t n;
+
+	if (driver == NULL)
+		return -1;
+
+	xSemaphoreTake(mutex, portMAX_DELAY);
+
+	mounted = 0;
+	if (driver->EraseChip() != 0)
+		retval = -1;
+
+	numObjects = 0;
+	activeSector = -1;
+	lastSeq = 0;
+	for (n = 0; n < numSectors && retval == 0; ++n) {
+		// Keep the erase counts known from the mount
+		sectors[n].eraseCount++;
+		sectors[n].seq = 0;
+		sectors[n].used = sizeof(header);
+		sectors[n].live = 0;
+		sectors[n].state = SECTOR_ERASE_NEEDED;
+
+		header.magic = SECTOR_MAGIC;
+		header.eraseCount = sectors[n].eraseCount;
+		if (driver->WriteData(n * driver->sector_size, (uint8_t *) &header, sizeof(header.magic) + sizeof(header.eraseCount)) != 0)
+			retval = -1;
+		else
+			sectors[n].state = SECTOR_FREE;
+	}
+	mounted = (retval == 0);
+
+	xSemaphoreGive(mutex);
+	return retval;
+}
+
+/**
+ * @brief Saves an object instance by appending a record to the log
+ * @param[in] obj UAVObjHandle the object to save
+ * @param[in] instId The instance of the object to save
+ * @param[in] data The instance data
+ * @return 0 if success or error code
+ * @retval -1 Object too large for a sector or no room in the index
+ * @retval -2 No free space left after compaction
+ * @retval -3 Unable to write the record
+ */
+int32_t PIOS_FLASHFS_ObjSave(UAVObjHandle obj, uint16_t instId, uint8_t * data)
+{
+	uint32_t objId = UAVObjGetID(obj);
+	uint16_t size = UAVObjGetNumBytes(obj);
+	struct objectEntry *entry;
+	int32_t retval;
+
+	if (!mounted || size == 0 || recordLength(size) > driver->sector_size - sizeof(struct sectorHeader))
+		return -1;
+
+	xSemaphoreTake(mutex, portMAX_DELAY);
+
+	entry = findEntry(objId, instId);
+	if (entry == NULL)
+		entry = newEntry(objId, instId);
+
+	if (entry == NULL)
+		retval = -1;
+	else if (reserveSpace(recordLength(size), 0) != 0)
+		retval = -2;
+	else if (appendRecord(entry, objId, instId, size, data) != 0)
+		retval = -3;
+	else
+		retval = 0;
+
+	// A new entry that could not be saved is dropped again
+	if (entry != NULL && entry->addr == 0)
+		--numObjects;
+
+	xSemaphoreGive(mutex);
+	return retval;
+}
+
+/**
+ * @brief Load an object instance from its latest record
+ * @param[in] obj UAVObjHandle the object to load
+ * @param[in] instId The instance of the object to load
+ * @param[out] data Buffer for the instance data, overwritten even if the CRC fails
+ * @return 0 if success or error code
+ * @retval -1 if object not saved
+ * @retval -3 if the saved size doesn't match the object
+ * @retval -4 if unable to retrieve instance data
+ * @retval -5 if unable to read CRC
+ * @retval -6 if CRC doesn't match
+ */
+int32_t PIOS_FLASHFS_ObjLoad(UAVObjHandle obj, uint16_t instId, uint8_t * data)
+{
+	uint32_t objId = UAVObjGetID(obj);
+	uint16_t objSize = UAVObjGetNumBytes(obj);
+	struct objectEntry *entry;
+	struct recordHeader header;
+	uint8_t crc;
+	uint8_t crcFlash;
+	int32_t retval = 0;
+
+	if (!mounted)
+		return -1;
+
+	xSemaphoreTake(mutex, portMAX_DELAY);
+
+	entry = findEntry(objId, instId);
+	if (entry == NULL || entry->size == 0)
+		retval = -1;
+	else if (entry->size != objSize)
+		retval = -3;
+	else {
+		// The header is known from the index, only the data and CRC are read
+		header.magic = RECORD_MAGIC;
+		header.size = objSize;
+		header.objId = objId;
+		header.instId = instId;
+		crc = PIOS_CRC_updateCRC(0, (uint8_t *) &header, sizeof(header));
+
+		if (driver->ReadData(entry->addr + sizeof(header), data, objSize) != 0)
+			retval = -4;
+		else if (driver->ReadData(entry->addr + sizeof(header) + objSize, &crcFlash, sizeof(crcFlash)) != 0)
+			retval = -5;
+		else if (PIOS_CRC_updateCRC(crc, data, objSize) != crcFlash)
+			retval = -6;
+	}
+
+	xSemaphoreGive(mutex);
+	return retval;
+}
+
+/**
+ * @brief Delete object from flash
+ * @param[in] obj UAVObjHandle the object to delete
+ * @param[in] instId The instance of the object to delete
+ * @return 0 if success or error code
+ * @retval -1 if object not saved
+ * @retval -2 if unable to write the delete record
+ * @note A record without data is appended so that the older records of the object
+ * stay hidden after the next init. It is kept until the object is saved again.
+ */
+int32_t PIOS_FLASHFS_ObjDelete(UAVObjHandle obj, uint16_t instId)
+{
+	uint32_t objId = UAVObjGetID(obj);
+	struct objectEntry *entry;
+	int32_t retval = 0;
+
+	if (!mounted)
+		return -1;
+
+	xSemaphoreTake(mutex, portMAX_DELAY);
+
+	entry = findEntry(objId, instId);
+	if (entry == NULL || entry->size == 0)
+		retval = -1;
+	else if (reserveSpace(recordLength(0), 0) != 0 || appendRecord(entry, objId, instId, 0, NULL) != 0)
+		retval = -2;
+
+	xSemaphoreGive(mutex);
+	return retval;
+}
+
+/**
+ * @brief Read the sector headers and records to build the index
+ * @return 0 if success, 1 if the chip holds no file system, 2 if it holds the
+ * old object table layout, -1 on read errors
+ */
+static int32_t mountLog()
+{
+	struct sectorHeader header;
+	uint8_t magic_fail_count = 0;
+	uint16_t numValid = 0;
+	uint32_t tableMagic;
+	uint16_t n;
+
+	while (numValid == 0) {
+		for (n = 0; n < numSectors; ++n) {
+			if (driver->ReadData(n * driver->sector_size, (uint8_t *) &header, sizeof(header)) != 0)
+				return -1;
+
+			sectors[n].used = sizeof(header);
+			sectors[n].live = 0;
+			if (header.magic != SECTOR_MAGIC) {
+				// Erase count unknown, interrupted erase or never formatted
+				sectors[n].eraseCount = 0;
+				sectors[n].seq = 0;
+				sectors[n].state = SECTOR_ERASE_NEEDED;
+				continue;
 			}
 
-		}
-		else {
-			magic_good = true;
+			++numValid;
+			sectors[n].eraseCount = header.eraseCount;
+			sectors[n].seq = header.seq;
+			if (header.seq == SEQ_ERASED_NOR || header.seq == SEQ_ERASED_EEPROM)
+				sectors[n].state = SECTOR_FREE;
+			else
+				sectors[n].state = SECTOR_USED;
 		}
 
+		// Reads can fail right after power up, only format after a few tries
+		if (numValid == 0) {
+			if (magic_fail_count++ > MAX_BADMAGIC) {
+				if (driver->ReadData(0, (uint8_t *) &tableMagic, sizeof(tableMagic)) != 0)
+					return -1;
+				return (tableMagic == OBJECT_TABLE_MAGIC) ? 2 : 1;
+			}
+			PIOS_DELAY_WaituS(100);
+		}
 	}
 
-	int32_t addr = OBJECT_TABLE_START;
-	struct objectHeader header;
+	// Replay the log oldest sector first so that newer records win
 	numObjects = 0;
+	activeSector = -1;
+	lastSeq = 0;
+	for (;;) {
+		int32_t next = -1;
+
+		for (n = 0; n < numSectors; ++n) {
+			if (sectors[n].state == SECTOR_USED && sectors[n].seq > lastSeq &&
+					(next < 0 || sectors[n].seq < sectors[next].seq))
+				next = n;
+		}
+		if (next < 0)
+			break;
+
+		if (scanSector(next) != 0)
+			return -1;
+		lastSeq = sectors[next].seq;
+		activeSector = next;
+	}
+
+	// Keep appending to the newest sector
+	if (activeSector >= 0)
+		sectors[activeSector].state = SECTOR_ACTIVE;
+
+	return 0;
+}
 
-	// Loop through header area while objects detect to count how many saved
-	while(addr < OBJECT_TABLE_END) {
-		// Read the instance data
-		if (driver->ReadData(addr, (uint8_t *)&header, sizeof(header)) != 0)
+/**
+ * @brief Add the records of a sector to the index
+ * @return 0 if success, -1 on read errors
+ */
+static int32_t scanSector(uint16_t sector)
+{
+	uint32_t base = sector * driver->sector_size;
+	struct recordHeader header;
+	struct objectEntry *entry;
+	uint8_t commit;
+
+	while (sectors[sector].used + sizeof(header) <= driver->sector_size) {
+		if (driver->ReadData(base + sectors[sector].used, (uint8_t *) &header, sizeof(header)) != 0)
 			return -1;
 
-		// Counting number of valid headers
-		if(header.objMagic != OBJ_MAGIC)
+		// End of the log in this sector, the rest of it is still erased
+		if (isErased((uint8_t *) &header, sizeof(header)))
+			break;
+
+		// Header or record cut by a reset, nothing may be appended behind it
+		if (header.magic != RECORD_MAGIC ||
+				sectors[sector].used + recordLength(header.size) > driver->sector_size ||
+				driver->ReadData(base + sectors[sector].used + recordLength(header.size) - 1, &commit, sizeof(commit)) != 0 ||
+				commit != RECORD_COMMIT) {
+			sectors[sector].used = driver->sector_size;
 			break;
+		}
+
+		entry = findEntry(header.objId, header.instId);
+		if (entry == NULL)
+			entry = newEntry(header.objId, header.instId);
+		// Objects beyond the index size are dropped, their records become garbage
+		if (entry != NULL)
+			updateEntry(entry, base + sectors[sector].used, header.size);
 
-		numObjects++;
-		addr += sizeof(header);
+		sectors[sector].used += recordLength(header.size);
 	}
 
 	return 0;
 }
 
 /**
- * @brief Erase the whole flash chip and create the file system
- * @return 0 if successful, -1 if not
+ * @brief Erase a sector and write its header, the sector becomes free
+ * @return 0 if success, -1 if not
  */
-int32_t PIOS_FLASHFS_Format() 
+static int32_t eraseSector(uint16_t sector)
 {
-	if(driver->EraseChip() != 0)
+	struct sectorHeader header;
+
+	sectors[sector].state = SECTOR_ERASE_NEEDED;
+	if (driver->EraseSector(sector * driver->sector_size) != 0)
 		return -1;
-	if(PIOS_FLASHFS_ClearObjectTableHeader() != 0)
+
+	sectors[sector].eraseCount++;
+	sectors[sector].seq = 0;
+	sectors[sector].used = sizeof(header);
+	sectors[sector].live = 0;
+
+	// The sequence number stays erased until the sector joins the log
+	header.magic = SECTOR_MAGIC;
+	header.eraseCount = sectors[sector].eraseCount;
+	if (driver->WriteData(sector * driver->sector_size, (uint8_t *) &header, sizeof(header.magic) + sizeof(header.eraseCount)) != 0)
 		return -1;
+
+	sectors[sector].state = SECTOR_FREE;
 	return 0;
 }
 
 /**
- * @brief Erase the headers for all objects in the flash chip
- * @return 0 if successful, -1 if not
+ * @brief Close the active sector and continue the log in the least worn free sector
+ * @param[in] useReserve Compaction may take the reserved sectors
+ * @return 0 if success, -1 if no sector is available
  */
-static int32_t PIOS_FLASHFS_ClearObjectTableHeader()
+static int32_t allocSector(uint8_t useReserve)
 {
-	if(driver->EraseSector(OBJECT_TABLE_START) != 0)
+	int32_t best = -1;
+	uint16_t n;
+
+	if (!useReserve && numReclaimable() <= RESERVE_SECTORS)
+		return -1;
+
+	for (n = 0; n < numSectors; ++n) {
+		if ((sectors[n].state == SECTOR_FREE || sectors[n].state == SECTOR_ERASE_NEEDED) &&
+				(best < 0 || sectors[n].eraseCount < sectors[best].eraseCount))
+			best = n;
+	}
+	if (best < 0)
+		return -1;
+
+	if (sectors[best].state == SECTOR_ERASE_NEEDED && eraseSector(best) != 0)
 		return -1;
 
-	uint32_t object_table_magic = OBJECT_TABLE_MAGIC;
-	if (driver->WriteData(0, (uint8_t *)&object_table_magic, sizeof(object_table_magic)) != 0)
+	++lastSeq;
+	if (driver->WriteData(best * driver->sector_size + offsetof(struct sectorHeader, seq), (uint8_t *) &lastSeq, sizeof(lastSeq)) != 0) {
+		sectors[best].state = SECTOR_ERASE_NEEDED;
 		return -1;
+	}
 
+	if (activeSector >= 0)
+		sectors[activeSector].state = SECTOR_USED;
+	activeSector = best;
+	sectors[best].seq = lastSeq;
+	sectors[best].state = SECTOR_ACTIVE;
 	return 0;
 }
 
 /**
- * @brief Get the address of an object
- * @param obj UAVObjHandle for that object
- * @parma instId Instance id for that object
- * @return address if successful, -1 if not found
+ * @brief Make sure a record fits in the active sector, compacting the log if needed
+ * @param[in] len Length of the record
+ * @param[in] useReserve Compaction may take the reserved sectors
+ * @return 0 if success, -1 if the log is full
  */
-static int32_t PIOS_FLASHFS_GetObjAddress(uint32_t objId, uint16_t instId)
+static int32_t reserveSpace(uint16_t len, uint8_t useReserve)
 {
-	int32_t addr = OBJECT_TABLE_START;
-	struct objectHeader header;
+	if (activeSector >= 0 && sectors[activeSector].used + len <= driver->sector_size)
+		return 0;
 
-	// Loop through header area while objects detect to count how many saved
-	while(addr < OBJECT_TABLE_END) {
-		// Read the instance data
-		if (driver->ReadData(addr, (uint8_t *) &header, sizeof(header)) != 0)
-			return -1;
-		if(header.objMagic != OBJ_MAGIC)
-			break; // stop searching once hit first non-object header
-		else if (header.objId == objId && header.instId == instId)
-			break;
-		addr += sizeof(header);
-	}
-
-	if (header.objId == objId && header.instId == instId)
-		return header.address;
+	if (!useReserve && numReclaimable() <= RESERVE_SECTORS)
+		compact();
 
-	return -1;
+	return allocSector(useReserve);
 }
 
 /**
- * @brief Returns an address for a new object and creates entry into object table
- * @param[in] obj Object handle for object to be saved
- * @param[in] instId The instance id of object to be saved
- * @return 0 if success or error code
- * @retval -1 Object not found
- * @retval -2 No room in object table
- * @retval -3 Unable to write entry into object table
- * @retval -4 FS not initialized
+ * @brief Reclaim a batch of sectors by moving their live records to the head of the log
+ * @return Number of sectors reclaimed
+ * @note Victims are the sectors with the most garbage, the least worn first. If the erase counts drifted
+ * apart the least worn sector is moved as well so that its static data doesn't keep
+ * it out of rotation.
  */
-int32_t PIOS_FLASHFS_GetNewAddress(uint32_t objId, uint16_t instId)
+static int32_t compact()
 {
-	struct objectHeader header;
-
-	if(numObjects < 0)
-		return -4;
-
-	// Don't worry about max size of flash chip here, other code will catch that
-	header.objMagic = OBJ_MAGIC;
-	header.objId = objId;
-	header.instId = instId;
-	header.address = OBJECT_TABLE_END + driver->sector_size * numObjects;
+	uint32_t minErase = 0xFFFFFFFF;
+	uint32_t maxErase = 0;
+	int32_t reclaimed = 0;
+	int32_t victim;
+	uint16_t n;
+
+	for (n = 0; n < numSectors; ++n) {
+		if (sectors[n].eraseCount < minErase)
+			minErase = sectors[n].eraseCount;
+		if (sectors[n].eraseCount > maxErase)
+			maxErase = sectors[n].eraseCount;
+	}
 
-	int32_t addr = OBJECT_TABLE_START + sizeof(header) * numObjects;
+	// Static wear levelling
+	if (maxErase - minErase > WEAR_THRESHOLD) {
+		victim = -1;
+		for (n = 0; n < numSectors; ++n) {
+			if (sectors[n].state == SECTOR_USED &&
+					(victim < 0 || sectors[n].eraseCount < sectors[victim].eraseCount))
+				victim = n;
+		}
+		if (victim >= 0 && sectors[victim].eraseCount == minErase && relocateSector(victim) == 0)
+			++reclaimed;
+	}
 
-	// No room for this header in object table
-	if((addr + sizeof(header)) > OBJECT_TABLE_END)
-		return -2;
+	while (numReclaimable() < RESERVE_SECTORS + COMPACT_BATCH) {
+		victim = -1;
+		for (n = 0; n < numSectors; ++n) {
+			if (sectors[n].state == SECTOR_USED && sectors[n].live < sectors[n].used - sizeof(struct sectorHeader) &&
+					(victim < 0 || sectors[n].live < sectors[victim].live ||
+					(sectors[n].live == sectors[victim].live && sectors[n].eraseCount < sectors[victim].eraseCount)))
+				victim = n;
+		}
 
-	if(driver->WriteData(addr, (uint8_t *) &header, sizeof(header)) != 0)
-		return -3;
+		// Nothing left to gain
+		if (victim < 0 || relocateSector(victim) != 0)
+			break;
+		++reclaimed;
+	}
 
-	// This numObejcts value must stay consistent or there will be a break in the table
-	// and later the table will have bad values in it
-	numObjects++;
-	return header.address;
+	return reclaimed;
 }
 
-
 /**
- * @brief Saves one object instance per sector
- * @param[in] obj UAVObjHandle the object to save
- * @param[in] instId The instance of the object to save
- * @return 0 if success or -1 if failure
- * @note This uses one sector on the flash chip per object so that no buffering in ram
- * must be done when erasing the sector before a save
+ * @brief Copy the live records of a sector to the head of the log and erase it
+ * @return 0 if success, -1 if not
  */
-int32_t PIOS_FLASHFS_ObjSave(UAVObjHandle obj, uint16_t instId, uint8_t * data)
+static int32_t relocateSector(uint16_t sector)
 {
-	uint32_t objId = UAVObjGetID(obj);
-	uint8_t crc = 0;
-
-	int32_t addr = PIOS_FLASHFS_GetObjAddress(objId, instId);
+	uint32_t base = sector * driver->sector_size;
+	uint16_t n;
 
-	// Object currently not saved
-	if(addr < 0)
-		addr = PIOS_FLASHFS_GetNewAddress(objId, instId);
+	for (n = 0; n < numObjects && sectors[sector].live > 0; ++n) {
+		if (objects[n].addr >= base && objects[n].addr < base + driver->sector_size) {
+			if (reserveSpace(recordLength(objects[n].size), 1) != 0 || copyRecord(&objects[n]) != 0)
+				return -1;
+		}
+	}
 
-	// Could not allocate a sector
-	if(addr < 0)
-		return -1;
+	return eraseSector(sector);
+}
 
-	struct fileHeader header = {
-		.id = objId,
-		.instId = instId,
-		.size = UAVObjGetNumBytes(obj)
+/**
+ * @brief Write a record at the end of the active sector and point the index entry at it
+ * @return 0 if success, -1 if not
+ * @note The commit byte is written last, a record cut by a reset is ignored at init
+ */
+static int32_t appendRecord(struct objectEntry *entry, uint32_t objId, uint16_t instId, uint16_t size, uint8_t *data)
+{
+	uint32_t addr = activeSector * driver->sector_size + sectors[activeSector].used;
+	struct recordHeader header = {
+		.magic = RECORD_MAGIC,
+		.size = size,
+		.objId = objId,
+		.instId = instId
 	};
+	uint8_t crc;
+	uint8_t commit = RECORD_COMMIT;
 
-	if(driver->EraseSector(addr) != 0)
-		return -2;
+	// Whatever happens the space is used now
+	sectors[activeSector].used += recordLength(size);
 
-	// Save header
-	// This information IS redundant with the object table id.  Oh well.  Better safe than sorry.
-	if(driver->WriteData(addr, (uint8_t *) &header, sizeof(header)) != 0)
-		return -3;
-
-	// Update CRC
 	crc = PIOS_CRC_updateCRC(0, (uint8_t *) &header, sizeof(header));
+	crc = PIOS_CRC_updateCRC(crc, data, size);
 
-	// Save data
-	if(driver->WriteData(addr + sizeof(header), data, UAVObjGetNumBytes(obj)) != 0)
-		return -4;
+	if (flashWrite(addr, (uint8_t *) &header, sizeof(header)) != 0 ||
+			flashWrite(addr + sizeof(header), data, size) != 0 ||
+			flashWrite(addr + sizeof(header) + size, &crc, sizeof(crc)) != 0 ||
+			flashWrite(addr + sizeof(header) + size + sizeof(crc), &commit, sizeof(commit)) != 0)
+		return -1;
 
-	// Update CRC
-	crc = PIOS_CRC_updateCRC(crc, (uint8_t *) data, UAVObjGetNumBytes(obj));
+	updateEntry(entry, addr, size);
+	return 0;
+}
 
-	// Save CRC (written so will work when CRC changes to uint16)
-	if(driver->WriteData(addr + sizeof(header) + UAVObjGetNumBytes(obj), (uint8_t *) &crc, sizeof(crc)) != 0)
-		return -4;
+/**
+ * @brief Copy a record to the end of the active sector
+ * @return 0 if success, -1 if not
+ */
+static int32_t copyRecord(struct objectEntry *entry)
+{
+	uint16_t len = recordLength(entry->size);
+	uint32_t addr = activeSector * driver->sector_size + sectors[activeSector].used;
+	uint8_t buffer[COPY_CHUNK];
+	uint16_t chunk;
+	uint16_t n;
+
+	sectors[activeSector].used += len;
+
+	// Everything but the commit byte, which is written last
+	for (n = 0; n < len - 1; n += chunk) {
+		chunk = (len - 1 - n < COPY_CHUNK) ? len - 1 - n : COPY_CHUNK;
+		if (driver->ReadData(entry->addr + n, buffer, chunk) != 0 ||
+				flashWrite(addr + n, buffer, chunk) != 0)
+			return -1;
+	}
+	buffer[0] = RECORD_COMMIT;
+	if (flashWrite(addr + len - 1, buffer, 1) != 0)
+		return -1;
 
+	updateEntry(entry, addr, entry->size);
 	return 0;
 }
 
 /**
- * @brief Load one object instance per sector
- * @param[in] obj UAVObjHandle the object to save
- * @param[in] instId The instance of the object to save
- * @return 0 if success or error code
- * @retval -1 if object not in file table
- * @retval -2 if unable to retrieve object header
- * @retval -3 if loaded data instId or objId don't match
- * @retval -4 if unable to retrieve instance data
- * @retval -5 if unable to read CRC
- * @retval -6 if CRC doesn't match
- * @note This uses one sector on the flash chip per object so that no buffering in ram
- * must be done when erasing the sector before a save
+ * @brief Write data split at the page boundaries of the chip
+ * @return 0 if success, -1 if not
  */
-int32_t PIOS_FLASHFS_ObjLoad(UAVObjHandle obj, uint16_t instId, uint8_t * data)
+static int32_t flashWrite(uint32_t addr, uint8_t *data, uint32_t len)
 {
-	uint32_t objId = UAVObjGetID(obj);
-	uint16_t objSize = UAVObjGetNumBytes(obj);
-	uint8_t crc = 0;
-	uint8_t crcFlash = 0;
-	const uint8_t crc_read_step = 8;
-	uint8_t crc_read_buffer[crc_read_step];
+	uint32_t chunk;
 
-	int32_t addr = PIOS_FLASHFS_GetObjAddress(objId, instId);
+	while (len > 0) {
+		chunk = PAGE_SIZE - (addr % PAGE_SIZE);
+		if (chunk > len)
+			chunk = len;
+		if (driver->WriteData(addr, data, chunk) != 0)
+			return -1;
+		addr += chunk;
+		data += chunk;
+		len -= chunk;
+	}
 
-	// Object currently not saved
-	if(addr < 0)
-		return -1;
+	return 0;
+}
 
-	struct fileHeader header;
+/**
+ * @brief Find the index entry of an object instance
+ * @return The entry or NULL if the instance is not saved
+ */
+static struct objectEntry *findEntry(uint32_t objId, uint16_t instId)
+{
+	uint16_t n;
 
-	// Load header
-	// This information IS redundant with the object table id.  Oh well.  Better safe than sorry.
-	if(driver->ReadData(addr, (uint8_t *) &header, sizeof(header)) != 0)
-		return -2;
+	for (n = 0; n < numObjects; ++n) {
+		if (objects[n].objId == objId && objects[n].instId == instId)
+			return &objects[n];
+	}
 
-	// Update CRC
-	crc = PIOS_CRC_updateCRC(0, (uint8_t *) &header, sizeof(header));
+	return NULL;
+}
 
-	if((header.id != objId) || (header.instId != instId))
-		return -3;
+/**
+ * @brief Add an index entry, it has no record until updateEntry is called
+ * @return The entry or NULL if the index is full
+ */
+static struct objectEntry *newEntry(uint32_t objId, uint16_t instId)
+{
+	struct objectEntry *entry;
 
-	// To avoid having to allocate the RAM for a copy of the object, we read by chunks
-	// and compute the CRC
-	for(uint32_t i = 0; i < objSize; i += crc_read_step) {
-		driver->ReadData(addr + sizeof(header) + i, crc_read_buffer, crc_read_step);
-		uint8_t valid_bytes = ((i + crc_read_step) >= objSize) ? objSize - i : crc_read_step;
-		crc = PIOS_CRC_updateCRC(crc, crc_read_buffer, valid_bytes);
-	}
+	if (numObjects >= PIOS_FLASHFS_MAX_OBJECTS)
+		return NULL;
 
-	// Read CRC (written so will work when CRC changes to uint16)
-	if(driver->ReadData(addr + sizeof(header) + objSize, (uint8_t *) &crcFlash, sizeof(crcFlash)) != 0)
-		return -5;
+	entry = &objects[numObjects++];
+	entry->objId = objId;
+	entry->instId = instId;
+	entry->addr = 0;
+	entry->size = 0;
+	return entry;
+}
 
-	if(crc != crcFlash)
-		return -6;
+/**
+ * @brief Point an index entry at a new record, the old record becomes garbage
+ */
+static void updateEntry(struct objectEntry *entry, uint32_t addr, uint16_t size)
+{
+	if (entry->addr != 0)
+		sectors[entry->addr / driver->sector_size].live -= recordLength(entry->size);
 
-	// Read the instance data
-	if (driver->ReadData(addr + sizeof(header), data, UAVObjGetNumBytes(obj)) != 0)
-		return -4;
+	entry->addr = addr;
+	entry->size = size;
+	sectors[addr / driver->sector_size].live += recordLength(size);
+}
 
-	return 0;
+/**
+ * @brief Length of a record on flash
+ */
+static uint16_t recordLength(uint16_t size)
+{
+	return sizeof(struct recordHeader) + size + sizeof(uint8_t) + sizeof(uint8_t);
 }
 
 /**
- * @brief Delete object from flash
- * @param[in] obj UAVObjHandle the object to save
- * @param[in] instId The instance of the object to save
- * @return 0 if success or error code
- * @retval -1 if object not in file table
- * @retval -2 Erase failed
- * @note To avoid buffering the file table (1k ram!) the entry in the file table
- * remains but destination sector is erased.  This will make the load fail as the
- * file header won't match the object.  At next save it goes back there.
+ * @brief Check for erased flash, 0xFF on NOR flash and 0x00 on the EEPROM
+ * @return 1 if all bytes read as erased, 0 if anything was programmed
  */
-int32_t PIOS_FLASHFS_ObjDelete(UAVObjHandle obj, uint16_t instId)
+static uint8_t isErased(uint8_t *data, uint16_t len)
 {
-	uint32_t objId = UAVObjGetID(obj);
+	uint16_t n;
 
-	int32_t addr = PIOS_FLASHFS_GetObjAddress(objId, instId);
+	for (n = 1; n < len; ++n) {
+		if (data[n] != data[0])
+			return 0;
+	}
 
-	// Object currently not saved
-	if(addr < 0)
-		return -1;
+	return data[0] == 0xFF || data[0] == 0x00;
+}
 
-	if(driver->EraseSector(addr) != 0)
-		return -2;
+/**
+ * @brief Number of sectors that can take the log without compaction
+ */
+static uint16_t numReclaimable()
+{
+	uint16_t count = 0;
+	uint16_t n;
 
-	return 0;
+	for (n = 0; n < numSectors; ++n) {
+		if (sectors[n].state == SECTOR_FREE || sectors[n].state == SECTOR_ERASE_NEEDED)
+			++count;
+	}
+
+	return count;
 }
+
+/**
+ * @}
+ * @}
+ */
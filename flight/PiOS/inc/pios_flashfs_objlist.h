@@ -3,7 +3,7 @@
  *
  * @addtogroup PIOS PIOS Core hardware abstraction layer
  * @{
- * @addtogroup PIOS_FLASHFS_OBJLIST Object list based flash filesystem (low ram)
+ * @addtogroup PIOS_FLASHFS_OBJLIST Log structured flash filesystem for objects
  * @{
  *
  * @file       pios_flashfs_objlist.h
@@ -34,8 +34,18 @@
 #include "openpilot.h"
 #include "uavobjectmanager.h"
 
+/* Size of the RAM index (12 bytes per object instance) and the number of sectors
+ * used (16 bytes each), set them for the chip and the settings of the board in pios_config.h */
+#ifndef PIOS_FLASHFS_MAX_OBJECTS
+#define PIOS_FLASHFS_MAX_OBJECTS	48
+#endif
+#ifndef PIOS_FLASHFS_MAX_SECTORS
+#define PIOS_FLASHFS_MAX_SECTORS	32
+#endif
+
 typedef struct {
 	uint32_t	sector_size;
+	uint32_t	chip_size;
 	int8_t		(* EraseSector)(uint32_t addr);
 	int8_t		(* EraseChip)(void);
 	int8_t		(* WriteData)(uint32_t addr, uint8_t *data, uint16_t len);
@@ -44,6 +54,7 @@ typedef struct {
 
 int32_t PIOS_FLASHFS_Init(PIOS_FLASHFS_Driver *withDriver);
 int32_t PIOS_FLASHFS_Format();
+int32_t PIOS_FLASHFS_IsMounted();
 int32_t PIOS_FLASHFS_ObjSave(UAVObjHandle obj, uint16_t instId, uint8_t * data);
 int32_t PIOS_FLASHFS_ObjLoad(UAVObjHandle obj, uint16_t instId, uint8_t * data);
 int32_t PIOS_FLASHFS_ObjDelete(UAVObjHandle obj, uint16_t instId);
@@ -40,7 +40,10 @@
 #endif /* PIOS_EVENTDISPATCHER_STACK_SIZE */
 
 #define TASK_PRIORITY (tskIDLE_PRIORITY + 3)
+#define BACKGROUND_TASK_PRIORITY (tskIDLE_PRIORITY + 1)
 #define MAX_UPDATE_PERIOD_MS 1000
+#define HASH_TABLE_SIZE 32 /** Buckets of the lookup table of periodic entries, power of two */
+#define MIN_HEAP_SIZE 16 /** Initial capacity of the deadline heap, doubled when full */
 
 // Private types
 
@@ -52,32 +55,56 @@ typedef struct {
 	UAVObjEvent ev; /** The actual event */
 	UAVObjEventCallback cb; /** The callback function, or zero if none */
 	xQueueHandle queue; /** The queue or zero if none */
+	portTickType dispatchTime; /** Time the event was pushed in the queue of its lane */
 } EventCallbackInfo;
 
 /**
  * List of object properties that are needed for the periodic updates.
+ * Entries are found through a hash table and, while their period is not zero,
+ * scheduled in a min-heap ordered by the time of their next update.
  */
 struct PeriodicObjectListStruct {
 	EventCallbackInfo evInfo; /** Event callback information */
     int32_t updatePeriodMs; /** Update period in ms or 0 if no periodic updates are needed */
-    int32_t timeToNextUpdateMs; /** Time delay to the next update */
-    struct PeriodicObjectListStruct* next; /** Needed by linked list library (utlist.h) */
+    int32_t timeToNextUpdateMs; /** System time of the next update */
+    int32_t heapIndex; /** Position in the deadline heap or -1 if not scheduled */
+    uint8_t priority; /** Lane the callback runs on, high priority callbacks are invoked directly */
+    struct PeriodicObjectListStruct* next; /** Next entry in the same hash table bucket */
 };
 typedef struct PeriodicObjectListStruct PeriodicObjectList;
 
 // Private variables
-static PeriodicObjectList* objList;
-static xQueueHandle queue;
+static PeriodicObjectList* objTable[HASH_TABLE_SIZE];
+static PeriodicObjectList** heap;
+static int32_t heapSize;
+static int32_t heapCapacity;
+static volatile int32_t timeToNextUpdateMs; /** System time the event task processes the periodic updates next */
+static xQueueHandle laneQueues[EVENT_NUM_PRIORITIES];
 static xTaskHandle eventTaskHandle;
+#if defined(PIOS_EVENTDISPATCHER_BACKGROUND_LANE)
+static xTaskHandle backgroundTaskHandle;
+#endif
 static xSemaphoreHandle mutex;
 static EventStats stats;
 
 // Private functions
 static int32_t processPeriodicUpdates();
 static void eventTask();
-static int32_t eventPeriodicCreate(UAVObjEvent* ev, UAVObjEventCallback cb, xQueueHandle queue, int32_t periodMs);
+#if defined(PIOS_EVENTDISPATCHER_BACKGROUND_LANE)
+static void backgroundTask();
+#endif
+static int32_t selectLane(int32_t priority);
+static int32_t dispatchToLane(EventCallbackInfo* evInfo, int32_t priority);
+static void invokeCallback(EventCallbackInfo* evInfo, int32_t priority);
+static int32_t eventPeriodicCreate(UAVObjEvent* ev, UAVObjEventCallback cb, xQueueHandle queue, int32_t periodMs, int32_t priority);
 static int32_t eventPeriodicUpdate(UAVObjEvent* ev, UAVObjEventCallback cb, xQueueHandle queue, int32_t periodMs);
 static uint32_t randomizePeriod(uint32_t periodMs);
+static uint32_t hashEntry(UAVObjEvent* ev, UAVObjEventCallback cb, xQueueHandle queue);
+static PeriodicObjectList* findEntry(UAVObjEvent* ev, UAVObjEventCallback cb, xQueueHandle queue);
+static int32_t schedule(PeriodicObjectList* objEntry, int32_t timeNow);
+static void heapRemove(PeriodicObjectList* objEntry);
+static void heapSiftUp(int32_t idx);
+static void heapSiftDown(int32_t idx);
 
 
 /**
@@ -87,7 +114,11 @@ static uint32_t randomizePeriod(uint32_t periodMs);
 int32_t EventDispatcherInitialize()
 {
 	// Initialize variables
-	objList = NULL;
+	memset(objTable, 0, sizeof(objTable));
+	heap = NULL;
+	heapSize = 0;
+	heapCapacity = 0;
+	timeToNextUpdateMs = 0;
 	memset(&stats, 0, sizeof(EventStats));
 
 	// Create mutex
@@ -95,11 +126,20 @@ int32_t EventDispatcherInitialize()
 	if (mutex == NULL)
 		return -1;
 
-	// Create event queue
-	queue = xQueueCreate(MAX_QUEUE_SIZE, sizeof(EventCallbackInfo));
+	// Create event queues, one for each lane. Boards without the background lane
+	// run every callback on the high priority lane.
+	laneQueues[EVENT_PRIORITY_HIGH] = xQueueCreate(MAX_QUEUE_SIZE, sizeof(EventCallbackInfo));
+#if defined(PIOS_EVENTDISPATCHER_BACKGROUND_LANE)
+	laneQueues[EVENT_PRIORITY_BACKGROUND] = xQueueCreate(MAX_QUEUE_SIZE, sizeof(EventCallbackInfo));
+#else
+	laneQueues[EVENT_PRIORITY_BACKGROUND] = NULL;
+#endif
 
-	// Create task
+	// Create tasks
 	xTaskCreate( eventTask, (signed char*)"Event", STACK_SIZE, NULL, TASK_PRIORITY, &eventTaskHandle );
+#if defined(PIOS_EVENTDISPATCHER_BACKGROUND_LANE)
+	xTaskCreate( backgroundTask, (signed char*)"EventBg", STACK_SIZE, NULL, BACKGROUND_TASK_PRIORITY, &backgroundTaskHandle );
+#endif
 
 	// Done
 	return 0;
@@ -111,9 +151,16 @@ int32_t EventDispatcherInitialize()
  */
 void EventGetStats(EventStats* statsOut)
 {
+	int32_t n;
 	xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+	taskENTER_CRITICAL();
 	memcpy(statsOut, &stats, sizeof(EventStats));
+	taskEXIT_CRITICAL();
 	xSemaphoreGiveRecursive(mutex);
+	for (n = 0; n < EVENT_NUM_PRIORITIES; ++n)
+	{
+		statsOut->lanes[n].queueDepth = (laneQueues[n] != NULL) ? uxQueueMessagesWaiting(laneQueues[n]) : 0;
+	}
 }
 
 /**
@@ -122,30 +169,47 @@ void EventGetStats(EventStats* statsOut)
 void EventClearStats()
 {
 	xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+	taskENTER_CRITICAL();
 	memset(&stats, 0, sizeof(EventStats));
+	taskEXIT_CRITICAL();
 	xSemaphoreGiveRecursive(mutex);
 }
 
 /**
  * Dispatch an event by invoking the supplied callback. The function
- * returns imidiatelly, the callback is invoked from the event task.
+ * returns imidiatelly, the callback is invoked from the high priority event task.
  * \param[in] ev The event to be dispatched
  * \param[in] cb The callback function
  * \return Success (0), failure (-1)
  */
 int32_t EventCallbackDispatch(UAVObjEvent* ev, UAVObjEventCallback cb)
+{
+	return EventCallbackDispatchPriority(ev, cb, EVENT_PRIORITY_HIGH);
+}
+
+/**
+ * Dispatch an event by invoking the supplied callback. The function
+ * returns imidiatelly, the callback is invoked from the event task of the selected lane.
+ * \param[in] ev The event to be dispatched
+ * \param[in] cb The callback function
+ * \param[in] priority The lane, EVENT_PRIORITY_HIGH or EVENT_PRIORITY_BACKGROUND
+ * \return Success (0), failure (-1)
+ */
+int32_t EventCallbackDispatchPriority(UAVObjEvent* ev, UAVObjEventCallback cb, int32_t priority)
 {
 	EventCallbackInfo evInfo;
+	if (priority < 0 || priority >= EVENT_NUM_PRIORITIES)
+		return -1;
 	// Initialize event callback information
 	memcpy(&evInfo.ev, ev, sizeof(UAVObjEvent));
 	evInfo.cb = cb;
 	evInfo.queue = 0;
 	// Push to queue
-	return xQueueSend(queue, &evInfo, 0); // will not block if queue is full
+	return dispatchToLane(&evInfo, selectLane(priority));
 }
 
 /**
- * Dispatch an event at periodic intervals.
+ * Dispatch an event at periodic intervals, the callback is invoked from the high priority event task.
  * \param[in] ev The event to be dispatched
  * \param[in] cb The callback to be invoked
  * \param[in] periodMs The period the event is generated
@@ -153,7 +217,22 @@ int32_t EventCallbackDispatch(UAVObjEvent* ev, UAVObjEventCallback cb)
  */
 int32_t EventPeriodicCallbackCreate(UAVObjEvent* ev, UAVObjEventCallback cb, int32_t periodMs)
 {
-	return eventPeriodicCreate(ev, cb, 0, periodMs);
+	return eventPeriodicCreate(ev, cb, 0, periodMs, EVENT_PRIORITY_HIGH);
+}
+
+/**
+ * Dispatch an event at periodic intervals, the callback is invoked from the event task of the selected lane.
+ * \param[in] ev The event to be dispatched
+ * \param[in] cb The callback to be invoked
+ * \param[in] periodMs The period the event is generated
+ * \param[in] priority The lane, EVENT_PRIORITY_HIGH or EVENT_PRIORITY_BACKGROUND
+ * \return Success (0), failure (-1)
+ */
+int32_t EventPeriodicCallbackCreatePriority(UAVObjEvent* ev, UAVObjEventCallback cb, int32_t periodMs, int32_t priority)
+{
+	if (priority < 0 || priority >= EVENT_NUM_PRIORITIES)
+		return -1;
+	return eventPeriodicCreate(ev, cb, 0, periodMs, selectLane(priority));
 }
 
 /**
@@ -177,7 +256,7 @@ int32_t EventPeriodicCallbackUpdate(UAVObjEvent* ev, UAVObjEventCallback cb, int
  */
 int32_t EventPeriodicQueueCreate(UAVObjEvent* ev, xQueueHandle queue, int32_t periodMs)
 {
-	return eventPeriodicCreate(ev, 0, queue, periodMs);
+	return eventPeriodicCreate(ev, 0, queue, periodMs, EVENT_PRIORITY_HIGH);
 }
 
 /**
@@ -198,39 +277,48 @@ int32_t EventPeriodicQueueUpdate(UAVObjEvent* ev, xQueueHandle queue, int32_t pe
  * \param[in] cb The callback to be invoked or zero if none
  * \param[in] queue The queue or zero if none
  * \param[in] periodMs The period the event is generated
+ * \param[in] priority The lane of the callback
  * \return Success (0), failure (-1)
  */
-static int32_t eventPeriodicCreate(UAVObjEvent* ev, UAVObjEventCallback cb, xQueueHandle queue, int32_t periodMs)
+static int32_t eventPeriodicCreate(UAVObjEvent* ev, UAVObjEventCallback cb, xQueueHandle queue, int32_t periodMs, int32_t priority)
 {
 	PeriodicObjectList* objEntry;
+	uint32_t hash;
 	// Get lock
 	xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 	// Check that the object is not already connected
-	LL_FOREACH(objList, objEntry)
+	if (findEntry(ev, cb, queue) != NULL)
 	{
-		if (objEntry->evInfo.cb == cb &&
-			objEntry->evInfo.queue == queue &&
-			objEntry->evInfo.ev.obj == ev->obj &&
-			objEntry->evInfo.ev.instId == ev->instId &&
-			objEntry->evInfo.ev.event == ev->event)
-		{
-			// Already registered, do nothing
-			xSemaphoreGiveRecursive(mutex);
-			return -1;
-		}
+		// Already registered, do nothing
+		xSemaphoreGiveRecursive(mutex);
+		return -1;
 	}
     // Create handle
 	objEntry = (PeriodicObjectList*)pvPortMalloc(sizeof(PeriodicObjectList));
-	if (objEntry == NULL) return -1;
+	if (objEntry == NULL)
+	{
+		xSemaphoreGiveRecursive(mutex);
+		return -1;
+	}
 	objEntry->evInfo.ev.obj = ev->obj;
 	objEntry->evInfo.ev.instId = ev->instId;
 	objEntry->evInfo.ev.event = ev->event;
 	objEntry->evInfo.cb = cb;
 	objEntry->evInfo.queue = queue;
     objEntry->updatePeriodMs = periodMs;
-    objEntry->timeToNextUpdateMs = randomizePeriod(periodMs); // avoid bunching of updates
-    // Add to list
-    LL_APPEND(objList, objEntry);
+    objEntry->heapIndex = -1;
+    objEntry->priority = priority;
+    // Add to lookup table
+    hash = hashEntry(ev, cb, queue);
+    objEntry->next = objTable[hash];
+    objTable[hash] = objEntry;
+    // Schedule first update
+    if (schedule(objEntry, xTaskGetTickCount()*portTICK_RATE_MS) != 0)
+    {
+    	objEntry->updatePeriodMs = 0;
+    	xSemaphoreGiveRecursive(mutex);
+    	return -1;
+    }
 	// Release lock
 	xSemaphoreGiveRecursive(mutex);
     return 0;
@@ -247,36 +335,31 @@ static int32_t eventPeriodicCreate(UAVObjEvent* ev, UAVObjEventCallback cb, xQue
 static int32_t eventPeriodicUpdate(UAVObjEvent* ev, UAVObjEventCallback cb, xQueueHandle queue, int32_t periodMs)
 {
 	PeriodicObjectList* objEntry;
+	int32_t retval;
 	// Get lock
 	xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 	// Find object
-	LL_FOREACH(objList, objEntry)
+	objEntry = findEntry(ev, cb, queue);
+	if (objEntry == NULL)
 	{
-		if (objEntry->evInfo.cb == cb &&
-			objEntry->evInfo.queue == queue &&
-			objEntry->evInfo.ev.obj == ev->obj &&
-			objEntry->evInfo.ev.instId == ev->instId &&
-			objEntry->evInfo.ev.event == ev->event)
-		{
-			// Object found, update period
-			objEntry->updatePeriodMs = periodMs;
-			objEntry->timeToNextUpdateMs = randomizePeriod(periodMs); // avoid bunching of updates
-			// Release lock
-			xSemaphoreGiveRecursive(mutex);
-			return 0;
-		}
+		// If this point is reached the object was not found
+		xSemaphoreGiveRecursive(mutex);
+		return -1;
 	}
-    // If this point is reached the object was not found
+	// Object found, update period and reschedule
+	objEntry->updatePeriodMs = periodMs;
+	retval = schedule(objEntry, xTaskGetTickCount()*portTICK_RATE_MS);
+	// Release lock
 	xSemaphoreGiveRecursive(mutex);
-    return -1;
+	return retval;
 }
 
 /**
- * Event task, responsible of invoking callbacks.
+ * Event task of the high priority lane, responsible of invoking callbacks and
+ * timing the periodic events.
  */
 static void eventTask()
 {
-	int32_t timeToNextUpdateMs;
 	int32_t delayMs;
 	EventCallbackInfo evInfo;
 
@@ -294,20 +377,91 @@ static void eventTask()
 		}
 
 		// Wait for queue message
-		if ( xQueueReceive(queue, &evInfo, delayMs/portTICK_RATE_MS) == pdTRUE )
+		if ( xQueueReceive(laneQueues[EVENT_PRIORITY_HIGH], &evInfo, delayMs/portTICK_RATE_MS) == pdTRUE )
 		{
-			// Invoke callback, if one
-			if ( evInfo.cb != 0)
-			{
-				evInfo.cb(&evInfo.ev); // the function is expected to copy the event information
-			}
+			invokeCallback(&evInfo, EVENT_PRIORITY_HIGH);
 		}
 
 		// Process periodic updates
 		if ((xTaskGetTickCount()*portTICK_RATE_MS) >= timeToNextUpdateMs )
 		{
-			timeToNextUpdateMs = processPeriodicUpdates();
+			processPeriodicUpdates();
+		}
+	}
+}
+
+#if defined(PIOS_EVENTDISPATCHER_BACKGROUND_LANE)
+/**
+ * Event task of the background lane, responsible of invoking callbacks.
+ */
+static void backgroundTask()
+{
+	EventCallbackInfo evInfo;
+
+	// Loop forever
+	while (1)
+	{
+		// Wait for queue message
+		if ( xQueueReceive(laneQueues[EVENT_PRIORITY_BACKGROUND], &evInfo, portMAX_DELAY) == pdTRUE )
+		{
+			invokeCallback(&evInfo, EVENT_PRIORITY_BACKGROUND);
+		}
+	}
+}
+#endif
+
+/**
+ * Map a requested priority to the lane that serves it, the background lane
+ * only exists on boards that define PIOS_EVENTDISPATCHER_BACKGROUND_LANE.
+ */
+static int32_t selectLane(int32_t priority)
+{
+#if defined(PIOS_EVENTDISPATCHER_BACKGROUND_LANE)
+	return priority;
+#else
+	return EVENT_PRIORITY_HIGH;
+#endif
+}
+
+/**
+ * Push an event in the queue of a lane and update the queue depth statistics.
+ * \return pdTRUE on success, the queue send result otherwise
+ */
+static int32_t dispatchToLane(EventCallbackInfo* evInfo, int32_t priority)
+{
+	int32_t res;
+	uint16_t depth;
+
+	evInfo->dispatchTime = xTaskGetTickCount();
+	res = xQueueSend(laneQueues[priority], evInfo, 0); // will not block if queue is full
+	depth = uxQueueMessagesWaiting(laneQueues[priority]);
+	taskENTER_CRITICAL();
+	if (depth > stats.lanes[priority].maxQueueDepth)
+	{
+		stats.lanes[priority].maxQueueDepth = depth;
+	}
+	taskEXIT_CRITICAL();
+	return res;
+}
+
+/**
+ * Invoke the callback of an event taken from the queue of a lane and update the latency statistics.
+ */
+static void invokeCallback(EventCallbackInfo* evInfo, int32_t priority)
+{
+	uint32_t latencyMs;
+
+	// Invoke callback, if one (empty messages only wake up the task)
+	if ( evInfo->cb != 0)
+	{
+		latencyMs = (xTaskGetTickCount() - evInfo->dispatchTime)*portTICK_RATE_MS;
+		taskENTER_CRITICAL();
+		if (latencyMs > stats.lanes[priority].maxLatencyMs)
+		{
+			stats.lanes[priority].maxLatencyMs = latencyMs;
 		}
+		taskEXIT_CRITICAL();
+		evInfo->cb(&evInfo->ev); // the function is expected to copy the event information
 	}
 }
 
@@ -325,43 +479,46 @@ static int32_t processPeriodicUpdates()
 	// Get lock
 	xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 
-    // Iterate through each object and update its timer, if zero then transmit object.
-    // Also calculate smallest delay to next update.
-    timeToNextUpdate = xTaskGetTickCount()*portTICK_RATE_MS + MAX_UPDATE_PERIOD_MS;
-    LL_FOREACH(objList, objEntry)
+    // Take due objects from the top of the heap, reset their timer and transmit them.
+    // Objects that are not due are not touched.
+    timeNow = xTaskGetTickCount()*portTICK_RATE_MS;
+    while (heapSize > 0 && heap[0]->timeToNextUpdateMs - timeNow <= 0)
     {
-        // If object is configured for periodic updates
-        if (objEntry->updatePeriodMs > 0)
-        {
-            // Check if time for the next update
-        	timeNow = xTaskGetTickCount()*portTICK_RATE_MS;
-            if (objEntry->timeToNextUpdateMs <= timeNow)
-            {
-                // Reset timer
-            	offset = ( timeNow - objEntry->timeToNextUpdateMs ) % objEntry->updatePeriodMs;
-            	objEntry->timeToNextUpdateMs = timeNow + objEntry->updatePeriodMs - offset;
-    			// Invoke callback, if one
-    			if ( objEntry->evInfo.cb != 0)
-    			{
-    				objEntry->evInfo.cb(&objEntry->evInfo.ev); // the function is expected to copy the event information
-    			}
-    			// Push event to queue, if one
-    			if ( objEntry->evInfo.queue != 0)
-    			{
-    				if ( xQueueSend(objEntry->evInfo.queue, &objEntry->evInfo.ev, 0) != pdTRUE ) // do not block if queue is full
-    				{
-    					++stats.eventErrors;
-    				}
-    			}
-            }
-            // Update minimum delay
-            if (objEntry->timeToNextUpdateMs < timeToNextUpdate)
-            {
-            	timeToNextUpdate = objEntry->timeToNextUpdateMs;
-            }
-        }
+    	objEntry = heap[0];
+        // Reset timer
+    	offset = ( timeNow - objEntry->timeToNextUpdateMs ) % objEntry->updatePeriodMs;
+    	objEntry->timeToNextUpdateMs = timeNow + objEntry->updatePeriodMs - offset;
+    	heapSiftDown(0);
+		// Invoke callback, if one, background callbacks are passed to their lane
+		if ( objEntry->evInfo.cb != 0)
+		{
+			if ( objEntry->priority == EVENT_PRIORITY_HIGH )
+			{
+				objEntry->evInfo.cb(&objEntry->evInfo.ev); // the function is expected to copy the event information
+			}
+			else if ( dispatchToLane(&objEntry->evInfo, objEntry->priority) != pdTRUE )
+			{
+				++stats.eventErrors;
+			}
+		}
+		// Push event to queue, if one
+		if ( objEntry->evInfo.queue != 0)
+		{
+			if ( xQueueSend(objEntry->evInfo.queue, &objEntry->evInfo.ev, 0) != pdTRUE ) // do not block if queue is full
+			{
+				++stats.eventErrors;
+			}
+		}
     }
 
+    // The next update is the one on top of the heap
+    timeToNextUpdate = timeNow + MAX_UPDATE_PERIOD_MS;
+    if (heapSize > 0 && heap[0]->timeToNextUpdateMs - timeToNextUpdate < 0)
+    {
+    	timeToNextUpdate = heap[0]->timeToNextUpdateMs;
+    }
+    timeToNextUpdateMs = timeToNextUpdate;
+
     // Done
     xSemaphoreGiveRecursive(mutex);
     return timeToNextUpdate;
@@ -385,3 +542,165 @@ static uint32_t randomizePeriod(uint32_t periodMs)
 	return (uint32_t)( ((float)periodMs * (float)lo) / (float)0x7FFFFFFF );
 }
 
+/**
+ * Hash table bucket of a periodic entry
+ */
+static uint32_t hashEntry(UAVObjEvent* ev, UAVObjEventCallback cb, xQueueHandle queue)
+{
+	uint32_t hash;
+	hash = (uint32_t)(uintptr_t)ev->obj ^ (uint32_t)(uintptr_t)cb ^ (uint32_t)(uintptr_t)queue ^ ((uint32_t)ev->instId << 16) ^ (uint32_t)ev->event;
+	hash ^= hash >> 13;
+	hash *= 0x9E3779B1;
+	return (hash >> 16) & (HASH_TABLE_SIZE - 1);
+}
+
+/**
+ * Find the periodic entry of an event, must be called with the lock held
+ * \return The entry or NULL if not found
+ */
+static PeriodicObjectList* findEntry(UAVObjEvent* ev, UAVObjEventCallback cb, xQueueHandle queue)
+{
+	PeriodicObjectList* objEntry;
+	for (objEntry = objTable[hashEntry(ev, cb, queue)]; objEntry != NULL; objEntry = objEntry->next)
+	{
+		if (objEntry->evInfo.cb == cb &&
+			objEntry->evInfo.queue == queue &&
+			objEntry->evInfo.ev.obj == ev->obj &&
+			objEntry->evInfo.ev.instId == ev->instId &&
+			objEntry->evInfo.ev.event == ev->event)
+		{
+			return objEntry;
+		}
+	}
+	return NULL;
+}
+
+/**
+ * Place an entry in the deadline heap according to its period, or take it out if the
+ * period is zero. The first update is at a random time within one period to avoid
+ * bunching of updates. If the entry is due before the event task wakes up next, the
+ * task is woken up. Must be called with the lock held.
+ * \return Success (0), failure (-1) if the heap could not grow
+ */
+static int32_t schedule(PeriodicObjectList* objEntry, int32_t timeNow)
+{
+	PeriodicObjectList** newHeap;
+	EventCallbackInfo wakeup;
+
+	if (objEntry->updatePeriodMs <= 0)
+	{
+		heapRemove(objEntry);
+		return 0;
+	}
+
+	objEntry->timeToNextUpdateMs = timeNow + randomizePeriod(objEntry->updatePeriodMs);
+	if (objEntry->heapIndex < 0)
+	{
+		// Grow heap if needed
+		if (heapSize == heapCapacity)
+		{
+			newHeap = (PeriodicObjectList**)pvPortMalloc(sizeof(PeriodicObjectList*) * (heapCapacity > 0 ? heapCapacity * 2 : MIN_HEAP_SIZE));
+			if (newHeap == NULL)
+			{
+				return -1;
+			}
+			if (heap != NULL)
+			{
+				memcpy(newHeap, heap, sizeof(PeriodicObjectList*) * heapSize);
+				vPortFree(heap);
+			}
+			heap = newHeap;
+			heapCapacity = (heapCapacity > 0 ? heapCapacity * 2 : MIN_HEAP_SIZE);
+		}
+		objEntry->heapIndex = heapSize;
+		heap[heapSize++] = objEntry;
+		heapSiftUp(objEntry->heapIndex);
+	}
+	else
+	{
+		// The deadline may have moved either way
+		heapSiftUp(objEntry->heapIndex);
+		heapSiftDown(objEntry->heapIndex);
+	}
+
+	// Wake up the event task with an empty message if it would miss the update
+	if (objEntry->timeToNextUpdateMs - timeToNextUpdateMs < 0)
+	{
+		timeToNextUpdateMs = objEntry->timeToNextUpdateMs;
+		memset(&wakeup, 0, sizeof(EventCallbackInfo));
+		xQueueSend(laneQueues[EVENT_PRIORITY_HIGH], &wakeup, 0);
+	}
+	return 0;
+}
+
+/**
+ * Take an entry out of the deadline heap, if it is scheduled
+ */
+static void heapRemove(PeriodicObjectList* objEntry)
+{
+	int32_t idx = objEntry->heapIndex;
+
+	if (idx < 0)
+	{
+		return;
+	}
+	objEntry->heapIndex = -1;
+	--heapSize;
+	if (idx < heapSize)
+	{
+		// Move the last entry into the hole
+		heap[idx] = heap[heapSize];
+		heap[idx]->heapIndex = idx;
+		heapSiftUp(idx);
+		heapSiftDown(heap[idx]->heapIndex);
+	}
+}
+
+/**
+ * Move a heap entry towards the top until its parent is due earlier
+ */
+static void heapSiftUp(int32_t idx)
+{
+	PeriodicObjectList* objEntry = heap[idx];
+	int32_t parent;
+
+	while (idx > 0)
+	{
+		parent = (idx - 1) / 2;
+		if (heap[parent]->timeToNextUpdateMs - objEntry->timeToNextUpdateMs <= 0)
+		{
+			break;
+		}
+		heap[idx] = heap[parent];
+		heap[idx]->heapIndex = idx;
+		idx = parent;
+	}
+	heap[idx] = objEntry;
+	objEntry->heapIndex = idx;
+}
+
+/**
+ * Move a heap entry towards the bottom until both children are due later
+ */
+static void heapSiftDown(int32_t idx)
+{
+	PeriodicObjectList* objEntry = heap[idx];
+	int32_t child;
+
+	while ((child = 2 * idx + 1) < heapSize)
+	{
+		if (child + 1 < heapSize && heap[child + 1]->timeToNextUpdateMs - heap[child]->timeToNextUpdateMs < 0)
+		{
+			++child;
+		}
+		if (objEntry->timeToNextUpdateMs - heap[child]->timeToNextUpdateMs <= 0)
+		{
+			break;
+		}
+		heap[idx] = heap[child];
+		heap[idx]->heapIndex = idx;
+		idx = child;
+	}
+	heap[idx] = objEntry;
+	objEntry->heapIndex = idx;
+}
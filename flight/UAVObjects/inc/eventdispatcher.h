@@ -27,11 +27,33 @@
 #define EVENTDISPATCHER_H
 
 // Public types
+/**
+ * Dispatch lanes, each one has its own queue and task. The high priority lane also
+ * times the periodic events. The background lane is only created on boards that
+ * define PIOS_EVENTDISPATCHER_BACKGROUND_LANE, elsewhere its callbacks run on the
+ * high priority lane.
+ */
+typedef enum {
+	EVENT_PRIORITY_HIGH = 0, /** Control path callbacks */
+	EVENT_PRIORITY_BACKGROUND = 1 /** Slow callbacks, e.g. settings updates and logging */
+} EventPriority;
+#define EVENT_NUM_PRIORITIES 2
+
+/**
+ * Event dispatcher statistics of one lane
+ */
+typedef struct {
+	uint16_t queueDepth; /** Events waiting in the queue of the lane */
+	uint16_t maxQueueDepth; /** Largest number of events that waited in the queue */
+	uint32_t maxLatencyMs; /** Longest time from the dispatch of an event to the invocation of its callback */
+} EventLaneStats;
+
 /**
  * Event dispatcher statistics
  */
 typedef struct {
 	uint32_t eventErrors;
+	EventLaneStats lanes[EVENT_NUM_PRIORITIES];
 } EventStats;
 
 // Public functions
@@ -39,7 +61,9 @@ int32_t EventDispatcherInitialize();
 void EventGetStats(EventStats* statsOut);
 void EventClearStats();
 int32_t EventCallbackDispatch(UAVObjEvent* ev, UAVObjEventCallback cb);
+int32_t EventCallbackDispatchPriority(UAVObjEvent* ev, UAVObjEventCallback cb, int32_t priority);
 int32_t EventPeriodicCallbackCreate(UAVObjEvent* ev, UAVObjEventCallback cb, int32_t periodMs);
+int32_t EventPeriodicCallbackCreatePriority(UAVObjEvent* ev, UAVObjEventCallback cb, int32_t periodMs, int32_t priority);
 int32_t EventPeriodicCallbackUpdate(UAVObjEvent* ev, UAVObjEventCallback cb, int32_t periodMs);
 int32_t EventPeriodicQueueCreate(UAVObjEvent* ev, xQueueHandle queue, int32_t periodMs);
 int32_t EventPeriodicQueueUpdate(UAVObjEvent* ev, xQueueHandle queue, int32_t periodMs);
@@ -121,8 +121,20 @@ typedef void (*UAVObjInitializeCallback)(UAVObjHandle obj, uint16_t instId);
  */
 typedef struct {
 	uint32_t eventErrors;
+	uint32_t eventsCoalesced;
 } UAVObjStats;
 
+/**
+ * Private copy of the data of an object, for tasks that read settings on every cycle.
+ * UAVObjSnapshotUpdate() copies the data again only when the object was written.
+ */
+typedef struct {
+	UAVObjHandle obj;
+	void* data; /** Copy of the data of instance 0, owned by the caller */
+	uint32_t seq; /** Sequence counter of the object when the data was copied */
+	uint32_t version; /** Number of copies made, changes every time the data is refreshed */
+} UAVObjSnapshot;
+
 int32_t UAVObjInitialize();
 void UAVObjGetStats(UAVObjStats* statsOut);
 void UAVObjClearStats();
@@ -160,12 +172,17 @@ int32_t UAVObjSetInstanceData(UAVObjHandle obj, uint16_t instId, const void* dat
 int32_t UAVObjSetInstanceDataField(UAVObjHandle obj, uint16_t instId, const void* dataIn, uint32_t offset, uint32_t size);
 int32_t UAVObjGetInstanceData(UAVObjHandle obj, uint16_t instId, void* dataOut);
 int32_t UAVObjGetInstanceDataField(UAVObjHandle obj, uint16_t instId, void* dataOut, uint32_t offset, uint32_t size);
+int32_t UAVObjSnapshotInit(UAVObjHandle obj, UAVObjSnapshot* snap, void* data);
+int32_t UAVObjSnapshotUpdate(UAVObjSnapshot* snap);
 int32_t UAVObjSetMetadata(UAVObjHandle obj, const UAVObjMetadata* dataIn);
 int32_t UAVObjGetMetadata(UAVObjHandle obj, UAVObjMetadata* dataOut);
 int8_t UAVObjReadOnly(UAVObjHandle obj);
 int32_t UAVObjConnectQueue(UAVObjHandle obj, xQueueHandle queue, int32_t eventMask);
+int32_t UAVObjConnectQueueCoalesced(UAVObjHandle obj, xQueueHandle queue, int32_t eventMask);
+int32_t UAVObjClearPendingEvent(xQueueHandle queue, const UAVObjEvent* ev);
 int32_t UAVObjDisconnectQueue(UAVObjHandle obj, xQueueHandle queue);
 int32_t UAVObjConnectCallback(UAVObjHandle obj, UAVObjEventCallback cb, int32_t eventMask);
+int32_t UAVObjConnectCallbackPriority(UAVObjHandle obj, UAVObjEventCallback cb, int32_t eventMask, int32_t priority);
 int32_t UAVObjDisconnectCallback(UAVObjHandle obj, UAVObjEventCallback cb);
 void UAVObjRequestUpdate(UAVObjHandle obj);
 void UAVObjRequestInstanceUpdate(UAVObjHandle obj, uint16_t instId);
@@ -60,6 +60,7 @@
 #define $(NAME)InstSet(instId, dataIn) UAVObjSetInstanceData($(NAME)Handle(), instId, dataIn)
 #define $(NAME)ConnectQueue(queue) UAVObjConnectQueue($(NAME)Handle(), queue, EV_MASK_ALL_UPDATES)
 #define $(NAME)ConnectCallback(cb) UAVObjConnectCallback($(NAME)Handle(), cb, EV_MASK_ALL_UPDATES)
+#define $(NAME)ConnectCallbackPriority(cb, priority) UAVObjConnectCallbackPriority($(NAME)Handle(), cb, EV_MASK_ALL_UPDATES, priority)
 #define $(NAME)CreateInstance() UAVObjCreateInstance($(NAME)Handle(),&$(NAME)SetDefaults)
 #define $(NAME)RequestUpdate() UAVObjRequestUpdate($(NAME)Handle())
 #define $(NAME)RequestInstUpdate(instId) UAVObjRequestInstanceUpdate($(NAME)Handle(), instId)
@@ -68,6 +69,7 @@
 #define $(NAME)GetMetadata(dataOut) UAVObjGetMetadata($(NAME)Handle(), dataOut)
 #define $(NAME)SetMetadata(dataIn) UAVObjSetMetadata($(NAME)Handle(), dataIn)
 #define $(NAME)ReadOnly(dataIn) UAVObjReadOnly($(NAME)Handle())
+#define $(NAME)SnapshotInit(snap, data) UAVObjSnapshotInit($(NAME)Handle(), snap, data)
 
 // Object data
 typedef struct {
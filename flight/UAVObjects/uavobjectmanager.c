@@ -34,6 +34,13 @@
 #include "openpilot.h"
 
 // Constants
+#if defined(PIOS_UAVOBJECTMANAGER_INDEX_SIZE)
+#define INDEX_SIZE PIOS_UAVOBJECTMANAGER_INDEX_SIZE
+#else
+#define INDEX_SIZE 256 /** Must be a power of two, each object and metaobject takes one slot */
+#endif
+#define INDEX_MASK (INDEX_SIZE - 1)
+#define INSTANCE_CHUNKS 10 /** Chunk k holds instances 2^k to 2^(k+1)-1, enough for UAVOBJ_MAX_INSTANCES */
 
 // Private types
 
@@ -44,20 +51,14 @@ struct ObjectEventListStruct {
 	  xQueueHandle queue;
 	  UAVObjEventCallback cb;
 	  int32_t eventMask;
+	  uint8_t coalesce;
+			  /** Set to 1 if an event already in the queue is not queued again */
+	  uint8_t priority;
+			   /** Event dispatcher lane the callback runs on (EventPriority) */
 	  struct ObjectEventListStruct *next;
 };
 typedef struct ObjectEventListStruct ObjectEventList;
 
-/**
- * List of object instances, holds the actual data structure and instance ID
- */
-struct ObjectInstListStruct {
-	  void *data;
-	  uint16_t instId;
-	  struct ObjectInstListStruct *next;
-};
-typedef struct ObjectInstListStruct ObjectInstList;
-
 /**
  * List of objects registered in the object manager
  */
@@ -76,10 +77,20 @@ struct ObjectListStruct {
 			   /** Number of data bytes contained in the object (for a single instance) */
 	  uint16_t numInstances;
 			       /** Number of instances */
+	  uint16_t maxInstances;
+			       /** Number of instances that can be created before a new chunk is needed */
+	  volatile uint32_t seq;
+			  /** Data sequence counter, incremented on each write of any instance (seqlock) */
+	  uint8_t pendingAll;
+			  /** Events of UAVOBJ_ALL_INSTANCES in the coalescing queue and not yet cleared */
 	  struct ObjectListStruct *linkedObj;
 					    /** Linked object, for regular objects this is the metaobject and for metaobjects it is the parent object */
-	  ObjectInstList instances;
-				  /** List of object instances, instance 0 always exists */
+	  void *data;
+		     /** Data of instance 0, which always exists */
+	  void **chunks;
+		     /** Data of the other instances in chunks of doubling size, allocated with the second instance.
+		      *  Each block of instance data is followed by one byte per instance with the events of that
+		      *  instance in the coalescing queue and not yet cleared (the dirty set) */
 	  ObjectEventList *events;
 				 /** Event queues registered on the object */
 	  struct ObjectListStruct *next;
@@ -90,12 +101,30 @@ typedef struct ObjectListStruct ObjectList;
 // Private functions
 static int32_t sendEvent(ObjectList * obj, uint16_t instId,
 			 UAVObjEventType event);
-static ObjectInstList *createInstance(ObjectList * obj, uint16_t instId);
-static ObjectInstList *getInstance(ObjectList * obj, uint16_t instId);
+static int32_t coalesceEvent(ObjectList * obj, uint16_t instId,
+			     UAVObjEventType event);
+static void clearPendingEvent(ObjectList * obj, uint16_t instId,
+			      UAVObjEventType event);
+static uint8_t *pendingEvents(ObjectList * obj, uint16_t instId);
+static void clearAllPendingEvents(ObjectList * obj);
+static int32_t createInstance(ObjectList * obj, uint16_t instId);
+static int32_t growInstances(ObjectList * obj, uint16_t numInstances);
+static uint8_t *instanceData(ObjectList * obj, uint16_t instId);
+static uint8_t *instancePending(ObjectList * obj, uint16_t instId);
 static int32_t connectObj(UAVObjHandle obj, xQueueHandle queue,
-			  UAVObjEventCallback cb, int32_t eventMask);
+			  UAVObjEventCallback cb, int32_t eventMask,
+			  uint8_t coalesce, uint8_t priority);
 static int32_t disconnectObj(UAVObjHandle obj, xQueueHandle queue,
 			     UAVObjEventCallback cb);
+static uint32_t readInstance(ObjectList * obj, uint16_t instId,
+			     void *dataOut, uint32_t offset, uint32_t size);
+static void writeInstance(ObjectList * obj, uint16_t instId,
+			  const void *dataIn, uint32_t offset, uint32_t size);
+static void indexInsert(ObjectList * obj);
+static ObjectList *indexGetByID(uint32_t id);
+static ObjectList *indexGetByName(const char *name);
+static uint32_t hashID(uint32_t id);
+static uint32_t hashName(const char *name);
 
 #if defined(PIOS_INCLUDE_SDCARD)
 static void objectFilename(ObjectList * obj, uint8_t * filename);
@@ -107,6 +136,9 @@ static ObjectList *objList;
 static xSemaphoreHandle mutex;
 static UAVObjMetadata defMetadata;
 static UAVObjStats stats;
+static ObjectList *idIndex[INDEX_SIZE];
+static ObjectList *nameIndex[INDEX_SIZE];
+static uint8_t indexOverflow;
 
 /**
  * Initialize the object manager
@@ -118,6 +150,9 @@ int32_t UAVObjInitialize()
 	  // Initialize variables
 	  objList = NULL;
 	  memset(&stats, 0, sizeof(UAVObjStats));
+	  memset(idIndex, 0, sizeof(idIndex));
+	  memset(nameIndex, 0, sizeof(nameIndex));
+	  indexOverflow = 0;
 
 	  // Create mutex
 	  mutex = xSemaphoreCreateRecursiveMutex();
@@ -146,9 +181,9 @@ int32_t UAVObjInitialize()
  */
 void UAVObjGetStats(UAVObjStats * statsOut)
 {
-	  xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+	  taskENTER_CRITICAL();
 	  memcpy(statsOut, &stats, sizeof(UAVObjStats));
-	  xSemaphoreGiveRecursive(mutex);
+	  taskEXIT_CRITICAL();
 }
 
 /**
@@ -156,9 +191,9 @@ void UAVObjGetStats(UAVObjStats * statsOut)
  */
 void UAVObjClearStats()
 {
-	  xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+	  taskENTER_CRITICAL();
 	  memset(&stats, 0, sizeof(UAVObjStats));
-	  xSemaphoreGiveRecursive(mutex);
+	  taskEXIT_CRITICAL();
 }
 
 /**
@@ -181,19 +216,16 @@ UAVObjHandle UAVObjRegister(uint32_t id, const char *name,
 			    UAVObjInitializeCallback initCb)
 {
 	  ObjectList *objEntry;
-	  ObjectInstList *instEntry;
 	  ObjectList *metaObj;
 
 	  // Get lock
 	  xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 
 	  // Check that the object is not already registered
-	  LL_FOREACH(objList, objEntry) {
-		    if (objEntry->id == id) {
-			      // Already registered, ignore
-			      xSemaphoreGiveRecursive(mutex);
-			      return NULL;
-		    }
+	  if (UAVObjGetByID(id) != NULL) {
+		    // Already registered, ignore
+		    xSemaphoreGiveRecursive(mutex);
+		    return NULL;
 	  }
 
 	  // Create and append entry
@@ -210,15 +242,16 @@ UAVObjHandle UAVObjRegister(uint32_t id, const char *name,
 	  objEntry->numBytes = numBytes;
 	  objEntry->events = NULL;
 	  objEntry->numInstances = 0;
-	  objEntry->instances.data = NULL;
-	  objEntry->instances.instId = 0xFFFF;
-	  objEntry->instances.next = NULL;
+	  objEntry->maxInstances = 0;
+	  objEntry->seq = 0;
+	  objEntry->pendingAll = 0;
+	  objEntry->data = NULL;
+	  objEntry->chunks = NULL;
 	  objEntry->linkedObj = NULL;	// will be set later
 	  LL_APPEND(objList, objEntry);
 
 	  // Create instance zero
-	  instEntry = createInstance(objEntry, 0);
-	  if (instEntry == NULL) {
+	  if (createInstance(objEntry, 0) != 0) {
 		    xSemaphoreGiveRecursive(mutex);
 		    return NULL;
 	  }
@@ -250,6 +283,8 @@ UAVObjHandle UAVObjRegister(uint32_t id, const char *name,
 	  if (objEntry->isSettings) {
 		    UAVObjLoad((UAVObjHandle) objEntry, 0);
 	  }
+	  // Make the object visible to lookups, only once it is fully initialized
+	  indexInsert(objEntry);
 	  // Release lock
 	  xSemaphoreGiveRecursive(mutex);
 	  return (UAVObjHandle) objEntry;
@@ -264,10 +299,14 @@ UAVObjHandle UAVObjGetByID(uint32_t id)
 {
 	  ObjectList *objEntry;
 
-	  // Get lock
-	  xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+	  // Look for object in the index, no lock is needed since entries are never removed
+	  objEntry = indexGetByID(id);
+	  if (objEntry != NULL || !indexOverflow) {
+		    return (UAVObjHandle) objEntry;
+	  }
 
-	  // Look for object
+	  // The index is full, search the objects that did not fit in it
+	  xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 	  LL_FOREACH(objList, objEntry) {
 		    if (objEntry->id == id) {
 			      // Release lock
@@ -291,10 +330,14 @@ UAVObjHandle UAVObjGetByName(char *name)
 {
 	  ObjectList *objEntry;
 
-	  // Get lock
-	  xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+	  // Look for object in the index, no lock is needed since entries are never removed
+	  objEntry = indexGetByName(name);
+	  if (objEntry != NULL || !indexOverflow) {
+		    return (UAVObjHandle) objEntry;
+	  }
 
-	  // Look for object
+	  // The index is full, search the objects that did not fit in it
+	  xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 	  LL_FOREACH(objList, objEntry) {
 		    if (objEntry->name != NULL
 			&& strcmp(objEntry->name, name) == 0) {
@@ -359,11 +402,7 @@ UAVObjHandle UAVObjGetLinkedObj(UAVObjHandle obj)
  */
 uint16_t UAVObjGetNumInstances(UAVObjHandle obj)
 {
-	  uint32_t numInstances;
-	  xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-	  numInstances = ((ObjectList *) obj)->numInstances;
-	  xSemaphoreGiveRecursive(mutex);
-	  return numInstances;
+	  return ((ObjectList *) obj)->numInstances;
 }
 
 /**
@@ -375,25 +414,25 @@ uint16_t UAVObjCreateInstance(UAVObjHandle obj,
 			      UAVObjInitializeCallback initCb)
 {
 	  ObjectList *objEntry;
-	  ObjectInstList *instEntry;
+	  uint16_t instId;
 
 	  // Lock
 	  xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 
 	  // Create new instance
 	  objEntry = (ObjectList *) obj;
-	  instEntry = createInstance(objEntry, objEntry->numInstances);
-	  if (instEntry == NULL) {
+	  instId = objEntry->numInstances;
+	  if (createInstance(objEntry, instId) != 0) {
 		    xSemaphoreGiveRecursive(mutex);
 		    return -1;
 	  }
 	  // Initialize instance data
 	  if (initCb != NULL) {
-		    initCb(obj, instEntry->instId);
+		    initCb(obj, instId);
 	  }
 	  // Unlock
 	  xSemaphoreGiveRecursive(mutex);
-	  return instEntry->instId;
+	  return instId;
 }
 
 /**
@@ -437,34 +476,26 @@ int32_t UAVObjUnpack(UAVObjHandle obj, uint16_t instId,
 		     const uint8_t * dataIn)
 {
 	  ObjectList *objEntry;
-	  ObjectInstList *instEntry;
-
-	  // Lock
-	  xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 
 	  // Cast handle to object
 	  objEntry = (ObjectList *) obj;
 
-	  // Get the instance
-	  instEntry = getInstance(objEntry, instId);
-
-	  // If the instance does not exist create it and any other instances before it
-	  if (instEntry == NULL) {
-		    instEntry = createInstance(objEntry, instId);
-		    if (instEntry == NULL) {
-			      // Error, unlock and return
+	  // If the instance does not exist create it and any other instances before it,
+	  // this changes the instance array so it needs the lock
+	  if (instId >= objEntry->numInstances) {
+		    xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+		    if (instId >= objEntry->numInstances
+			&& createInstance(objEntry, instId) != 0) {
 			      xSemaphoreGiveRecursive(mutex);
 			      return -1;
 		    }
+		    xSemaphoreGiveRecursive(mutex);
 	  }
 	  // Set the data
-	  memcpy(instEntry->data, dataIn, objEntry->numBytes);
+	  writeInstance(objEntry, instId, dataIn, 0, objEntry->numBytes);
 
 	  // Fire event
 	  sendEvent(objEntry, instId, EV_UNPACKED);
-
-	  // Unlock
-	  xSemaphoreGiveRecursive(mutex);
 	  return 0;
 }
 
@@ -478,26 +509,16 @@ int32_t UAVObjUnpack(UAVObjHandle obj, uint16_t instId,
 int32_t UAVObjPack(UAVObjHandle obj, uint16_t instId, uint8_t * dataOut)
 {
 	  ObjectList *objEntry;
-	  ObjectInstList *instEntry;
-
-	  // Lock
-	  xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 
 	  // Cast handle to object
 	  objEntry = (ObjectList *) obj;
 
-	  // Get the instance
-	  instEntry = getInstance(objEntry, instId);
-	  if (instEntry == NULL) {
-		    // Error, unlock and return
-		    xSemaphoreGiveRecursive(mutex);
+	  // Check the instance
+	  if (instId >= objEntry->numInstances) {
 		    return -1;
 	  }
 	  // Pack data
-	  memcpy(dataOut, instEntry->data, objEntry->numBytes);
-
-	  // Unlock
-	  xSemaphoreGiveRecursive(mutex);
+	  readInstance(objEntry, instId, dataOut, 0, objEntry->numBytes);
 	  return 0;
 }
 
@@ -516,7 +537,7 @@ int32_t UAVObjSaveToFile(UAVObjHandle obj, uint16_t instId,
 #if defined(PIOS_INCLUDE_SDCARD)
 	  uint32_t bytesWritten;
 	  ObjectList *objEntry;
-	  ObjectInstList *instEntry;
+	  uint8_t *buffer;
 
 	  // Check for file system availability
 	  if (PIOS_SDCARD_IsMounted() == 0) {
@@ -528,9 +549,8 @@ int32_t UAVObjSaveToFile(UAVObjHandle obj, uint16_t instId,
 	  // Cast to object
 	  objEntry = (ObjectList *) obj;
 
-	  // Get the instance information
-	  instEntry = getInstance(objEntry, instId);
-	  if (instEntry == NULL) {
+	  // Check the instance
+	  if (instId >= objEntry->numInstances) {
 		    xSemaphoreGiveRecursive(mutex);
 		    return -1;
 	  }
@@ -540,12 +560,20 @@ int32_t UAVObjSaveToFile(UAVObjHandle obj, uint16_t instId,
 
 	  // Write the instance ID
 	  if (!objEntry->isSingleInstance) {
-		    PIOS_FWRITE(file, &instEntry->instId,
-				sizeof(instEntry->instId), &bytesWritten);
+		    PIOS_FWRITE(file, &instId, sizeof(instId),
+				&bytesWritten);
+	  }
+	  // Take a consistent copy of the data, writers do not wait for the file system
+	  buffer = (uint8_t *) pvPortMalloc(objEntry->numBytes);
+	  if (buffer == NULL) {
+		    xSemaphoreGiveRecursive(mutex);
+		    return -1;
 	  }
+	  readInstance(objEntry, instId, buffer, 0, objEntry->numBytes);
+
 	  // Write the data and check that the write was successful
-	  PIOS_FWRITE(file, instEntry->data, objEntry->numBytes,
-		      &bytesWritten);
+	  PIOS_FWRITE(file, buffer, objEntry->numBytes, &bytesWritten);
+	  vPortFree(buffer);
 	  if (bytesWritten != objEntry->numBytes) {
 		    xSemaphoreGiveRecursive(mutex);
 		    return -1;
@@ -574,15 +602,20 @@ int32_t UAVObjSave(UAVObjHandle obj, uint16_t instId)
 	  if (objEntry == NULL)
 		    return -1;
 
-	  ObjectInstList *instEntry = getInstance(objEntry, instId);
-
-	  if (instEntry == NULL)
+	  if (instId >= objEntry->numInstances)
 		    return -1;
 
-	  if (instEntry->data == NULL)
+	  // Save a consistent copy, writers are not blocked while the flash is programmed
+	  uint8_t *buffer = (uint8_t *) pvPortMalloc(objEntry->numBytes);
+
+	  if (buffer == NULL)
 		    return -1;
 
-	  if (PIOS_FLASHFS_ObjSave(obj, instId, instEntry->data) != 0)
+	  readInstance(objEntry, instId, buffer, 0, objEntry->numBytes);
+	  int32_t res = PIOS_FLASHFS_ObjSave(obj, instId, buffer);
+	  vPortFree(buffer);
+
+	  if (res != 0)
 		    return -1;
 #elif defined(PIOS_INCLUDE_SDCARD)
 	  FILEINFO file;
@@ -632,7 +665,7 @@ UAVObjHandle UAVObjLoadFromFile(FILEINFO * file)
 #elif defined(PIOS_INCLUDE_SDCARD)
 	  uint32_t bytesRead;
 	  ObjectList *objEntry;
-	  ObjectInstList *instEntry;
+	  uint8_t *buffer;
 	  uint32_t objId;
 	  uint16_t instId;
 	  UAVObjHandle obj;
@@ -666,24 +699,28 @@ UAVObjHandle UAVObjLoadFromFile(FILEINFO * file)
 			      return NULL;
 		    }
 	  }
-	  // Get the instance information
-	  instEntry = getInstance(objEntry, instId);
-
 	  // If the instance does not exist create it and any other instances before it
-	  if (instEntry == NULL) {
-		    instEntry = createInstance(objEntry, instId);
-		    if (instEntry == NULL) {
+	  if (instId >= objEntry->numInstances) {
+		    if (createInstance(objEntry, instId) != 0) {
 			      // Error, unlock and return
 			      xSemaphoreGiveRecursive(mutex);
 			      return NULL;
 		    }
 	  }
-	  // Read the instance data
-	  if (PIOS_FREAD
-	      (file, instEntry->data, objEntry->numBytes, &bytesRead)) {
+	  // Read the instance data, into a buffer first so that readers never see a partial load
+	  buffer = (uint8_t *) pvPortMalloc(objEntry->numBytes);
+	  if (buffer == NULL) {
+		    xSemaphoreGiveRecursive(mutex);
+		    return NULL;
+	  }
+	  if (PIOS_FREAD(file, buffer, objEntry->numBytes, &bytesRead)) {
+		    vPortFree(buffer);
 		    xSemaphoreGiveRecursive(mutex);
 		    return NULL;
 	  }
+	  writeInstance(objEntry, instId, buffer, 0, objEntry->numBytes);
+	  vPortFree(buffer);
+
 	  // Fire event
 	  sendEvent(objEntry, instId, EV_UNPACKED);
 
@@ -711,19 +748,24 @@ int32_t UAVObjLoad(UAVObjHandle obj, uint16_t instId)
 	if (objEntry == NULL)
 		return -1;
 
-	ObjectInstList *instEntry = getInstance(objEntry, instId);
-
-	if (instEntry == NULL)
+	if (instId >= objEntry->numInstances)
 		return -1;
 
-	if (instEntry->data == NULL)
+	// Load into a buffer first so that readers never see a partial load
+	uint8_t *buffer = (uint8_t *) pvPortMalloc(objEntry->numBytes);
+
+	if (buffer == NULL)
 		return -1;
 
 	// Fire event on success
-	if (PIOS_FLASHFS_ObjLoad(obj, instId, instEntry->data) == 0)
+	if (PIOS_FLASHFS_ObjLoad(obj, instId, buffer) == 0) {
+		writeInstance(objEntry, instId, buffer, 0, objEntry->numBytes);
+		vPortFree(buffer);
 		sendEvent(objEntry, instId, EV_UNPACKED);
-	else
+	} else {
+		vPortFree(buffer);
 		return -1;
+	}
 #elif defined(PIOS_INCLUDE_SDCARD)
 	  FILEINFO file;
 	  ObjectList *objEntry;
@@ -1036,40 +1078,28 @@ int32_t UAVObjSetInstanceData(UAVObjHandle obj, uint16_t instId,
 			      const void *dataIn)
 {
 	  ObjectList *objEntry;
-	  ObjectInstList *instEntry;
 	  UAVObjMetadata *mdata;
 
-	  // Lock
-	  xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-
 	  // Cast to object info
 	  objEntry = (ObjectList *) obj;
 
 	  // Check access level
 	  if (!objEntry->isMetaobject) {
 		    mdata =
-			(UAVObjMetadata *) (objEntry->linkedObj->instances.
-					    data);
+			(UAVObjMetadata *) (objEntry->linkedObj->data);
 		    if (mdata->access == ACCESS_READONLY) {
-			      xSemaphoreGiveRecursive(mutex);
 			      return -1;
 		    }
 	  }
-	  // Get instance information
-	  instEntry = getInstance(objEntry, instId);
-	  if (instEntry == NULL) {
-		    // Error, unlock and return
-		    xSemaphoreGiveRecursive(mutex);
+	  // Check instance
+	  if (instId >= objEntry->numInstances) {
 		    return -1;
 	  }
 	  // Set data
-	  memcpy(instEntry->data, dataIn, objEntry->numBytes);
+	  writeInstance(objEntry, instId, dataIn, 0, objEntry->numBytes);
 
-	  // Fire event
+	  // Fire event, outside of the data critical section
 	  sendEvent(objEntry, instId, EV_UPDATED);
-
-	  // Unlock
-	  xSemaphoreGiveRecursive(mutex);
 	  return 0;
 }
 
@@ -1083,50 +1113,37 @@ int32_t UAVObjSetInstanceData(UAVObjHandle obj, uint16_t instId,
 int32_t UAVObjSetInstanceDataField(UAVObjHandle obj, uint16_t instId, const void* dataIn, uint32_t offset, uint32_t size)
 {
 	ObjectList* objEntry;
-	ObjectInstList* instEntry;
 	UAVObjMetadata* mdata;
 
-	// Lock
-	xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-
 	// Cast to object info
 	objEntry = (ObjectList*)obj;
 
 	// Check access level
 	if ( !objEntry->isMetaobject )
 	{
-		mdata = (UAVObjMetadata*)(objEntry->linkedObj->instances.data);
+		mdata = (UAVObjMetadata*)(objEntry->linkedObj->data);
 		if ( mdata->access == ACCESS_READONLY )
 		{
-			xSemaphoreGiveRecursive(mutex);
 			return -1;
 		}
 	}
 
-	// Get instance information
-	instEntry = getInstance(objEntry, instId);
-	if ( instEntry == NULL )
+	// Check instance
+	if ( instId >= objEntry->numInstances )
 	{
-		// Error, unlock and return
-		xSemaphoreGiveRecursive(mutex);
 		return -1;
 	}
 
 	// return if we set too much of what we have
 	if ( (size + offset) > objEntry->numBytes) {
-		// Error, unlock and return
-		xSemaphoreGiveRecursive(mutex);		
 		return -1;
 	}
 
 	// Set data
-	memcpy(instEntry->data + offset, dataIn, size);
+	writeInstance(objEntry, instId, dataIn, offset, size);
 
-	// Fire event
+	// Fire event, outside of the data critical section
 	sendEvent(objEntry, instId, EV_UPDATED);
-
-	// Unlock
-	xSemaphoreGiveRecursive(mutex);
 	return 0;
 }
 
@@ -1141,26 +1158,16 @@ int32_t UAVObjGetInstanceData(UAVObjHandle obj, uint16_t instId,
 			      void *dataOut)
 {
 	  ObjectList *objEntry;
-	  ObjectInstList *instEntry;
-
-	  // Lock
-	  xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 
 	  // Cast to object info
 	  objEntry = (ObjectList *) obj;
 
-	  // Get instance information
-	  instEntry = getInstance(objEntry, instId);
-	  if (instEntry == NULL) {
-		    // Error, unlock and return
-		    xSemaphoreGiveRecursive(mutex);
+	  // Check instance
+	  if (instId >= objEntry->numInstances) {
 		    return -1;
 	  }
-	  // Set data
-	  memcpy(dataOut, instEntry->data, objEntry->numBytes);
-
-	  // Unlock
-	  xSemaphoreGiveRecursive(mutex);
+	  // Get data
+	  readInstance(objEntry, instId, dataOut, 0, objEntry->numBytes);
 	  return 0;
 }
 
@@ -1174,39 +1181,69 @@ int32_t UAVObjGetInstanceData(UAVObjHandle obj, uint16_t instId,
 int32_t UAVObjGetInstanceDataField(UAVObjHandle obj, uint16_t instId, void* dataOut, uint32_t offset, uint32_t size)
 {
 	ObjectList* objEntry;
-	ObjectInstList* instEntry;
-
-	// Lock
-	xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 
 	// Cast to object info
 	objEntry = (ObjectList*)obj;
 
-	// Get instance information
-	instEntry = getInstance(objEntry, instId);
-	if ( instEntry == NULL )
+	// Check instance
+	if ( instId >= objEntry->numInstances )
 	{
-		// Error, unlock and return
-		xSemaphoreGiveRecursive(mutex);
 		return -1;
 	}
 
 	// return if we request too much of what we can give
 	if ( (size + offset) > objEntry->numBytes) 
 	{
-		// Error, unlock and return
-		xSemaphoreGiveRecursive(mutex);
 		return -1;
 	}
 	
-	// Set data
-	memcpy(dataOut, instEntry->data + offset, size);
-
-	// Unlock
-	xSemaphoreGiveRecursive(mutex);
+	// Get data
+	readInstance(objEntry, instId, dataOut, offset, size);
 	return 0;
 }
 
+/**
+ * Initialize a snapshot of an object and copy its data (instance 0)
+ * \param[in] obj The object handle
+ * \param[out] snap The snapshot
+ * \param[in] data Buffer for the copy of the data, of the size of the object data structure
+ * \return 0 if success or -1 if failure
+ */
+int32_t UAVObjSnapshotInit(UAVObjHandle obj, UAVObjSnapshot * snap, void *data)
+{
+	  if (obj == NULL || data == NULL) {
+		    return -1;
+	  }
+	  snap->obj = obj;
+	  snap->data = data;
+	  snap->version = 0;
+	  // Differs from the current counter, so the first update copies the data
+	  snap->seq = ((ObjectList *) obj)->seq - 1;
+	  UAVObjSnapshotUpdate(snap);
+	  return 0;
+}
+
+/**
+ * Copy the data of the object into the snapshot again if the object was written since
+ * the last copy, by a set, a telemetry update or a load from the flash. Otherwise this
+ * only compares the sequence counter of the object, without any lock, so control loops
+ * can call it on every cycle and then read snap->data directly.
+ * \param[in] snap The snapshot
+ * \return 1 if the data was copied again, 0 if it did not change
+ */
+int32_t UAVObjSnapshotUpdate(UAVObjSnapshot * snap)
+{
+	  ObjectList *objEntry;
+
+	  objEntry = (ObjectList *) snap->obj;
+	  if (objEntry->seq == snap->seq) {
+		    return 0;
+	  }
+	  snap->seq = readInstance(objEntry, 0, snap->data, 0, objEntry->numBytes);
+	  ++snap->version;
+	  return 1;
+}
+
 /**
  * Set the object metadata
  * \param[in] obj The object handle
@@ -1217,9 +1254,6 @@ int32_t UAVObjSetMetadata(UAVObjHandle obj, const UAVObjMetadata * dataIn)
 {
 	  ObjectList *objEntry;
 
-	  // Lock
-	  xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-
 	  // Set metadata (metadata of metaobjects can not be modified)
 	  objEntry = (ObjectList *) obj;
 	  if (!objEntry->isMetaobject) {
@@ -1228,9 +1262,6 @@ int32_t UAVObjSetMetadata(UAVObjHandle obj, const UAVObjMetadata * dataIn)
 	  } else {
 		    return -1;
 	  }
-
-	  // Unlock
-	  xSemaphoreGiveRecursive(mutex);
 	  return 0;
 }
 
@@ -1244,9 +1275,6 @@ int32_t UAVObjGetMetadata(UAVObjHandle obj, UAVObjMetadata * dataOut)
 {
 	  ObjectList *objEntry;
 
-	  // Lock
-	  xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-
 	  // Get metadata
 	  objEntry = (ObjectList *) obj;
 	  if (objEntry->isMetaobject) {
@@ -1255,9 +1283,6 @@ int32_t UAVObjGetMetadata(UAVObjHandle obj, UAVObjMetadata * dataOut)
 		    UAVObjGetData((UAVObjHandle) objEntry->linkedObj,
 				  dataOut);
 	  }
-
-	  // Unlock
-	  xSemaphoreGiveRecursive(mutex);
 	  return 0;
 }
 
@@ -1280,8 +1305,7 @@ int8_t UAVObjReadOnly(UAVObjHandle obj)
 	  // Check access level
 	  if (!objEntry->isMetaobject) {
 		    mdata =
-			(UAVObjMetadata *) (objEntry->linkedObj->instances.
-					    data);
+			(UAVObjMetadata *) (objEntry->linkedObj->data);
 		    return mdata->access == ACCESS_READONLY;
 	  }
 	  return -1;
@@ -1300,11 +1324,56 @@ int32_t UAVObjConnectQueue(UAVObjHandle obj, xQueueHandle queue,
 {
 	  int32_t res;
 	  xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-	  res = connectObj(obj, queue, 0, eventMask);
+	  res = connectObj(obj, queue, 0, eventMask, 0, EVENT_PRIORITY_HIGH);
 	  xSemaphoreGiveRecursive(mutex);
 	  return res;
 }
 
+/**
+ * Connect an event queue to the object like UAVObjConnectQueue(), but an event is not
+ * queued again while the same event of the same instance is still in the queue. The
+ * receiver must call UAVObjClearPendingEvent() for each event it takes from the queue,
+ * before reading the object, so that it always acts on the latest data. Bursts of
+ * updates of one instance then take a single queue slot. The pending events are kept
+ * per instance with the object, so an object can only be connected to one coalescing queue.
+ * \param[in] obj The object handle
+ * \param[in] queue The event queue
+ * \param[in] eventMask The event mask, if EV_MASK_ALL then all events are enabled (e.g. EV_UPDATED | EV_UPDATED_MANUAL)
+ * \return 0 if success or -1 if failure
+ */
+int32_t UAVObjConnectQueueCoalesced(UAVObjHandle obj, xQueueHandle queue,
+				    int32_t eventMask)
+{
+	  int32_t res;
+	  xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+	  res = connectObj(obj, queue, 0, eventMask, 1, EVENT_PRIORITY_HIGH);
+	  xSemaphoreGiveRecursive(mutex);
+	  return res;
+}
+
+/**
+ * Mark an event received from a queue connected with UAVObjConnectQueueCoalesced()
+ * as no longer pending, the next event of the object will be queued again.
+ * \param[in] queue The event queue
+ * \param[in] ev The event taken from the queue
+ * \return 0 if success or -1 if the queue is not connected to the object
+ */
+int32_t UAVObjClearPendingEvent(xQueueHandle queue, const UAVObjEvent * ev)
+{
+	  ObjectEventList *eventEntry;
+
+	  if (ev->obj == NULL)
+		    return -1;
+
+	  LL_FOREACH(((ObjectList *) ev->obj)->events, eventEntry) {
+		    if (eventEntry->queue == queue && eventEntry->cb == 0) {
+			      clearPendingEvent((ObjectList *) ev->obj, ev->instId, ev->event);
+			      return 0;
+		    }
+	  }
+	  return -1;
+}
+
 /**
  * Disconnect an event queue from the object.
  * \param[in] obj The object handle
@@ -1333,7 +1402,31 @@ int32_t UAVObjConnectCallback(UAVObjHandle obj, UAVObjEventCallback cb,
 {
 	  int32_t res;
 	  xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
-	  res = connectObj(obj, 0, cb, eventMask);
+	  res = connectObj(obj, 0, cb, eventMask, 0, EVENT_PRIORITY_HIGH);
+	  xSemaphoreGiveRecursive(mutex);
+	  return res;
+}
+
+/**
+ * Connect an event callback to the object and select the event dispatcher lane it runs on,
+ * if the callback is already connected then the event mask and lane are only updated.
+ * Callbacks that are slow and not time critical (e.g. settings updates) should use
+ * EVENT_PRIORITY_BACKGROUND so they do not delay the control path and the periodic events.
+ * \param[in] obj The object handle
+ * \param[in] cb The event callback
+ * \param[in] eventMask The event mask, if EV_MASK_ALL then all events are enabled (e.g. EV_UPDATED | EV_UPDATED_MANUAL)
+ * \param[in] priority The lane, EVENT_PRIORITY_HIGH or EVENT_PRIORITY_BACKGROUND
+ * \return 0 if success or -1 if failure
+ */
+int32_t UAVObjConnectCallbackPriority(UAVObjHandle obj, UAVObjEventCallback cb,
+				      int32_t eventMask, int32_t priority)
+{
+	  int32_t res;
+	  if (priority < 0 || priority >= EVENT_NUM_PRIORITIES) {
+		    return -1;
+	  }
+	  xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
+	  res = connectObj(obj, 0, cb, eventMask, 0, priority);
 	  xSemaphoreGiveRecursive(mutex);
 	  return res;
 }
@@ -1371,9 +1464,7 @@ void UAVObjRequestUpdate(UAVObjHandle obj)
  */
 void UAVObjRequestInstanceUpdate(UAVObjHandle obj, uint16_t instId)
 {
-	  xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 	  sendEvent((ObjectList *) obj, instId, EV_UPDATE_REQ);
-	  xSemaphoreGiveRecursive(mutex);
 }
 
 /**
@@ -1392,9 +1483,7 @@ void UAVObjUpdated(UAVObjHandle obj)
  */
 void UAVObjInstanceUpdated(UAVObjHandle obj, uint16_t instId)
 {
-	  xSemaphoreTakeRecursive(mutex, portMAX_DELAY);
 	  sendEvent((ObjectList *) obj, instId, EV_UPDATED_MANUAL);
-	  xSemaphoreGiveRecursive(mutex);
 }
 
 /**
@@ -1418,14 +1507,75 @@ void UAVObjIterate(void (*iterator) (UAVObjHandle obj))
 	  xSemaphoreGiveRecursive(mutex);
 }
 
+/**
+ * Check if an event of an instance is already pending in the coalescing queue, if not
+ * mark it as pending.
+ * \return 1 if the event must not be queued, 0 otherwise
+ */
+static int32_t coalesceEvent(ObjectList * obj, uint16_t instId,
+			     UAVObjEventType event)
+{
+	  uint8_t *pending;
+	  int32_t queued = 0;
+
+	  taskENTER_CRITICAL();
+	  pending = pendingEvents(obj, instId);
+	  if (pending != NULL) {
+		    if ((*pending & event) != 0) {
+			      ++stats.eventsCoalesced;
+			      queued = 1;
+		    } else {
+			      *pending |= event;
+		    }
+	  }
+	  taskEXIT_CRITICAL();
+	  return queued;
+}
+
+/**
+ * Mark an event of an instance as no longer pending in the coalescing queue
+ */
+static void clearPendingEvent(ObjectList * obj, uint16_t instId,
+			      UAVObjEventType event)
+{
+	  uint8_t *pending;
+
+	  taskENTER_CRITICAL();
+	  pending = pendingEvents(obj, instId);
+	  if (pending != NULL) {
+		    *pending &= ~event;
+	  }
+	  taskEXIT_CRITICAL();
+}
+
+/**
+ * Get the pending events of an instance, or of all instances for UAVOBJ_ALL_INSTANCES
+ * \return NULL if the instance does not exist
+ */
+static uint8_t *pendingEvents(ObjectList * obj, uint16_t instId)
+{
+	  if (instId == UAVOBJ_ALL_INSTANCES) {
+		    return &obj->pendingAll;
+	  }
+	  if (instId >= obj->numInstances) {
+		    return NULL;
+	  }
+	  return instancePending(obj, instId);
+}
+
 /**
  * Send an event to all event queues registered on the object.
+ * This is called without holding any lock, the event list can be walked safely since
+ * entries are only ever appended and disconnected entries are disabled but not freed.
  */
 static int32_t sendEvent(ObjectList * obj, uint16_t instId,
 			 UAVObjEventType event)
 {
 	  ObjectEventList *eventEntry;
 	  UAVObjEvent msg;
+	  xQueueHandle queue;
+	  UAVObjEventCallback cb;
+	  uint8_t priority;
 
 	  // Setup event
 	  msg.obj = (UAVObjHandle) obj;
@@ -1436,18 +1586,30 @@ static int32_t sendEvent(ObjectList * obj, uint16_t instId,
 	  LL_FOREACH(obj->events, eventEntry) {
 		    if (eventEntry->eventMask == 0
 			|| (eventEntry->eventMask & event) != 0) {
+			      // Read the entry once, it can be disconnected or reused concurrently
+			      queue = eventEntry->queue;
+			      cb = eventEntry->cb;
+			      priority = eventEntry->priority;
 			      // Send to queue if a valid queue is registered
-			      if (eventEntry->queue != 0) {
-					if (xQueueSend(eventEntry->queue, &msg, 0) != pdTRUE)	// will not block
+			      if (queue != 0) {
+					if (eventEntry->coalesce && coalesceEvent(obj, instId, event)) {
+						  // Same event already in the queue
+					} else if (xQueueSend(queue, &msg, 0) != pdTRUE)	// will not block
 					{
+						  taskENTER_CRITICAL();
 						  ++stats.eventErrors;
+						  taskEXIT_CRITICAL();
+						  if (eventEntry->coalesce)
+							    clearPendingEvent(obj, instId, event);
 					}
 			      }
 			      // Invoke callback (from event task) if a valid one is registered
-			      if (eventEntry->cb != 0) {
-					if (EventCallbackDispatch(&msg, eventEntry->cb) != pdTRUE)	// invoke callback from the event task, will not block
+			      if (cb != 0) {
+					if (EventCallbackDispatchPriority(&msg, cb, priority) != pdTRUE)	// invoke callback from the event task of its lane, will not block
 					{
+						  taskENTER_CRITICAL();
 						  ++stats.eventErrors;
+						  taskEXIT_CRITICAL();
 					}
 			      }
 		    }
@@ -1458,77 +1620,134 @@ static int32_t sendEvent(ObjectList * obj, uint16_t instId,
 }
 
 /**
- * Create a new object instance, return the instance info or NULL if failure.
+ * Create a new object instance and any missing instance before it (all instance IDs
+ * must be sequential). Must be called with the lock held.
+ * \return 0 if success or -1 if failure
  */
-static ObjectInstList *createInstance(ObjectList * obj, uint16_t instId)
+static int32_t createInstance(ObjectList * obj, uint16_t instId)
 {
-	  ObjectInstList *instEntry;
-	  int32_t n;
+	  uint16_t numInstances;
+	  uint16_t n;
 
 	  // For single instance objects, only instance zero is allowed
 	  if (obj->isSingleInstance && instId != 0) {
-		    return NULL;
+		    return -1;
 	  }
 	  // Make sure that the instance ID is within limits
 	  if (instId >= UAVOBJ_MAX_INSTANCES) {
-		    return NULL;
+		    return -1;
 	  }
 	  // Check if the instance already exists
-	  if (getInstance(obj, instId) != NULL) {
-		    return NULL;
+	  if (instId < obj->numInstances) {
+		    return -1;
 	  }
-	  // Create any missing instances (all instance IDs must be sequential)
-	  for (n = obj->numInstances; n < instId; ++n) {
-		    if (createInstance(obj, n) == NULL) {
-			      return NULL;
+	  // Make room for the new instances
+	  if (instId >= obj->maxInstances) {
+		    if (growInstances(obj, instId + 1) != 0) {
+			      return -1;
 		    }
 	  }
-
-	  if (instId == 0) {	/* Instance 0 ObjectInstList allocated with ObjectList element */
-		    instEntry = &obj->instances;
-		    instEntry->data = pvPortMalloc(obj->numBytes);
-		    if (instEntry->data == NULL)
-			      return NULL;
-		    memset(instEntry->data, 0, obj->numBytes);
-		    instEntry->instId = instId;
-	  } else {
-		    // Create the actual instance
-		    instEntry =
-			(ObjectInstList *)
-			pvPortMalloc(sizeof(ObjectInstList));
-		    if (instEntry == NULL)
-			      return NULL;
-		    instEntry->data = pvPortMalloc(obj->numBytes);
-		    if (instEntry->data == NULL)
-			      return NULL;
-		    memset(instEntry->data, 0, obj->numBytes);
-		    instEntry->instId = instId;
-		    LL_APPEND(obj->instances.next, instEntry);
+	  // Clear the new instances before making them visible to the lock free accessors
+	  numInstances = obj->numInstances;
+	  for (n = numInstances; n <= instId; ++n) {
+		    memset(instanceData(obj, n), 0, obj->numBytes);
+		    *instancePending(obj, n) = 0;
 	  }
-	  ++obj->numInstances;
+	  __asm__ __volatile__("":::"memory");	// publish the data before the instance count
+	  obj->numInstances = instId + 1;
 
-	  // Fire event
-	  UAVObjInstanceUpdated((UAVObjHandle) obj, instId);
+	  // Fire events
+	  for (n = numInstances; n <= instId; ++n) {
+		    UAVObjInstanceUpdated((UAVObjHandle) obj, n);
+	  }
 
 	  // Done
-	  return instEntry;
+	  return 0;
 }
 
 /**
- * Get the instance information or NULL if the instance does not exist
+ * Allocate instance data so that it holds at least numInstances instances.
+ * Instance 0 has its own block, the other instances live in chunks of 1, 2, 4, ...
+ * instances so that a long list of instances (e.g. waypoints) only takes a few
+ * allocations. Chunks are never moved or freed, lock free readers can keep
+ * pointers into them. Each block ends with the pending events of its instances,
+ * one byte per instance. Must be called with the lock held.
+ * \return 0 if success or -1 if failure
  */
-static ObjectInstList *getInstance(ObjectList * obj, uint16_t instId)
+static int32_t growInstances(ObjectList * obj, uint16_t numInstances)
 {
-	  ObjectInstList *instEntry;
+	  void *data;
 
-	  // Look for specified instance ID
-	  LL_FOREACH(&(obj->instances), instEntry) {
-		    if (instEntry->instId == instId) {
-			      return instEntry;
+	  if (obj->data == NULL) {
+		    data = pvPortMalloc(obj->numBytes + 1);
+		    if (data == NULL) {
+			      return -1;
 		    }
+		    obj->data = data;
+		    obj->maxInstances = 1;
 	  }
-	  // If this point is reached then instance id was not found
-	  return NULL;
+	  if (numInstances > 1 && obj->chunks == NULL) {
+		    obj->chunks = (void **) pvPortMalloc(INSTANCE_CHUNKS * sizeof(void *));
+		    if (obj->chunks == NULL) {
+			      return -1;
+		    }
+		    memset(obj->chunks, 0, INSTANCE_CHUNKS * sizeof(void *));
+	  }
+	  // maxInstances is a power of two, the next chunk holds as many instances again
+	  while (obj->maxInstances < numInstances) {
+		    data = pvPortMalloc((uint32_t) obj->maxInstances * (obj->numBytes + 1));
+		    if (data == NULL) {
+			      return -1;
+		    }
+		    obj->chunks[31 - __builtin_clz(obj->maxInstances)] = data;
+		    obj->maxInstances *= 2;
+	  }
+	  return 0;
+}
+
+/**
+ * Get the address of an instance data, the instance must exist
+ */
+static uint8_t *instanceData(ObjectList * obj, uint16_t instId)
+{
+	  uint8_t chunk;
+
+	  if (instId == 0) {
+		    return (uint8_t *) obj->data;
+	  }
+	  chunk = 31 - __builtin_clz(instId);
+	  return (uint8_t *) obj->chunks[chunk] +
+	      (uint32_t) (instId - (1 << chunk)) * obj->numBytes;
+}
+
+/**
+ * Get the address of the pending events of an instance, the instance block must exist
+ */
+static uint8_t *instancePending(ObjectList * obj, uint16_t instId)
+{
+	  uint8_t chunk;
+
+	  if (instId == 0) {
+		    return (uint8_t *) obj->data + obj->numBytes;
+	  }
+	  chunk = 31 - __builtin_clz(instId);
+	  return (uint8_t *) obj->chunks[chunk] +
+	      ((uint32_t) 1 << chunk) * obj->numBytes + (instId - (1 << chunk));
+}
+
+/**
+ * Mark the events of all instances as not pending, used when a coalescing queue is connected
+ */
+static void clearAllPendingEvents(ObjectList * obj)
+{
+	  uint16_t n;
+
+	  taskENTER_CRITICAL();
+	  obj->pendingAll = 0;
+	  for (n = 0; n < obj->numInstances; ++n) {
+		    *instancePending(obj, n) = 0;
+	  }
+	  taskEXIT_CRITICAL();
 }
 
 /**
@@ -1537,20 +1756,57 @@ static ObjectInstList *getInstance(ObjectList * obj, uint16_t instId)
  * \param[in] queue The event queue
  * \param[in] cb The event callback
  * \param[in] eventMask The event mask, if EV_MASK_ALL then all events are enabled (e.g. EV_UPDATED | EV_UPDATED_MANUAL)
+ * \param[in] coalesce Set to 1 if an event already in the queue is not queued again
+ * \param[in] priority The event dispatcher lane of the callback
  * \return 0 if success or -1 if failure
  */
 static int32_t connectObj(UAVObjHandle obj, xQueueHandle queue,
-			  UAVObjEventCallback cb, int32_t eventMask)
+			  UAVObjEventCallback cb, int32_t eventMask,
+			  uint8_t coalesce, uint8_t priority)
 {
 	  ObjectEventList *eventEntry;
 	  ObjectList *objEntry;
 
-	  // Check that the queue is not already connected, if it is simply update event mask
 	  objEntry = (ObjectList *) obj;
+
+	  // The pending events are kept with the object, only one queue can coalesce them
+	  if (coalesce) {
+		    LL_FOREACH(objEntry->events, eventEntry) {
+			      if (eventEntry->coalesce && eventEntry->queue != 0
+				  && (eventEntry->queue != queue || eventEntry->cb != cb)) {
+					return -1;
+			      }
+		    }
+	  }
+
+	  // Check that the queue is not already connected, if it is simply update event mask
 	  LL_FOREACH(objEntry->events, eventEntry) {
 		    if (eventEntry->queue == queue && eventEntry->cb == cb) {
 			      // Already connected, update event mask and return
+			      if (coalesce && !eventEntry->coalesce) {
+					clearAllPendingEvents(objEntry);
+			      }
+			      eventEntry->eventMask = eventMask;
+			      eventEntry->coalesce = coalesce;
+			      eventEntry->priority = priority;
+			      return 0;
+		    }
+	  }
+
+	  if (coalesce) {
+		    clearAllPendingEvents(objEntry);
+	  }
+
+	  // Reuse a disconnected entry if there is one, the mask is set before the entry is enabled
+	  LL_FOREACH(objEntry->events, eventEntry) {
+		    if (eventEntry->queue == 0 && eventEntry->cb == 0) {
 			      eventEntry->eventMask = eventMask;
+			      eventEntry->coalesce = coalesce;
+			      eventEntry->priority = priority;
+			      taskENTER_CRITICAL();
+			      eventEntry->queue = queue;
+			      eventEntry->cb = cb;
+			      taskEXIT_CRITICAL();
 			      return 0;
 		    }
 	  }
@@ -1564,14 +1820,19 @@ static int32_t connectObj(UAVObjHandle obj, xQueueHandle queue,
 	  eventEntry->queue = queue;
 	  eventEntry->cb = cb;
 	  eventEntry->eventMask = eventMask;
+	  eventEntry->coalesce = coalesce;
+	  eventEntry->priority = priority;
+	  taskENTER_CRITICAL();
 	  LL_APPEND(objEntry->events, eventEntry);
+	  taskEXIT_CRITICAL();
 
 	  // Done
 	  return 0;
 }
 
 /**
- * Disconnect an event queue from the object
+ * Disconnect an event queue from the object. The entry stays in the list (sendEvent() may be
+ * walking it) but is disabled, it will be reused by the next connection on this object.
  * \param[in] obj The object handle
  * \param[in] queue The event queue
  * \param[in] cb The event callback
@@ -1588,8 +1849,10 @@ static int32_t disconnectObj(UAVObjHandle obj, xQueueHandle queue,
 	  LL_FOREACH(objEntry->events, eventEntry) {
 		    if ((eventEntry->queue == queue
 			 && eventEntry->cb == cb)) {
-			      LL_DELETE(objEntry->events, eventEntry);
-			      vPortFree(eventEntry);
+			      taskENTER_CRITICAL();
+			      eventEntry->queue = 0;
+			      eventEntry->cb = 0;
+			      taskEXIT_CRITICAL();
 			      return 0;
 		    }
 	  }
@@ -1598,6 +1861,150 @@ static int32_t disconnectObj(UAVObjHandle obj, xQueueHandle queue,
 	  return -1;
 }
 
+/**
+ * Copy data into an object instance. The copy is done in a critical section, which makes it
+ * atomic for other writers and lets lock free readers detect it through the sequence counter.
+ * Objects are small, so this is much shorter than waiting for a mutex owned by a lower priority task.
+ */
+static void writeInstance(ObjectList * obj, uint16_t instId,
+			  const void *dataIn, uint32_t offset, uint32_t size)
+{
+	  taskENTER_CRITICAL();
+	  memcpy(instanceData(obj, instId) + offset, dataIn, size);
+	  ++obj->seq;
+	  taskEXIT_CRITICAL();
+}
+
+/**
+ * Copy data out of an object instance without any lock (seqlock read side).
+ * If a writer preempted the copy the sequence counter changed and the copy is retried.
+ * \return The sequence counter the copy is consistent with
+ */
+static uint32_t readInstance(ObjectList * obj, uint16_t instId,
+			     void *dataOut, uint32_t offset, uint32_t size)
+{
+	  uint32_t seq;
+
+	  do {
+		    seq = obj->seq;
+		    __asm__ __volatile__("":::"memory");	// keep the copy between the two reads of seq
+		    memcpy(dataOut, instanceData(obj, instId) + offset, size);
+		    __asm__ __volatile__("":::"memory");
+	  } while (seq != obj->seq);
+	  return seq;
+}
+
+/**
+ * Add an object to the ID and name indexes (open addressing, linear probing).
+ * Must be called with the lock held. The slot is written last so that lock free
+ * readers never see a partially initialized entry. If the index is full the
+ * object is only reachable through the object list.
+ */
+static void indexInsert(ObjectList * obj)
+{
+	  uint32_t slot;
+	  uint32_t n;
+
+	  // Insert in the ID index
+	  slot = hashID(obj->id);
+	  for (n = 0; n < INDEX_SIZE; ++n) {
+		    if (idIndex[slot] == NULL) {
+			      idIndex[slot] = obj;
+			      break;
+		    }
+		    slot = (slot + 1) & INDEX_MASK;
+	  }
+	  if (n == INDEX_SIZE) {
+		    indexOverflow = 1;
+	  }
+
+	  // Insert in the name index (objects without a name can only be found by ID)
+	  if (obj->name == NULL) {
+		    return;
+	  }
+	  slot = hashName(obj->name);
+	  for (n = 0; n < INDEX_SIZE; ++n) {
+		    if (nameIndex[slot] == NULL) {
+			      nameIndex[slot] = obj;
+			      break;
+		    }
+		    slot = (slot + 1) & INDEX_MASK;
+	  }
+	  if (n == INDEX_SIZE) {
+		    indexOverflow = 1;
+	  }
+}
+
+/**
+ * Find an object in the ID index, return NULL if not indexed
+ */
+static ObjectList *indexGetByID(uint32_t id)
+{
+	  ObjectList *objEntry;
+	  uint32_t slot;
+	  uint32_t n;
+
+	  slot = hashID(id);
+	  for (n = 0; n < INDEX_SIZE; ++n) {
+		    objEntry = idIndex[slot];
+		    if (objEntry == NULL) {
+			      // Empty slot reached, the object is not in the index
+			      return NULL;
+		    }
+		    if (objEntry->id == id) {
+			      return objEntry;
+		    }
+		    slot = (slot + 1) & INDEX_MASK;
+	  }
+	  return NULL;
+}
+
+/**
+ * Find an object in the name index, return NULL if not indexed
+ */
+static ObjectList *indexGetByName(const char *name)
+{
+	  ObjectList *objEntry;
+	  uint32_t slot;
+	  uint32_t n;
+
+	  slot = hashName(name);
+	  for (n = 0; n < INDEX_SIZE; ++n) {
+		    objEntry = nameIndex[slot];
+		    if (objEntry == NULL) {
+			      // Empty slot reached, the object is not in the index
+			      return NULL;
+		    }
+		    if (strcmp(objEntry->name, name) == 0) {
+			      return objEntry;
+		    }
+		    slot = (slot + 1) & INDEX_MASK;
+	  }
+	  return NULL;
+}
+
+/**
+ * Index slot of an object ID. The IDs are already hashes of the object definition,
+ * they are scrambled again so that an object and its metaobject (ID + 1) do not cluster.
+ */
+static uint32_t hashID(uint32_t id)
+{
+	  return ((id * 2654435761u) >> 16) & INDEX_MASK;
+}
+
+/**
+ * Index slot of an object name, using the same Shift-Add-XOR hash as the UAVObject generator
+ */
+static uint32_t hashName(const char *name)
+{
+	  uint32_t hash = 0;
+
+	  while (*name != '\0') {
+		    hash ^= (hash << 5) + (hash >> 2) + (uint8_t)(*name++);
+	  }
+	  return hash & INDEX_MASK;
+}
+
 #if defined(PIOS_INCLUDE_SDCARD)
 /**
  * Wrapper for the sprintf function
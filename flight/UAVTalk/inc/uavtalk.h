@@ -41,6 +41,7 @@ typedef struct {
     uint32_t txObjects;
     uint32_t txErrors;
     uint32_t rxErrors;
+    uint32_t rxCopiedBytes;
 } UAVTalkStats;
 
 typedef void* UAVTalkConnection;
@@ -52,6 +53,7 @@ UAVTalkOutputStream UAVTalkGetOutputStream(UAVTalkConnection connection);
 int32_t UAVTalkSendObject(UAVTalkConnection connection, UAVObjHandle obj, uint16_t instId, uint8_t acked, int32_t timeoutMs);
 int32_t UAVTalkSendObjectRequest(UAVTalkConnection connection, UAVObjHandle obj, uint16_t instId, int32_t timeoutMs);
 int32_t UAVTalkProcessInputStream(UAVTalkConnection connection, uint8_t rxbyte);
+int32_t UAVTalkProcessInputBuffer(UAVTalkConnection connection, const uint8_t *data, uint32_t length);
 void UAVTalkGetStats(UAVTalkConnection connection, UAVTalkStats *stats);
 void UAVTalkResetStats(UAVTalkConnection connection);
 
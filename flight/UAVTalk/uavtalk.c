@@ -38,7 +38,9 @@ static int32_t objectTransaction(UAVTalkConnectionData *connection, UAVObjHandle
 static int32_t sendObject(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, uint8_t type);
 static int32_t sendSingleObject(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId, uint8_t type);
 static int32_t sendNack(UAVTalkConnectionData *connection, uint32_t objId);
-static int32_t receiveObject(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId, uint8_t* data, int32_t length);
+static int32_t receiveObject(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId, const uint8_t* data, int32_t length);
+static void processInputByte(UAVTalkConnectionData *connection, uint8_t rxbyte);
+static void processChecksum(UAVTalkConnectionData *connection, uint8_t rxbyte, const uint8_t *payload);
 static void updateAck(UAVTalkConnectionData *connection, UAVObjHandle obj, uint16_t instId);
 
 /**
@@ -262,6 +264,100 @@ int32_t UAVTalkProcessInputStream(UAVTalkConnection connectionHandle, uint8_t rx
 	UAVTalkConnectionData *connection;
     CHECKCONHANDLE(connectionHandle,connection,return -1);
 
+	processInputByte(connection, rxbyte);
+
+	// Done
+	return 0;
+}
+
+/**
+ * Process a block of bytes from the telemetry stream.
+ * Gives the same result as calling UAVTalkProcessInputStream() for each byte, but
+ * garbage between packets is skipped with a single search for the sync byte and the
+ * payload is copied and checksummed in spans instead of byte by byte. When the whole
+ * payload and its checksum are in the block, the object is unpacked straight from
+ * the block without staging the payload in the receive buffer.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] data Received bytes
+ * \param[in] length Number of received bytes
+ * \return 0 Success
+ * \return -1 Failure
+ */
+int32_t UAVTalkProcessInputBuffer(UAVTalkConnection connectionHandle, const uint8_t *data, uint32_t length)
+{
+	UAVTalkConnectionData *connection;
+    CHECKCONHANDLE(connectionHandle,connection,return -1);
+
+	UAVTalkInputProcessor *iproc = &connection->iproc;
+	const uint8_t *end = data + length;
+	const uint8_t *sync;
+	uint32_t count;
+
+	while (data < end)
+	{
+		switch (iproc->state)
+		{
+			case UAVTALK_STATE_SYNC:
+				// Skip everything up to the next sync byte
+				sync = memchr(data, UAVTALK_SYNC_VAL, end - data);
+				if (sync == NULL)
+					sync = end;
+				connection->stats.rxBytes += sync - data;
+				data = sync;
+				if (data < end)
+					processInputByte(connection, *data++);
+				break;
+
+			case UAVTALK_STATE_DATA:
+				if (iproc->rxCount == 0 && (uint32_t)(end - data) > iproc->length)
+				{
+					// Complete payload and checksum available, no need to stage it
+					iproc->cs = PIOS_CRC_updateCRC(iproc->cs, data, iproc->length);
+					iproc->rxPacketLength += iproc->length + 1;
+					connection->stats.rxBytes += iproc->length + 1;
+					processChecksum(connection, data[iproc->length], data);
+					data += iproc->length + 1;
+					break;
+				}
+
+				// Take as much of the payload as is available
+				count = iproc->length - iproc->rxCount;
+				if (count > (uint32_t)(end - data))
+					count = end - data;
+
+				iproc->cs = PIOS_CRC_updateCRC(iproc->cs, data, count);
+				memcpy(&connection->rxBuffer[iproc->rxCount], data, count);
+				iproc->rxCount += count;
+				iproc->rxPacketLength += count;	// bounded by the packet size checked in the header
+				connection->stats.rxBytes += count;
+				connection->stats.rxCopiedBytes += count;
+				data += count;
+
+				if (iproc->rxCount >= iproc->length)
+				{
+					iproc->state = UAVTALK_STATE_CS;
+					iproc->rxCount = 0;
+				}
+				break;
+
+			default:
+				// Header and checksum bytes
+				processInputByte(connection, *data++);
+				break;
+		}
+	}
+
+	// Done
+	return 0;
+}
+
+/**
+ * Run the receive state machine on one byte of the telemetry stream.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] rxbyte Received byte
+ */
+static void processInputByte(UAVTalkConnectionData *connection, uint8_t rxbyte)
+{
 	UAVTalkInputProcessor *iproc = &connection->iproc;
 	++connection->stats.rxBytes;
 	
@@ -424,6 +520,7 @@ int32_t UAVTalkProcessInputStream(UAVTalkConnection connectionHandle, uint8_t rx
 			iproc->cs = PIOS_CRC_updateByte(iproc->cs, rxbyte);
 			
 			connection->rxBuffer[iproc->rxCount++] = rxbyte;
+			++connection->stats.rxCopiedBytes;
 			if (iproc->rxCount < iproc->length)
 				break;
 			
@@ -433,37 +530,45 @@ int32_t UAVTalkProcessInputStream(UAVTalkConnection connectionHandle, uint8_t rx
 			
 		case UAVTALK_STATE_CS:
 			
-			// the CRC byte
-			if (rxbyte != iproc->cs)
-			{   // packet error - faulty CRC
-				connection->stats.rxErrors++;
-				iproc->state = UAVTALK_STATE_SYNC;
-				break;
-			}
-			
-			if (iproc->rxPacketLength != (iproc->packet_size + 1))
-			{   // packet error - mismatched packet size
-				connection->stats.rxErrors++;
-				iproc->state = UAVTALK_STATE_SYNC;
-				break;
-			}
-			
-			xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
-			receiveObject(connection, iproc->type, iproc->objId, iproc->instId, connection->rxBuffer, iproc->length);
-			connection->stats.rxObjectBytes += iproc->length;
-			connection->stats.rxObjects++;
-			xSemaphoreGiveRecursive(connection->lock);
-			
-			iproc->state = UAVTALK_STATE_SYNC;
+			processChecksum(connection, rxbyte, connection->rxBuffer);
 			break;
 			
 		default:
 			connection->stats.rxErrors++;
 			iproc->state = UAVTALK_STATE_SYNC;
 	}
-	
-	// Done
-	return 0;
+}
+
+/**
+ * Check the checksum byte of a packet and process the received object.
+ * \param[in] connection UAVTalkConnection to be used
+ * \param[in] rxbyte Received checksum byte
+ * \param[in] payload Payload of the packet, either the receive buffer or the input block
+ */
+static void processChecksum(UAVTalkConnectionData *connection, uint8_t rxbyte, const uint8_t *payload)
+{
+	UAVTalkInputProcessor *iproc = &connection->iproc;
+
+	iproc->state = UAVTALK_STATE_SYNC;
+
+	// the CRC byte
+	if (rxbyte != iproc->cs)
+	{   // packet error - faulty CRC
+		connection->stats.rxErrors++;
+		return;
+	}
+
+	if (iproc->rxPacketLength != (iproc->packet_size + 1))
+	{   // packet error - mismatched packet size
+		connection->stats.rxErrors++;
+		return;
+	}
+
+	xSemaphoreTakeRecursive(connection->lock, portMAX_DELAY);
+	receiveObject(connection, iproc->type, iproc->objId, iproc->instId, payload, iproc->length);
+	connection->stats.rxObjectBytes += iproc->length;
+	connection->stats.rxObjects++;
+	xSemaphoreGiveRecursive(connection->lock);
 }
 
 /**
@@ -477,7 +582,7 @@ int32_t UAVTalkProcessInputStream(UAVTalkConnection connectionHandle, uint8_t rx
  * \return 0 Success
  * \return -1 Failure
  */
-static int32_t receiveObject(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId, uint8_t* data, int32_t length)
+static int32_t receiveObject(UAVTalkConnectionData *connection, uint8_t type, uint32_t objId, uint16_t instId, const uint8_t* data, int32_t length)
 {
 	UAVObjHandle obj;
 	int32_t ret = 0;
@@ -494,6 +599,7 @@ static int32_t receiveObject(UAVTalkConnectionData *connection, uint8_t type, ui
 			{
 				// Unpack object, if the instance does not exist it will be created!
 				UAVObjUnpack(obj, instId, data);
+				connection->stats.rxCopiedBytes += length;
 				// Check if an ack is pending
 				updateAck(connection, obj, instId);
 			}
@@ -509,6 +615,7 @@ static int32_t receiveObject(UAVTalkConnectionData *connection, uint8_t type, ui
 				// Unpack object, if the instance does not exist it will be created!
 				if ( UAVObjUnpack(obj, instId, data) == 0 )
 				{
+					connection->stats.rxCopiedBytes += length;
 					// Transmit ACK
 					sendObject(connection, obj, instId, UAVTALK_TYPE_ACK);
 				}
@@ -33,6 +33,7 @@ TEMPLATE  = subdirs
 
 SUBDIRS = \
         sub_openpilotgcs \
+        sub_opldecode \
         sub_uavobjects \
         sub_uavobjgenerator
 
@@ -46,3 +47,7 @@ sub_uavobjects.depends = sub_uavobjgenerator
 # openpilotgcs
 sub_openpilotgcs.subdir  = openpilotgcs
 sub_openpilotgcs.depends = sub_uavobjects
+
+# opldecode
+sub_opldecode.subdir  = opldecode
+sub_opldecode.depends = sub_uavobjects
@@ -30,11 +30,153 @@
 //#define DEBUG_PUREIMAGECACHE
 namespace core {
     qlonglong PureImageCache::ConnCounter=0;
+    QThreadStorage<PureImageCache::ThreadConnections*> PureImageCache::threadConnections;
+    QMutex PureImageCache::openLock;
 
-    PureImageCache::PureImageCache()
+    /**
+     * Connection of one thread to the tile database, with its prepared statements
+     */
+    class PureImageCache::Connection
+    {
+    public:
+        Connection(PureImageCache *cache, const QString &file, qlonglong id, int generation);
+        ~Connection();
+        bool isOpen() const { return select!=0; }
+
+        QSqlDatabase db;
+        int generation;
+        QSqlQuery *select;
+        QSqlQuery *insertTile;
+        QSqlQuery *insertData;
+        PureImageCache *cache;      // 0 once the cache is destroyed, written under openLock
+    private:
+        void closeStatements();
+    };
+
+    /**
+     * Connections opened by one thread, to any cache. QThreadStorage deletes them
+     * when the thread exits, so each connection is closed by the thread that opened it.
+     */
+    class PureImageCache::ThreadConnections
+    {
+    public:
+        ~ThreadConnections() { qDeleteAll(list); }
+        QList<Connection*> list;
+    };
+
+    PureImageCache::Connection::Connection(PureImageCache *cache, const QString &file, qlonglong id, int generation):
+            generation(generation),select(0),insertTile(0),insertData(0),cache(cache)
+    {
+        openLock.lock();
+        cache->openConnections.append(this);
+        openLock.unlock();
+        db=QSqlDatabase::addDatabase("QSQLITE",QString("PureImageCache%1").arg(id));
+        db.setDatabaseName(file);
+        if(!db.open())
+        {
+#ifdef DEBUG_PUREIMAGECACHE
+            qDebug()<<"Connection: "<<db.lastError().driverText();
+#endif //DEBUG_PUREIMAGECACHE
+            return;
+        }
+        {
+            // A cache does not need to survive a power loss, WAL keeps it consistent
+            QSqlQuery query(db);
+            query.exec("PRAGMA synchronous=NORMAL");
+        }
+        select=new QSqlQuery(db);
+        insertTile=new QSqlQuery(db);
+        insertData=new QSqlQuery(db);
+        if(!select->prepare("SELECT Tile FROM TilesData WHERE id = (SELECT id FROM Tiles WHERE X=? AND Y=? AND Zoom=? AND Type=?)") ||
+           !insertTile->prepare("INSERT INTO Tiles(X, Y, Zoom, Type,Date) VALUES(?, ?, ?, ?,?)") ||
+           !insertData->prepare("INSERT INTO TilesData(id, Tile) VALUES((SELECT last_insert_rowid()), ?)"))
+        {
+#ifdef DEBUG_PUREIMAGECACHE
+            qDebug()<<"Connection: "<<db.lastError().driverText();
+#endif //DEBUG_PUREIMAGECACHE
+            closeStatements();
+        }
+    }
+    PureImageCache::Connection::~Connection()
+    {
+        QString name=db.connectionName();
+        closeStatements();
+        db.close();
+        db=QSqlDatabase();
+        QSqlDatabase::removeDatabase(name);
+        openLock.lock();
+        if(cache)
+            cache->openConnections.removeOne(this);
+        openLock.unlock();
+    }
+    void PureImageCache::Connection::closeStatements()
+    {
+        delete select;
+        delete insertTile;
+        delete insertData;
+        select=0;
+        insertTile=0;
+        insertData=0;
+    }
+
+    PureImageCache::PureImageCache():generation(0)
     {
 
     }
+    PureImageCache::~PureImageCache()
+    {
+        // A QSqlDatabase may only be closed by its own thread, the connections of the
+        // other threads are detached from the cache and closed when their threads exit
+        lock.lockForWrite();
+        if(threadConnections.hasLocalData())
+        {
+            QList<Connection*> &list=threadConnections.localData()->list;
+            for(int i=list.size()-1;i>=0;--i)
+            {
+                if(list[i]->cache==this)
+                    delete list.takeAt(i);
+            }
+        }
+        openLock.lock();
+        foreach(Connection *cn,openConnections)
+            cn->cache=0;
+        openConnections.clear();
+        openLock.unlock();
+        lock.unlock();
+    }
+
+    /**
+     * Returns the connection of the calling thread, opening it on first use or after
+     * the cache directory changed. Must be called with the lock held.
+     */
+    PureImageCache::Connection *PureImageCache::connection()
+    {
+        if(!threadConnections.hasLocalData())
+            threadConnections.setLocalData(new ThreadConnections);
+        QList<Connection*> &list=threadConnections.localData()->list;
+        for(int i=0;i<list.size();++i)
+        {
+            if(list[i]->cache!=this)
+                continue;
+            if(list[i]->generation==generation)
+                return list[i];
+            // The cache moved to another directory
+            delete list.takeAt(i);
+            break;
+        }
+        Mcounter.lock();
+        qlonglong id=++ConnCounter;
+        Mcounter.unlock();
+        Connection *cn=new Connection(this,gtilecache+"Data.qmdb",id,generation);
+        if(!cn->isOpen())
+        {
+            // Try again on the next tile
+            delete cn;
+            return 0;
+        }
+        list.append(cn);
+        return cn;
+    }
 
     void PureImageCache::setGtileCache(const QString &value)
     {
@@ -57,7 +199,12 @@ namespace core {
 #endif //DEBUG_PUREIMAGECACHE
                 CreateEmptyDB(db);
             }
+            else
+            {
+                UpgradeDB(db);
+            }
         }
+        ++generation;
         lock.unlock();
     }
     QString PureImageCache::GtileCache()
@@ -167,7 +314,35 @@ namespace core {
         }
         db.close();
         QSqlDatabase::removeDatabase(QLatin1String("CreateConn"));
-        return true;
+        return UpgradeDB(file);
+    }
+    /**
+     * Adds the tile lookup index to databases created by older versions and
+     * switches them to write-ahead logging, so readers do not wait for the writer
+     */
+    bool PureImageCache::UpgradeDB(const QString &file)
+    {
+        bool ret=false;
+        {
+            QSqlDatabase db=QSqlDatabase::addDatabase("QSQLITE",QLatin1String("UpgradeConn"));
+            db.setDatabaseName(file);
+            if(db.open())
+            {
+                {
+                    QSqlQuery query(db);
+                    ret=query.exec("CREATE INDEX IF NOT EXISTS IndexOfTiles ON Tiles (X, Y, Zoom, Type)");
+#ifdef DEBUG_PUREIMAGECACHE
+                    if(!ret)
+                        qDebug()<<"UpgradeDB: "<<query.lastError().driverText();
+#endif //DEBUG_PUREIMAGECACHE
+                    // Persistent in the file, a no-op before SQLite 3.7
+                    query.exec("PRAGMA journal_mode=WAL");
+                }
+                db.close();
+            }
+        }
+        QSqlDatabase::removeDatabase(QLatin1String("UpgradeConn"));
+        return ret;
     }
     bool PureImageCache::PutImageToCache(const QByteArray &tile, const MapType::Types &type,const Point &pos,const int &zoom)
     {
@@ -177,80 +352,83 @@ namespace core {
 #ifdef DEBUG_PUREIMAGECACHE
         qDebug()<<"PutImageToCache Start:";//<<pos;
 #endif //DEBUG_PUREIMAGECACHE
-        Mcounter.lock();
-        qlonglong id=++ConnCounter;
-        Mcounter.unlock();
+        bool ret=false;
+        Connection *cn=connection();
+        if(cn)
         {
-            QSqlDatabase cn;
-            cn = QSqlDatabase::addDatabase("QSQLITE",QString::number(id));
-            QString db=gtilecache+"Data.qmdb";
-            cn.setDatabaseName(db);
-            cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-            if(cn.open())
+            cn->db.transaction();
+            ret=InsertTile(cn,tile,type,pos,zoom);
+            if(ret)
+                ret=cn->db.commit();
+            else
+                cn->db.rollback();
+        }
+        lock.unlock();
+        return ret;
+    }
+    /**
+     * Stores a batch of tiles in a single transaction, which costs one sync of
+     * the database instead of one per tile. Nothing is stored if a tile fails.
+     */
+    bool PureImageCache::PutImagesToCache(const QList<CacheItemQueue*> &tiles)
+    {
+        if(gtilecache.isEmpty()|gtilecache.isNull())
+            return false;
+        lock.lockForRead();
+        bool ret=false;
+        Connection *cn=connection();
+        if(cn)
+        {
+            cn->db.transaction();
+            ret=true;
+            foreach(CacheItemQueue *item,tiles)
             {
+                if(!InsertTile(cn,item->GetImg(),item->GetMapType(),item->GetPosition(),item->GetZoom()))
                 {
-                    QSqlQuery query(cn);
-                    query.prepare("INSERT INTO Tiles(X, Y, Zoom, Type,Date) VALUES(?, ?, ?, ?,?)");
-                    query.addBindValue(pos.X());
-                    query.addBindValue(pos.Y());
-                    query.addBindValue(zoom);
-
-                    query.addBindValue((int)type);
-                    query.addBindValue(QDateTime::currentDateTime().toString());
-                    query.exec();
+                    ret=false;
+                    break;
                 }
-                {
-                    QSqlQuery query(cn);
-                    query.prepare("INSERT INTO TilesData(id, Tile) VALUES((SELECT last_insert_rowid()), ?)");
-                    query.addBindValue(tile);
-                    query.exec();
-                }
-                cn.close();
             }
+            if(ret)
+                ret=cn->db.commit();
+            else
+                cn->db.rollback();
         }
-        QSqlDatabase::removeDatabase(QString::number(id));
         lock.unlock();
-        return true;
+        return ret;
+    }
+    bool PureImageCache::InsertTile(Connection *cn,const QByteArray &tile,const MapType::Types &type,const Point &pos,const int &zoom)
+    {
+        cn->insertTile->bindValue(0,pos.X());
+        cn->insertTile->bindValue(1,pos.Y());
+        cn->insertTile->bindValue(2,zoom);
+        cn->insertTile->bindValue(3,(int)type);
+        cn->insertTile->bindValue(4,QDateTime::currentDateTime().toString());
+        cn->insertData->bindValue(0,tile);
+        return cn->insertTile->exec() && cn->insertData->exec();
     }
     QByteArray PureImageCache::GetImageFromCache(MapType::Types type, Point pos, int zoom)
     {
-        lock.lockForRead();
         QByteArray ar;
         if(gtilecache.isEmpty()|gtilecache.isNull())
             return ar;
-        QString dir=gtilecache;
-        Mcounter.lock();
-        qlonglong id=++ConnCounter;
-        Mcounter.unlock();
+        lock.lockForRead();
 #ifdef DEBUG_PUREIMAGECACHE
-        qDebug()<<"Cache dir="<<dir<<" Try to GET:"<<pos.X()+","+pos.Y();
+        qDebug()<<"Cache dir="<<gtilecache<<" Try to GET:"<<pos.X()+","+pos.Y();
 #endif //DEBUG_PUREIMAGECACHE
-
+        Connection *cn=connection();
+        if(cn)
         {
-            QString db=dir+"Data.qmdb";
-            {
-                QSqlDatabase cn;
-
-                cn = QSqlDatabase::addDatabase("QSQLITE",QString::number(id));
-
-                cn.setDatabaseName(db);
-                cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-                if(cn.open())
-                {
-                    {
-                        QSqlQuery query(cn);
-                        query.exec(QString("SELECT Tile FROM TilesData WHERE id = (SELECT id FROM Tiles WHERE X=%1 AND Y=%2 AND Zoom=%3 AND Type=%4)").arg(pos.X()).arg(pos.Y()).arg(zoom).arg((int) type));
-                        query.next();
-                        if(query.isValid())
-                        {
-                            ar=query.value(0).toByteArray();
-                        }
-                    }
-                    cn.close();
-                }
-            }
+            QSqlQuery *query=cn->select;
+            query->bindValue(0,pos.X());
+            query->bindValue(1,pos.Y());
+            query->bindValue(2,zoom);
+            query->bindValue(3,(int)type);
+            if(query->exec() && query->next())
+                ar=query->value(0).toByteArray();
+            // Ends the read transaction so the WAL can be checkpointed
+            query->finish();
         }
-        QSqlDatabase::removeDatabase(QString::number(id));
         lock.unlock();
         return ar;
     }
@@ -258,42 +436,29 @@ namespace core {
     {
         if(gtilecache.isEmpty()|gtilecache.isNull())
             return;
-        QList<long> add;
-        bool ret=true;
-        QString dir=gtilecache;
+        lock.lockForRead();
+        Connection *cn=connection();
+        if(cn)
         {
-            QString db=dir+"Data.qmdb";
-            ret=QFileInfo(db).exists();
-            if(ret)
+            QList<qlonglong> add;
+            QSqlQuery query(cn->db);
+            query.exec(QString("SELECT id, Date FROM Tiles"));
+            while(query.next())
             {
-                QSqlDatabase cn;
-                Mcounter.lock();
-                qlonglong id=++ConnCounter;
-                Mcounter.unlock();
-                cn = QSqlDatabase::addDatabase("QSQLITE",QString::number(id));
-                cn.setDatabaseName(db);
-                cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
-                if(cn.open())
-                {
-                    {
-                        QSqlQuery query(cn);
-                        query.exec(QString("SELECT id, X, Y, Zoom, Type, Date FROM Tiles"));
-                        while(query.next())
-                        {
-                            if(QDateTime::fromString(query.value(5).toString()).daysTo(QDateTime::currentDateTime())>days)
-                                add.append(query.value(0).toLongLong());
-                        }
-                        foreach(long i,add)
-                        {
-                            query.exec(QString("DELETE FROM Tiles WHERE id = %1;").arg(i));
-                        }
-                    }
-
-                    cn.close();
-                }
-                QSqlDatabase::removeDatabase(QString::number(id));
+                if(QDateTime::fromString(query.value(1).toString()).daysTo(QDateTime::currentDateTime())>days)
+                    add.append(query.value(0).toLongLong());
             }
+            query.finish();
+            query.prepare("DELETE FROM Tiles WHERE id = ?");
+            cn->db.transaction();
+            foreach(qlonglong i,add)
+            {
+                query.bindValue(0,i);
+                query.exec();
+            }
+            cn->db.commit();
         }
+        lock.unlock();
     }
     // PureImageCache::ExportMapDataToDB("C:/Users/Xapo/Documents/mapcontrol/debug/mapscache/data.qmdb","C:/Users/Xapo/Documents/mapcontrol/debug/mapscache/data2.qmdb");
     bool PureImageCache::ExportMapDataToDB(QString sourceFile, QString destFile)
@@ -39,27 +39,49 @@
 #include "point.h"
 #include <QVariant>
 #include "pureimage.h"
+#include "cacheitemqueue.h"
 #include <QList>
 #include <QMutex>
 #include <QReadWriteLock>
+#include <QThreadStorage>
 namespace core {
+    /**
+     * SQLite tile cache in gtilecache/Data.qmdb.
+     * Every thread keeps its own connection to the database, with the tile
+     * SELECT and INSERT statements prepared once, until the thread exits or
+     * the cache moves to another directory. A connection is only ever closed
+     * by its own thread: destroying the cache closes the connection of the
+     * calling thread, those of the other threads are closed when they exit.
+     */
     class PureImageCache
     {
 
     public:
         PureImageCache();
+        ~PureImageCache();
         static bool CreateEmptyDB(const QString &file);
         bool PutImageToCache(const QByteArray &tile,const MapType::Types &type,const core::Point &pos, const int &zoom);
+        bool PutImagesToCache(const QList<CacheItemQueue*> &tiles);
         QByteArray GetImageFromCache(MapType::Types type, core::Point pos, int zoom);
         QString GtileCache();
         void setGtileCache(const QString &value);
         static bool ExportMapDataToDB(QString sourceFile, QString destFile);
         void deleteOlderTiles(int const& days);
     private:
+        class Connection;
+        class ThreadConnections;
+        Connection *connection();
+        static bool InsertTile(Connection *cn,const QByteArray &tile,const MapType::Types &type,const core::Point &pos,const int &zoom);
+        static bool UpgradeDB(const QString &file);
+
         QString gtilecache;
+        int generation;
         QMutex Mcounter;
         QReadWriteLock lock;
         static qlonglong ConnCounter;
+        static QThreadStorage<ThreadConnections*> threadConnections;
+        static QMutex openLock;
+        QList<Connection*> openConnections;    // of all threads, guarded by openLock
 
     };
 
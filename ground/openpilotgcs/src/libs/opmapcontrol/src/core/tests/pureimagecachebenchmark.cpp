@@ -0,0 +1,246 @@
+/**
+******************************************************************************
+*
+* @file       pureimagecachebenchmark.cpp
+* @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2011.
+* @brief      Benchmark of the SQLite tile cache
+* @see        The GNU Public License (GPL) Version 3
+* @defgroup   OPMapWidget
+* @{
+* 
+*****************************************************************************/
+/* 
+* This program is free software; you can redistribute it and/or modify 
+* it under the terms of the GNU General Public License as published by 
+* the Free Software Foundation; either version 3 of the License, or 
+* (at your option) any later version.
+* 
+* This program is distributed in the hope that it will be useful, but 
+* WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY 
+* or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License 
+* for more details.
+* 
+* You should have received a copy of the GNU General Public License along 
+* with this program; if not, write to the Free Software Foundation, Inc., 
+* 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+*/
+#include <QtTest/QtTest>
+#include <QTemporaryFile>
+#include <QSemaphore>
+#include "pureimagecache.h"
+
+using namespace core;
+
+/**
+ * Reads one tile and keeps running, with its connection open, until released
+ */
+class ReaderThread: public QThread
+{
+public:
+    ReaderThread(PureImageCache *cache, QSemaphore *done, QSemaphore *release):
+        cache(cache), done(done), release(release) {}
+protected:
+    void run()
+    {
+        cache->GetImageFromCache(MapType::GoogleSatellite, Point(0, 0), 17);
+        done->release();
+        release->acquire();
+    }
+private:
+    PureImageCache *cache;
+    QSemaphore *done;
+    QSemaphore *release;
+};
+
+/**
+ * Reads a block of tiles the way a pan at high zoom does. Cold reads go through a
+ * new cache object, so every pass opens its connection and prepares its statements
+ * on an empty page cache; warm reads reuse the connection of the benchmark thread.
+ * The per tile case is what the cache did before: one connection and one SELECT
+ * built from a string for every tile.
+ */
+class PureImageCacheBenchmark: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void cleanupTestCase();
+    void coldRead();
+    void warmRead();
+    void perTileConnectionRead();
+    void write();
+    void closeThreadConnections();
+
+private:
+    // Tiles read by one pass, SIDE x SIDE
+    static const int SIDE = 32;
+    static const int ZOOM = 17;
+    // Size of a typical satellite tile
+    static const int TILE_SIZE = 16 * 1024;
+
+    QString dir;
+    QByteArray tile;
+
+    int readAll(PureImageCache &cache);
+    static void report(const char *what, int tiles, int ms);
+};
+
+void PureImageCacheBenchmark::initTestCase()
+{
+    {
+        QTemporaryFile file;
+        QVERIFY(file.open());
+        dir = file.fileName() + "_tiles" + QDir::separator();
+    }
+    tile.resize(TILE_SIZE);
+    for (int i = 0; i < TILE_SIZE; ++i)
+        tile[i] = char(qrand());
+
+    PureImageCache cache;
+    cache.setGtileCache(dir);
+    for (int x = 0; x < SIDE; ++x)
+        for (int y = 0; y < SIDE; ++y)
+            QVERIFY(cache.PutImageToCache(tile, MapType::GoogleSatellite, Point(x, y), ZOOM));
+}
+
+void PureImageCacheBenchmark::cleanupTestCase()
+{
+    QDir d(dir);
+    foreach (QString name, d.entryList(QDir::Files))
+        d.remove(name);
+    d.rmdir(dir);
+}
+
+int PureImageCacheBenchmark::readAll(PureImageCache &cache)
+{
+    int found = 0;
+    for (int x = 0; x < SIDE; ++x)
+        for (int y = 0; y < SIDE; ++y)
+            if (cache.GetImageFromCache(MapType::GoogleSatellite, Point(x, y), ZOOM).size() == TILE_SIZE)
+                ++found;
+    return found;
+}
+
+void PureImageCacheBenchmark::report(const char *what, int tiles, int ms)
+{
+    qDebug("%s: %.0f tiles/s", what, ms > 0 ? tiles * 1000.0 / ms : 0.0);
+}
+
+void PureImageCacheBenchmark::coldRead()
+{
+    int tiles = 0;
+    QTime time;
+    int elapsed = 0;
+    QBENCHMARK {
+        time.start();
+        PureImageCache cache;
+        cache.setGtileCache(dir);
+        QCOMPARE(readAll(cache), SIDE * SIDE);
+        elapsed += time.elapsed();
+        tiles += SIDE * SIDE;
+    }
+    report("cold", tiles, elapsed);
+}
+
+void PureImageCacheBenchmark::warmRead()
+{
+    PureImageCache cache;
+    cache.setGtileCache(dir);
+    QCOMPARE(readAll(cache), SIDE * SIDE);
+
+    int tiles = 0;
+    QTime time;
+    int elapsed = 0;
+    QBENCHMARK {
+        time.start();
+        QCOMPARE(readAll(cache), SIDE * SIDE);
+        elapsed += time.elapsed();
+        tiles += SIDE * SIDE;
+    }
+    report("warm", tiles, elapsed);
+}
+
+void PureImageCacheBenchmark::perTileConnectionRead()
+{
+    int tiles = 0;
+    QTime time;
+    int elapsed = 0;
+    qlonglong id = 0;
+    QBENCHMARK {
+        time.start();
+        int found = 0;
+        for (int x = 0; x < SIDE; ++x) {
+            for (int y = 0; y < SIDE; ++y) {
+                QString name = QString("PerTile%1").arg(++id);
+                {
+                    QSqlDatabase cn = QSqlDatabase::addDatabase("QSQLITE", name);
+                    cn.setDatabaseName(dir + "Data.qmdb");
+                    cn.setConnectOptions("QSQLITE_ENABLE_SHARED_CACHE");
+                    if (cn.open()) {
+                        {
+                            QSqlQuery query(cn);
+                            query.exec(QString("SELECT Tile FROM TilesData WHERE id = (SELECT id FROM Tiles WHERE X=%1 AND Y=%2 AND Zoom=%3 AND Type=%4)")
+                                       .arg(x).arg(y).arg(ZOOM).arg((int)MapType::GoogleSatellite));
+                            if (query.next() && query.value(0).toByteArray().size() == TILE_SIZE)
+                                ++found;
+                        }
+                        cn.close();
+                    }
+                }
+                QSqlDatabase::removeDatabase(name);
+            }
+        }
+        QCOMPARE(found, SIDE * SIDE);
+        elapsed += time.elapsed();
+        tiles += SIDE * SIDE;
+    }
+    report("per tile connection", tiles, elapsed);
+}
+
+void PureImageCacheBenchmark::write()
+{
+    PureImageCache cache;
+    cache.setGtileCache(dir);
+    int zoom = ZOOM;
+    QBENCHMARK {
+        ++zoom;
+        for (int x = 0; x < SIDE; ++x)
+            QVERIFY(cache.PutImageToCache(tile, MapType::GoogleSatellite, Point(x, 0), zoom));
+    }
+}
+
+/**
+ * Destroying the cache closes the connection of the calling thread, the connections
+ * of the threads that are still running are closed by those threads when they exit
+ */
+void PureImageCacheBenchmark::closeThreadConnections()
+{
+    const int THREADS = 4;
+    QSemaphore done;
+    QSemaphore release;
+    QList<ReaderThread*> threads;
+
+    PureImageCache *cache = new PureImageCache;
+    cache->setGtileCache(dir);
+    QCOMPARE(readAll(*cache), SIDE * SIDE);
+    for (int n = 0; n < THREADS; ++n) {
+        threads.append(new ReaderThread(cache, &done, &release));
+        threads.last()->start();
+    }
+    done.acquire(THREADS);
+    QCOMPARE(QSqlDatabase::connectionNames().filter("PureImageCache").size(), THREADS + 1);
+
+    delete cache;
+    QCOMPARE(QSqlDatabase::connectionNames().filter("PureImageCache").size(), THREADS);
+
+    release.release(THREADS);
+    foreach (ReaderThread *thread, threads) {
+        QVERIFY(thread->wait(5000));
+        delete thread;
+    }
+    QCOMPARE(QSqlDatabase::connectionNames().filter("PureImageCache").size(), 0);
+}
+
+QTEST_MAIN(PureImageCacheBenchmark)
+#include "pureimagecachebenchmark.moc"
@@ -0,0 +1,18 @@
+# -------------------------------------------------
+# QTestLib benchmark of the SQLite tile cache
+# -------------------------------------------------
+QT += sql
+QT += testlib
+TARGET = pureimagecachebenchmark
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+INCLUDEPATH += ..
+SOURCES += pureimagecachebenchmark.cpp \
+    ../pureimagecache.cpp \
+    ../point.cpp \
+    ../size.cpp
+HEADERS += ../pureimagecache.h \
+    ../maptype.h \
+    ../point.h \
+    ../size.h
@@ -30,7 +30,7 @@
 //#define DEBUG_TILECACHEQUEUE
  
 namespace core {
-TileCacheQueue::TileCacheQueue()
+TileCacheQueue::TileCacheQueue():running(false)
 {
 
 }
@@ -44,80 +44,74 @@ void TileCacheQueue::EnqueueCacheTask(CacheItemQueue *task)
 #ifdef DEBUG_TILECACHEQUEUE
     qDebug()<<"DB Do I EnqueueCacheTask"<<task->GetPosition().X()<<","<<task->GetPosition().Y();
 #endif //DEBUG_TILECACHEQUEUE
-    if(!tileCacheQueue.contains(task))
+    QMutexLocker locker(&mutex);
+    RawTile key(task->GetMapType(),task->GetPosition(),task->GetZoom());
+    if(pending.contains(key))
     {
+        delete task;
+        return;
+    }
 #ifdef DEBUG_TILECACHEQUEUE
-        qDebug()<<"EnqueueCacheTask"<<task->GetPosition().X()<<","<<task->GetPosition().Y();
+    qDebug()<<"EnqueueCacheTask"<<task->GetPosition().X()<<","<<task->GetPosition().Y();
 #endif //DEBUG_TILECACHEQUEUE
-        mutex.lock();
-        tileCacheQueue.enqueue(task);
-        mutex.unlock();
-        if(this->isRunning())
-        {
+    pending.insert(key);
+    tileCacheQueue.enqueue(task);
+    if(running)
+    {
 #ifdef DEBUG_TILECACHEQUEUE
-            qDebug()<<"Wake Thread";
+        qDebug()<<"Wake Thread";
 #endif //DEBUG_TILECACHEQUEUE
-            //this->start(QThread::NormalPriority);
-            //waitmutex.lock();
-            waitc.wakeAll();
-            //waitmutex.unlock();
-        }
-        else
-        {
+        waitc.wakeAll();
+    }
+    else
+    {
 #ifdef DEBUG_TILECACHEQUEUE
-            qDebug()<<"Start Thread";
+        qDebug()<<"Start Thread";
 #endif //DEBUG_TILECACHEQUEUE
-            this->start(QThread::NormalPriority);
-        }
+        // The thread may still be returning from run() after its timeout
+        wait();
+        running=true;
+        this->start(QThread::NormalPriority);
     }
-
 }
 void TileCacheQueue::run()
 {
 #ifdef DEBUG_TILECACHEQUEUE
     qDebug()<<"Cache Engine Start";
 #endif //DEBUG_TILECACHEQUEUE
+    QList<CacheItemQueue*> batch;
     while(true)
     {
-        CacheItemQueue *task;
-#ifdef DEBUG_TILECACHEQUEUE
-        qDebug()<<"Cache";
-#endif //DEBUG_TILECACHEQUEUE
-        if(tileCacheQueue.count()>0)
+        mutex.lock();
+        if(tileCacheQueue.isEmpty())
         {
-            mutex.lock();
-            task=tileCacheQueue.dequeue();
-            mutex.unlock();
 #ifdef DEBUG_TILECACHEQUEUE
-            qDebug()<<"Cache engine Put:"<<task->GetPosition().X()<<","<<task->GetPosition().Y();
-#endif //DEBUG_TILECACHEQUEUE
-            Cache::Instance()->ImageCache.PutImageToCache(task->GetImg(),task->GetMapType(),task->GetPosition(),task->GetZoom());
-            usleep(44);
-            delete task;
-        }
-
-        else
-        {
             qDebug()<<"Cache engine BEGIN WAIT";
-            waitmutex.lock();
+#endif //DEBUG_TILECACHEQUEUE
             int tout=4000;
-            if(!waitc.wait(&waitmutex,tout))
+            if(!waitc.wait(&mutex,tout) && tileCacheQueue.isEmpty())
             {
-                waitmutex.unlock();
 #ifdef DEBUG_TILECACHEQUEUE
                 qDebug()<<"Cache Engine TimeOut";
 #endif //DEBUG_TILECACHEQUEUE
-                mutex.lock();
-                if(tileCacheQueue.count()==0)
-                {
-                    mutex.unlock();
-                    break;
-                }
+                running=false;
                 mutex.unlock();
+                break;
             }
-            qDebug()<<"Cache Engine DID NOT TimeOut";
-            waitmutex.unlock();
         }
+        while(!tileCacheQueue.isEmpty() && batch.count()<MAX_BATCH)
+            batch.append(tileCacheQueue.dequeue());
+        mutex.unlock();
+#ifdef DEBUG_TILECACHEQUEUE
+        qDebug()<<"Cache engine Put:"<<batch.count()<<"tiles";
+#endif //DEBUG_TILECACHEQUEUE
+        Cache::Instance()->ImageCache.PutImagesToCache(batch);
+        mutex.lock();
+        foreach(CacheItemQueue *task,batch)
+            pending.remove(RawTile(task->GetMapType(),task->GetPosition(),task->GetZoom()));
+        mutex.unlock();
+        qDeleteAll(batch);
+        batch.clear();
     }
 #ifdef DEBUG_TILECACHEQUEUE
     qDebug()<<"Cache Engine Stopped";
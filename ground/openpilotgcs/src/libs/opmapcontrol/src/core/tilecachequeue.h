@@ -34,11 +34,18 @@
 #include <QWaitCondition>
 #include <QObject>
 #include <QMutexLocker>
+#include <QSet>
 #include "pureimagecache.h"
 #include "cache.h"
+#include "rawtile.h"
 
 
 namespace core {
+    /**
+     * Writes the downloaded tiles to the database from its own thread.
+     * The thread drains the queue in batches of up to MAX_BATCH tiles, each
+     * stored in one transaction, and stops after 4s without work.
+     */
     class TileCacheQueue:public QThread
     {
         Q_OBJECT
@@ -50,10 +57,14 @@ namespace core {
     protected:
         QQueue<CacheItemQueue*> tileCacheQueue;
     private:
+        static const int MAX_BATCH=256;
+
         void run();
         QMutex mutex;
-        QMutex waitmutex;
         QWaitCondition waitc;
+        // Tiles queued or being written, to drop the ones downloaded twice
+        QSet<RawTile> pending;
+        bool running;
     };
 }
 #endif // TILECACHEQUEUE_H
@@ -108,6 +108,11 @@ void ConfigPlugin::shutdown()
 void ConfigPlugin::onAutopilotConnect()
 {
     cmd->action()->setEnabled(true);
+
+    // Warn once per connection when the board can not use its settings storage
+    settingsAlarmShown = false;
+    SystemAlarms* alarms = SystemAlarms::GetInstance(getObjectManager());
+    connect(alarms, SIGNAL(objectUpdated(UAVObject*)), this, SLOT(checkSettingsAlarm(UAVObject*)), Qt::UniqueConnection);
 }
 
 /**
@@ -116,6 +121,32 @@ void ConfigPlugin::onAutopilotConnect()
 void ConfigPlugin::onAutopilotDisconnect()
 {
     cmd->action()->setEnabled(false);
+
+    SystemAlarms* alarms = SystemAlarms::GetInstance(getObjectManager());
+    disconnect(alarms, SIGNAL(objectUpdated(UAVObject*)), this, SLOT(checkSettingsAlarm(UAVObject*)));
+}
+
+/**
+  * Tell the user when the board keeps settings of an older flash layout, the
+  * firmware does not format it until all settings are erased from the menu
+  */
+void ConfigPlugin::checkSettingsAlarm(UAVObject * obj)
+{
+    SystemAlarms* alarms = dynamic_cast<SystemAlarms*>(obj);
+    Q_ASSERT(alarms);
+
+    if (settingsAlarmShown || alarms->getData().Alarm[SystemAlarms::ALARM_SETTINGS] < SystemAlarms::ALARM_ERROR)
+        return;
+    settingsAlarmShown = true;
+
+    QMessageBox msgBox;
+    msgBox.setText(tr("The board can not load or save its settings."));
+    msgBox.setInformativeText(tr("The board runs with default settings and will not arm. Most likely the settings were saved by an older "
+                                 "firmware in a format this firmware does not read. To keep them, flash the older firmware and export them first. "
+                                 "Then use \"Erase all settings from board...\" in the Tools menu to start over."));
+    msgBox.setStandardButtons(QMessageBox::Ok);
+    msgBox.setDefaultButton(QMessageBox::Ok);
+    msgBox.exec();
 }
 
 
@@ -33,6 +33,7 @@
 #include <coreplugin/actionmanager/actionmanager.h>
 #include "uavtalk/telemetrymanager.h"
 #include "objectpersistence.h"
+#include "systemalarms.h"
 
 
 #include <QMessageBox>
@@ -59,11 +60,13 @@ private slots:
     void onAutopilotDisconnect();
     void eraseDone(UAVObject *);
     void eraseFailed();
+    void checkSettingsAlarm(UAVObject *);
 
  private:
     ConfigGadgetFactory *cf;
     Core::Command* cmd;
     bool settingsErased;
+    bool settingsAlarmShown;
 
 };
 
@@ -113,6 +113,7 @@ void DialGadgetWidget::connectNeedles(QString object1, QString nfield1,
                 field1=  nfield1;
                 haveSubField1 = false;
             }
+            field1Binding = obj1->bindField(field1, haveSubField1 ? subfield1 : QString());
         } else {
             qDebug() << "Error: Object is unknown (" << object1 << ").";
         }
@@ -136,6 +137,7 @@ void DialGadgetWidget::connectNeedles(QString object1, QString nfield1,
                 field2=  nfield2;
                 haveSubField2 = false;
             }
+            field2Binding = obj2->bindField(field2, haveSubField2 ? subfield2 : QString());
         } else {
             qDebug() << "Error: Object is unknown (" << object2 << ").";
         }
@@ -159,6 +161,7 @@ void DialGadgetWidget::connectNeedles(QString object1, QString nfield1,
                 field3=  nfield3;
                 haveSubField3 = false;
             }
+            field3Binding = obj3->bindField(field3, haveSubField3 ? subfield3 : QString());
         } else {
             qDebug() << "Error: Object is unknown (" << object3 << ").";
         }
@@ -169,15 +172,9 @@ void DialGadgetWidget::connectNeedles(QString object1, QString nfield1,
   \brief Called by the UAVObject which got updated
   */
 void DialGadgetWidget::updateNeedle1(UAVObject *object1) {
-    // Double check that the field exists:
-    double value;
-    UAVObjectField* field = object1->getField(field1);
-    if (field) {
-        if(haveSubField1){
-            int indexOfSubField = field->getElementNames().indexOf(QRegExp(subfield1, Qt::CaseSensitive, QRegExp::FixedString));
-            value = field->getDouble(indexOfSubField);
-        } else
-            value = field->getDouble();
+    Q_UNUSED(object1);
+    if (field1Binding.isValid()) {
+        double value = field1Binding.getDouble();
         if (value != value) {
             qDebug() << "Dial widget: encountered NaN !!";
             return;
@@ -192,14 +189,9 @@ void DialGadgetWidget::updateNeedle1(UAVObject *object1) {
   \brief Called by the UAVObject which got updated
   */
 void DialGadgetWidget::updateNeedle2(UAVObject *object2) {
-    double value;
-    UAVObjectField* field = object2->getField(field2);
-    if (field) {
-        if(haveSubField2){
-            int indexOfSubField = field->getElementNames().indexOf(QRegExp(subfield2, Qt::CaseSensitive, QRegExp::FixedString));
-            value = field->getDouble(indexOfSubField);
-        } else
-            value = field->getDouble();
+    Q_UNUSED(object2);
+    if (field2Binding.isValid()) {
+        double value = field2Binding.getDouble();
         if (value != value) {
             qDebug() << "Dial widget: encountered NaN !!";
             return;
@@ -214,14 +206,9 @@ void DialGadgetWidget::updateNeedle2(UAVObject *object2) {
   \brief Called by the UAVObject which got updated
   */
 void DialGadgetWidget::updateNeedle3(UAVObject *object3) {
-    double value;
-    UAVObjectField* field = object3->getField(field3);
-    if (field) {
-        if(haveSubField3){
-            int indexOfSubField = field->getElementNames().indexOf(QRegExp(subfield3, Qt::CaseSensitive, QRegExp::FixedString));
-            value = field->getDouble(indexOfSubField);
-        } else
-            value = field->getDouble();
+    Q_UNUSED(object3);
+    if (field3Binding.isValid()) {
+        double value = field3Binding.getDouble();
         if (value != value) {
             qDebug() << "Dial widget: encountered NaN !!";
             return;
@@ -144,6 +144,9 @@ private:
    QString field3;
    QString subfield3;
    bool haveSubField3;
+   UAVObjectFieldBinding field1Binding;
+   UAVObjectFieldBinding field2Binding;
+   UAVObjectFieldBinding field3Binding;
 
    // Rotation timer
    QTimer dialTimer;
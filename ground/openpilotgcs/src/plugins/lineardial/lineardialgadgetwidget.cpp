@@ -101,6 +101,7 @@ void LineardialGadgetWidget::connectInput(QString object1, QString nfield1) {
                 field1=  nfield1;
                 haveSubField1 = false;
             }
+            field1Binding = obj1->bindField(field1, haveSubField1 ? subfield1 : QString());
             if (fieldName)
                 fieldName->setPlainText(nfield1);
             updateIndex(obj1);
@@ -117,17 +118,13 @@ void LineardialGadgetWidget::connectInput(QString object1, QString nfield1) {
   Updates the numeric value and/or the icon if the dial wants this.
   */
 void LineardialGadgetWidget::updateIndex(UAVObject *object1) {
+    Q_UNUSED(object1);
     // Double check that the field exists:
-    UAVObjectField* field = object1->getField(field1);
+    UAVObjectField* field = field1Binding.getField();
     if (field) {
         QString s;
         if (field->isNumeric()) {
-            double v;
-            if(haveSubField1){
-                int indexOfSubField = field->getElementNames().indexOf(QRegExp(subfield1, Qt::CaseSensitive, QRegExp::FixedString));
-                v = field->getDouble(indexOfSubField)*factor;
-            }else
-                v = field->getDouble()*factor;
+            double v = field1Binding.getDouble()*factor;
             setIndex(v);
             s.sprintf("%.*f",places,v);
         }
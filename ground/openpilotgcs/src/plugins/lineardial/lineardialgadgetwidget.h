@@ -119,6 +119,7 @@ private:
    QString field1;
    QString subfield1;
    bool haveSubField1;
+   UAVObjectFieldBinding field1Binding;
 
 };
 #endif /* LINEARDIALGADGETWIDGET_H_ */
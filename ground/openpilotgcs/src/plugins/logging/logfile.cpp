@@ -1,9 +1,22 @@
 #include "logfile.h"
 #include <QDebug>
 #include <QtGlobal>
+#include <QtEndian>
+#include <extensionsystem/pluginmanager.h>
+#include "uavobjectfield.h"
+
+static const int KEYFRAME_INTERVAL_MS = 10000;
+// Bytes released per timer event when replaying as fast as possible
+static const int FAST_FORWARD_SLICE = 65536;
 
 LogFile::LogFile(QObject *parent) :
-    QIODevice(parent)
+    QIODevice(parent),
+    timeOffset(0),
+    pausedTime(0),
+    playbackSpeed(1),
+    fastForward(false),
+    writePos(0),
+    inKeyframe(false)
 {
     connect(&timer, SIGNAL(timeout()), this, SLOT(timerFired()));
 }
@@ -17,7 +30,7 @@ bool LogFile::open(OpenMode mode) {
 
     // start a timer for playback
     myTime.restart();
-    if (file.isOpen()) {
+    if (file.isOpen() || reader.isOpen()) {
         // We end up here when doing a replay, because the connection
         // manager will also try to open the QIODevice, even though we just
         // opened it after selecting the file, which happens before the
@@ -25,15 +38,33 @@ bool LogFile::open(OpenMode mode) {
         return true;
     }
 
-    if(file.open(mode) == FALSE)
+    if (mode & QIODevice::WriteOnly)
+    {
+        // The writer thread batches the records, QFile buffering would only add a copy
+        if(file.open(mode | QIODevice::Unbuffered) == FALSE)
+        {
+            qDebug() << "Unable to open " << file.fileName() << " for logging";
+            return false;
+        }
+
+        // Describe the objects so that they can be read back if ID's change
+        stream.setDevice(&file);
+        stream.setByteOrder(QDataStream::LittleEndian);
+        if (!writeHeader())
+        {
+            qDebug() << "Unable to write the header of " << file.fileName();
+            file.close();
+            return false;
+        }
+        writePos = file.pos();
+        writer.begin(&file);
+    }
+    else if (!reader.open(file.fileName()))
     {
-        qDebug() << "Unable to open " << file.fileName() << " for logging";
+        qDebug() << "Unable to open " << file.fileName() << " for replay";
         return false;
     }
 
-    // TODO: Write a header at the beginng describing objects so that in future
-    // they can be read back if ID's change
-
     // Must call parent function for QIODevice to pass calls to writeData
     // We always open ReadWrite, because otherwise we will get tons of warnings
     // during a logfile replay. Read nature is checked upon write ops below.
@@ -48,7 +79,15 @@ void LogFile::close()
 
     if (timer.isActive())
         timer.stop();
+    if (file.isWritable()) {
+        writer.finish();
+        if (writer.recordsDropped() > 0)
+            qDebug() << "Logfile: dropped" << writer.recordsDropped() << "records, the disk did not keep up";
+        writeIndex();
+    }
+    stream.setDevice(0);
     file.close();
+    reader.close();
     QIODevice::close();
 }
 
@@ -56,24 +95,21 @@ qint64 LogFile::writeData(const char * data, qint64 dataSize) {
     if (!file.isWritable())
         return dataSize;
 
-    quint32 timeStamp = myTime.elapsed();
-
-    file.write((char *) &timeStamp,sizeof(timeStamp));
-    file.write((char *) &dataSize, sizeof(dataSize));
+    // The objects of a keyframe are written as a single record
+    if (inKeyframe) {
+        keyframeBuffer.append(data, dataSize);
+        return dataSize;
+    }
 
-    qint64 written = file.write(data, dataSize);
-    if(written != -1)
-        emit bytesWritten(written);
+    if (writeRecord(LogReader::RECORD_DATA, myTime.elapsed(), data, dataSize))
+        emit bytesWritten(dataSize);
 
     return dataSize;
 }
 
 qint64 LogFile::readData(char * data, qint64 maxSize) {
     QMutexLocker locker(&mutex);
-    qint64 toRead = qMin(maxSize,(qint64)dataBuffer.size());
-    memcpy(data,dataBuffer.data(),toRead);
-    dataBuffer.remove(0,toRead);
-    return toRead;
+    return dataBuffer.read(data, qMin(maxSize, (qint64)dataBuffer.size()));
 }
 
 qint64 LogFile::bytesAvailable() const
@@ -81,44 +117,176 @@ qint64 LogFile::bytesAvailable() const
     return dataBuffer.size();
 }
 
-void LogFile::timerFired()
+/**
+ * Returns true when the logging thread should write the state of all objects
+ */
+bool LogFile::keyframeDue()
+{
+    return file.isWritable() && (keyframeTimes.isEmpty() ||
+            (quint32)myTime.elapsed() - keyframeTimes.last() >= (quint32)KEYFRAME_INTERVAL_MS);
+}
+
+/**
+ * Collect the packets written until endKeyframe() in a keyframe record
+ */
+void LogFile::beginKeyframe()
+{
+    keyframeBuffer.clear();
+    inKeyframe = true;
+}
+
+void LogFile::endKeyframe()
 {
-    qint64 dataSize;
+    inKeyframe = false;
+    quint32 timeStamp = myTime.elapsed();
+    qint64 offset = writePos;
+    if (writeRecord(LogReader::RECORD_KEYFRAME, timeStamp, keyframeBuffer.constData(), keyframeBuffer.size())) {
+        keyframeTimes.append(timeStamp);
+        keyframeOffsets.append(offset);
+    }
+    keyframeBuffer.clear();
+}
 
-    if(file.bytesAvailable() > 4)
+/**
+ * Hash of the object name and the name, type and size of its fields, it changes
+ * whenever the layout of the packed object changes
+ */
+quint32 LogFile::layoutHash(UAVObject *obj)
+{
+    QByteArray layout = obj->getName().toLatin1();
+    QList<UAVObjectField*> fields = obj->getFields();
+    for (int n = 0; n < fields.length(); ++n)
     {
+        layout += fields[n]->getName().toLatin1();
+        layout += (char)fields[n]->getType();
+        layout += (char)fields[n]->getNumElements();
+    }
 
-        // TODO: going back in time will be a problem
-        while ((myTime.elapsed() - timeOffset) * playbackSpeed > lastTimeStamp) {
+    // FNV-1a
+    quint32 hash = 2166136261u;
+    for (int n = 0; n < layout.size(); ++n)
+    {
+        hash ^= (quint8)layout[n];
+        hash *= 16777619u;
+    }
+    return hash;
+}
 
-            if(file.bytesAvailable() < 4) {
-                stopReplay();
-                return;
-            }
+/**
+ * Write the magic and the dictionary of all registered objects
+ */
+bool LogFile::writeHeader()
+{
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+    QList< QList<UAVObject*> > objs = objManager->getObjects();
+
+    QByteArray header;
+    QDataStream out(&header, QIODevice::WriteOnly);
+    out.setByteOrder(QDataStream::LittleEndian);
+    out << (quint32)objs.length();
+    for (int n = 0; n < objs.length(); ++n)
+    {
+        UAVObject *obj = objs[n][0];
+        out << obj->getObjID() << layoutHash(obj) << (quint16)obj->getNumBytes()
+            << (quint16)objs[n].length() << obj->getName().toLatin1();
+    }
 
-            file.read((char *) &dataSize, sizeof(dataSize));
+    keyframeTimes.clear();
+    keyframeOffsets.clear();
+    inKeyframe = false;
+    lastTimeStamp = 0;
 
-            if(file.bytesAvailable() < dataSize) {
-                stopReplay();
-                return;
-            }
+    stream.writeRawData(LOGFILE_MAGIC, sizeof(LOGFILE_MAGIC));
+    stream << (quint32)header.size();
+    stream.writeRawData(header.constData(), header.size());
+    return stream.status() == QDataStream::Ok;
+}
 
+/**
+ * Queue a record for the writer thread
+ * \return false if the record was dropped
+ */
+bool LogFile::writeRecord(quint8 type, quint32 timeStamp, const char *data, qint64 dataSize)
+{
+    char header[LOGFILE_RECORD_HEADER_SIZE];
+    qToLittleEndian<quint32>(timeStamp, (uchar *)header);
+    header[4] = type;
+    qToLittleEndian<quint32>((quint32)dataSize, (uchar *)header + 5);
+
+    if (!writer.write(header, sizeof(header), data, dataSize))
+        return false;
+    writePos += sizeof(header) + dataSize;
+    lastTimeStamp = timeStamp;
+    return true;
+}
+
+/**
+ * Append the keyframe index and the trailer pointing at it
+ */
+void LogFile::writeIndex()
+{
+    qint64 indexOffset = file.pos();
+
+    stream << (quint32)keyframeTimes.size();
+    for (int n = 0; n < keyframeTimes.size(); ++n)
+        stream << keyframeTimes[n] << keyframeOffsets[n];
+    stream << indexOffset << (quint32)lastTimeStamp << (quint32)LOGFILE_INDEX_MAGIC;
+}
+
+/**
+ * Warn about logged objects that are unknown or changed since the log was written
+ */
+void LogFile::checkDictionary()
+{
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+    QList<LogReader::ObjectInfo> dictionary = reader.objectDictionary();
+
+    for (int n = 0; n < dictionary.length(); ++n)
+    {
+        UAVObject *obj = objManager->getObject(dictionary[n].objId);
+        if (obj == NULL)
+            qDebug() << "Logfile: object" << dictionary[n].name << "is unknown, its updates are ignored";
+        else if (layoutHash(obj) != dictionary[n].layoutHash)
+            qDebug() << "Logfile: layout of" << dictionary[n].name << "changed since the log was written";
+    }
+}
+
+void LogFile::timerFired()
+{
+    int released = 0;
+
+    // Time only runs forward here, seekReplay moves the reader and the replay clock together
+    // As fast as possible the records are released in slices to keep the event loop running
+    while (fastForward ? released < FAST_FORWARD_SLICE :
+           (myTime.elapsed() - timeOffset) * playbackSpeed > lastTimeStamp) {
+
+        // Keyframes repeat the state the replay already has, they are only used to seek
+        if (reader.recordType() == LogReader::RECORD_DATA) {
             mutex.lock();
-            dataBuffer.append(file.read(dataSize));
+            dataBuffer.append(reader.recordData(), reader.recordSize());
             mutex.unlock();
-            emit readyRead();
-
-            if(file.bytesAvailable() < 4) {
-                stopReplay();
-                return;
-            }
+            released += reader.recordSize();
+        }
 
-            file.read((char *) &lastTimeStamp,sizeof(lastTimeStamp));
+        if (!reader.next()) {
+            if (released > 0)
+                emit readyRead();
+            stopReplay();
+            return;
         }
-    } else {
-        stopReplay();
+        lastTimeStamp = reader.recordTime();
     }
 
+    // UAVTalk decodes everything released by this event in one go
+    if (released > 0)
+        emit readyRead();
+
+    // Keep the replay clock with the data so that normal speed continues from here
+    if (fastForward)
+        timeOffset = myTime.elapsed() - (int)(lastTimeStamp / playbackSpeed);
+    emit replayPosition(lastTimeStamp);
 }
 
 bool LogFile::startReplay() {
@@ -126,8 +294,16 @@ bool LogFile::startReplay() {
     myTime.restart();
     timeOffset = 0;
     playbackSpeed = 1;
-    file.read((char *) &lastTimeStamp,sizeof(lastTimeStamp));
-    timer.setInterval(10);
+
+    checkDictionary();
+    reader.rewind();
+    if (!reader.next()) {
+        stopReplay();
+        return false;
+    }
+    lastTimeStamp = reader.recordTime();
+
+    timer.setInterval(fastForward ? 0 : 10);
     timer.start();
     emit replayStarted();
     return true;
@@ -151,3 +327,44 @@ void LogFile::resumeReplay()
     timer.start();
 }
 
+/**
+ * Release the records as fast as the decoding allows instead of following the clock
+ */
+void LogFile::setFastForward(bool enabled)
+{
+    fastForward = enabled;
+    timer.setInterval(enabled ? 0 : 10);
+}
+
+/**
+ * Jump to a time in a version 2 log. The state at the closest keyframe before
+ * that time and the updates up to it are replayed at once, then the replay
+ * continues from there.
+ * \param[in] timeStamp Time from the start of the log in ms
+ * \return false if the log has no index
+ */
+bool LogFile::seekReplay(int timeStamp)
+{
+    if (!reader.isOpen() || !reader.seekKeyframe(qMax(timeStamp, 0)))
+        return false;
+
+    bool more;
+    mutex.lock();
+    dataBuffer.append(reader.recordData(), reader.recordSize());
+    while ((more = reader.next()) && (qint32)reader.recordTime() < timeStamp) {
+        if (reader.recordType() == LogReader::RECORD_DATA)
+            dataBuffer.append(reader.recordData(), reader.recordSize());
+    }
+    mutex.unlock();
+    emit readyRead();
+
+    // Move the replay clock to the time
+    lastTimeStamp = reader.recordTime();
+    int now = timer.isActive() ? myTime.elapsed() : pausedTime;
+    timeOffset = now - (int)(timeStamp / playbackSpeed);
+    emit replayPosition(timeStamp);
+
+    if (!more)
+        stopReplay();
+    return true;
+}
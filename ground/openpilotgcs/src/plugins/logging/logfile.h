@@ -7,16 +7,28 @@
 #include <QMutexLocker>
 #include <QDebug>
 #include <QBuffer>
+#include <QDataStream>
+#include <QVector>
 #include "uavobjectmanager.h"
+#include "logreader.h"
+#include "ringbuffer.h"
+#include "logwriter.h"
 #include <math.h>
 
+/**
+ * Log file with UAVTalk packets. Version 2 files start with a dictionary of the
+ * logged objects, store a keyframe with the state of all objects at a fixed interval
+ * and end with an index of the keyframes so that a replay can seek. Version 1 files
+ * (bare records) are still replayed.
+ * Records are written to disk by a LogWriter thread.
+ */
 class LogFile : public QIODevice
 {
     Q_OBJECT
 public:
     explicit LogFile(QObject *parent = 0);
     qint64 bytesAvailable() const;
-    qint64 bytesToWrite() { return file.bytesToWrite(); };
+    qint64 bytesToWrite() { return 0; };
     bool open(OpenMode mode);
     void setFileName(QString name) { file.setFileName(name); };
     void close();
@@ -26,10 +38,24 @@ public:
     bool startReplay();
     bool stopReplay();
 
+    bool keyframeDue();
+    void beginKeyframe();
+    void endKeyframe();
+    int replayLength() { return reader.length(); };
+    QList<LogReader::ObjectInfo> objectDictionary() { return reader.objectDictionary(); };
+
+    void setSyncInterval(int ms) { writer.setSyncInterval(ms); };
+    quint32 recordsWritten() const { return writer.recordsWritten(); };
+    quint32 recordsDropped() const { return writer.recordsDropped(); };
+
+    static quint32 layoutHash(UAVObject *obj);
+
 public slots:
     void setReplaySpeed(double val) { playbackSpeed = pow(10,(val)/100); qDebug() << playbackSpeed; };
     void pauseReplay();
     void resumeReplay();
+    bool seekReplay(int timeStamp);
+    void setFastForward(bool enabled);
 
 protected slots:
     void timerFired();
@@ -38,12 +64,16 @@ signals:
     void readReady();
     void replayStarted();
     void replayFinished();
+    void replayPosition(int timeStamp);
 
 protected:
-    QByteArray dataBuffer;
+    RingBuffer dataBuffer;
     QTimer timer;
     QTime myTime;
     QFile file;
+    QDataStream stream;
+    LogReader reader;
+    LogWriter writer;
     qint32 lastTimeStamp;
     QMutex mutex;
 
@@ -51,6 +81,21 @@ protected:
     int timeOffset;
     int pausedTime;
     double playbackSpeed;
+    bool fastForward;
+
+    // Offset in the file of the next queued record
+    qint64 writePos;
+
+    // Keyframes written so far
+    QVector<quint32> keyframeTimes;
+    QVector<qint64> keyframeOffsets;
+    bool inKeyframe;
+    QByteArray keyframeBuffer;
+
+    void checkDictionary();
+    bool writeHeader();
+    bool writeRecord(quint8 type, quint32 timeStamp, const char *data, qint64 dataSize);
+    void writeIndex();
 };
 
 #endif // LOGFILE_H
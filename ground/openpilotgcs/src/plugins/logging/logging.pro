@@ -6,6 +6,9 @@ include(../../openpilotgcsplugin.pri)
 include(logging_dependencies.pri)
 HEADERS += loggingplugin.h \
     logfile.h \
+    logreader.h \
+    logwriter.h \
+    ringbuffer.h \
     logginggadgetwidget.h \
     logginggadget.h \
     logginggadgetfactory.h
@@ -14,6 +17,9 @@ HEADERS += loggingplugin.h \
 
 SOURCES += loggingplugin.cpp \
     logfile.cpp \
+    logreader.cpp \
+    logwriter.cpp \
+    ringbuffer.cpp \
     logginggadgetwidget.cpp \
     logginggadget.cpp \
     logginggadgetfactory.cpp
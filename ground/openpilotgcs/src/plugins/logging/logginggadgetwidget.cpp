@@ -43,6 +43,9 @@ LoggingGadgetWidget::LoggingGadgetWidget(QWidget *parent) : QLabel(parent)
     ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
     scpPlugin = pm->getObject<ScopeGadgetFactory>();
 
+    statsTimer.setInterval(1000);
+    connect(&statsTimer, SIGNAL(timeout()), this, SLOT(updateWriteStats()));
+
 }
 
 LoggingGadgetWidget::~LoggingGadgetWidget()
@@ -59,6 +62,10 @@ void LoggingGadgetWidget::setPlugin(LoggingPlugin * p)
     connect(m_logging->pauseButton,SIGNAL(clicked()),p->getLogfile(),SLOT(pauseReplay()));
     connect(m_logging->pauseButton, SIGNAL(clicked()), scpPlugin, SLOT(stopPlotting()));
     connect(m_logging->playbackSpeed,SIGNAL(valueChanged(double)),p->getLogfile(),SLOT(setReplaySpeed(double)));
+    connect(m_logging->fastForward,SIGNAL(toggled(bool)),p->getLogfile(),SLOT(setFastForward(bool)));
+    connect(p->getLogfile(),SIGNAL(replayPosition(int)),this,SLOT(replayPosition(int)));
+    connect(m_logging->positionSlider,SIGNAL(sliderReleased()),this,SLOT(positionReleased()));
+    connect(m_logging->syncInterval,SIGNAL(valueChanged(int)),p,SLOT(setSyncInterval(int)));
     void pauseReplay();
     void resumeReplay();
 }
@@ -67,6 +74,47 @@ void LoggingGadgetWidget::setPlugin(LoggingPlugin * p)
 void LoggingGadgetWidget::stateChanged(QString status)
 {
     m_logging->statusLabel->setText(status);
+
+    if (status == "LOGGING") {
+        statsTimer.start();
+        updateWriteStats();
+    } else {
+        // Final counts of a log that just closed
+        if (statsTimer.isActive())
+            updateWriteStats();
+        statsTimer.stop();
+    }
+
+    // Only logs with an index can seek
+    int length = loggingPlugin->getLogfile()->replayLength();
+    bool seekable = (status == "REPLAY") && length > 0;
+    m_logging->positionSlider->setEnabled(seekable);
+    if (seekable)
+        m_logging->positionSlider->setRange(0, length);
+}
+
+/**
+  * Follow the replay unless the user is dragging the slider
+  */
+void LoggingGadgetWidget::replayPosition(int timeStamp)
+{
+    if (!m_logging->positionSlider->isSliderDown())
+        m_logging->positionSlider->setValue(timeStamp);
+}
+
+void LoggingGadgetWidget::positionReleased()
+{
+    loggingPlugin->getLogfile()->seekReplay(m_logging->positionSlider->value());
+}
+
+/**
+  * Show how many records were logged and dropped
+  */
+void LoggingGadgetWidget::updateWriteStats()
+{
+    m_logging->writeStats->setText(tr("Records: %1, dropped: %2")
+                                   .arg(loggingPlugin->recordsWritten())
+                                   .arg(loggingPlugin->recordsDropped()));
 }
 
 /**
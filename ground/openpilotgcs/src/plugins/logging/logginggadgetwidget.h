@@ -29,6 +29,7 @@
 #define LoggingGADGETWIDGET_H_
 
 #include <QtGui/QLabel>
+#include <QTimer>
 #include "extensionsystem/pluginmanager.h"
 #include "scope/scopeplugin.h"
 #include "scope/scopegadgetfactory.h"
@@ -48,6 +49,9 @@ public:
 
 protected slots:
     void stateChanged(QString status);
+    void replayPosition(int timeStamp);
+    void positionReleased();
+    void updateWriteStats();
 
 signals:
     void pause();
@@ -57,6 +61,7 @@ private:
     Ui_Logging *m_logging;
     LoggingPlugin * loggingPlugin;
     ScopeGadgetFactory * scpPlugin;
+    QTimer statsTimer;
 
 
 };
@@ -143,15 +143,37 @@ bool LoggingThread::openFile(QString file, LoggingPlugin * parent)
   * Logs an object update to the file.  Data format is the
   * timestamp as a 32 bit uint counting ms from start of
   * file writing (flight time will be embedded in stream),
-  * then object packet size, then the packed UAVObject.
+  * then record type and size, then the packed UAVObject.
+  * A keyframe with all objects is written first when due.
   */
 void LoggingThread::objectUpdated(UAVObject * obj)
 {
     QWriteLocker locker(&lock);
+    if (logFile.keyframeDue())
+        writeKeyframe();
     if(!uavTalk->sendObject(obj,false,false) )
         qDebug() << "Error logging " << obj->getName();
 };
 
+/**
+  * Logs the current state of all objects as one keyframe record,
+  * a replay seeking to a later time starts from it
+  */
+void LoggingThread::writeKeyframe()
+{
+    ExtensionSystem::PluginManager *pm = ExtensionSystem::PluginManager::instance();
+    UAVObjectManager *objManager = pm->getObject<UAVObjectManager>();
+    QList< QList<UAVObject*> > list = objManager->getObjects();
+
+    logFile.beginKeyframe();
+    for (int n = 0; n < list.length(); ++n)
+    {
+        if (!list[n].isEmpty())
+            uavTalk->sendObject(list[n][0], false, true);
+    }
+    logFile.endKeyframe();
+}
+
 /**
   * Connect signals from all the objects updates to the write routine then
   * run event loop
@@ -299,7 +321,7 @@ void LoggingThread::transactionCompleted(UAVObject* obj, bool success)
  ********************************/
 
 
-LoggingPlugin::LoggingPlugin() : state(IDLE)
+LoggingPlugin::LoggingPlugin() : state(IDLE), syncInterval(0)
 {
     logConnection = new LoggingConnection();
 }
@@ -390,6 +412,7 @@ void LoggingPlugin::startLogging(QString file)
     if (loggingThread)
         delete loggingThread;
     loggingThread = new LoggingThread();
+    loggingThread->getLogfile()->setSyncInterval(syncInterval * 1000);
     if(loggingThread->openFile(file,this))
     {
         connect(loggingThread,SIGNAL(finished()),this,SLOT(loggingStopped()));
@@ -429,6 +452,33 @@ void LoggingPlugin::loggingStopped()
     loggingThread = NULL;
 }
 
+/**
+  * Sets how often the log being written is synced to the disk,
+  * applies to the current log too
+  */
+void LoggingPlugin::setSyncInterval(int seconds)
+{
+    syncInterval = seconds;
+    if (loggingThread)
+        loggingThread->getLogfile()->setSyncInterval(syncInterval * 1000);
+}
+
+/**
+  * Number of records queued to the log being written
+  */
+quint32 LoggingPlugin::recordsWritten()
+{
+    return loggingThread ? loggingThread->getLogfile()->recordsWritten() : 0;
+}
+
+/**
+  * Number of records dropped because the disk did not keep up
+  */
+quint32 LoggingPlugin::recordsDropped()
+{
+    return loggingThread ? loggingThread->getLogfile()->recordsDropped() : 0;
+}
+
 /**
   * Received the replay stopped signal from the LogFile
   */
@@ -87,6 +87,7 @@ class LoggingThread : public QThread
 Q_OBJECT
 public:
     bool openFile(QString file, LoggingPlugin * parent);
+    LogFile* getLogfile() { return &logFile; }
 
 private slots:
     void objectUpdated(UAVObject * obj);
@@ -106,6 +107,7 @@ private:
 
     void retrieveSettings();
     void retrieveNextObject();
+    void writeKeyframe();
 
 };
 
@@ -124,6 +126,8 @@ public:
     LoggingConnection* getLogConnection() { return logConnection; };
     LogFile* getLogfile() { return logConnection->getLogfile();}
     void setLogMenuTitle(QString str);
+    quint32 recordsWritten();
+    quint32 recordsDropped();
 
 
 signals:
@@ -139,6 +143,12 @@ protected:
     // These are used for replay, logging in its own thread
     LoggingConnection* logConnection;
 
+    // Seconds between syncs of the log to the disk, 0 leaves it to the system
+    int syncInterval;
+
+public slots:
+    void setSyncInterval(int seconds);
+
 private slots:
     void toggleLogging();
     void startLogging(QString file);
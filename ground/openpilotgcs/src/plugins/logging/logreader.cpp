@@ -0,0 +1,262 @@
+/**
+ ******************************************************************************
+ * @file       logreader.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2011.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup loggingplugin
+ * @{
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "logreader.h"
+#include <QtAlgorithms>
+#include <QtEndian>
+#include <QDebug>
+#include <string.h>
+
+LogReader::LogReader() :
+    logData(0),
+    logSize(0),
+    fileVersion(1),
+    logLength(0),
+    pos(0),
+    recordsStart(0),
+    recordsEnd(0),
+    timeStamp(0),
+    type(RECORD_DATA),
+    data(0),
+    size(0)
+{
+}
+
+LogReader::~LogReader()
+{
+    close();
+}
+
+/**
+ * Map the file and read its dictionary and index
+ * \return false if the file can't be read
+ */
+bool LogReader::open(const QString &fileName)
+{
+    close();
+    file.setFileName(fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    logSize = file.size();
+    logData = file.map(0, logSize);
+    if (logData == 0)
+    {
+        // Mapping fails for empty files and can fail on 32 bit hosts
+        copy = file.readAll();
+        logData = (const uchar *)copy.constData();
+        logSize = copy.size();
+    }
+
+    if (readHeader())
+    {
+        fileVersion = 2;
+        readIndex();
+    }
+    else
+    {
+        fileVersion = 1;
+        recordsStart = 0;
+        recordsEnd = logSize;
+        logLength = 0;
+    }
+
+    rewind();
+    return true;
+}
+
+void LogReader::close()
+{
+    if (file.isOpen())
+        file.close();
+    copy.clear();
+    logData = 0;
+    logSize = 0;
+    dictionary.clear();
+    keyframeTimes.clear();
+    keyframeOffsets.clear();
+}
+
+/**
+ * Go back before the first record
+ */
+void LogReader::rewind()
+{
+    pos = recordsStart;
+}
+
+/**
+ * Load the next record
+ * \return false at the end of the records or if the last record is cut
+ */
+bool LogReader::next()
+{
+    if (fileVersion < 2)
+    {
+        qint64 dataSize;
+        if (pos + (qint64)(sizeof(timeStamp) + sizeof(dataSize)) > recordsEnd)
+            return false;
+        memcpy(&timeStamp, logData + pos, sizeof(timeStamp));
+        memcpy(&dataSize, logData + pos + sizeof(timeStamp), sizeof(dataSize));
+        pos += sizeof(timeStamp) + sizeof(dataSize);
+        if (dataSize < 0 || dataSize > recordsEnd - pos)
+            return false;
+        type = RECORD_DATA;
+        size = dataSize;
+    }
+    else
+    {
+        if (pos + LOGFILE_RECORD_HEADER_SIZE > recordsEnd)
+            return false;
+        timeStamp = qFromLittleEndian<quint32>(logData + pos);
+        type = logData[pos + 4];
+        size = qFromLittleEndian<quint32>(logData + pos + 5);
+        pos += LOGFILE_RECORD_HEADER_SIZE;
+        if (size > recordsEnd - pos)
+            return false;
+    }
+
+    data = logData + pos;
+    pos += size;
+    return true;
+}
+
+/**
+ * Load the last keyframe at or before a time, found by binary search of the index
+ * \return false if the log has no keyframes
+ */
+bool LogReader::seekKeyframe(quint32 time)
+{
+    if (keyframeTimes.isEmpty())
+        return false;
+
+    QVector<quint32>::const_iterator it = qUpperBound(keyframeTimes.constBegin(), keyframeTimes.constEnd(), time);
+    int keyframe = (it == keyframeTimes.constBegin()) ? 0 : (it - keyframeTimes.constBegin()) - 1;
+
+    if (keyframeOffsets[keyframe] < recordsStart || keyframeOffsets[keyframe] >= recordsEnd)
+        return false;
+
+    pos = keyframeOffsets[keyframe];
+    return next() && type == RECORD_KEYFRAME;
+}
+
+/**
+ * Read the magic and the object dictionary
+ * \return false if this is not a version 2 file
+ */
+bool LogReader::readHeader()
+{
+    const qint64 magicSize = sizeof(LOGFILE_MAGIC);
+
+    dictionary.clear();
+    if (logSize < magicSize + 4 || memcmp(logData, LOGFILE_MAGIC, magicSize) != 0)
+        return false;
+
+    recordsStart = qMin(magicSize + 4 + qFromLittleEndian<quint32>(logData + magicSize), logSize);
+
+    qint64 at = magicSize + 4;
+    if (at + 4 > recordsStart)
+        return true;
+    quint32 numObjects = qFromLittleEndian<quint32>(logData + at);
+    at += 4;
+
+    for (quint32 n = 0; n < numObjects && at + 16 <= recordsStart; ++n)
+    {
+        ObjectInfo info;
+        info.objId = qFromLittleEndian<quint32>(logData + at);
+        info.layoutHash = qFromLittleEndian<quint32>(logData + at + 4);
+        info.numBytes = qFromLittleEndian<quint16>(logData + at + 8);
+        info.numInstances = qFromLittleEndian<quint16>(logData + at + 10);
+        quint32 nameLength = qFromLittleEndian<quint32>(logData + at + 12);
+        at += 16;
+
+        // QDataStream marks a null QByteArray with 0xFFFFFFFF
+        if (nameLength == 0xFFFFFFFF)
+            nameLength = 0;
+        if (nameLength > recordsStart - at)
+            break;
+        info.name = QString::fromLatin1((const char *)logData + at, nameLength);
+        at += nameLength;
+        dictionary.append(info);
+    }
+
+    return true;
+}
+
+/**
+ * Load the keyframe index, rebuild it from the records if the log was not closed
+ */
+void LogReader::readIndex()
+{
+    keyframeTimes.clear();
+    keyframeOffsets.clear();
+    recordsEnd = logSize;
+    logLength = 0;
+
+    if (logSize - recordsStart >= LOGFILE_TRAILER_SIZE)
+    {
+        const uchar *trailer = logData + logSize - LOGFILE_TRAILER_SIZE;
+        qint64 indexOffset = qFromLittleEndian<qint64>(trailer);
+        quint32 length = qFromLittleEndian<quint32>(trailer + 8);
+        quint32 magic = qFromLittleEndian<quint32>(trailer + 12);
+
+        if (magic == LOGFILE_INDEX_MAGIC && indexOffset >= recordsStart && indexOffset + 4 <= logSize - LOGFILE_TRAILER_SIZE)
+        {
+            quint32 count = qFromLittleEndian<quint32>(logData + indexOffset);
+            if (count <= (logSize - LOGFILE_TRAILER_SIZE - indexOffset - 4) / 12)
+            {
+                const uchar *entry = logData + indexOffset + 4;
+                keyframeTimes.resize(count);
+                keyframeOffsets.resize(count);
+                for (quint32 n = 0; n < count; ++n, entry += 12)
+                {
+                    keyframeTimes[n] = qFromLittleEndian<quint32>(entry);
+                    keyframeOffsets[n] = qFromLittleEndian<qint64>(entry + 4);
+                }
+                recordsEnd = indexOffset;
+                logLength = length;
+                return;
+            }
+        }
+    }
+
+    qDebug() << "Logfile: no index, scanning the records";
+    rewind();
+    while (next())
+    {
+        if (type == RECORD_KEYFRAME)
+        {
+            keyframeTimes.append(timeStamp);
+            keyframeOffsets.append(pos - size - LOGFILE_RECORD_HEADER_SIZE);
+        }
+        logLength = timeStamp;
+    }
+}
+
+/**
+ * @}
+ * @}
+ */
@@ -0,0 +1,113 @@
+/**
+ ******************************************************************************
+ * @file       logreader.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2011.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup loggingplugin
+ * @{
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef LOGREADER_H
+#define LOGREADER_H
+
+#include <QFile>
+#include <QList>
+#include <QString>
+#include <QVector>
+
+// Version 2 layout:
+//   magic, quint32 dictionary size, dictionary
+//   records: quint32 timestamp, quint8 type, quint32 size, UAVTalk packets
+//   index: quint32 count, count * (quint32 timestamp, qint64 offset) of the keyframes
+//   trailer: qint64 index offset, quint32 last timestamp, quint32 index magic
+// All integers are little endian. Version 1 files only have records made of
+// the native quint32 timestamp, qint64 size and the UAVTalk packets.
+#define LOGFILE_MAGIC "OPLOGv2"
+#define LOGFILE_INDEX_MAGIC 0x58444E49
+#define LOGFILE_RECORD_HEADER_SIZE 9
+#define LOGFILE_TRAILER_SIZE 16
+
+/**
+ * Reads the records of a log file from memory. The file is mapped, or read
+ * at once when it can't be mapped, so walking the records costs no I/O calls.
+ * Has no dependency on the plugin manager so that command line tools can use it.
+ */
+class LogReader
+{
+public:
+    enum RecordType { RECORD_DATA = 0, RECORD_KEYFRAME = 1 };
+
+    // Object as described in the dictionary of a log
+    struct ObjectInfo {
+        quint32 objId;
+        quint32 layoutHash;
+        quint16 numBytes;
+        quint16 numInstances;
+        QString name;
+    };
+
+    LogReader();
+    ~LogReader();
+    bool open(const QString &fileName);
+    void close();
+    bool isOpen() const { return logData != 0; }
+    int version() const { return fileVersion; }
+    quint32 length() const { return logLength; }
+    bool hasIndex() const { return !keyframeTimes.isEmpty(); }
+    QList<ObjectInfo> objectDictionary() const { return dictionary; }
+
+    void rewind();
+    bool next();
+    bool seekKeyframe(quint32 time);
+
+    // The record loaded by next() or seekKeyframe()
+    quint32 recordTime() const { return timeStamp; }
+    quint8 recordType() const { return type; }
+    const char *recordData() const { return (const char *)data; }
+    quint32 recordSize() const { return size; }
+
+private:
+    QFile file;
+    QByteArray copy;
+    const uchar *logData;
+    qint64 logSize;
+    int fileVersion;
+    quint32 logLength;
+    qint64 pos;
+    qint64 recordsStart;
+    qint64 recordsEnd;
+    QList<ObjectInfo> dictionary;
+    QVector<quint32> keyframeTimes;
+    QVector<qint64> keyframeOffsets;
+
+    quint32 timeStamp;
+    quint8 type;
+    const uchar *data;
+    quint32 size;
+
+    bool readHeader();
+    void readIndex();
+};
+
+#endif // LOGREADER_H
+/**
+ * @}
+ * @}
+ */
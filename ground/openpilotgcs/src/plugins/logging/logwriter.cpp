@@ -0,0 +1,196 @@
+/**
+ ******************************************************************************
+ * @file       logwriter.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2011.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup loggingplugin
+ * @{
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "logwriter.h"
+#include <QTime>
+#include <string.h>
+#ifdef Q_OS_WIN
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+// The ring is written out at least this often, or sooner once it is a quarter full
+static const int FLUSH_INTERVAL_MS = 200;
+
+/**
+ * \param[in] capacity Size of the ring, rounded up to a power of two
+ */
+LogWriter::LogWriter(int capacity) :
+    file(0),
+    head(0),
+    tail(0),
+    records(0),
+    dropped(0),
+    syncInterval(0),
+    writeError(false),
+    stopping(false),
+    flushRequested(false)
+{
+    int size = 1;
+    while (size < capacity)
+        size *= 2;
+    buffer.resize(size);
+    mask = size - 1;
+}
+
+/**
+ * Start writing to an open file
+ */
+void LogWriter::begin(QFile *file)
+{
+    this->file = file;
+    head = 0;
+    tail = 0;
+    records = 0;
+    dropped = 0;
+    writeError = false;
+    stopping = false;
+    flushRequested = false;
+    start();
+}
+
+/**
+ * Write what is left in the ring and stop the thread
+ */
+void LogWriter::finish()
+{
+    if (!isRunning())
+        return;
+
+    mutex.lock();
+    stopping = true;
+    wake.wakeOne();
+    mutex.unlock();
+    wait();
+}
+
+/**
+ * Queue a record made of a header and a payload, called by a single producer at a time
+ * \return false if the ring is full, the record is then dropped
+ */
+bool LogWriter::write(const char *header, int headerSize, const char *data, int dataSize)
+{
+    quint32 size = headerSize + dataSize;
+    quint32 in = (quint32)head.fetchAndAddRelaxed(0);
+    quint32 out = (quint32)tail.fetchAndAddAcquire(0);
+    quint32 used = in - out;
+
+    if (size > buffer.size() - used)
+    {
+        dropped.ref();
+        return false;
+    }
+
+    copyIn(in, header, headerSize);
+    copyIn(in + headerSize, data, dataSize);
+    head.fetchAndStoreRelease(in + size);
+    records.ref();
+
+    if (used + size >= (quint32)buffer.size() / 4)
+    {
+        // The flag is set under the mutex so that the request is not lost while
+        // the writer is busy flushing instead of waiting
+        mutex.lock();
+        flushRequested = true;
+        wake.wakeOne();
+        mutex.unlock();
+    }
+    return true;
+}
+
+void LogWriter::copyIn(quint32 pos, const char *data, int size)
+{
+    int at = pos & mask;
+    int first = qMin(size, buffer.size() - at);
+    memcpy(buffer.data() + at, data, first);
+    memcpy(buffer.data(), data + first, size - first);
+}
+
+void LogWriter::run()
+{
+    QTime lastSync;
+    lastSync.start();
+
+    mutex.lock();
+    while (!stopping)
+    {
+        if (!flushRequested)
+            wake.wait(&mutex, FLUSH_INTERVAL_MS);
+        flushRequested = false;
+        mutex.unlock();
+
+        flush();
+        if (syncInterval > 0 && lastSync.elapsed() >= syncInterval)
+        {
+            sync();
+            lastSync.restart();
+        }
+
+        mutex.lock();
+    }
+    mutex.unlock();
+
+    flush();
+    if (syncInterval > 0)
+        sync();
+}
+
+/**
+ * Write the queued bytes, at most two writes when the data wraps around
+ */
+void LogWriter::flush()
+{
+    quint32 in = (quint32)head.fetchAndAddAcquire(0);
+    quint32 out = (quint32)tail.fetchAndAddRelaxed(0);
+
+    while (in != out)
+    {
+        int at = out & mask;
+        int span = qMin((quint32)(buffer.size() - at), in - out);
+        if (file->write(buffer.constData() + at, span) != span)
+            writeError = true;
+        out += span;
+        tail.fetchAndStoreRelease(out);
+    }
+}
+
+/**
+ * Push the written data to the disk so that a crash loses at most one interval
+ */
+void LogWriter::sync()
+{
+#ifdef Q_OS_WIN
+    _commit(file->handle());
+#else
+    fsync(file->handle());
+#endif
+}
+
+/**
+ * @}
+ * @}
+ */
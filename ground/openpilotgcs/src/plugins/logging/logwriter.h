@@ -0,0 +1,89 @@
+/**
+ ******************************************************************************
+ * @file       logwriter.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2011.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup loggingplugin
+ * @{
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef LOGWRITER_H
+#define LOGWRITER_H
+
+#include <QThread>
+#include <QFile>
+#include <QByteArray>
+#include <QAtomicInt>
+#include <QMutex>
+#include <QWaitCondition>
+
+/**
+ * Writes the log file from its own thread. Records are copied into a single
+ * producer, single consumer ring without taking a lock, the thread writes
+ * whatever the ring holds in one or two large writes. A record that does not
+ * fit is dropped whole and counted, the telemetry never waits for the disk.
+ */
+class LogWriter : public QThread
+{
+    Q_OBJECT
+public:
+    explicit LogWriter(int capacity = 1 << 20);
+
+    void begin(QFile *file);
+    void finish();
+    bool write(const char *header, int headerSize, const char *data, int dataSize);
+    void setSyncInterval(int ms) { syncInterval = ms; }
+
+    quint32 recordsWritten() const { return (quint32)(int)records; }
+    quint32 recordsDropped() const { return (quint32)(int)dropped; }
+    bool failed() const { return writeError; }
+
+protected:
+    void run();
+
+private:
+    QFile *file;
+    QByteArray buffer;
+    quint32 mask;
+
+    // Free running positions, head is only moved by the producer and tail by the writer thread
+    QAtomicInt head;
+    QAtomicInt tail;
+
+    QAtomicInt records;
+    QAtomicInt dropped;
+    volatile int syncInterval;
+    volatile bool writeError;
+
+    QMutex mutex;
+    QWaitCondition wake;
+    bool stopping;          // guarded by mutex
+    bool flushRequested;    // guarded by mutex
+
+    void copyIn(quint32 pos, const char *data, int size);
+    void flush();
+    void sync();
+};
+
+#endif // LOGWRITER_H
+/**
+ * @}
+ * @}
+ */
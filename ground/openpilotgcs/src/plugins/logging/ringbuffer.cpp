@@ -0,0 +1,92 @@
+/**
+ ******************************************************************************
+ * @file       ringbuffer.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2011.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup loggingplugin
+ * @{
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "ringbuffer.h"
+#include <string.h>
+
+RingBuffer::RingBuffer(int capacity) :
+    buffer(qMax(capacity, 1), 0),    // positions are taken modulo the capacity
+    head(0),
+    count(0)
+{
+}
+
+void RingBuffer::clear()
+{
+    head = 0;
+    count = 0;
+}
+
+/**
+ * Add bytes at the end, the buffer grows if they don't fit
+ */
+void RingBuffer::append(const char *data, int length)
+{
+    if (count + length > buffer.size())
+        grow(count + length);
+
+    int tail = (head + count) % buffer.size();
+    int first = qMin(length, buffer.size() - tail);
+    memcpy(buffer.data() + tail, data, first);
+    memcpy(buffer.data(), data + first, length - first);
+    count += length;
+}
+
+/**
+ * Take bytes from the front
+ * \return Number of bytes copied to data
+ */
+int RingBuffer::read(char *data, int maxLength)
+{
+    int length = qMin(maxLength, count);
+    int first = qMin(length, buffer.size() - head);
+    memcpy(data, buffer.constData() + head, first);
+    memcpy(data + first, buffer.constData(), length - first);
+    head = (head + length) % buffer.size();
+    count -= length;
+    return length;
+}
+
+/**
+ * Double the capacity until minCapacity fits and unwrap the content
+ */
+void RingBuffer::grow(int minCapacity)
+{
+    int capacity = qMax(buffer.size(), 1);
+    while (capacity < minCapacity)
+        capacity *= 2;
+
+    QByteArray larger(capacity, 0);
+    int length = read(larger.data(), count);
+    buffer = larger;
+    head = 0;
+    count = length;
+}
+
+/**
+ * @}
+ * @}
+ */
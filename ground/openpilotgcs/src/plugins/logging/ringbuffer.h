@@ -0,0 +1,58 @@
+/**
+ ******************************************************************************
+ * @file       ringbuffer.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2011.
+ * @see        The GNU Public License (GPL) Version 3
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup loggingplugin
+ * @{
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef RINGBUFFER_H
+#define RINGBUFFER_H
+
+#include <QByteArray>
+
+/**
+ * Byte FIFO for the replayed data. Reads advance a position instead of moving the
+ * remaining bytes to the front, the storage only grows when it is full. The
+ * capacity is at least one byte.
+ */
+class RingBuffer
+{
+public:
+    explicit RingBuffer(int capacity = 4096);
+    int size() const { return count; }
+    void clear();
+    void append(const char *data, int length);
+    int read(char *data, int maxLength);
+
+private:
+    QByteArray buffer;
+    int head;
+    int count;
+
+    void grow(int minCapacity);
+};
+
+#endif // RINGBUFFER_H
+/**
+ * @}
+ * @}
+ */
@@ -121,6 +121,8 @@ void PFDGadgetWidget::connectNeedles() {
 
     airspeedObj = dynamic_cast<UAVDataObject*>(objManager->getObject("VelocityActual"));
     if (airspeedObj != NULL ) {
+        northField = airspeedObj->bindField("North");
+        eastField = airspeedObj->bindField("East");
         connect(airspeedObj, SIGNAL(objectUpdated(UAVObject*)), this, SLOT(updateAirspeed(UAVObject*)));
     } else {
          qDebug() << "Error: Object is unknown (VelocityActual).";
@@ -128,6 +130,7 @@ void PFDGadgetWidget::connectNeedles() {
 
     altitudeObj = dynamic_cast<UAVDataObject*>(objManager->getObject("PositionActual"));
     if (altitudeObj != NULL ) {
+        downField = altitudeObj->bindField("Down");
         connect(altitudeObj, SIGNAL(objectUpdated(UAVObject*)), this, SLOT(updateAltitude(UAVObject*)));
     } else {
          qDebug() << "Error: Object is unknown (PositionActual).";
@@ -135,6 +138,9 @@ void PFDGadgetWidget::connectNeedles() {
 
    attitudeObj = dynamic_cast<UAVDataObject*>(objManager->getObject("AttitudeActual"));
    if (attitudeObj != NULL ) {
+       rollField = attitudeObj->bindField("Roll");
+       pitchField = attitudeObj->bindField("Pitch");
+       yawField = attitudeObj->bindField("Yaw");
        connect(attitudeObj, SIGNAL(objectUpdated(UAVObject*)), this, SLOT(updateAttitude(UAVObject*)));
    } else {
         qDebug() << "Error: Object is unknown (AttitudeActual).";
@@ -169,6 +175,9 @@ void PFDGadgetWidget::connectNeedles() {
    if (gcsBatteryStats) {  // Only register if the PFD wants battery display
        gcsBatteryObj = dynamic_cast<UAVDataObject*>(objManager->getObject("FlightBatteryState"));
        if (gcsBatteryObj != NULL ) {
+           voltageField = gcsBatteryObj->bindField("Voltage");
+           currentField = gcsBatteryObj->bindField("Current");
+           energyField = gcsBatteryObj->bindField("ConsumedEnergy");
            connect(gcsBatteryObj, SIGNAL(objectUpdated(UAVObject*)), this, SLOT(updateBattery(UAVObject*)));
        } else {
             qDebug() << "Error: Object is unknown (FlightBatteryState).";
@@ -229,10 +238,8 @@ void PFDGadgetWidget::updateLinkStatus(UAVObject *object1) {
   Resolution is 1 degree roll & 1/7.5 degree pitch.
   */
 void PFDGadgetWidget::updateAttitude(UAVObject *object1) {
-    UAVObjectField * rollField = object1->getField(QString("Roll"));
-    UAVObjectField * yawField = object1->getField(QString("Yaw"));
-    UAVObjectField * pitchField = object1->getField(QString("Pitch"));
-    if(rollField && yawField && pitchField) {
+    Q_UNUSED(object1);
+    if(rollField.isValid() && yawField.isValid() && pitchField.isValid()) {
         // These factors assume some things about the PFD SVG, namely:
         // - Roll, Pitch and Heading value in degrees
         // - Pitch lines are 300px high for a +20/-20 range, which means
@@ -240,13 +247,13 @@ void PFDGadgetWidget::updateAttitude(UAVObject *object1) {
         // TODO: loosen this constraint and only require a +/- 20 deg range,
         //       and compute the height from the SVG element.
         // Also: keep the integer value only, to avoid unnecessary redraws
-        rollTarget = -floor(rollField->getDouble()*10)/10;
+        rollTarget = -floor(rollField.getDouble()*10)/10;
         if ((rollTarget - rollValue) > 180) {
             rollValue += 360;
         } else if (((rollTarget - rollValue) < -180)) {
             rollValue -= 360;
         }
-        pitchTarget = floor(pitchField->getDouble()*7.5);
+        pitchTarget = floor(pitchField.getDouble()*7.5);
 
         // These factors assume some things about the PFD SVG, namely:
         // - Heading value in degrees
@@ -256,7 +263,7 @@ void PFDGadgetWidget::updateAttitude(UAVObject *object1) {
         // one from another, and if the result is >180 or <-180 I substract (respectively add) 360 degrees
         // to it. That way you always get the "shorter difference" to turn in."
         double fac = compassBandWidth/540;
-        headingTarget = yawField->getDouble()*(-fac);
+        headingTarget = yawField.getDouble()*(-fac);
         if (headingTarget != headingTarget)
             headingTarget = headingValue; // NaN checking.
         if ((headingValue - headingTarget)/fac > 180) {
@@ -291,10 +298,11 @@ void PFDGadgetWidget::updateHeading(UAVObject *object) {
   \brief Called by updates to @PositionActual to compute airspeed from velocity
   */
 void PFDGadgetWidget::updateAirspeed(UAVObject *object) {
-    UAVObjectField* northField = object->getField("North");
-    UAVObjectField* eastField = object->getField("East");
-    if (northField && eastField) {
-        double val = floor(sqrt(pow(northField->getDouble(),2) + pow(eastField->getDouble(),2))*10)/10;
+    Q_UNUSED(object);
+    if (northField.isValid() && eastField.isValid()) {
+        double north = northField.getDouble();
+        double east = eastField.getDouble();
+        double val = floor(sqrt(north*north + east*east)*10)/10;
         groundspeedTarget = 3.6*val*speedScaleHeight/3000;
 
         if (!dialTimer.isActive())
@@ -309,10 +317,9 @@ void PFDGadgetWidget::updateAirspeed(UAVObject *object) {
   \brief Called by the @ref PositionActual updates to show altitude
   */
 void PFDGadgetWidget::updateAltitude(UAVObject *object) {
-    UAVObjectField* downField = object->getField("Down");
-    if (downField) {
+    if (downField.isValid()) {
         // The altitude scale represents 30 meters
-        altitudeTarget = -floor(downField->getDouble()*10)/10*altitudeScaleHeight/3000;
+        altitudeTarget = -floor(downField.getDouble()*10)/10*altitudeScaleHeight/3000;
         if (!dialTimer.isActive())
             dialTimer.start(); // Rearm the dial Timer which might be stopped.
 
@@ -326,18 +333,13 @@ void PFDGadgetWidget::updateAltitude(UAVObject *object) {
   \brief Called by the UAVObject which got updated
   */
 void PFDGadgetWidget::updateBattery(UAVObject *object1) {
-    // Double check that the field exists:
-    QString voltage = QString("Voltage");
-    QString current = QString("Current");
-    QString energy = QString("ConsumedEnergy");
-    UAVObjectField* field = object1->getField(voltage);
-    UAVObjectField* field2 = object1->getField(current);
-    UAVObjectField* field3 = object1->getField(energy);
-    if (field && field2 && field3) {
+    Q_UNUSED(object1);
+    // Double check that the fields exist:
+    if (voltageField.isValid() && currentField.isValid() && energyField.isValid()) {
     	QString s = QString();
-    	double v0 = field->getDouble();
-        double v1 = field2->getDouble();
-        double v2 = field3->getDouble();
+    	double v0 = voltageField.getDouble();
+        double v1 = currentField.getDouble();
+        double v2 = energyField.getDouble();
         s.sprintf("%.2fV\n%.2fA\n%.0fmAh",v0,v1,v2);
         if (s != batString) {
             gcsBatteryStats->setPlainText(s);
@@ -134,6 +134,17 @@ private:
    UAVDataObject* gcsTelemetryObj;
    UAVDataObject* gcsBatteryObj;
 
+   // Fields read on every update, resolved in connectNeedles()
+   UAVObjectFieldBinding northField;
+   UAVObjectFieldBinding eastField;
+   UAVObjectFieldBinding downField;
+   UAVObjectFieldBinding rollField;
+   UAVObjectFieldBinding pitchField;
+   UAVObjectFieldBinding yawField;
+   UAVObjectFieldBinding voltageField;
+   UAVObjectFieldBinding currentField;
+   UAVObjectFieldBinding energyField;
+
    // Rotation timer
    QTimer dialTimer;
    QTimer skyDialTimer;
@@ -0,0 +1,169 @@
+/**
+ ******************************************************************************
+ *
+ * @file       plotbuffer.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2011.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include "plotbuffer.h"
+
+PlotBuffer::PlotBuffer(int capacity) :
+    head(0),
+    count(0),
+    indexAsX(false),
+    decimated(false)
+{
+    int size = 1;
+    while (size < capacity)
+        size *= 2;
+    xData.resize(size);
+    yData.resize(size);
+    mask = size - 1;
+}
+
+void PlotBuffer::clear()
+{
+    head = 0;
+    count = 0;
+    decimated = false;
+}
+
+void PlotBuffer::append(double x, double y)
+{
+    if (count == xData.size())
+        grow();
+
+    int tail = (head + count) & mask;
+    xData[tail] = x;
+    yData[tail] = y;
+    ++count;
+}
+
+void PlotBuffer::removeFirst(int n)
+{
+    n = qMin(n, count);
+    head = (head + n) & mask;
+    count -= n;
+}
+
+/*!
+  \brief Double the capacity and unwrap the points
+  */
+void PlotBuffer::grow()
+{
+    int size = xData.size() * 2;
+    QVector<double> x(size);
+    QVector<double> y(size);
+    for (int i = 0; i < count; ++i)
+    {
+        x[i] = xData[(head + i) & mask];
+        y[i] = yData[(head + i) & mask];
+    }
+    xData = x;
+    yData = y;
+    head = 0;
+    mask = size - 1;
+}
+
+/*!
+  \brief Reduce the points to the first, minimum, maximum and last point of each
+  pixel column, in the order they were received. The lines drawn between them
+  cover the same pixels as the lines between all points, but no more than four
+  points per column are drawn. Nothing is done when there are fewer points.
+  \param columns Width of the plot canvas in pixels
+  */
+void PlotBuffer::decimate(int columns)
+{
+    decimated = columns > 0 && count > 4 * columns;
+    if (!decimated)
+        return;
+
+    decimatedX.resize(0);
+    decimatedY.resize(0);
+    decimatedX.reserve(4 * columns);
+    decimatedY.reserve(4 * columns);
+
+    for (int column = 0; column < columns; ++column)
+    {
+        int from = (int)((qint64)column * count / columns);
+        int to = (int)((qint64)(column + 1) * count / columns);
+        int minIndex = from;
+        int maxIndex = from;
+        for (int i = from + 1; i < to; ++i)
+        {
+            double value = y(i);
+            if (value < y(minIndex))
+                minIndex = i;
+            else if (value > y(maxIndex))
+                maxIndex = i;
+        }
+
+        int points[4] = { from, qMin(minIndex, maxIndex), qMax(minIndex, maxIndex), to - 1 };
+        for (int n = 0; n < 4; ++n)
+        {
+            if (n > 0 && points[n] == points[n - 1])
+                continue;
+            decimatedX.append(x(points[n]));
+            decimatedY.append(y(points[n]));
+        }
+    }
+}
+
+size_t PlotBufferData::size() const
+{
+    return buffer->decimated ? buffer->decimatedX.size() : buffer->count;
+}
+
+double PlotBufferData::x(size_t i) const
+{
+    return buffer->decimated ? buffer->decimatedX[i] : buffer->x(i);
+}
+
+double PlotBufferData::y(size_t i) const
+{
+    return buffer->decimated ? buffer->decimatedY[i] : buffer->y(i);
+}
+
+/*!
+  \brief Bounding rectangle of the drawn points, the decimated points keep the
+  extremes of each column so it is the same as for all points
+  */
+QwtDoubleRect PlotBufferData::boundingRect() const
+{
+    size_t n = size();
+    if (n == 0)
+        return QwtDoubleRect(1.0, 1.0, -2.0, -2.0); // invalid
+
+    double minX = x(0);
+    double maxX = minX;
+    double minY = y(0);
+    double maxY = minY;
+    for (size_t i = 1; i < n; ++i)
+    {
+        minX = qMin(minX, x(i));
+        maxX = qMax(maxX, x(i));
+        minY = qMin(minY, y(i));
+        maxY = qMax(maxY, y(i));
+    }
+    return QwtDoubleRect(minX, minY, maxX - minX, maxY - minY);
+}
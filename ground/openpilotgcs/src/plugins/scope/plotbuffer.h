@@ -0,0 +1,101 @@
+/**
+ ******************************************************************************
+ *
+ * @file       plotbuffer.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2011.
+ * @addtogroup GCSPlugins GCS Plugins
+ * @{
+ * @addtogroup ScopePlugin Scope Gadget Plugin
+ * @{
+ * @brief The scope Gadget, graphically plots the states of UAVObjects
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#ifndef PLOTBUFFER_H
+#define PLOTBUFFER_H
+
+#include "qwt/src/qwt_data.h"
+
+#include <QVector>
+
+/*!
+  \brief Ring of curve points. Appending a point and removing the oldest ones
+  costs the same whatever the size, the storage only grows when a point is added
+  to a full buffer.
+  */
+class PlotBuffer
+{
+public:
+    explicit PlotBuffer(int capacity = 1024);
+
+    int size() const { return count; }
+    bool isEmpty() const { return count == 0; }
+    void clear();
+    void append(double x, double y);
+    void removeFirst(int n = 1);
+
+    /*!
+      \brief When set, the x value of a point is its position in the buffer
+      */
+    void setIndexAsX(bool enable) { indexAsX = enable; }
+
+    double x(int i) const { return indexAsX ? i : xData[(head + i) & mask]; }
+    double y(int i) const { return yData[(head + i) & mask]; }
+    double firstX() const { return x(0); }
+    double lastX() const { return x(count - 1); }
+    double lastY() const { return y(count - 1); }
+
+    void decimate(int columns);
+
+private:
+    friend class PlotBufferData;
+
+    QVector<double> xData;
+    QVector<double> yData;
+    int mask;
+    int head;
+    int count;
+    bool indexAsX;
+
+    // Points drawn when there are more than four per pixel column
+    QVector<double> decimatedX;
+    QVector<double> decimatedY;
+    bool decimated;
+
+    void grow();
+};
+
+/*!
+  \brief QwtData view of a PlotBuffer, the curve reads the points in place.
+  Once decimated, the view holds the decimated points instead.
+  */
+class PlotBufferData : public QwtData
+{
+public:
+    explicit PlotBufferData(const PlotBuffer *buffer) : buffer(buffer) {}
+
+    virtual QwtData *copy() const { return new PlotBufferData(buffer); }
+    virtual size_t size() const;
+    virtual double x(size_t i) const;
+    virtual double y(size_t i) const;
+    virtual QwtDoubleRect boundingRect() const;
+
+private:
+    const PlotBuffer *buffer;
+};
+
+#endif // PLOTBUFFER_H
@@ -47,60 +47,43 @@ PlotData::PlotData(QString p_uavObject, QString p_uavField)
         haveSubField = false;
     }
 
-    xData = new QVector<double>();
-    yData = new QVector<double>();
-
     curve = 0;
     scalePower = 0;
+    scaleFactor = 1;
     yMinimum = 0;
     yMaximum = 0;
 
     m_xWindowSize = 0;
 }
 
-double PlotData::valueAsDouble(UAVObject* obj, UAVObjectField* field)
+/*!
+  \brief Resolve the plotted element of the field and the scale, call after setting scalePower
+  \return false if the sub field does not exist
+  */
+bool PlotData::bind(UAVObjectField* field)
 {
-    Q_UNUSED(obj);
-    QVariant value;
-
-    if(haveSubField){
-        int indexOfSubField = field->getElementNames().indexOf(QRegExp(uavSubField, Qt::CaseSensitive, QRegExp::FixedString));
-        value = field->getValue(indexOfSubField);
-    }else
-        value = field->getValue();
-
-    // qDebug() << "Data  (" << value.typeName() << ") " <<  value.toString();
-
-    return value.toDouble();
+    binding = haveSubField ? field->bind(uavSubField) : field->bind();
+    scaleFactor = pow(10, scalePower);
+    return binding.isValid();
 }
 
 PlotData::~PlotData()
 {
-    delete xData;
-    delete yData;
 }
 
 
 bool SequencialPlotData::append(UAVObject* obj)
 {
-    if (uavObject == obj->getName()) {
-
-        //Get the field of interest
-        UAVObjectField* field =  obj->getField(uavField);
-
-        if (field) {
+    if (isBoundTo(obj)) {
 
-            //Shift data forward and put the new value at the front
-            yData->append( valueAsDouble(obj, field) * pow(10, scalePower));
-            if (yData->size() > m_xWindowSize) {
-                yData->pop_front();
-            } else
-                xData->insert(xData->size(), xData->size());
+        //Put the new value at the end and drop the oldest, the x value is the position
+        points.append(0, binding.getDouble() * scaleFactor);
+        if (points.size() > m_xWindowSize)
+            points.removeFirst();
 
-            //notify the gui of changes in the data
-            //dataChanged();
-            return true;
-        }
+        //notify the gui of changes in the data
+        //dataChanged();
+        return true;
     }
 
     return false;
@@ -108,29 +91,20 @@ bool SequencialPlotData::append(UAVObject* obj)
 
 bool ChronoPlotData::append(UAVObject* obj)
 {
-    if (uavObject == obj->getName()) {
-        //Get the field of interest
-        UAVObjectField* field =  obj->getField(uavField);
-        //qDebug() << "uavObject: " << uavObject << ", uavField: " << uavField;
+    if (isBoundTo(obj)) {
+        //Put the new value at the end
+        QDateTime NOW = QDateTime::currentDateTime();
 
-        if (field) {
-            //Put the new value at the front
-            QDateTime NOW = QDateTime::currentDateTime();
+        double valueX = NOW.toTime_t() + NOW.time().msec() / 1000.0;
+        double valueY = binding.getDouble() * scaleFactor;
+        points.append(valueX, valueY);
 
-            double valueX = NOW.toTime_t() + NOW.time().msec() / 1000.0;
-            double valueY = valueAsDouble(obj, field) * pow(10, scalePower);
-            xData->append(valueX);
-            yData->append(valueY);
+        //Remove stale data
+        removeStaleData();
 
-            //qDebug() << "Data  " << uavObject << "." << field->getName() << " X,Y:" << valueX << "," <<  valueY;
-
-            //Remove stale data
-            removeStaleData();
-
-            //notify the gui of chages in the data
-            //dataChanged();
-            return true;
-        }
+        //notify the gui of chages in the data
+        //dataChanged();
+        return true;
     }
 
     return false;
@@ -138,22 +112,8 @@ bool ChronoPlotData::append(UAVObject* obj)
 
 void ChronoPlotData::removeStaleData()
 {
-    double newestValue;
-    double oldestValue;
-
-    while (1) {
-        if (xData->size() == 0)
-            break;
-
-        newestValue = xData->last();
-        oldestValue = xData->first();
-
-        if (newestValue - oldestValue > m_xWindowSize) {
-            yData->pop_front();
-            xData->pop_front();
-        } else
-            break;
-    }
+    while (!points.isEmpty() && points.lastX() - points.firstX() > m_xWindowSize)
+        points.removeFirst();
 
     //qDebug() << "removeStaleData ";
 }
@@ -33,6 +33,7 @@
 #include "positionactual.h"
 #include "attituderaw.h"
 #include "manualcontrolcommand.h"
+#include "plotbuffer.h"
 
 
 #include "qwt/src/qwt.h"
@@ -76,17 +77,21 @@ public:
     double yMaximum;
     double m_xWindowSize;
     QwtPlotCurve* curve;
-    QVector<double>* xData;
-    QVector<double>* yData;
+    PlotBuffer points;
 
     virtual bool append(UAVObject* obj) = 0;
     virtual PlotType plotType() = 0;
     virtual void removeStaleData() = 0;
 
     void updatePlotCurveData();
+    bool bind(UAVObjectField* field);
 
 protected:
-    double valueAsDouble(UAVObject* obj, UAVObjectField* field);
+    // Element plotted, resolved when the curve is added
+    UAVObjectFieldBinding binding;
+    double scaleFactor;
+
+    bool isBoundTo(UAVObject* obj) { return binding.isValid() && binding.getField()->getObject() == obj; }
 
 signals:
     void dataChanged();
@@ -101,7 +106,9 @@ class SequencialPlotData : public PlotData
     Q_OBJECT
 public:
     SequencialPlotData(QString uavObject, QString uavField)
-            : PlotData(uavObject, uavField) {}
+            : PlotData(uavObject, uavField) {
+        points.setIndexAsX(true);
+    }
     ~SequencialPlotData() {}
 
     /*!
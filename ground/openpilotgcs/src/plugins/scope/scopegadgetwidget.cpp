@@ -387,6 +387,8 @@ void ScopeGadgetWidget::addCurvePlot(QString uavObject, QString uavFieldSubField
     UAVDataObject* obj = dynamic_cast<UAVDataObject*>(objManager->getObject((plotData->uavObject)));
 
     UAVObjectField* field = obj->getField(plotData->uavField);
+    if (!plotData->bind(field))
+        qDebug() << "Scope: no element" << plotData->uavSubField << "in" << curveName;
     QString units = field->getUnits();
 
     if(units == 0)
@@ -400,7 +402,8 @@ void ScopeGadgetWidget::addCurvePlot(QString uavObject, QString uavFieldSubField
 
     QwtPlotCurve* plotCurve = new QwtPlotCurve(curveNameScaled);
     plotCurve->setPen(pen);
-    plotCurve->setData(*plotData->xData, *plotData->yData);
+    // The curve reads the points from the buffer, no copy is made on replot
+    plotCurve->setData(PlotBufferData(&plotData->points));
     plotCurve->attach(this);
     plotData->curve = plotCurve;
 
@@ -448,7 +451,7 @@ void ScopeGadgetWidget::replotNewData()
 	foreach(PlotData* plotData, m_curvesData.values())
 	{
         plotData->removeStaleData();
-        plotData->curve->setData(*plotData->xData, *plotData->yData);
+        plotData->points.decimate(canvas()->contentsRect().width());
     }
 
     QDateTime NOW = QDateTime::currentDateTime();
@@ -697,12 +700,12 @@ int ScopeGadgetWidget::csvLoggingInsertData()
         foreach(PlotData* plotData2, m_curvesData.values())
         {
             ss  << ", ";
-            if (plotData2->xData->isEmpty ())
+            if (plotData2->points.isEmpty ())
             {
             }
             else
             {
-                ss  << QString().sprintf("%3.6g",plotData2->yData->last()/pow(10,plotData2->scalePower));
+                ss  << QString().sprintf("%3.6g",plotData2->points.lastY()/pow(10,plotData2->scalePower));
                 m_csvLoggingDataValid=1;
             }
         }
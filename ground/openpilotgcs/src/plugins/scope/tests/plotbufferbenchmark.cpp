@@ -0,0 +1,217 @@
+/**
+ ******************************************************************************
+ *
+ * @file       plotbufferbenchmark.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2011.
+ * @brief      Benchmark of the storage of the scope curves
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <QtTest/QtTest>
+#include <math.h>
+#include "plotbuffer.h"
+
+/**
+ * Feeds N curves with full windows of samples, as a 100Hz object does during one
+ * replot period, then prepares them for drawing. The QVector cases are the storage
+ * the scope used before: front removal and a copy of the points on every replot.
+ */
+class PlotBufferBenchmark: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void appendVector_data() { curvesAndWindows(); }
+    void appendVector();
+    void appendBuffer_data() { curvesAndWindows(); }
+    void appendBuffer();
+    void replotVector_data() { curvesAndWindows(); }
+    void replotVector();
+    void replotBuffer_data() { curvesAndWindows(); }
+    void replotBuffer();
+    void decimation();
+
+private:
+    // 100Hz samples received between two replots
+    static const int SAMPLES_PER_REPLOT = 10;
+    // Width of the plot canvas in pixels
+    static const int CANVAS_WIDTH = 800;
+
+    void curvesAndWindows();
+    static double sample(int n) { return sin(n * 0.01) + 0.1 * sin(n * 1.7); }
+    static double drawPoints(const QwtData &data);
+};
+
+void PlotBufferBenchmark::curvesAndWindows()
+{
+    QTest::addColumn<int>("curves");
+    QTest::addColumn<int>("window");
+
+    const int curves[] = { 1, 4, 16 };
+    const int windows[] = { 1000, 10000, 60000 };
+    for (int c = 0; c < 3; ++c)
+        for (int w = 0; w < 3; ++w)
+            QTest::newRow(qPrintable(QString("%1 curves x %2").arg(curves[c]).arg(windows[w])))
+                    << curves[c] << windows[w];
+}
+
+/**
+ * Reads all points like the curve does when drawing
+ */
+double PlotBufferBenchmark::drawPoints(const QwtData &data)
+{
+    double sum = 0;
+    size_t size = data.size();
+    for (size_t i = 0; i < size; ++i)
+        sum += data.x(i) + data.y(i);
+    return sum;
+}
+
+void PlotBufferBenchmark::appendVector()
+{
+    QFETCH(int, curves);
+    QFETCH(int, window);
+
+    QVector< QVector<double> > yData(curves);
+    for (int c = 0; c < curves; ++c)
+        for (int n = 0; n < window; ++n)
+            yData[c].append(sample(n));
+
+    int n = window;
+    QBENCHMARK {
+        for (int s = 0; s < SAMPLES_PER_REPLOT; ++s, ++n)
+        {
+            for (int c = 0; c < curves; ++c)
+            {
+                yData[c].append(sample(n));
+                yData[c].pop_front();
+            }
+        }
+    }
+    QCOMPARE(yData[0].size(), window);
+}
+
+void PlotBufferBenchmark::appendBuffer()
+{
+    QFETCH(int, curves);
+    QFETCH(int, window);
+
+    QVector<PlotBuffer*> buffers(curves);
+    for (int c = 0; c < curves; ++c)
+    {
+        buffers[c] = new PlotBuffer(window + 1);
+        for (int n = 0; n < window; ++n)
+            buffers[c]->append(n, sample(n));
+    }
+
+    int n = window;
+    QBENCHMARK {
+        for (int s = 0; s < SAMPLES_PER_REPLOT; ++s, ++n)
+        {
+            for (int c = 0; c < curves; ++c)
+            {
+                buffers[c]->append(n, sample(n));
+                buffers[c]->removeFirst();
+            }
+        }
+    }
+    QCOMPARE(buffers[0]->size(), window);
+    qDeleteAll(buffers);
+}
+
+void PlotBufferBenchmark::replotVector()
+{
+    QFETCH(int, curves);
+    QFETCH(int, window);
+
+    QVector<double> xData(window);
+    QVector<double> yData(window);
+    for (int n = 0; n < window; ++n)
+    {
+        xData[n] = n;
+        yData[n] = sample(n);
+    }
+
+    double sum = 0;
+    QBENCHMARK {
+        for (int c = 0; c < curves; ++c)
+        {
+            QwtArrayData data(xData, yData);
+            sum += drawPoints(data);
+        }
+    }
+    QVERIFY(sum != 0);
+}
+
+void PlotBufferBenchmark::replotBuffer()
+{
+    QFETCH(int, curves);
+    QFETCH(int, window);
+
+    PlotBuffer buffer(window);
+    for (int n = 0; n < window; ++n)
+        buffer.append(n, sample(n));
+    PlotBufferData data(&buffer);
+
+    double sum = 0;
+    QBENCHMARK {
+        for (int c = 0; c < curves; ++c)
+        {
+            buffer.decimate(CANVAS_WIDTH);
+            sum += drawPoints(data);
+        }
+    }
+    QVERIFY(sum != 0);
+}
+
+/**
+ * The decimated curve keeps the extremes and both ends of the data
+ */
+void PlotBufferBenchmark::decimation()
+{
+    const int window = 60000;
+    PlotBuffer buffer(window);
+    double minY = 0;
+    double maxY = 0;
+    for (int n = 0; n < window; ++n)
+    {
+        buffer.append(n, sample(n));
+        minY = qMin(minY, sample(n));
+        maxY = qMax(maxY, sample(n));
+    }
+    PlotBufferData data(&buffer);
+
+    buffer.decimate(CANVAS_WIDTH);
+    QVERIFY(data.size() <= (size_t)(4 * CANVAS_WIDTH));
+    QCOMPARE(data.x(0), 0.0);
+    QCOMPARE(data.x(data.size() - 1), (double)(window - 1));
+    QCOMPARE(data.boundingRect().top(), minY);
+    QVERIFY(qFuzzyCompare(data.boundingRect().bottom(), maxY));
+    for (size_t i = 1; i < data.size(); ++i)
+        QVERIFY(data.x(i) > data.x(i - 1));
+
+    // Few points are drawn as they are
+    buffer.removeFirst(window - CANVAS_WIDTH);
+    buffer.decimate(CANVAS_WIDTH);
+    QCOMPARE(data.size(), (size_t)CANVAS_WIDTH);
+}
+
+QTEST_APPLESS_MAIN(PlotBufferBenchmark)
+
+#include "plotbufferbenchmark.moc"
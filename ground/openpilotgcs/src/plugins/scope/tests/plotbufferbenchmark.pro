@@ -0,0 +1,16 @@
+# -------------------------------------------------
+# QTestLib benchmark of the scope curve storage
+# -------------------------------------------------
+QT -= gui
+QT += testlib
+TARGET = plotbufferbenchmark
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+INCLUDEPATH += .. \
+    ../../../libs \
+    ../../../libs/qwt/src
+SOURCES += plotbufferbenchmark.cpp \
+    ../plotbuffer.cpp \
+    ../../../libs/qwt/src/qwt_data.cpp
+HEADERS += ../plotbuffer.h
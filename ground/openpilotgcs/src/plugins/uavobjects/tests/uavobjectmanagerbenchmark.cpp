@@ -0,0 +1,168 @@
+/**
+ ******************************************************************************
+ *
+ * @file       uavobjectmanagerbenchmark.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2011.
+ * @brief      Benchmark of the object lookups of the UAVObjectManager
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+
+#include <QtTest/QtTest>
+#include "uavobjectmanager.h"
+#include "attitudeactual.h"
+
+/**
+ * Minimal multi instance data object with a single field, used to fill the manager
+ */
+class BenchObject: public UAVDataObject
+{
+public:
+    BenchObject(quint32 objID, const QString& name): UAVDataObject(objID, false, false, name)
+    {
+        QList<UAVObjectField*> fields;
+        fields.append( new UAVObjectField(QString("Value"), QString(""), UAVObjectField::UINT32, 1, QStringList()) );
+        initializeFields(fields, (quint8*)&value, sizeof(value));
+    }
+
+    Metadata getDefaultMetadata()
+    {
+        Metadata metadata;
+        memset(&metadata, 0, sizeof(metadata));
+        return metadata;
+    }
+
+    UAVDataObject* clone(quint32 instID)
+    {
+        BenchObject* obj = new BenchObject(objID, name);
+        obj->initialize(instID, this->getMetaObject());
+        return obj;
+    }
+
+private:
+    quint32 value;
+};
+
+/**
+ * Registers about as many objects as the GCS does, with the object looked up
+ * registered last, and measures the lookups done by the gadgets and by UAVTalk.
+ */
+class UAVObjectManagerBenchmark: public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void getObjectById();
+    void getObjectByName();
+    void getObjectInstance();
+    void getInstance();
+    void readFieldByName();
+    void readFieldBinding();
+
+private:
+    static const int NUM_OBJECTS = 100;
+    static const int NUM_INSTANCES = 10;
+    static const quint32 MULTI_OBJID = 0x10000000;
+
+    UAVObjectManager objMngr;
+};
+
+void UAVObjectManagerBenchmark::initTestCase()
+{
+    for (int n = 0; n < NUM_OBJECTS; ++n)
+    {
+        // LSB of the ID is reserved for the metaobject
+        objMngr.registerObject(new BenchObject(MULTI_OBJID + 2 * (n + 1), QString("BenchObject%1").arg(n)));
+    }
+    BenchObject* multi = new BenchObject(MULTI_OBJID, QString("BenchMulti"));
+    objMngr.registerObject(multi);
+    for (int n = 1; n < NUM_INSTANCES; ++n)
+    {
+        QVERIFY(objMngr.registerObject(multi->clone(n)));
+    }
+    QVERIFY(objMngr.registerObject(new AttitudeActual()));
+}
+
+void UAVObjectManagerBenchmark::getObjectById()
+{
+    UAVObject* obj = NULL;
+    QBENCHMARK {
+        obj = objMngr.getObject(AttitudeActual::OBJID);
+    }
+    QVERIFY(obj != NULL && obj->getObjID() == AttitudeActual::OBJID);
+}
+
+void UAVObjectManagerBenchmark::getObjectByName()
+{
+    UAVObject* obj = NULL;
+    QBENCHMARK {
+        obj = objMngr.getObject(AttitudeActual::NAME);
+    }
+    QVERIFY(obj != NULL && obj->getObjID() == AttitudeActual::OBJID);
+}
+
+void UAVObjectManagerBenchmark::getObjectInstance()
+{
+    UAVObject* obj = NULL;
+    QBENCHMARK {
+        obj = objMngr.getObject(MULTI_OBJID, NUM_INSTANCES - 1);
+    }
+    QVERIFY(obj != NULL && obj->getInstID() == NUM_INSTANCES - 1);
+    QVERIFY(objMngr.getObject(MULTI_OBJID, NUM_INSTANCES) == NULL);
+}
+
+void UAVObjectManagerBenchmark::getInstance()
+{
+    AttitudeActual* obj = NULL;
+    QBENCHMARK {
+        obj = AttitudeActual::GetInstance(&objMngr);
+    }
+    QVERIFY(obj != NULL && obj == objMngr.getObject(AttitudeActual::OBJID));
+}
+
+/**
+ * What the gadgets did for each update: field lookup by name, then a QVariant
+ */
+void UAVObjectManagerBenchmark::readFieldByName()
+{
+    UAVObject* obj = objMngr.getObject(AttitudeActual::OBJID);
+    obj->getField("Yaw")->setDouble(12.5);
+    double value = 0;
+    QBENCHMARK {
+        value = obj->getField("Yaw")->getValue().toDouble();
+    }
+    QCOMPARE(value, 12.5);
+}
+
+void UAVObjectManagerBenchmark::readFieldBinding()
+{
+    UAVObject* obj = objMngr.getObject(AttitudeActual::OBJID);
+    obj->getField("Yaw")->setDouble(12.5);
+    UAVObjectFieldBinding binding = obj->bindField("Yaw");
+    QVERIFY(binding.isValid());
+    double value = 0;
+    QBENCHMARK {
+        value = binding.getDouble();
+    }
+    QCOMPARE(value, 12.5);
+}
+
+QTEST_APPLESS_MAIN(UAVObjectManagerBenchmark)
+
+#include "uavobjectmanagerbenchmark.moc"
@@ -0,0 +1,26 @@
+# -------------------------------------------------
+# QTestLib benchmark of the UAVObjectManager lookups
+# -------------------------------------------------
+QT -= gui
+QT += testlib
+TARGET = uavobjectmanagerbenchmark
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+DEFINES += UAVOBJECTS_LIBRARY
+UAVOBJECT_SYNTHETICS = $$PWD/../../../../../../build/uavobject-synthetics/gcs
+INCLUDEPATH += .. \
+    $$UAVOBJECT_SYNTHETICS
+SOURCES += uavobjectmanagerbenchmark.cpp \
+    ../uavobjectmanager.cpp \
+    ../uavobjectfield.cpp \
+    ../uavobject.cpp \
+    ../uavmetaobject.cpp \
+    ../uavdataobject.cpp \
+    $$UAVOBJECT_SYNTHETICS/attitudeactual.cpp
+HEADERS += ../uavobjectmanager.h \
+    ../uavobjectfield.h \
+    ../uavobject.h \
+    ../uavmetaobject.h \
+    ../uavdataobject.h \
+    $$UAVOBJECT_SYNTHETICS/attitudeactual.h
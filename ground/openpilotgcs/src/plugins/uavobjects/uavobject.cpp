@@ -42,6 +42,9 @@ UAVObject::UAVObject(quint32 objID, bool isSingleInst, const QString& name)
     this->isSingleInst = isSingleInst;
     this->name = name;
     this->mutex = new QMutex(QMutex::Recursive);
+    this->numBytes = 0;
+    this->data = NULL;
+    this->directPack = false;
 }
 
 /**
@@ -73,6 +76,10 @@ void UAVObject::initializeFields(QList<UAVObjectField*>& fields, quint8* data, q
         offset += fields[n]->getNumBytes();
         connect(fields[n], SIGNAL(fieldUpdated(UAVObjectField*)), this, SLOT(fieldUpdated(UAVObjectField*)));
     }
+    // The fields are stored back to back in the (packed) data, in the order and
+    // with the sizes they are packed. On a little endian host each field is stored
+    // exactly as it is packed, so the whole object can be copied in one go.
+    directPack = (Q_BYTE_ORDER == Q_LITTLE_ENDIAN && offset == numBytes);
 }
 
 /**
@@ -229,6 +236,20 @@ UAVObjectField* UAVObject::getField(const QString& name)
     return NULL;
 }
 
+/**
+ * Bind an element of a field, the first one if no element name is given
+ * @returns The binding, invalid if the field or the element does not exist
+ */
+UAVObjectFieldBinding UAVObject::bindField(const QString& name, const QString& elementName)
+{
+    UAVObjectField* field = getField(name);
+    if (field == NULL)
+    {
+        return UAVObjectFieldBinding();
+    }
+    return elementName.isEmpty() ? field->bind() : field->bind(elementName);
+}
+
 /**
  * Pack the object data into a byte array
  * @returns The number of bytes copied
@@ -236,6 +257,11 @@ UAVObjectField* UAVObject::getField(const QString& name)
 qint32 UAVObject::pack(quint8* dataOut)
 {
     QMutexLocker locker(mutex);
+    if (directPack)
+    {
+        memcpy(dataOut, data, numBytes);
+        return numBytes;
+    }
     qint32 offset = 0;
     for (int n = 0; n < fields.length(); ++n)
     {
@@ -252,11 +278,18 @@ qint32 UAVObject::pack(quint8* dataOut)
 qint32 UAVObject::unpack(const quint8* dataIn)
 {
     QMutexLocker locker(mutex);
-    qint32 offset = 0;
-    for (int n = 0; n < fields.length(); ++n)
+    if (directPack)
     {
-        fields[n]->unpack(&dataIn[offset]);
-        offset += fields[n]->getNumBytes();
+        memcpy(data, dataIn, numBytes);
+    }
+    else
+    {
+        qint32 offset = 0;
+        for (int n = 0; n < fields.length(); ++n)
+        {
+            fields[n]->unpack(&dataIn[offset]);
+            offset += fields[n]->getNumBytes();
+        }
     }
     emit objectUnpacked(this); // trigger object updated event
     emit objectUpdated(this);
@@ -39,6 +39,7 @@
 #include "uavobjectfield.h"
 
 class UAVObjectField;
+class UAVObjectFieldBinding;
 
 class UAVOBJECTS_EXPORT UAVObject: public QObject
 {
@@ -108,6 +109,7 @@ public:
     qint32 getNumFields();
     QList<UAVObjectField*> getFields();
     UAVObjectField* getField(const QString& name);
+    UAVObjectFieldBinding bindField(const QString& name, const QString& elementName = QString());
     QString toString();
     QString toStringBrief();
     QString toStringData();
@@ -134,6 +136,7 @@ protected:
     QMutex* mutex;
     quint8* data;
     QList<UAVObjectField*> fields;
+    bool directPack; /** True if the data in memory has the same layout as the packed data */
 
     void initializeFields(QList<UAVObjectField*>& fields, quint8* data, quint32 numBytes);
     void setDescription(const QString& description);
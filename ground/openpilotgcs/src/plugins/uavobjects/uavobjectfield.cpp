@@ -574,6 +574,10 @@ void UAVObjectField::setValue(const QVariant& value, quint32 index)
 
 double UAVObjectField::getDouble(quint32 index)
 {
+    if ( isNumeric() )
+    {
+        return bind(index).getDouble();
+    }
     return getValue(index).toDouble();
 }
 
@@ -582,3 +586,97 @@ void UAVObjectField::setDouble(double value, quint32 index)
     setValue(QVariant(value), index);
 }
 
+/**
+ * Bind an element of the field
+ * @returns The binding, invalid if the index is out of bounds
+ */
+UAVObjectFieldBinding UAVObjectField::bind(quint32 index)
+{
+    if ( index >= numElements )
+    {
+        return UAVObjectFieldBinding();
+    }
+    return UAVObjectFieldBinding(this, index);
+}
+
+/**
+ * Bind an element of the field by name
+ * @returns The binding, invalid if there is no such element
+ */
+UAVObjectFieldBinding UAVObjectField::bind(const QString& elementName)
+{
+    int index = elementNames.indexOf(elementName);
+    if ( index < 0 )
+    {
+        return UAVObjectFieldBinding();
+    }
+    return bind(index);
+}
+
+UAVObjectFieldBinding::UAVObjectFieldBinding():
+    field(NULL), type(UAVObjectField::UINT8), mutex(NULL), element(NULL)
+{
+}
+
+UAVObjectFieldBinding::UAVObjectFieldBinding(UAVObjectField* field, quint32 index):
+    field(field),
+    type(field->type),
+    mutex(field->obj->getMutex()),
+    element(&field->data[field->offset + field->numBytesPerElement*index])
+{
+}
+
+/**
+ * Read the element as a double, enums give the index of their option
+ * and strings give 0
+ */
+double UAVObjectFieldBinding::getDouble() const
+{
+    if ( field == NULL )
+    {
+        return 0;
+    }
+    QMutexLocker locker(mutex);
+    switch (type)
+    {
+        case UAVObjectField::INT8:
+            return *(const qint8*)element;
+        case UAVObjectField::INT16:
+        {
+            qint16 tmpint16;
+            memcpy(&tmpint16, element, sizeof(tmpint16));
+            return tmpint16;
+        }
+        case UAVObjectField::INT32:
+        {
+            qint32 tmpint32;
+            memcpy(&tmpint32, element, sizeof(tmpint32));
+            return tmpint32;
+        }
+        case UAVObjectField::UINT8:
+        case UAVObjectField::ENUM:
+            return *(const quint8*)element;
+        case UAVObjectField::UINT16:
+        {
+            quint16 tmpuint16;
+            memcpy(&tmpuint16, element, sizeof(tmpuint16));
+            return tmpuint16;
+        }
+        case UAVObjectField::UINT32:
+        {
+            quint32 tmpuint32;
+            memcpy(&tmpuint32, element, sizeof(tmpuint32));
+            return tmpuint32;
+        }
+        case UAVObjectField::FLOAT32:
+        {
+            float tmpfloat;
+            memcpy(&tmpfloat, element, sizeof(tmpfloat));
+            return tmpfloat;
+        }
+        case UAVObjectField::STRING:
+            return 0;
+    }
+    return 0;
+}
+
@@ -34,6 +34,7 @@
 #include <QVariant>
 
 class UAVObject;
+class UAVObjectFieldBinding;
 
 class UAVOBJECTS_EXPORT UAVObjectField: public QObject
 {
@@ -59,6 +60,8 @@ public:
     void setValue(const QVariant& data, quint32 index = 0);
     double getDouble(quint32 index = 0);
     void setDouble(double value, quint32 index = 0);
+    UAVObjectFieldBinding bind(quint32 index = 0);
+    UAVObjectFieldBinding bind(const QString& elementName);
     quint32 getDataOffset();
     quint32 getNumBytes();
     quint32 getNumBytesElement();
@@ -84,7 +87,28 @@ protected:
     void clear();
     void constructorInitialize(const QString& name, const QString& units, FieldType type, const QStringList& elementNames, const QStringList& options);
 
+    friend class UAVObjectFieldBinding;
+};
+
+/**
+ * One element of a field, resolved once so that reading it needs no name lookup
+ * and no QVariant. Gadgets bind the fields they show when they are configured and
+ * read the bindings on every update.
+ */
+class UAVOBJECTS_EXPORT UAVObjectFieldBinding
+{
+public:
+    UAVObjectFieldBinding();
+    UAVObjectFieldBinding(UAVObjectField* field, quint32 index);
+    bool isValid() const { return field != NULL; }
+    UAVObjectField* getField() const { return field; }
+    double getDouble() const;
 
+private:
+    UAVObjectField* field;
+    UAVObjectField::FieldType type;
+    QMutex* mutex;
+    const quint8* element;
 };
 
 #endif // UAVOBJECTFIELD_H
@@ -50,64 +50,61 @@ bool UAVObjectManager::registerObject(UAVDataObject* obj)
 {
     QMutexLocker locker(mutex);
     // Check if this object type is already in the list
-    for (int objidx = 0; objidx < objects.length(); ++objidx)
+    int objidx = findObject(NULL, obj->getObjID());
+    if (objidx >= 0)
     {
-        // Check if the object ID is in the list
-        if (objects[objidx].length() > 0 && objects[objidx][0]->getObjID() == obj->getObjID())
+        // Check if this is a single instance object, if yes we can not add a new instance
+        if (obj->isSingleInstance())
         {
-            // Check if this is a single instance object, if yes we can not add a new instance
-            if (obj->isSingleInstance())
-            {
-                return false;
-            }
-            // The object type has alredy been added, so now we need to initialize the new instance with the appropriate id
-            // There is a single metaobject for all object instances of this type, so no need to create a new one
-            // Get object type metaobject from existing instance
-            UAVDataObject* refObj = dynamic_cast<UAVDataObject*>(objects[objidx][0]);
-            if (refObj == NULL)
-            {
-                return false;
-            }
-            UAVMetaObject* mobj = refObj->getMetaObject();
-            // If the instance ID is specified and not at the default value (0) then we need to make sure
-            // that there are no gaps in the instance list. If gaps are found then then additional instances
-            // will be created.
-            if ( (obj->getInstID() > 0) && (obj->getInstID() < MAX_INSTANCES) )
+            return false;
+        }
+        // The object type has alredy been added, so now we need to initialize the new instance with the appropriate id
+        // There is a single metaobject for all object instances of this type, so no need to create a new one
+        // Get object type metaobject from existing instance
+        UAVDataObject* refObj = dynamic_cast<UAVDataObject*>(objects[objidx][0]);
+        if (refObj == NULL)
+        {
+            return false;
+        }
+        UAVMetaObject* mobj = refObj->getMetaObject();
+        // If the instance ID is specified and not at the default value (0) then we need to make sure
+        // that there are no gaps in the instance list. If gaps are found then then additional instances
+        // will be created.
+        if ( (obj->getInstID() > 0) && (obj->getInstID() < MAX_INSTANCES) )
+        {
+            for (int instidx = 0; instidx < objects[objidx].length(); ++instidx)
             {
-                for (int instidx = 0; instidx < objects[objidx].length(); ++instidx)
+                if ( objects[objidx][instidx]->getInstID() == obj->getInstID() )
                 {
-                    if ( objects[objidx][instidx]->getInstID() == obj->getInstID() )
-                    {
-                        // Instance conflict, do not add
-                        return false;
-                    }
+                    // Instance conflict, do not add
+                    return false;
                 }
-                // Check if there are any gaps between the requested instance ID and the ones in the list,
-                // if any then create the missing instances.
-                for (quint32 instidx = objects[objidx].length(); instidx < obj->getInstID(); ++instidx)
-                {
-                    UAVDataObject* cobj = obj->clone(instidx);
-                    cobj->initialize(mobj);
-                    objects[objidx].append(cobj);
-                    emit newInstance(cobj);
-                }
-                // Finally, initialize the actual object instance
-                obj->initialize(mobj);
             }
-            else if (obj->getInstID() == 0)
+            // Check if there are any gaps between the requested instance ID and the ones in the list,
+            // if any then create the missing instances.
+            for (quint32 instidx = objects[objidx].length(); instidx < obj->getInstID(); ++instidx)
             {
-                // Assign the next available ID and initialize the object instance
-                obj->initialize(objects[objidx].length(), mobj);
+                UAVDataObject* cobj = obj->clone(instidx);
+                cobj->initialize(mobj);
+                objects[objidx].append(cobj);
+                emit newInstance(cobj);
             }
-            else
-            {
-                return false;
-            }
-            // Add the actual object instance in the list
-            objects[objidx].append(obj);
-            emit newInstance(obj);
-            return true;
+            // Finally, initialize the actual object instance
+            obj->initialize(mobj);
+        }
+        else if (obj->getInstID() == 0)
+        {
+            // Assign the next available ID and initialize the object instance
+            obj->initialize(objects[objidx].length(), mobj);
         }
+        else
+        {
+            return false;
+        }
+        // Add the actual object instance in the list
+        objects[objidx].append(obj);
+        emit newInstance(obj);
+        return true;
     }
     // If this point is reached then this is the first time this object type (ID) is added in the list
     // create a new list of the instances, add in the object collection and create the object's metaobject
@@ -125,13 +122,32 @@ bool UAVObjectManager::registerObject(UAVDataObject* obj)
 
 void UAVObjectManager::addObject(UAVObject* obj)
 {
-    // Add to list
+    // Add to list and index
     QList<UAVObject*> list;
     list.append(obj);
+    indexById.insert(obj->getObjID(), objects.length());
+    indexByName.insert(obj->getName(), objects.length());
     objects.append(list);
     emit newObject(obj);
 }
 
+/**
+ * Find the position of an object type in the object list, by name if name is not NULL
+ * and by object ID otherwise. Object types are never removed, so the index stays valid.
+ * @returns The index in the object list or -1 if not found
+ */
+int UAVObjectManager::findObject(const QString* name, quint32 objId)
+{
+    if (name != NULL)
+    {
+        return indexByName.value(*name, -1);
+    }
+    else
+    {
+        return indexById.value(objId, -1);
+    }
+}
+
 /**
  * Get all objects. A two dimentional QList is returned. Objects are grouped by
  * instances of the same object type.
@@ -240,22 +256,21 @@ UAVObject* UAVObjectManager::getObject(quint32 objId, quint32 instId)
 UAVObject* UAVObjectManager::getObject(const QString* name, quint32 objId, quint32 instId)
 {
     QMutexLocker locker(mutex);
-    // Check if this object type is already in the list
-    for (int objidx = 0; objidx < objects.length(); ++objidx)
+    int objidx = findObject(name, objId);
+    if (objidx >= 0)
     {
-        // Check if the object ID is in the list
-        if (objects[objidx].length() > 0)
+        const QList<UAVObject*>& instances = objects[objidx];
+        // Instances are registered without gaps, so the instance ID is normally the position in the list
+        if (instId < (quint32)instances.length() && instances[instId]->getInstID() == instId)
         {
-            if ( (name != NULL && objects[objidx][0]->getName().compare(name) == 0) || (name == NULL && objects[objidx][0]->getObjID() == objId) )
+            return instances[instId];
+        }
+        // Look for the requested instance ID
+        for (int instidx = 0; instidx < instances.length(); ++instidx)
+        {
+            if (instances[instidx]->getInstID() == instId)
             {
-                // Look for the requested instance ID
-                for (int instidx = 0; instidx < objects[objidx].length(); ++instidx)
-                {
-                    if (objects[objidx][instidx]->getInstID() == instId)
-                    {
-                        return objects[objidx][instidx];
-                    }
-                }
+                return instances[instidx];
             }
         }
     }
@@ -286,17 +301,10 @@ QList<UAVObject*> UAVObjectManager::getObjectInstances(quint32 objId)
 QList<UAVObject*> UAVObjectManager::getObjectInstances(const QString* name, quint32 objId)
 {
     QMutexLocker locker(mutex);
-    // Check if this object type is already in the list
-    for (int objidx = 0; objidx < objects.length(); ++objidx)
+    int objidx = findObject(name, objId);
+    if (objidx >= 0)
     {
-        // Check if the object ID is in the list
-        if (objects[objidx].length() > 0)
-        {
-            if ( (name != NULL && objects[objidx][0]->getName().compare(name) == 0) || (name == NULL && objects[objidx][0]->getObjID() == objId) )
-            {
-                return objects[objidx];
-            }
-        }
+        return objects[objidx];
     }
     // If this point is reached then the requested object could not be found
     return QList<UAVObject*>();
@@ -324,17 +332,10 @@ qint32 UAVObjectManager::getNumInstances(quint32 objId)
 qint32 UAVObjectManager::getNumInstances(const QString* name, quint32 objId)
 {
     QMutexLocker locker(mutex);
-    // Check if this object type is already in the list
-    for (int objidx = 0; objidx < objects.length(); ++objidx)
+    int objidx = findObject(name, objId);
+    if (objidx >= 0)
     {
-        // Check if the object ID is in the list
-        if (objects[objidx].length() > 0)
-        {
-            if ( (name != NULL && objects[objidx][0]->getName().compare(name) == 0) || (name == NULL && objects[objidx][0]->getObjID() == objId) )
-            {
-                return objects[objidx].length();
-            }
-        }
+        return objects[objidx].length();
     }
     // If this point is reached then the requested object could not be found
     return -1;
@@ -8,11 +8,44 @@ $(ALLOCATIONCODE)
     logfile = strcat(PathName,FileName);
     fid = fopen(logfile);
     
+    %% Skip the object dictionary of version 2 logs and stop at their index
+    fseek(fid, 0, 'eof');
+    recordsEnd = ftell(fid);
+    fseek(fid, 0, 'bof');
+    version = 1;
+    magic = fread(fid, 8, 'uint8=>char')';
+    if strcmp(magic, ['OPLOGv2' char(0)])
+        version = 2;
+        headerSize = fread(fid, 1, 'uint32');
+        recordsStart = ftell(fid) + headerSize;
+        fseek(fid, -16, 'eof');
+        indexOffset = fread(fid, 1, 'int64');
+        fread(fid, 1, 'uint32');
+        indexMagic = fread(fid, 1, 'uint32');
+        if indexMagic == hex2dec('58444E49')
+            recordsEnd = indexOffset;
+        end
+        fseek(fid, recordsStart, 'bof');
+    else
+        fseek(fid, 0, 'bof');
+    end
+    
     while (1)
         %% Read logging header        
+        if (ftell(fid) >= recordsEnd); break; end
         timestamp = fread(fid, 1, 'uint32');
         if (feof(fid)); break; end
-        datasize = fread(fid, 1, 'int64');
+        if version == 1
+            datasize = fread(fid, 1, 'int64');
+        else
+            recordType = fread(fid, 1, 'uint8');
+            datasize = fread(fid, 1, 'uint32');
+            % Keyframes repeat the state of all objects, they are only used to seek
+            if recordType ~= 0
+                fseek(fid, datasize, 'cof');
+                continue;
+            end
+        end
           
         
         %% Read message header        
@@ -53,11 +53,6 @@ Telemetry::Telemetry(UAVTalk* utalk, UAVObjectManager* objMngr)
     connect(utalk, SIGNAL(transactionCompleted(UAVObject*,bool)), this, SLOT(transactionCompleted(UAVObject*,bool)));
     // Get GCS stats object
     gcsStatsObj = GCSTelemetryStats::GetInstance(objMngr);
-    // Setup transaction timer
-    transPending = false;
-    transTimer = new QTimer(this);
-    transTimer->stop();
-    connect(transTimer, SIGNAL(timeout()), this, SLOT(transactionTimeout()));
     // Setup and start the periodic timer
     timeToNextUpdateMs = 0;
     updateTimer = new QTimer(this);
@@ -66,6 +61,28 @@ Telemetry::Telemetry(UAVTalk* utalk, UAVObjectManager* objMngr)
     // Setup and start the stats timer
     txErrors = 0;
     txRetries = 0;
+    txQueueDepth = 0;
+    txPending = 0;
+    txCoalesced = 0;
+    txQueueFull = 0;
+}
+
+/**
+ * Destructor, the timers are children of the object but the pending transactions are not
+ */
+Telemetry::~Telemetry()
+{
+    {
+        QMutexLocker locker(mutex);
+        updateTimer->stop();
+        foreach (ObjectTransactionInfo* info, transMap)
+        {
+            info->timer->stop();
+        }
+        qDeleteAll(transMap);
+        transMap.clear();
+    }
+    delete mutex;
 }
 
 /**
@@ -209,13 +226,13 @@ void Telemetry::updateObject(UAVObject* obj)
  */
 void Telemetry::transactionCompleted(UAVObject* obj, bool success)
 {
-    // Check if there is a pending transaction and the objects match
-    if ( transPending && transInfo.obj->getObjID() == obj->getObjID() )
+    // Check if there is a pending transaction for this object
+    ObjectTransactionInfo* transInfo = findTransaction(obj);
+    if ( transInfo != NULL )
     {
     //    qDebug() << QString("Telemetry: transaction completed for %1").arg(obj->getName());
         // Complete transaction
-        transTimer->stop();
-        transPending = false;
+        endTransaction(transInfo);
         // Send signal
         obj->emitTransactionCompleted(success);
         // Process new object updates from queue
@@ -232,24 +249,34 @@ void Telemetry::transactionCompleted(UAVObject* obj, bool success)
 void Telemetry::transactionTimeout()
 {
 //    qDebug() << "Telemetry: transaction timeout.";
-    transTimer->stop();
-    // Proceed only if there is a pending transaction
-    if ( transPending )
+    // Find the transaction of the timer
+    ObjectTransactionInfo* transInfo = NULL;
+    foreach (ObjectTransactionInfo* info, transMap)
+    {
+        if (info->timer == sender())
+        {
+            transInfo = info;
+            break;
+        }
+    }
+    // Proceed only if the transaction is still pending
+    if ( transInfo != NULL )
     {
         // Check if more retries are pending
-        if (transInfo.retriesRemaining > 0)
+        if (transInfo->retriesRemaining > 0)
         {
-            --transInfo.retriesRemaining;
-            processObjectTransaction();
+            --transInfo->retriesRemaining;
+            processObjectTransaction(transInfo);
             ++txRetries;
         }
         else
         {
             // Terminate transaction
-            utalk->cancelTransaction();
-            transPending = false;
+            UAVObject* obj = transInfo->obj;
+            utalk->cancelTransaction(obj);
+            endTransaction(transInfo);
             // Send signal
-            transInfo.obj->emitTransactionCompleted(false);
+            obj->emitTransactionCompleted(false);
             // Process new object updates from queue
             processObjectQueue();
             ++txErrors;
@@ -258,35 +285,81 @@ void Telemetry::transactionTimeout()
 }
 
 /**
- * Start an object transaction with UAVTalk, all information is stored in transInfo
+ * Key of a transaction in transMap, all instance transactions use ALL_INSTANCES_KEY
  */
-void Telemetry::processObjectTransaction()
+static quint64 transactionKey(UAVObject* obj, quint32 instId)
 {
-    if (transPending)
+    return ((quint64)obj->getObjID() << 32) | instId;
+}
+
+/**
+ * Check if a transaction is pending which would receive the same responses as a new
+ * transaction of the object, the new transaction then has to wait.
+ */
+bool Telemetry::isTransactionPending(UAVObject* obj, bool allInstances)
+{
+    if (allInstances)
     {
-    //    qDebug() << tr("Process Object transaction for %1").arg(transInfo.obj->getName());
-        // Initiate transaction
-        if (transInfo.objRequest)
-        {
-            utalk->sendObjectRequest(transInfo.obj, transInfo.allInstances);
-        }
-        else
-        {
-            utalk->sendObject(transInfo.obj, transInfo.acked, transInfo.allInstances);
-        }
-        // Start timer if a response is expected
-        if ( transInfo.objRequest || transInfo.acked )
-        {
-            transTimer->start(REQ_TIMEOUT_MS);
-        }
-        else
+        foreach (ObjectTransactionInfo* info, transMap)
         {
-            transTimer->stop();
-            transPending = false;
+            if (info->obj->getObjID() == obj->getObjID())
+            {
+                return true;
+            }
         }
-    } else
+        return false;
+    }
+    return transMap.contains(transactionKey(obj, obj->getInstID())) ||
+           transMap.contains(transactionKey(obj, ALL_INSTANCES_KEY));
+}
+
+/**
+ * Find the pending transaction a received object instance answers
+ */
+Telemetry::ObjectTransactionInfo* Telemetry::findTransaction(UAVObject* obj)
+{
+    ObjectTransactionInfo* transInfo = transMap.value(transactionKey(obj, obj->getInstID()), NULL);
+    if (transInfo == NULL)
+    {
+        transInfo = transMap.value(transactionKey(obj, ALL_INSTANCES_KEY), NULL);
+    }
+    return transInfo;
+}
+
+/**
+ * Remove a transaction from the pending ones and free it
+ */
+void Telemetry::endTransaction(ObjectTransactionInfo* transInfo)
+{
+    transMap.remove(transactionKey(transInfo->obj, transInfo->allInstances ? ALL_INSTANCES_KEY : transInfo->obj->getInstID()));
+    transInfo->timer->stop();
+    transInfo->timer->deleteLater();
+    delete transInfo;
+}
+
+/**
+ * Start or retry an object transaction with UAVTalk
+ */
+void Telemetry::processObjectTransaction(ObjectTransactionInfo* transInfo)
+{
+//    qDebug() << tr("Process Object transaction for %1").arg(transInfo->obj->getName());
+    // Initiate transaction
+    if (transInfo->objRequest)
+    {
+        utalk->sendObjectRequest(transInfo->obj, transInfo->allInstances);
+    }
+    else
+    {
+        utalk->sendObject(transInfo->obj, transInfo->acked, transInfo->allInstances);
+    }
+    // Start timer if a response is expected
+    if ( transInfo->objRequest || transInfo->acked )
+    {
+        transInfo->timer->start(REQ_TIMEOUT_MS);
+    }
+    else
     {
-  //      qDebug() << "Error: inside of processObjectTransaction with no transPending";
+        endTransaction(transInfo);
     }
 }
 
@@ -303,121 +376,137 @@ void Telemetry::processObjectUpdates(UAVObject* obj, EventMask event, bool allIn
     objInfo.allInstances = allInstances;
     if (priority)
     {
-        if ( objPriorityQueue.length() < MAX_QUEUE_SIZE )
-        {
-            objPriorityQueue.enqueue(objInfo);
-        }
-        else
+        if ( !enqueueObjectUpdate(objPriorityQueue, objInfo) )
         {
             ++txErrors;
+            ++txQueueFull;
             obj->emitTransactionCompleted(false);
             qxtLog->warning(tr("Telemetry: priority event queue is full, event lost (%1)").arg(obj->getName()));
         }
     }
     else
     {
-        if ( objQueue.length() < MAX_QUEUE_SIZE )
-        {
-            objQueue.enqueue(objInfo);
-        }
-        else
+        if ( !enqueueObjectUpdate(objQueue, objInfo) )
         {
             ++txErrors;
+            ++txQueueFull;
             obj->emitTransactionCompleted(false);
         }
     }
-
-    // If there is no transaction in progress then process event
-    if (!transPending)
+    if ( (quint32)(objQueue.length() + objPriorityQueue.length()) > txQueueDepth )
     {
-    //    qDebug() << "No transaction pending, process object queue...";
-        processObjectQueue();
-    } else
-    {
-   //     qDebug() << "Transaction pending, DO NOT process object queue...";
+        txQueueDepth = objQueue.length() + objPriorityQueue.length();
     }
+
+    // Start transactions if the window is not full
+    processObjectQueue();
 }
 
 /**
- * Process events from the object queue
+ * Add an event to a queue. If the same event of the object is already queued the two
+ * are merged: the object data is only packed when the transaction starts, so the
+ * queued event will send the latest data anyway.
+ * \return False if the queue is full
  */
-void Telemetry::processObjectQueue()
+bool Telemetry::enqueueObjectUpdate(QQueue<ObjectQueueInfo>& queue, const ObjectQueueInfo& objInfo)
 {
-  //  qDebug() << "Process object queue " << tr("- Depth (%1 %2)").arg(objQueue.length()).arg(objPriorityQueue.length());
-
-    // Don nothing if a transaction is already in progress (should not happen)
-    if (transPending)
+    for (int n = 0; n < queue.length(); ++n)
     {
-        qxtLog->error("Telemetry: Dequeue while a transaction pending!");
-        return;
-    }
-
-    // Get object information from queue (first the priority and then the regular queue)
-    ObjectQueueInfo objInfo;
-    if ( !objPriorityQueue.isEmpty() )
-    {
-        objInfo = objPriorityQueue.dequeue();
+        if ( queue[n].obj == objInfo.obj && queue[n].event == objInfo.event )
+        {
+            queue[n].allInstances |= objInfo.allInstances;
+            ++txCoalesced;
+            return true;
+        }
     }
-    else if ( !objQueue.isEmpty() )
+    if ( queue.length() >= MAX_QUEUE_SIZE )
     {
-        objInfo = objQueue.dequeue();
+        return false;
     }
-    else
+    queue.enqueue(objInfo);
+    return true;
+}
+
+/**
+ * Remove the first event of a queue whose object has no transaction pending, events
+ * of objects waiting for a response stay in the queue in their order.
+ * \return False if there is no such event
+ */
+bool Telemetry::dequeueObjectUpdate(QQueue<ObjectQueueInfo>& queue, ObjectQueueInfo& objInfo)
+{
+    for (int n = 0; n < queue.length(); ++n)
     {
-        return;
+        if ( queue[n].event == EV_UNPACKED || !isTransactionPending(queue[n].obj, queue[n].allInstances) )
+        {
+            objInfo = queue.takeAt(n);
+            return true;
+        }
     }
+    return false;
+}
+
+/**
+ * Process events from the object queue, start transactions until MAX_PENDING_TRANSACTIONS
+ * are waiting for a response or the queues are empty
+ */
+void Telemetry::processObjectQueue()
+{
+  //  qDebug() << "Process object queue " << tr("- Depth (%1 %2)").arg(objQueue.length()).arg(objPriorityQueue.length());
 
-    // Check if a connection has been established, only process GCSTelemetryStats updates
-    // (used to establish the connection)
-    GCSTelemetryStats::DataFields gcsStats = gcsStatsObj->getData();
-    if ( gcsStats.Status != GCSTelemetryStats::STATUS_CONNECTED )
+    while ( transMap.size() < MAX_PENDING_TRANSACTIONS )
     {
-        objQueue.clear();
-        if ( objInfo.obj->getObjID() != GCSTelemetryStats::OBJID )
+        // Get object information from queue (first the priority and then the regular queue)
+        ObjectQueueInfo objInfo;
+        if ( !dequeueObjectUpdate(objPriorityQueue, objInfo) && !dequeueObjectUpdate(objQueue, objInfo) )
         {
-            objInfo.obj->emitTransactionCompleted(false);
             return;
         }
-    }
 
-    // Setup transaction (skip if unpack event)
-    if ( objInfo.event != EV_UNPACKED )
-    {
-        UAVObject::Metadata metadata = objInfo.obj->getMetadata();
-        transInfo.obj = objInfo.obj;
-        transInfo.allInstances = objInfo.allInstances;
-        transInfo.retriesRemaining = MAX_RETRIES;
-        transInfo.acked = metadata.gcsTelemetryAcked;
-        if ( objInfo.event == EV_UPDATED || objInfo.event == EV_UPDATED_MANUAL )
+        // Check if a connection has been established, only process GCSTelemetryStats updates
+        // (used to establish the connection)
+        GCSTelemetryStats::DataFields gcsStats = gcsStatsObj->getData();
+        if ( gcsStats.Status != GCSTelemetryStats::STATUS_CONNECTED )
         {
-            transInfo.objRequest = false;
+            objQueue.clear();
+            if ( objInfo.obj->getObjID() != GCSTelemetryStats::OBJID )
+            {
+                objInfo.obj->emitTransactionCompleted(false);
+                continue;
+            }
         }
-        else if ( objInfo.event == EV_UPDATE_REQ )
+
+        // Setup transaction (skip if unpack event)
+        if ( objInfo.event != EV_UNPACKED )
+        {
+            UAVObject::Metadata metadata = objInfo.obj->getMetadata();
+            ObjectTransactionInfo* transInfo = new ObjectTransactionInfo;
+            transInfo->obj = objInfo.obj;
+            transInfo->allInstances = objInfo.allInstances;
+            transInfo->retriesRemaining = MAX_RETRIES;
+            transInfo->acked = metadata.gcsTelemetryAcked;
+            transInfo->objRequest = ( objInfo.event == EV_UPDATE_REQ );
+            transInfo->timer = new QTimer(this);
+            transInfo->timer->setSingleShot(true);
+            connect(transInfo->timer, SIGNAL(timeout()), this, SLOT(transactionTimeout()));
+            transMap.insert(transactionKey(objInfo.obj, objInfo.allInstances ? ALL_INSTANCES_KEY : objInfo.obj->getInstID()), transInfo);
+            if ( (quint32)transMap.size() > txPending )
+            {
+                txPending = transMap.size();
+            }
+            // Start transaction
+            processObjectTransaction(transInfo);
+        } else
         {
-            transInfo.objRequest = true;
+//            qDebug() << QString("Process object queue: this is an unpack event for %1").arg(objInfo.obj->getName());
         }
-        // Start transaction
-        transPending = true;
-        processObjectTransaction();
-    } else
-    {
-//        qDebug() << QString("Process object queue: this is an unpack event for %1").arg(objInfo.obj->getName());
-    }
 
-    // If this is a metaobject then make necessary telemetry updates
-    UAVMetaObject* metaobj = dynamic_cast<UAVMetaObject*>(objInfo.obj);
-    if ( metaobj != NULL )
-    {
-        updateObject( metaobj->getParentObject() );
+        // If this is a metaobject then make necessary telemetry updates
+        UAVMetaObject* metaobj = dynamic_cast<UAVMetaObject*>(objInfo.obj);
+        if ( metaobj != NULL )
+        {
+            updateObject( metaobj->getParentObject() );
+        }
     }
-
-    // The fact we received an unpacked event does not mean that
-    // we do not have additional objects still in the queue,
-    // so we have to reschedule queue processing to make sure they are not
-    // stuck:
-    if ( objInfo.event == EV_UNPACKED )
-        processObjectQueue();
-
 }
 
 /**
@@ -497,6 +586,10 @@ Telemetry::TelemetryStats Telemetry::getStats()
     stats.txErrors = utalkStats.txErrors + txErrors;
     stats.rxErrors = utalkStats.rxErrors;
     stats.txRetries = txRetries;
+    stats.txQueueDepth = txQueueDepth;
+    stats.txPending = txPending;
+    stats.txCoalesced = txCoalesced;
+    stats.txQueueFull = txQueueFull;
 
     // Done
     return stats;
@@ -508,6 +601,10 @@ void Telemetry::resetStats()
     utalk->resetStats();
     txErrors = 0;
     txRetries = 0;
+    txQueueDepth = objQueue.length() + objPriorityQueue.length();
+    txPending = transMap.size();
+    txCoalesced = 0;
+    txQueueFull = 0;
 }
 
 void Telemetry::objectUpdatedAuto(UAVObject* obj)
@@ -35,6 +35,7 @@
 #include <QMutexLocker>
 #include <QTimer>
 #include <QQueue>
+#include <QHash>
 
 class Telemetry: public QObject
 {
@@ -51,9 +52,14 @@ public:
         quint32 txErrors;
         quint32 rxErrors;
         quint32 txRetries;
+        quint32 txQueueDepth;
+        quint32 txPending;
+        quint32 txCoalesced;
+        quint32 txQueueFull;
     } TelemetryStats;
 
     Telemetry(UAVTalk* utalk, UAVObjectManager* objMngr);
+    ~Telemetry();
     TelemetryStats getStats();
     void resetStats();
 
@@ -77,7 +83,9 @@ private:
     static const int MAX_RETRIES = 2;
     static const int MAX_UPDATE_PERIOD_MS = 1000;
     static const int MIN_UPDATE_PERIOD_MS = 1;
-    static const int MAX_QUEUE_SIZE = 20;
+    static const int MAX_QUEUE_SIZE = 100;
+    static const int MAX_PENDING_TRANSACTIONS = 4;
+    static const quint32 ALL_INSTANCES_KEY = 0xFFFFFFFF;
 
     // Types
     /**
@@ -108,6 +116,7 @@ private:
         bool objRequest;
         qint32 retriesRemaining;
         bool acked;
+        QTimer* timer;
     } ObjectTransactionInfo;
 
     // Variables
@@ -117,15 +126,17 @@ private:
     QList<ObjectTimeInfo> objList;
     QQueue<ObjectQueueInfo> objQueue;
     QQueue<ObjectQueueInfo> objPriorityQueue;
-    ObjectTransactionInfo transInfo;
-    bool transPending;
+    QHash<quint64, ObjectTransactionInfo*> transMap;
     QMutex* mutex;
     QTimer* updateTimer;
-    QTimer* transTimer;
     QTimer* statsTimer;
     qint32 timeToNextUpdateMs;
     quint32 txErrors;
     quint32 txRetries;
+    quint32 txQueueDepth;
+    quint32 txPending;
+    quint32 txCoalesced;
+    quint32 txQueueFull;
 
     // Methods
     void registerObject(UAVObject* obj);
@@ -134,7 +145,12 @@ private:
     void connectToObjectInstances(UAVObject* obj, quint32 eventMask);
     void updateObject(UAVObject* obj);
     void processObjectUpdates(UAVObject* obj, EventMask event, bool allInstances, bool priority);
-    void processObjectTransaction();
+    bool enqueueObjectUpdate(QQueue<ObjectQueueInfo>& queue, const ObjectQueueInfo& objInfo);
+    bool dequeueObjectUpdate(QQueue<ObjectQueueInfo>& queue, ObjectQueueInfo& objInfo);
+    bool isTransactionPending(UAVObject* obj, bool allInstances);
+    ObjectTransactionInfo* findTransaction(UAVObject* obj);
+    void processObjectTransaction(ObjectTransactionInfo* transInfo);
+    void endTransaction(ObjectTransactionInfo* transInfo);
     void processObjectQueue();
 
 
@@ -195,6 +195,10 @@ void TelemetryMonitor::processStatsUpdates()
     gcsStats.RxFailures += telStats.rxErrors;
     gcsStats.TxFailures += telStats.txErrors;
     gcsStats.TxRetries += telStats.txRetries;
+    gcsStats.TxQueueDepth = telStats.txQueueDepth;
+    gcsStats.TxPending = telStats.txPending;
+    gcsStats.TxCoalesced += telStats.txCoalesced;
+    gcsStats.TxQueueFull += telStats.txQueueFull;
 
     // Check for a connection timeout
     bool connectionTimeout;
@@ -64,8 +64,6 @@ UAVTalk::UAVTalk(QIODevice* iodev, UAVObjectManager* objMngr)
 
     mutex = new QMutex(QMutex::Recursive);
 
-    respObj = NULL;
-
     memset(&stats, 0, sizeof(ComStats));
 
     connect(io, SIGNAL(readyRead()), this, SLOT(processInputStream()));
@@ -98,16 +96,84 @@ UAVTalk::ComStats UAVTalk::getStats()
 }
 
 /**
- * Called each time there are data in the input buffer
+ * Called each time there are data in the input buffer, reads everything
+ * available in blocks and parses each block at once
  */
 void UAVTalk::processInputStream()
 {
-    quint8 tmp;
-
     while (io->bytesAvailable() > 0)
     {
-        io->read((char*)&tmp, 1);
-        processInputByte(tmp);
+        qint64 length = io->read((char*)rxReadBuffer, RX_READ_BUFFER_SIZE);
+        if (length <= 0)
+            break;
+        processInputBuffer(rxReadBuffer, length);
+    }
+}
+
+/**
+ * Process a block of bytes from the telemetry stream.
+ * Gives the same result as calling processInputByte() for each byte, but garbage
+ * between packets is skipped with a single search for the sync byte and the payload
+ * is checksummed in one go. When the whole payload and its checksum are in the
+ * block the object is unpacked straight from the block, otherwise the payload is
+ * copied to rxBuffer in spans.
+ * \param[in] data Received bytes
+ * \param[in] length Number of received bytes
+ */
+void UAVTalk::processInputBuffer(quint8* data, qint64 length)
+{
+    quint8* end = data + length;
+
+    while (data < end)
+    {
+        if (rxState == STATE_SYNC)
+        {
+            // Skip everything up to the next sync byte
+            quint8* sync = (quint8*)memchr(data, SYNC_VAL, end - data);
+            if (sync == NULL)
+                sync = end;
+            stats.rxBytes += sync - data;
+            data = sync;
+            if (data < end)
+                processInputByte(*data++);
+        }
+        else if (rxState == STATE_DATA)
+        {
+            if (rxCount == 0 && end - data > rxLength)
+            {
+                // Complete payload and checksum available, no need to copy it
+                rxCS = updateCRC(rxCS, data, rxLength);
+                rxPacketLength += rxLength + 1;
+                stats.rxBytes += rxLength + 1;
+                processChecksum(data[rxLength], data);
+                data += rxLength + 1;
+                continue;
+            }
+
+            // Take as much of the payload as is available
+            qint32 count = rxLength - rxCount;
+            if (count > end - data)
+                count = end - data;
+
+            rxCS = updateCRC(rxCS, data, count);
+            memcpy(&rxBuffer[rxCount], data, count);
+            rxCount += count;
+            rxPacketLength += count;
+            stats.rxBytes += count;
+            stats.rxCopiedBytes += count;
+            data += count;
+
+            if (rxCount >= rxLength)
+            {
+                rxState = STATE_CS;
+                rxCount = 0;
+            }
+        }
+        else
+        {
+            // Header and checksum bytes
+            processInputByte(*data++);
+        }
     }
 }
 
@@ -145,12 +211,20 @@ bool UAVTalk::sendObject(UAVObject* obj, bool acked, bool allInstances)
 }
 
 /**
- * Cancel a pending transaction
+ * Cancel the pending transaction of an object
+ * \param[in] obj Object given when the transaction was started
  */
-void UAVTalk::cancelTransaction()
+void UAVTalk::cancelTransaction(UAVObject* obj)
 {
     QMutexLocker locker(mutex);
-    respObj = NULL;
+    for (int n = 0; n < pendingTransactions.length(); ++n)
+    {
+        if (pendingTransactions[n].obj == obj)
+        {
+            pendingTransactions.removeAt(n);
+            return;
+        }
+    }
 }
 
 /**
@@ -170,8 +244,14 @@ bool UAVTalk::objectTransaction(UAVObject* obj, quint8 type, bool allInstances)
     {
         if ( transmitObject(obj, type, allInstances) )
         {
-            respObj = obj;
-            respAllInstances = allInstances;    
+            // Several transactions can be pending, one per object instance
+            if (findTransaction(obj) < 0)
+            {
+                PendingTransaction trans;
+                trans.obj = obj;
+                trans.allInstances = allInstances;
+                pendingTransactions.append(trans);
+            }
             return true;
         }
         else
@@ -357,6 +437,7 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
             rxCS = updateCRC(rxCS, rxbyte);
 
             rxBuffer[rxCount++] = rxbyte;
+            ++stats.rxCopiedBytes;
             if (rxCount < rxLength)
                 break;
 
@@ -366,30 +447,7 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
 
         case STATE_CS:
 
-            // The CRC byte
-            rxCSPacket = rxbyte;
-
-            if (rxCS != rxCSPacket)
-            {   // packet error - faulty CRC
-                stats.rxErrors++;
-                rxState = STATE_SYNC;
-                break;
-            }
-
-            if (rxPacketLength != packetSize + 1)
-            {   // packet error - mismatched packet size
-                stats.rxErrors++;
-                rxState = STATE_SYNC;
-                break;
-            }
-
-            mutex->lock();
-                receiveObject(rxType, rxObjId, rxInstId, rxBuffer, rxLength);
-                stats.rxObjectBytes += rxLength;
-                stats.rxObjects++;
-            mutex->unlock();
-
-            rxState = STATE_SYNC;
+            processChecksum(rxbyte, rxBuffer);
             break;
 
         default:
@@ -401,6 +459,40 @@ bool UAVTalk::processInputByte(quint8 rxbyte)
     return true;
 }
 
+/**
+ * Check the checksum byte of a packet and process the received object.
+ * \param[in] rxbyte Received checksum byte
+ * \param[in] payload Payload of the packet, either rxBuffer or the block being parsed
+ * \return Success (true), Failure (false)
+ */
+bool UAVTalk::processChecksum(quint8 rxbyte, quint8* payload)
+{
+    rxState = STATE_SYNC;
+
+    // The CRC byte
+    rxCSPacket = rxbyte;
+
+    if (rxCS != rxCSPacket)
+    {   // packet error - faulty CRC
+        stats.rxErrors++;
+        return false;
+    }
+
+    if (rxPacketLength != packetSize + 1)
+    {   // packet error - mismatched packet size
+        stats.rxErrors++;
+        return false;
+    }
+
+    mutex->lock();
+        receiveObject(rxType, rxObjId, rxInstId, payload, rxLength);
+        stats.rxObjectBytes += rxLength;
+        stats.rxObjects++;
+    mutex->unlock();
+
+    return true;
+}
+
 /**
  * Receive an object. This function process objects received through the telemetry stream.
  * \param[in] type Type of received message (TYPE_OBJ, TYPE_OBJ_REQ, TYPE_OBJ_ACK, TYPE_ACK, TYPE_NACK)
@@ -556,13 +648,13 @@ UAVObject* UAVTalk::updateObject(quint32 objId, quint16 instId, quint8* data)
         {
             return NULL;
         }
-        instobj->unpack(data);
+        stats.rxCopiedBytes += instobj->unpack(data);
         return instobj;
     }
     else
     {
         // Unpack data into object instance
-        obj->unpack(data);
+        stats.rxCopiedBytes += obj->unpack(data);
         return obj;
     }
 }
@@ -572,9 +664,10 @@ UAVObject* UAVTalk::updateObject(quint32 objId, quint16 instId, quint8* data)
  */
 void UAVTalk::updateNack(UAVObject* obj)
 {
-    if (respObj != NULL && respObj->getObjID() == obj->getObjID() && (respObj->getInstID() == obj->getInstID() || respAllInstances))
+    int n = findTransaction(obj);
+    if (n >= 0)
     {
-        respObj = NULL;
+        pendingTransactions.removeAt(n);
         emit transactionCompleted(obj, false);
     }
 }
@@ -585,13 +678,31 @@ void UAVTalk::updateNack(UAVObject* obj)
  */
 void UAVTalk::updateAck(UAVObject* obj)
 {
-    if (respObj != NULL && respObj->getObjID() == obj->getObjID() && (respObj->getInstID() == obj->getInstID() || respAllInstances))
+    int n = findTransaction(obj);
+    if (n >= 0)
     {
-        respObj = NULL;
+        pendingTransactions.removeAt(n);
         emit transactionCompleted(obj, true);
     }
 }
 
+/**
+ * Find the pending transaction a received object instance answers.
+ * \return The index in pendingTransactions or -1 if none
+ */
+int UAVTalk::findTransaction(UAVObject* obj)
+{
+    for (int n = 0; n < pendingTransactions.length(); ++n)
+    {
+        UAVObject* respObj = pendingTransactions[n].obj;
+        if (respObj->getObjID() == obj->getObjID() && (respObj->getInstID() == obj->getInstID() || pendingTransactions[n].allInstances))
+        {
+            return n;
+        }
+    }
+    return -1;
+}
+
 
 /**
  * Send an object through the telemetry link.
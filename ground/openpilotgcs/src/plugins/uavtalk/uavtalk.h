@@ -48,15 +48,18 @@ public:
         quint32 txObjects;
         quint32 txErrors;
         quint32 rxErrors;
+        quint32 rxCopiedBytes;
     } ComStats;
 
     UAVTalk(QIODevice* iodev, UAVObjectManager* objMngr);
     ~UAVTalk();
     bool sendObject(UAVObject* obj, bool acked, bool allInstances);
     bool sendObjectRequest(UAVObject* obj, bool allInstances);
-    void cancelTransaction();
+    void cancelTransaction(UAVObject* obj);
     ComStats getStats();
     void resetStats();
+    // Decode a block of received bytes, for streams that are not read from the QIODevice
+    void processInputBuffer(quint8* data, qint64 length);
 
 signals:
     void transactionCompleted(UAVObject* obj, bool success);
@@ -87,19 +90,25 @@ private:
     static const quint16 OBJID_NOTFOUND = 0x0000;
 
     static const int TX_BUFFER_SIZE = 2*1024;
+    static const int RX_READ_BUFFER_SIZE = 4*1024;
     static const quint8 crc_table[256];
 
     // Types
     typedef enum {STATE_SYNC, STATE_TYPE, STATE_SIZE, STATE_OBJID, STATE_INSTID, STATE_DATA, STATE_CS} RxStateType;
 
+    typedef struct {
+        UAVObject* obj;
+        bool allInstances;
+    } PendingTransaction;
+
     // Variables
     QIODevice* io;
     UAVObjectManager* objMngr;
     QMutex* mutex;
-    UAVObject* respObj;
-    bool respAllInstances;
+    QList<PendingTransaction> pendingTransactions;
     quint8 rxBuffer[MAX_PACKET_LENGTH];
     quint8 txBuffer[MAX_PACKET_LENGTH];
+    quint8 rxReadBuffer[RX_READ_BUFFER_SIZE];
     // Variables used by the receive state machine
     quint8 rxTmpBuffer[4];
     quint8 rxType;
@@ -117,8 +126,10 @@ private:
     // Methods
     bool objectTransaction(UAVObject* obj, quint8 type, bool allInstances);
     bool processInputByte(quint8 rxbyte);
+    bool processChecksum(quint8 rxbyte, quint8* payload);
     bool receiveObject(quint8 type, quint32 objId, quint16 instId, quint8* data, qint32 length);
     UAVObject* updateObject(quint32 objId, quint16 instId, quint8* data);
+    int findTransaction(UAVObject* obj);
     void updateAck(UAVObject* obj);
     void updateNack(UAVObject* obj);
     bool transmitNack(quint32 objId);
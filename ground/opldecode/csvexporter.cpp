@@ -0,0 +1,114 @@
+/**
+ ******************************************************************************
+ *
+ * @file       csvexporter.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2011.
+ * @brief      Writes the updates of selected objects to CSV files.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include "csvexporter.h"
+#include <QDir>
+
+CsvExporter::CsvExporter(UAVObjectManager *objMngr, const QString &directory) :
+    objMngr(objMngr),
+    directory(directory),
+    time(0)
+{
+    // Count the updates of all objects, instances created by the log included
+    QList< QList<UAVObject*> > objs = objMngr->getObjects();
+    for (int n = 0; n < objs.length(); ++n)
+        for (int i = 0; i < objs[n].length(); ++i)
+            connect(objs[n][i], SIGNAL(objectUnpacked(UAVObject*)), this, SLOT(objectUnpacked(UAVObject*)));
+    connect(objMngr, SIGNAL(newInstance(UAVObject*)), this, SLOT(newInstance(UAVObject*)));
+}
+
+CsvExporter::~CsvExporter()
+{
+    foreach (Output output, outputs)
+    {
+        delete output.stream;
+        delete output.file;
+    }
+}
+
+/**
+ * Export the updates of an object
+ * \return false if the object is unknown or its file can't be created
+ */
+bool CsvExporter::addObject(const QString &name)
+{
+    UAVObject *obj = objMngr->getObject(name);
+    if (obj == NULL)
+        return false;
+    if (outputs.contains(name))
+        return true;
+
+    Output output;
+    output.file = new QFile(QDir(directory).filePath(name + ".csv"));
+    if (!output.file->open(QIODevice::WriteOnly | QIODevice::Truncate | QIODevice::Text))
+    {
+        delete output.file;
+        return false;
+    }
+    output.stream = new QTextStream(output.file);
+    writeHeader(*output.stream, obj);
+    outputs.insert(name, output);
+    return true;
+}
+
+void CsvExporter::writeHeader(QTextStream &out, UAVObject *obj)
+{
+    out << "time_ms,instance";
+    QList<UAVObjectField*> fields = obj->getFields();
+    for (int n = 0; n < fields.length(); ++n)
+    {
+        if (fields[n]->getNumElements() == 1)
+        {
+            out << "," << fields[n]->getName();
+            continue;
+        }
+        QStringList elements = fields[n]->getElementNames();
+        for (int i = 0; i < elements.length(); ++i)
+            out << "," << fields[n]->getName() << "." << elements[i];
+    }
+    out << "\n";
+}
+
+void CsvExporter::objectUnpacked(UAVObject *obj)
+{
+    ++counts[obj->getName()];
+
+    QHash<QString, Output>::iterator output = outputs.find(obj->getName());
+    if (output == outputs.end())
+        return;
+
+    QTextStream &out = *output->stream;
+    out << time << "," << obj->getInstID();
+    QList<UAVObjectField*> fields = obj->getFields();
+    for (int n = 0; n < fields.length(); ++n)
+        for (quint32 i = 0; i < fields[n]->getNumElements(); ++i)
+            out << "," << fields[n]->getValue(i).toString();
+    out << "\n";
+}
+
+void CsvExporter::newInstance(UAVObject *obj)
+{
+    connect(obj, SIGNAL(objectUnpacked(UAVObject*)), this, SLOT(objectUnpacked(UAVObject*)));
+}
@@ -0,0 +1,68 @@
+/**
+ ******************************************************************************
+ *
+ * @file       csvexporter.h
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2011.
+ * @brief      Writes the updates of selected objects to CSV files.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#ifndef CSVEXPORTER_H
+#define CSVEXPORTER_H
+
+#include <QObject>
+#include <QFile>
+#include <QHash>
+#include <QTextStream>
+#include "uavobjectmanager.h"
+
+/**
+ * Writes a line to <directory>/<object>.csv each time an instance of an
+ * exported object is unpacked, and counts the updates of every object.
+ */
+class CsvExporter : public QObject
+{
+    Q_OBJECT
+public:
+    CsvExporter(UAVObjectManager *objMngr, const QString &directory);
+    ~CsvExporter();
+    bool addObject(const QString &name);
+    void setTime(quint32 timeStamp) { time = timeStamp; }
+    QHash<QString, quint32> updateCounts() const { return counts; }
+
+private slots:
+    void objectUnpacked(UAVObject *obj);
+    void newInstance(UAVObject *obj);
+
+private:
+    struct Output {
+        QFile *file;
+        QTextStream *stream;
+    };
+
+    UAVObjectManager *objMngr;
+    QString directory;
+    quint32 time;
+    QHash<QString, Output> outputs;
+    QHash<QString, quint32> counts;
+
+    void writeHeader(QTextStream &out, UAVObject *obj);
+};
+
+#endif // CSVEXPORTER_H
@@ -0,0 +1,135 @@
+/**
+ ******************************************************************************
+ *
+ * @file       main.cpp
+ * @author     The OpenPilot Team, http://www.openpilot.org Copyright (C) 2011.
+ * @brief      Decodes GCS .opl logs without the GCS, as fast as the records
+ *             can be unpacked.
+ *
+ * @see        The GNU Public License (GPL) Version 3
+ *
+ *****************************************************************************/
+/*
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of MERCHANTABILITY
+ * or FITNESS FOR A PARTICULAR PURPOSE. See the GNU General Public License
+ * for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with this program; if not, write to the Free Software Foundation, Inc.,
+ * 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA
+ */
+#include <QtCore/QCoreApplication>
+#include <QBuffer>
+#include <QStringList>
+#include <QTime>
+#include <iostream>
+#include "uavobjectmanager.h"
+#include "uavobjectsinit.h"
+#include "uavtalk.h"
+#include "logreader.h"
+#include "csvexporter.h"
+
+#define RETURN_ERR_USAGE 1
+#define RETURN_ERR_FILE 2
+#define RETURN_OK 0
+
+using namespace std;
+
+static void usage()
+{
+    cout << "Usage: opldecode [-o directory] logfile.opl [UAVObj1] ... [UAVObjN]" << endl;
+    cout << "\tWithout objects, prints the objects of the log and their number of updates" << endl;
+    cout << "\tWith objects, writes the updates of each object to directory/UAVObj.csv" << endl;
+}
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication a(argc, argv);
+    QStringList arguments = a.arguments();
+    QString directory = ".";
+
+    arguments.removeFirst();
+    if (arguments.length() >= 2 && arguments[0] == "-o")
+    {
+        directory = arguments[1];
+        arguments = arguments.mid(2);
+    }
+    if (arguments.isEmpty())
+    {
+        usage();
+        return RETURN_ERR_USAGE;
+    }
+
+    QString fileName = arguments.takeFirst();
+    LogReader reader;
+    if (!reader.open(fileName))
+    {
+        cerr << "Unable to open " << qPrintable(fileName) << endl;
+        return RETURN_ERR_FILE;
+    }
+
+    UAVObjectManager objMngr;
+    UAVObjectsInitialize(&objMngr);
+
+    // Nothing is read from the link, the records are handed to UAVTalk directly
+    QBuffer link;
+    link.open(QIODevice::ReadWrite);
+    UAVTalk talk(&link, &objMngr);
+
+    CsvExporter exporter(&objMngr, directory);
+    foreach (QString name, arguments)
+    {
+        if (!exporter.addObject(name))
+        {
+            cerr << "Unknown object or unable to create the file for " << qPrintable(name) << endl;
+            return RETURN_ERR_FILE;
+        }
+    }
+
+    QTime timer;
+    qint64 bytes = 0;
+    quint32 lastTime = 0;
+    timer.start();
+
+    // Keyframes repeat the state the data records already give
+    while (reader.next())
+    {
+        if (reader.recordType() != LogReader::RECORD_DATA)
+            continue;
+        exporter.setTime(reader.recordTime());
+        talk.processInputBuffer((quint8*)reader.recordData(), reader.recordSize());
+        bytes += reader.recordSize();
+        lastTime = reader.recordTime();
+    }
+
+    int elapsed = qMax(timer.elapsed(), 1);
+    cout << qPrintable(fileName) << ": version " << reader.version() << ", " << lastTime / 1000
+         << " s, " << bytes << " bytes decoded in " << elapsed << " ms ("
+         << (bytes * 1000 / elapsed) / 1024 << " KB/s)" << endl;
+
+    if (arguments.isEmpty())
+    {
+        QHash<QString, quint32> counts = exporter.updateCounts();
+        QList<LogReader::ObjectInfo> dictionary = reader.objectDictionary();
+        for (int n = 0; n < dictionary.length(); ++n)
+        {
+            cout << qPrintable(dictionary[n].name) << " 0x" << hex << dictionary[n].objId << dec
+                 << ", " << dictionary[n].numBytes << " bytes, " << dictionary[n].numInstances
+                 << " instances, " << counts.value(dictionary[n].name) << " updates" << endl;
+        }
+        // Version 1 logs have no dictionary
+        if (dictionary.isEmpty())
+        {
+            foreach (QString name, counts.keys())
+                cout << qPrintable(name) << ", " << counts[name] << " updates" << endl;
+        }
+    }
+
+    return RETURN_OK;
+}
@@ -0,0 +1,35 @@
+# -------------------------------------------------
+# Command line decoder of GCS .opl logs
+# -------------------------------------------------
+QT -= gui
+TARGET = opldecode
+CONFIG += console
+CONFIG -= app_bundle
+TEMPLATE = app
+DEFINES += UAVOBJECTS_LIBRARY \
+    UAVTALK_LIBRARY
+PLUGINS = $$PWD/../openpilotgcs/src/plugins
+UAVOBJECT_SYNTHETICS = $$PWD/../../build/uavobject-synthetics/gcs
+INCLUDEPATH += $$PLUGINS/uavobjects \
+    $$PLUGINS/uavtalk \
+    $$PLUGINS/logging \
+    $$UAVOBJECT_SYNTHETICS
+SOURCES += main.cpp \
+    csvexporter.cpp \
+    $$PLUGINS/uavobjects/uavobjectmanager.cpp \
+    $$PLUGINS/uavobjects/uavobjectfield.cpp \
+    $$PLUGINS/uavobjects/uavobject.cpp \
+    $$PLUGINS/uavobjects/uavmetaobject.cpp \
+    $$PLUGINS/uavobjects/uavdataobject.cpp \
+    $$PLUGINS/uavtalk/uavtalk.cpp \
+    $$PLUGINS/logging/logreader.cpp \
+    $$files($$UAVOBJECT_SYNTHETICS/*.cpp)
+HEADERS += csvexporter.h \
+    $$PLUGINS/uavobjects/uavobjectmanager.h \
+    $$PLUGINS/uavobjects/uavobjectfield.h \
+    $$PLUGINS/uavobjects/uavobject.h \
+    $$PLUGINS/uavobjects/uavmetaobject.h \
+    $$PLUGINS/uavobjects/uavdataobject.h \
+    $$PLUGINS/uavtalk/uavtalk.h \
+    $$PLUGINS/logging/logreader.h \
+    $$files($$UAVOBJECT_SYNTHETICS/*.h)